@@ -0,0 +1,288 @@
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <iterator>
+#include <liberay/math/vec.hpp>
+#include <liberay/util/logger.hpp>
+#include <libminicad/algorithm/ball_finishing_paths.hpp>
+#include <libminicad/algorithm/parallel.hpp>
+#include <limits>
+#include <utility>
+#include <vector>
+
+namespace mini {
+
+namespace {
+
+// Uniform intervals of an iso-line before the adaptive subdivision and the max subdivision depth of an interval
+constexpr uint32_t kInitialIntervals = 8;
+constexpr uint32_t kMaxDepth         = 10;
+
+// Number of the samples of an iso-line used to estimate the parameter distance to the next iso-line
+constexpr uint32_t kSpacingProbes = 16;
+constexpr float kMinLineStep      = 1e-4F;
+constexpr float kMaxLineStep      = 0.25F;
+
+// Slack of the link checks, the tips of the iso-lines lie exactly on the safety heights
+constexpr float kLinkEpsilon = 1e-4F;
+
+/**
+ * @brief The safety heights in world space. The height at a position is the max of the 4 texels around it, so the
+ * cutter never dips below the field between the texels. Outside of the field the background height is used.
+ *
+ */
+class SafetyField {
+ public:
+  SafetyField(const TiledHeightField& heights, const MillingDesc& milling)
+      : heights_(heights),
+        milling_(milling),
+        texel_size_(milling.width / static_cast<float>(std::max(heights.width(), 1U)),
+                    milling.height / static_cast<float>(std::max(heights.height(), 1U))) {}
+
+  [[nodiscard]] float at(float x, float z) const {
+    // Inverse of `MillingDesc::texel_center`
+    auto fx = static_cast<int64_t>(std::floor((x + milling_.width / 2.F) / texel_size_.x - 0.5F));
+    auto fz = static_cast<int64_t>(std::floor((z + milling_.height / 2.F) / texel_size_.y - 0.5F));
+
+    auto result = heights_.background();
+    for (auto tz = fz; tz <= fz + 1; ++tz) {
+      for (auto tx = fx; tx <= fx + 1; ++tx) {
+        if (tx >= 0 && tz >= 0 && tx < heights_.width() && tz < heights_.height()) {
+          result = std::max(result, heights_.at(static_cast<uint32_t>(tx), static_cast<uint32_t>(tz)));
+        }
+      }
+    }
+    return result;
+  }
+
+  /**
+   * @brief Returns true if the straight move between the tips stays above the safety heights.
+   *
+   */
+  [[nodiscard]] bool is_clear(const eray::math::Vec3f& a, const eray::math::Vec3f& b) const {
+    auto dist  = std::max(std::abs(b.x - a.x) / texel_size_.x, std::abs(b.z - a.z) / texel_size_.y);
+    auto steps = static_cast<uint32_t>(std::ceil(dist)) + 1;
+    for (auto i = 0U; i <= steps; ++i) {
+      auto p = a + (static_cast<float>(i) / static_cast<float>(steps)) * (b - a);
+      if (p.y < at(p.x, p.z) - kLinkEpsilon) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+ private:
+  const TiledHeightField& heights_;
+  const MillingDesc& milling_;
+  eray::math::Vec2f texel_size_;
+};
+
+struct Sample {
+  float t;
+  eray::math::Vec3f tip;
+  bool trimmed;
+};
+
+/**
+ * @brief Samples the iso-lines of a single surface. The line parameter is the fixed parameter of an iso-line and t the
+ * one varying along it.
+ *
+ */
+class IsoLineSampler {
+ public:
+  IsoLineSampler(const SceneSnapshot::PatchSurfaceView& surface, const SafetyField& safety,
+                 const BallFinishingDesc& desc)
+      : surface_(surface), safety_(safety), desc_(desc) {}
+
+  /**
+   * @brief Untrimmed runs of the cutter tips along the iso-line.
+   *
+   */
+  [[nodiscard]] std::vector<std::vector<eray::math::Vec3f>> runs(float line) const {
+    auto samples = std::vector<Sample>();
+    samples.push_back(sample(line, 0.F));
+    for (auto i = 1U; i <= kInitialIntervals; ++i) {
+      auto start = samples.back();
+      auto end   = sample(line, static_cast<float>(i) / static_cast<float>(kInitialIntervals));
+      refine(line, start, end, 0, samples);
+    }
+
+    auto result = std::vector<std::vector<eray::math::Vec3f>>();
+    auto run    = std::vector<eray::math::Vec3f>();
+    for (const auto& s : samples) {
+      if (!s.trimmed) {
+        run.push_back(s.tip);
+        continue;
+      }
+      if (run.size() > 1) {
+        result.push_back(std::move(run));
+      }
+      run.clear();
+    }
+    if (run.size() > 1) {
+      result.push_back(std::move(run));
+    }
+
+    return result;
+  }
+
+  /**
+   * @brief Parameter step to the next iso-line: the line spacing divided by the max rate of change of the surface
+   * across the line.
+   *
+   */
+  [[nodiscard]] float next_line_step(float line) const {
+    auto max_rate = 0.F;
+    for (auto i = 0U; i < kSpacingProbes; ++i) {
+      auto t        = (static_cast<float>(i) + 0.5F) / static_cast<float>(kSpacingProbes);
+      auto [u, v]   = to_uv(line, t);
+      auto [du, dv] = surface_.evaluate_derivatives(u, v);
+      max_rate      = std::max(max_rate, eray::math::length(desc_.direction == IsoLineDirection::AlongU ? dv : du));
+    }
+
+    if (max_rate <= 0.F) {
+      return kMaxLineStep;
+    }
+    return std::clamp(desc_.line_spacing / max_rate, kMinLineStep, kMaxLineStep);
+  }
+
+ private:
+  [[nodiscard]] std::pair<float, float> to_uv(float line, float t) const {
+    return desc_.direction == IsoLineDirection::AlongU ? std::pair{t, line} : std::pair{line, t};
+  }
+
+  [[nodiscard]] Sample sample(float line, float t) const {
+    auto [u, v]   = to_uv(line, t);
+    auto point    = surface_.evaluate(u, v);
+    auto [du, dv] = surface_.evaluate_derivatives(u, v);
+
+    // The cutter reaches the surface from above, so the normal is flipped upwards
+    auto normal = eray::math::cross(du, dv);
+    if (normal.y < 0.F) {
+      normal = eray::math::cross(dv, du);
+    }
+    normal = eray::math::length(normal) > std::numeric_limits<float>::epsilon() ? eray::math::normalize(normal)
+                                                                                : eray::math::Vec3f(0.F, 1.F, 0.F);
+
+    // Ball center offset along the normal and the tip below it
+    auto tip = point + desc_.cutter_radius * normal - eray::math::Vec3f(0.F, desc_.cutter_radius, 0.F);
+    tip.y    = std::max(tip.y, safety_.at(tip.x, tip.z));
+
+    return Sample{.t = t, .tip = tip, .trimmed = surface_.trimming_mask.is_trimmed(u, v)};
+  }
+
+  /**
+   * @brief Appends the samples of the interval (a, b]. The interval is halved while it's longer than the max sample
+   * spacing, its midpoint deviates from the chord or it crosses the trimming boundary.
+   *
+   */
+  void refine(float line, const Sample& a, const Sample& b, uint32_t depth, std::vector<Sample>& out) const {
+    if (depth < kMaxDepth) {
+      auto mid       = sample(line, 0.5F * (a.t + b.t));
+      auto deviation = eray::math::distance(mid.tip, 0.5F * (a.tip + b.tip));
+      if (a.trimmed != b.trimmed || deviation > desc_.tolerance ||
+          eray::math::distance(a.tip, b.tip) > desc_.max_sample_spacing) {
+        refine(line, a, mid, depth + 1, out);
+        refine(line, mid, b, depth + 1, out);
+        return;
+      }
+    }
+
+    out.push_back(b);
+  }
+
+  const SceneSnapshot::PatchSurfaceView& surface_;
+  const SafetyField& safety_;
+  const BallFinishingDesc& desc_;
+};
+
+/**
+ * @brief Runs of the cutter tips of a surface in the milling order, every other iso-line is reversed.
+ *
+ */
+std::vector<std::vector<eray::math::Vec3f>> surface_strokes(const SceneSnapshot::PatchSurfaceView& surface,
+                                                            const SafetyField& safety, const BallFinishingDesc& desc,
+                                                            const JobContext& ctx) {
+  const auto sampler = IsoLineSampler(surface, safety, desc);
+
+  auto result  = std::vector<std::vector<eray::math::Vec3f>>();
+  auto reverse = false;
+  for (auto line = 0.F;; line = std::min(line + sampler.next_line_step(line), 1.F)) {
+    if (ctx.is_cancelled()) {
+      return {};
+    }
+
+    auto runs = sampler.runs(line);
+    if (reverse) {
+      std::ranges::reverse(runs);
+      for (auto& run : runs) {
+        std::ranges::reverse(run);
+      }
+    }
+    std::ranges::move(runs, std::back_inserter(result));
+
+    // A line without any untrimmed run doesn't change the direction, so the zig-zag continues at the same side
+    reverse = runs.empty() ? reverse : !reverse;
+    if (line >= 1.F) {
+      break;
+    }
+  }
+
+  return result;
+}
+
+}  // namespace
+
+ToolPath BallFinishingPaths::generate(const SceneSnapshot& snapshot, std::span<const PatchSurfaceHandle> handles,
+                                      const TiledHeightField& safety_heights, const MillingDesc& milling,
+                                      const BallFinishingDesc& desc, const JobContext& ctx) {
+  const auto safety = SafetyField(safety_heights, milling);
+
+  auto strokes       = std::vector<std::vector<std::vector<eray::math::Vec3f>>>(handles.size());
+  auto surfaces_done = std::atomic<size_t>(0);
+  parallel_for(handles.size(), 1, [&](size_t begin, size_t end) {
+    for (auto i = begin; i < end; ++i) {
+      if (auto surface = snapshot.patch_surface(handles[i])) {
+        strokes[i] = surface_strokes(*surface, safety, desc, ctx);
+      }
+      ctx.report(static_cast<float>(surfaces_done.fetch_add(1) + 1) / static_cast<float>(handles.size()));
+    }
+  });
+
+  if (ctx.is_cancelled()) {
+    return ToolPath{};
+  }
+
+  auto path    = ToolPath{};
+  auto& points = path.points;
+  for (const auto& surface_strokes : strokes) {
+    for (const auto& stroke : surface_strokes) {
+      const auto& start = stroke.front();
+      if (points.empty()) {
+        points.emplace_back(start.x, desc.safe_height, start.z);
+      } else if (auto last = points.back(); !safety.is_clear(last, start)) {
+        points.emplace_back(last.x, desc.safe_height, last.z);
+        points.emplace_back(start.x, desc.safe_height, start.z);
+      }
+      points.insert(points.end(), stroke.begin(), stroke.end());
+    }
+  }
+
+  if (!points.empty()) {
+    auto last = points.back();
+    points.emplace_back(last.x, desc.safe_height, last.z);
+  }
+
+  // The adaptive sampling already emits only the points needed to stay within the tolerance
+  path.stats.raw_points_count = points.size();
+  path.stats.points_count     = points.size();
+  for (auto i = size_t{1}; i < points.size(); ++i) {
+    path.stats.length += eray::math::distance(points[i - 1], points[i]);
+  }
+
+  eray::util::Logger::info("Generated ball finishing path of {} surfaces with {} points, length: {}", handles.size(),
+                           path.stats.points_count, path.stats.length);
+  return path;
+}
+
+}  // namespace mini
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <cstdint>
+#include <libminicad/algorithm/height_field.hpp>
+#include <libminicad/algorithm/paths_generator.hpp>
+#include <libminicad/algorithm/tool_path.hpp>
+#include <libminicad/jobs/job_context.hpp>
+#include <libminicad/scene/handles.hpp>
+#include <libminicad/scene/scene_snapshot.hpp>
+#include <span>
+
+namespace mini {
+
+enum class IsoLineDirection : uint8_t {
+  AlongU = 0,  // the lines of constant v
+  AlongV = 1,  // the lines of constant u
+};
+
+struct BallFinishingDesc {
+  float cutter_radius = 0.4F;
+
+  IsoLineDirection direction = IsoLineDirection::AlongU;
+
+  /**
+   * @brief Target world distance between the neighbouring iso-lines.
+   *
+   */
+  float line_spacing = 0.1F;
+
+  /**
+   * @brief Max world distance between the neighbouring samples of an iso-line.
+   *
+   */
+  float max_sample_spacing = 0.1F;
+
+  /**
+   * @brief An iso-line interval is subdivided until its midpoint lies within the tolerance from the chord.
+   *
+   */
+  float tolerance = 1e-3F;
+
+  /**
+   * @brief Height of the moves between the iso-lines that cannot be joined directly, must be above the model.
+   *
+   */
+  float safe_height = 6.F;
+};
+
+/**
+ * @brief Generates the finishing paths of a ball-end cutter following the patch surfaces. Every surface is sampled
+ * along its iso-parameter lines, the lines are spaced and sampled adaptively in world space. A sample is offset along
+ * the surface normal by the cutter radius to the ball center and moved down to the cutter tip, the samples in the
+ * trimmed regions are discarded. The tips are clipped against the safety height field, so the cutter never gouges
+ * the neighbouring surfaces. The lines of a surface are joined into a zig-zag, the cutter goes straight between the
+ * neighbouring lines whenever the link stays above the safety heights and retracts otherwise. The surfaces are
+ * sampled in parallel.
+ *
+ */
+class BallFinishingPaths {
+ public:
+  /**
+   * @brief The safety heights must be the cutter-offset heights of the whole model for the ball cutter of the same
+   * radius, see `CutterOffset`. Returns an empty path if the job is cancelled.
+   *
+   */
+  static ToolPath generate(const SceneSnapshot& snapshot, std::span<const PatchSurfaceHandle> handles,
+                           const TiledHeightField& safety_heights, const MillingDesc& milling,
+                           const BallFinishingDesc& desc, const JobContext& ctx = {});
+};
+
+}  // namespace mini
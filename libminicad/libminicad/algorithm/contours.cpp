@@ -0,0 +1,281 @@
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cmath>
+#include <libminicad/algorithm/contours.hpp>
+#include <libminicad/algorithm/parallel.hpp>
+#include <ranges>
+#include <unordered_map>
+#include <utility>
+
+namespace mini {
+
+namespace {
+
+// Directed segment of a contour, the region lies on its left
+struct Segment {
+  uint64_t from;  // index of the grid edge the segment starts at
+  uint64_t to;    // index of the grid edge the segment ends at
+  eray::math::Vec2f start;
+};
+
+/**
+ * @brief The field surrounded by a ring of samples outside of the region, the cell (i, j) spans the samples [i, i + 1]
+ * x [j, j + 1] and the sample (i, j) is the texel (i - 1, j - 1) of the field.
+ *
+ */
+class PaddedGrid {
+ public:
+  PaddedGrid(std::span<const float> field, uint32_t width, uint32_t height, float iso)
+      : field_(field), width_(width), height_(height), iso_(iso) {}
+
+  [[nodiscard]] bool in_field(uint32_t i, uint32_t j) const {
+    return i >= 1 && j >= 1 && i <= width_ && j <= height_;
+  }
+
+  [[nodiscard]] float value(uint32_t i, uint32_t j) const {
+    return field_[static_cast<size_t>(j - 1) * width_ + (i - 1)];
+  }
+
+  [[nodiscard]] bool inside(uint32_t i, uint32_t j) const { return in_field(i, j) && value(i, j) > iso_; }
+
+  [[nodiscard]] uint64_t horizontal_edge(uint32_t i, uint32_t j) const {
+    return 2 * (static_cast<uint64_t>(j) * (width_ + 2) + i);
+  }
+
+  [[nodiscard]] uint64_t vertical_edge(uint32_t i, uint32_t j) const { return horizontal_edge(i, j) + 1; }
+
+  /**
+   * @brief Iso crossing on the edge between the neighbouring samples in the field texel coordinates. The crossing
+   * between the field and the padding is put on the field border, half a texel from the last texel.
+   *
+   */
+  [[nodiscard]] eray::math::Vec2f crossing(uint32_t i0, uint32_t j0, uint32_t i1, uint32_t j1) const {
+    auto a = eray::math::Vec2f(static_cast<float>(i0) - 1.F, static_cast<float>(j0) - 1.F);
+    auto b = eray::math::Vec2f(static_cast<float>(i1) - 1.F, static_cast<float>(j1) - 1.F);
+    if (!in_field(i0, j0)) {
+      return b + 0.5F * (a - b);
+    }
+    if (!in_field(i1, j1)) {
+      return a + 0.5F * (b - a);
+    }
+
+    auto va = value(i0, j0);
+    auto vb = value(i1, j1);
+    return a + std::clamp((iso_ - va) / (vb - va), 0.F, 1.F) * (b - a);
+  }
+
+  /**
+   * @brief Marching squares in the cells [i0, i1) x [j0, j1). The corners and the edges of a cell are numbered
+   * counter-clockwise starting from the bottom left corner, the edge k joins the corners k and k + 1.
+   *
+   */
+  void march(uint32_t i0, uint32_t j0, uint32_t i1, uint32_t j1, std::vector<Segment>& out) const {
+    for (auto j = j0; j < j1; ++j) {
+      for (auto i = i0; i < i1; ++i) {
+        const auto corners = std::array<std::pair<uint32_t, uint32_t>, 4>{
+            std::pair{i, j}, std::pair{i + 1, j}, std::pair{i + 1, j + 1}, std::pair{i, j + 1}};
+        const auto edges = std::array<uint64_t, 4>{horizontal_edge(i, j), vertical_edge(i + 1, j),
+                                                   horizontal_edge(i, j + 1), vertical_edge(i, j)};
+
+        auto bits = 0U;
+        for (auto k = 0U; k < 4; ++k) {
+          bits |= (inside(corners[k].first, corners[k].second) ? 1U : 0U) << k;
+        }
+        if (bits == 0 || bits == 0b1111) {
+          continue;
+        }
+
+        const auto add = [&](uint32_t from, uint32_t to) {
+          const auto& [ia, ja] = corners[from];
+          const auto& [ib, jb] = corners[(from + 1) % 4];
+          out.push_back(Segment{.from = edges[from], .to = edges[to], .start = crossing(ia, ja, ib, jb)});
+        };
+        const auto is_inside = [&](uint32_t k) { return (bits >> k) & 1U; };
+
+        switch (std::popcount(bits)) {
+          case 1: {
+            auto k = static_cast<uint32_t>(std::countr_zero(bits));
+            add(k, (k + 3) % 4);
+            break;
+          }
+          case 3: {
+            auto k = static_cast<uint32_t>(std::countr_zero(~bits & 0b1111U));
+            add((k + 3) % 4, k);
+            break;
+          }
+          default: {
+            if (bits != 0b0101 && bits != 0b1010) {
+              auto k = 0U;
+              while (!is_inside(k) || !is_inside((k + 1) % 4)) {
+                ++k;
+              }
+              add((k + 1) % 4, (k + 3) % 4);
+              break;
+            }
+
+            // Saddle, the diagonal inside corners are connected if the center of the cell is inside
+            auto center_inside =
+                std::ranges::all_of(corners, [&](const auto& c) { return in_field(c.first, c.second); });
+            if (center_inside) {
+              auto sum = 0.F;
+              for (const auto& [ci, cj] : corners) {
+                sum += value(ci, cj);
+              }
+              center_inside = sum / 4.F > iso_;
+            }
+
+            for (auto k = 0U; k < 4; ++k) {
+              if (center_inside && !is_inside(k)) {
+                add((k + 3) % 4, k);
+              } else if (!center_inside && is_inside(k)) {
+                add(k, (k + 3) % 4);
+              }
+            }
+            break;
+          }
+        }
+      }
+    }
+  }
+
+ private:
+  std::span<const float> field_;
+  uint32_t width_;
+  uint32_t height_;
+  float iso_;
+};
+
+float segment_distance(const eray::math::Vec2f& p, const eray::math::Vec2f& a, const eray::math::Vec2f& b) {
+  auto ab      = b - a;
+  auto len2    = eray::math::dot(ab, ab);
+  auto t       = len2 > 0.F ? std::clamp(eray::math::dot(p - a, ab) / len2, 0.F, 1.F) : 0.F;
+  auto closest = a + t * ab;
+  return eray::math::length(p - closest);
+}
+
+}  // namespace
+
+std::vector<Contour> IsoContours::extract(std::span<const float> field, uint32_t width, uint32_t height, float iso,
+                                          const JobContext& ctx) {
+  if (width == 0 || height == 0 || field.size() < static_cast<size_t>(width) * height) {
+    return {};
+  }
+
+  // There is one more cell than the samples along each axis because of the padding
+  const auto grid    = PaddedGrid(field, width, height, iso);
+  const auto cells_x = width + 1;
+  const auto cells_y = height + 1;
+  const auto tiles_x = (cells_x + kTileSize - 1) / kTileSize;
+  const auto tiles_y = (cells_y + kTileSize - 1) / kTileSize;
+
+  auto tiles = std::vector<std::vector<Segment>>(static_cast<size_t>(tiles_x) * tiles_y);
+  parallel_for(tiles.size(), 1, [&](size_t begin, size_t end) {
+    for (auto tile = begin; tile < end; ++tile) {
+      if (ctx.is_cancelled()) {
+        return;
+      }
+
+      auto i0 = static_cast<uint32_t>(tile % tiles_x) * kTileSize;
+      auto j0 = static_cast<uint32_t>(tile / tiles_x) * kTileSize;
+      grid.march(i0, j0, std::min(i0 + kTileSize, cells_x), std::min(j0 + kTileSize, cells_y), tiles[tile]);
+    }
+  });
+
+  if (ctx.is_cancelled()) {
+    return {};
+  }
+
+  auto segments = std::vector<Segment>();
+  for (auto& tile : tiles) {
+    segments.insert(segments.end(), tile.begin(), tile.end());
+    tile = {};
+  }
+
+  // Every crossed edge starts exactly one segment and ends exactly one segment, so the contours are followed through
+  // the edges
+  auto by_start = std::unordered_map<uint64_t, size_t>();
+  by_start.reserve(segments.size());
+  for (auto [idx, segment] : std::views::enumerate(segments)) {
+    by_start.emplace(segment.from, static_cast<size_t>(idx));
+  }
+
+  auto result  = std::vector<Contour>();
+  auto visited = std::vector<bool>(segments.size(), false);
+  for (auto first = size_t{0}; first < segments.size(); ++first) {
+    if (visited[first]) {
+      continue;
+    }
+
+    auto contour = Contour{};
+    auto current = first;
+    while (!visited[current]) {
+      visited[current] = true;
+      contour.points.push_back(segments[current].start);
+
+      auto next = by_start.find(segments[current].to);
+      if (next == by_start.end()) {
+        break;
+      }
+      current = next->second;
+    }
+    result.push_back(std::move(contour));
+  }
+
+  return result;
+}
+
+std::vector<eray::math::Vec2f> IsoContours::simplify(std::span<const eray::math::Vec2f> loop, float tolerance) {
+  if (loop.size() < 4) {
+    return {loop.begin(), loop.end()};
+  }
+
+  // The loop is split at the first point and the point farthest from it, both halves are simplified as open polylines
+  auto far      = size_t{0};
+  auto far_dist = 0.F;
+  for (auto i = size_t{1}; i < loop.size(); ++i) {
+    auto dist = eray::math::length(loop[i] - loop[0]);
+    if (dist > far_dist) {
+      far      = i;
+      far_dist = dist;
+    }
+  }
+
+  const auto point  = [&](size_t i) { return loop[i % loop.size()]; };
+  auto keep         = std::vector<bool>(loop.size() + 1, false);
+  keep[0]           = true;
+  keep[far]         = true;
+  keep[loop.size()] = true;
+
+  auto stack = std::vector<std::pair<size_t, size_t>>{{0, far}, {far, loop.size()}};
+  while (!stack.empty()) {
+    auto [a, b] = stack.back();
+    stack.pop_back();
+
+    auto worst      = a;
+    auto worst_dist = tolerance;
+    for (auto i = a + 1; i < b; ++i) {
+      auto dist = segment_distance(point(i), point(a), point(b));
+      if (dist > worst_dist) {
+        worst      = i;
+        worst_dist = dist;
+      }
+    }
+
+    if (worst != a) {
+      keep[worst] = true;
+      stack.emplace_back(a, worst);
+      stack.emplace_back(worst, b);
+    }
+  }
+
+  auto result = std::vector<eray::math::Vec2f>();
+  for (auto i = size_t{0}; i < loop.size(); ++i) {
+    if (keep[i]) {
+      result.push_back(loop[i]);
+    }
+  }
+  return result;
+}
+
+}  // namespace mini
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstdint>
+#include <liberay/math/vec.hpp>
+#include <libminicad/jobs/job_context.hpp>
+#include <span>
+#include <vector>
+
+namespace mini {
+
+/**
+ * @brief Closed polyline in the texel coordinates of the contoured field, the texel (x, y) center is at (x, y). The
+ * first point is not repeated at the end.
+ *
+ */
+struct Contour {
+  std::vector<eray::math::Vec2f> points;
+};
+
+/**
+ * @brief Marching squares on a dense row-major field. The cells are processed in square tiles in parallel, every tile
+ * emits the directed segments keyed by the global indices of the grid edges they cross, so the segments of the
+ * neighbouring tiles share their ends exactly and are stitched into the closed polylines afterwards.
+ *
+ */
+class IsoContours {
+ public:
+  static constexpr uint32_t kTileSize = 64;
+
+  /**
+   * @brief Boundaries of the region where the field is above the iso level. The region is considered empty outside of
+   * the field, the contours leaving the field run half a texel outside of its border, so all of them are closed. The
+   * contours go counter-clockwise around the region (with y pointing up), so the holes are clockwise. Returns no
+   * contours if the job is cancelled.
+   *
+   */
+  static std::vector<Contour> extract(std::span<const float> field, uint32_t width, uint32_t height, float iso,
+                                      const JobContext& ctx = {});
+
+  /**
+   * @brief Douglas-Peucker simplification of a closed polyline, the removed points lie within the tolerance from the
+   * simplified polyline.
+   *
+   */
+  static std::vector<eray::math::Vec2f> simplify(std::span<const eray::math::Vec2f> loop, float tolerance);
+};
+
+}  // namespace mini
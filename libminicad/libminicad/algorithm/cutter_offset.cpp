@@ -0,0 +1,185 @@
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <libminicad/algorithm/cutter_offset.hpp>
+#include <limits>
+
+namespace mini {
+
+namespace {
+
+// Number of output texels processed at once by the ball cutter, the chunk is skipped if the chord cannot raise it
+constexpr int32_t kChunkSize = 64;
+
+}  // namespace
+
+TiledHeightField CutterOffset::compute(const TiledHeightField& heights, const eray::math::Vec2f& texel_size,
+                                       const Cutter& cutter, const JobContext& ctx) {
+  const auto width  = heights.width();
+  const auto height = heights.height();
+  if (width == 0 || height == 0 || cutter.radius <= 0.F || texel_size.x <= 0.F || texel_size.y <= 0.F) {
+    return heights;
+  }
+
+  const auto cutter_chords = chords(texel_size, cutter);
+  const auto max_half_width =
+      std::ranges::max(cutter_chords, {}, [](const Chord& chord) { return chord.half_width; }).half_width;
+
+  // The chords are sorted by the distance from the cutter axis, the last one reaches the farthest row
+  const auto max_dy     = static_cast<uint32_t>(std::abs(cutter_chords.back().dy));
+  const auto background = heights.background();
+
+  auto rows_done = std::atomic<uint32_t>(0);
+  auto fill_band = [&](uint32_t y0, uint32_t y1, std::span<float> rows) {
+    auto report = [&]() {
+      auto done = rows_done.fetch_add(y1 - y0) + (y1 - y0);
+      ctx.report(static_cast<float>(done) / static_cast<float>(height));
+    };
+
+    // No texel under the cutter anywhere in the band rises above the background, so the band stays at the background
+    if (heights.range_max(0, y0 >= max_dy ? y0 - max_dy : 0, width, y1 + max_dy) <= background) {
+      report();
+      return false;
+    }
+
+    auto row      = std::vector<float>(width);
+    auto filtered = std::vector<float>(width);
+    auto scratch  = std::vector<float>(2 * (static_cast<size_t>(width) + 2 * max_half_width));
+    auto profile  = std::vector<float>(2 * static_cast<size_t>(max_half_width) + 1);
+    for (auto y = y0; y < y1; ++y) {
+      if (ctx.is_cancelled()) {
+        return false;
+      }
+
+      auto out = rows.subspan(static_cast<size_t>(y - y0) * width, width);
+      if (cutter.type == CutterType::Flat) {
+        flat_row(heights, y, cutter_chords, out, row, filtered, scratch);
+      } else {
+        ball_row(heights, y, cutter_chords, texel_size, cutter, out, row, profile);
+      }
+    }
+
+    report();
+    return true;
+  };
+
+  return TiledHeightField::generate_rows(width, height, background, fill_band);
+}
+
+void CutterOffset::max_filter(std::span<const float> in, uint32_t half_width, std::span<float> out,
+                              std::span<float> scratch) {
+  // The input is padded with the lowest float on both sides and split into blocks of the window size. Every window
+  // covers the suffix of one block and the prefix of the next one, so it's the max of the block suffix max and the
+  // block prefix max.
+  const auto n      = in.size();
+  const auto window = 2 * static_cast<size_t>(half_width) + 1;
+  const auto len    = n + 2 * static_cast<size_t>(half_width);
+  auto prefix       = scratch.subspan(0, len);
+  auto suffix       = scratch.subspan(len, len);
+  const auto padded = [&](size_t i) {
+    return i < half_width || i >= half_width + n ? std::numeric_limits<float>::lowest() : in[i - half_width];
+  };
+
+  for (auto block = size_t{0}; block < len; block += window) {
+    auto block_end = std::min(block + window, len);
+
+    prefix[block] = padded(block);
+    for (auto i = block + 1; i < block_end; ++i) {
+      prefix[i] = std::max(prefix[i - 1], padded(i));
+    }
+
+    suffix[block_end - 1] = padded(block_end - 1);
+    for (auto i = block_end - 1; i > block; --i) {
+      suffix[i - 1] = std::max(suffix[i], padded(i - 1));
+    }
+  }
+
+  for (auto x = size_t{0}; x < n; ++x) {
+    out[x] = std::max(suffix[x], prefix[x + window - 1]);
+  }
+}
+
+std::vector<CutterOffset::Chord> CutterOffset::chords(const eray::math::Vec2f& texel_size, const Cutter& cutter) {
+  const auto r2          = cutter.radius * cutter.radius;
+  const auto half_height = static_cast<int32_t>(std::floor(cutter.radius / texel_size.y));
+
+  auto result = std::vector<Chord>();
+  result.reserve(2 * static_cast<size_t>(half_height) + 1);
+  for (auto dy = -half_height; dy <= half_height; ++dy) {
+    auto dz        = static_cast<float>(dy) * texel_size.y;
+    auto half_span = std::sqrt(std::max(r2 - dz * dz, 0.F));
+    result.push_back(Chord{
+        .dy         = dy,
+        .half_width = static_cast<uint32_t>(std::floor(half_span / texel_size.x)),
+        .max_offset = cutter.type == CutterType::Flat ? 0.F : half_span - cutter.radius,
+    });
+  }
+
+  // The chords closest to the cutter axis raise the output the most, visiting them first lets the ball cutter skip
+  // most of the chunks of the remaining chords
+  std::ranges::stable_sort(result, {}, [](const Chord& chord) { return std::abs(chord.dy); });
+  return result;
+}
+
+void CutterOffset::flat_row(const TiledHeightField& heights, uint32_t y, std::span<const Chord> chords,
+                            std::span<float> out, std::span<float> row, std::span<float> filtered,
+                            std::span<float> scratch) {
+  std::ranges::fill(out, std::numeric_limits<float>::lowest());
+  for (const auto& chord : chords) {
+    auto sy = static_cast<int64_t>(y) + chord.dy;
+    if (sy < 0 || sy >= heights.height()) {
+      continue;
+    }
+
+    heights.read_row(static_cast<uint32_t>(sy), 0, row);
+    max_filter(row, chord.half_width, filtered, scratch);
+    for (auto x = size_t{0}; x < out.size(); ++x) {
+      out[x] = std::max(out[x], filtered[x]);
+    }
+  }
+}
+
+void CutterOffset::ball_row(const TiledHeightField& heights, uint32_t y, std::span<const Chord> chords,
+                            const eray::math::Vec2f& texel_size, const Cutter& cutter, std::span<float> out,
+                            std::span<float> row, std::span<float> profile) {
+  const auto width = static_cast<int32_t>(out.size());
+  const auto r2    = cutter.radius * cutter.radius;
+
+  std::ranges::fill(out, std::numeric_limits<float>::lowest());
+  for (const auto& chord : chords) {
+    auto sy = static_cast<int64_t>(y) + chord.dy;
+    if (sy < 0 || sy >= heights.height()) {
+      continue;
+    }
+
+    // Height of the cutter tip above the texel under the cutter when the sphere touches it, relative to the texel
+    const auto hw = static_cast<int32_t>(chord.half_width);
+    const auto dz = static_cast<float>(chord.dy) * texel_size.y;
+    for (auto dx = -hw; dx <= hw; ++dx) {
+      auto dxw         = static_cast<float>(dx) * texel_size.x;
+      profile[dx + hw] = std::sqrt(std::max(r2 - dxw * dxw - dz * dz, 0.F)) - cutter.radius;
+    }
+
+    heights.read_row(static_cast<uint32_t>(sy), 0, row);
+    for (auto cx0 = 0; cx0 < width; cx0 += kChunkSize) {
+      auto cx1       = std::min(cx0 + kChunkSize, width);
+      auto chunk     = out.subspan(static_cast<size_t>(cx0), static_cast<size_t>(cx1 - cx0));
+      auto src_begin = row.begin() + std::max(cx0 - hw, 0);
+      auto src_end   = row.begin() + std::min(cx1 + hw, width);
+      if (*std::max_element(src_begin, src_end) + chord.max_offset <= std::ranges::min(chunk)) {
+        continue;
+      }
+
+      for (auto dx = -hw; dx <= hw; ++dx) {
+        const auto offset = profile[dx + hw];
+        const auto x0     = std::max(cx0, -dx);
+        const auto x1     = std::min(cx1, width - dx);
+        for (auto x = x0; x < x1; ++x) {
+          out[x] = std::max(out[x], row[x + dx] + offset);
+        }
+      }
+    }
+  }
+}
+
+}  // namespace mini
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <cstdint>
+#include <liberay/math/vec.hpp>
+#include <libminicad/algorithm/height_field.hpp>
+#include <libminicad/jobs/job_context.hpp>
+#include <span>
+#include <vector>
+
+namespace mini {
+
+enum class CutterType : uint8_t {
+  Flat = 0,
+  Ball = 1,
+};
+
+struct Cutter {
+  CutterType type = CutterType::Ball;
+  float radius    = 0.5F;
+};
+
+/**
+ * @brief Turns a height map of the surface into the cutter-offset map: the lowest height the tip of the cutter can be
+ * lowered to above every texel without gouging the surface. It's a grey-scale dilation of the height map by the cutter
+ * profile, the texels outside of the map do not constrain the cutter.
+ *
+ * The disk under the cutter is decomposed into the chords along x, one per row of texels it covers. For the flat cutter
+ * every chord is a 1D max filter computed with the van Herk/Gil-Werman algorithm in 3 comparisons per texel regardless
+ * of the radius. For the ball cutter every chord is swept in chunks of texels with a branchless inner loop over the
+ * contiguous row, the chunks that cannot be raised by the chord are skipped. The chords are visited starting from the
+ * highest point of the profile, so most of them are skipped once the output is close to its final values.
+ *
+ * The output is computed in parallel bands of tile rows written straight into the tiles, the bands with no texel above
+ * the background within the cutter radius are skipped and allocate nothing. The sampled height maps never go below the
+ * background, so the skipped bands are exactly at the background.
+ *
+ */
+class CutterOffset {
+ public:
+  /**
+   * @brief Computes the cutter-offset map. The texel size is the world size of a single texel along x and z, stored
+   * in x and y. Returns a partially computed map if the job is cancelled.
+   *
+   */
+  static TiledHeightField compute(const TiledHeightField& heights, const eray::math::Vec2f& texel_size,
+                                  const Cutter& cutter, const JobContext& ctx = {});
+
+  /**
+   * @brief Max of the window [x - half_width, x + half_width] of `in` for every x, the window is clamped to the input.
+   * The scratch must hold at least 2 * (in.size() + 2 * half_width) floats.
+   *
+   */
+  static void max_filter(std::span<const float> in, uint32_t half_width, std::span<float> out,
+                         std::span<float> scratch);
+
+ private:
+  struct Chord {
+    int32_t dy;
+    uint32_t half_width;
+    float max_offset;  // the max of the cutter profile along the chord
+  };
+
+  static std::vector<Chord> chords(const eray::math::Vec2f& texel_size, const Cutter& cutter);
+  static void flat_row(const TiledHeightField& heights, uint32_t y, std::span<const Chord> chords,
+                       std::span<float> out, std::span<float> row, std::span<float> filtered, std::span<float> scratch);
+  static void ball_row(const TiledHeightField& heights, uint32_t y, std::span<const Chord> chords,
+                       const eray::math::Vec2f& texel_size, const Cutter& cutter, std::span<float> out,
+                       std::span<float> row, std::span<float> profile);
+};
+
+}  // namespace mini
@@ -0,0 +1,260 @@
+#include <algorithm>
+#include <cmath>
+#include <liberay/math/vec.hpp>
+#include <liberay/util/logger.hpp>
+#include <libminicad/algorithm/contours.hpp>
+#include <libminicad/algorithm/flat_finishing_paths.hpp>
+#include <libminicad/algorithm/parallel.hpp>
+#include <limits>
+#include <optional>
+#include <ranges>
+#include <span>
+#include <vector>
+
+namespace mini {
+
+namespace {
+
+// Number of rows or columns transformed by a single parallel task
+constexpr size_t kLinesPerBlock = 16;
+
+// Squared distance of the texels that are not the sites, finite so that the parabola intersections stay finite
+constexpr float kFar = 1e20F;
+
+/**
+ * @brief Felzenszwalb-Huttenlocher 1D squared distance transform: the lower envelope of the parabolas rooted at the
+ * samples. The spacing is the world distance between the neighbouring samples.
+ *
+ */
+void distance_transform(std::span<const float> f, float spacing, std::span<float> out, std::span<uint32_t> v,
+                        std::span<float> z) {
+  const auto n   = f.size();
+  const auto w2  = spacing * spacing;
+  const auto pos = [](size_t q) { return static_cast<float>(q); };
+
+  // Position along the line where the parabolas rooted at the samples q and r intersect
+  const auto intersection = [&](size_t q, size_t r) {
+    return ((f[q] + pos(q) * pos(q) * w2) - (f[r] + pos(r) * pos(r) * w2)) / (2.F * w2 * (pos(q) - pos(r)));
+  };
+
+  auto k = size_t{0};
+  v[0]   = 0;
+  z[0]   = std::numeric_limits<float>::lowest();
+  z[1]   = std::numeric_limits<float>::max();
+  for (auto q = size_t{1}; q < n; ++q) {
+    auto s = intersection(q, v[k]);
+    while (s <= z[k]) {
+      --k;
+      s = intersection(q, v[k]);
+    }
+
+    ++k;
+    v[k]     = static_cast<uint32_t>(q);
+    z[k]     = s;
+    z[k + 1] = std::numeric_limits<float>::max();
+  }
+
+  k = 0;
+  for (auto q = size_t{0}; q < n; ++q) {
+    while (z[k + 1] < pos(q)) {
+      ++k;
+    }
+    auto d = (pos(q) - pos(v[k])) * spacing;
+    out[q] = d * d + f[v[k]];
+  }
+}
+
+/**
+ * @brief Euclidean distance from every texel to the nearest site texel, the columns are transformed first and the
+ * rows of the result next.
+ *
+ */
+std::vector<float> distance_field(const std::vector<bool>& sites, uint32_t width, uint32_t height,
+                                  const eray::math::Vec2f& texel_size) {
+  auto result = std::vector<float>(sites.size());
+  parallel_for(width, kLinesPerBlock, [&](size_t begin, size_t end) {
+    auto column = std::vector<float>(height);
+    auto out    = std::vector<float>(height);
+    auto v      = std::vector<uint32_t>(height);
+    auto z      = std::vector<float>(static_cast<size_t>(height) + 1);
+    for (auto x = begin; x < end; ++x) {
+      for (auto y = size_t{0}; y < height; ++y) {
+        column[y] = sites[y * width + x] ? 0.F : kFar;
+      }
+      distance_transform(column, texel_size.y, out, v, z);
+      for (auto y = size_t{0}; y < height; ++y) {
+        result[y * width + x] = out[y];
+      }
+    }
+  });
+
+  parallel_for(height, kLinesPerBlock, [&](size_t begin, size_t end) {
+    auto row = std::vector<float>(width);
+    auto v   = std::vector<uint32_t>(width);
+    auto z   = std::vector<float>(static_cast<size_t>(width) + 1);
+    for (auto y = begin; y < end; ++y) {
+      auto line = std::span(result).subspan(y * width, width);
+      std::ranges::copy(line, row.begin());
+      distance_transform(row, texel_size.x, line, v, z);
+      for (auto& d : line) {
+        d = std::sqrt(d);
+      }
+    }
+  });
+
+  return result;
+}
+
+}  // namespace
+
+ToolPath FlatFinishingPaths::generate(const TiledHeightField& heights, const MillingDesc& milling,
+                                      const FlatFinishingDesc& desc, const JobContext& ctx) {
+  const auto width  = heights.width();
+  const auto height = heights.height();
+  if (width == 0 || height == 0 || desc.step_over <= 0.F) {
+    return ToolPath{};
+  }
+
+  const auto texel_size = eray::math::Vec2f(milling.width / static_cast<float>(width),
+                                            milling.height / static_cast<float>(height));
+
+  // Signed distance to the obstacle boundary: positive inside of the obstacles and negative in the flat region
+  auto obstacles = std::vector<bool>(heights.size());
+  auto row       = std::vector<float>(width);
+  for (auto y = 0U; y < height; ++y) {
+    heights.read_row(y, 0, row);
+    for (auto x = 0U; x < width; ++x) {
+      obstacles[static_cast<size_t>(y) * width + x] = row[x] > desc.level;
+    }
+  }
+  if (std::ranges::none_of(obstacles, [](bool obstacle) { return obstacle; })) {
+    return ToolPath{};
+  }
+  auto flat = obstacles;
+  flat.flip();
+
+  auto sdf                = distance_field(flat, width, height, texel_size);
+  const auto to_obstacles = distance_field(obstacles, width, height, texel_size);
+  for (auto i = size_t{0}; i < sdf.size(); ++i) {
+    sdf[i] -= to_obstacles[i];
+  }
+  ctx.report(0.2F);
+
+  // The distances are measured between the texel centers, while the obstacle boundary lies half a texel from the
+  // nearest obstacle texel center. The offsets past the farthest point of the flat region would only circle the stock
+  // border.
+  const auto half_texel = 0.5F * std::max(texel_size.x, texel_size.y);
+  const auto max_offset = -std::ranges::min(sdf) - half_texel;
+  auto offsets          = std::vector<float>();
+  for (auto d = desc.cutter_radius; d < max_offset; d += desc.step_over) {
+    if (desc.max_passes > 0 && offsets.size() == desc.max_passes) {
+      break;
+    }
+    offsets.push_back(d);
+  }
+
+  const auto to_world = [&](const eray::math::Vec2f& texel) {
+    return eray::math::Vec2f((texel.x + 0.5F) * texel_size.x - milling.width / 2.F,
+                             (texel.y + 0.5F) * texel_size.y - milling.height / 2.F);
+  };
+
+  // A straight link at the level is safe if the cutter stays out of the obstacles along it, one texel of slack covers
+  // the interpolated contour points
+  const auto link_margin = desc.cutter_radius - std::max(texel_size.x, texel_size.y);
+  const auto is_safe     = [&](const eray::math::Vec2f& a, const eray::math::Vec2f& b) {
+    auto steps = static_cast<uint32_t>(std::ceil(std::max(std::abs(b.x - a.x), std::abs(b.y - a.y)))) + 1;
+    for (auto i = 0U; i <= steps; ++i) {
+      auto p = a + (static_cast<float>(i) / static_cast<float>(steps)) * (b - a);
+      auto x = std::clamp(static_cast<int64_t>(std::lround(p.x)), int64_t{0}, static_cast<int64_t>(width) - 1);
+      auto y = std::clamp(static_cast<int64_t>(std::lround(p.y)), int64_t{0}, static_cast<int64_t>(height) - 1);
+      if (sdf[static_cast<size_t>(y) * width + static_cast<size_t>(x)] > -link_margin) {
+        return false;
+      }
+    }
+    return true;
+  };
+
+  auto path        = ToolPath{};
+  auto& points     = path.points;
+  auto current     = std::optional<eray::math::Vec2f>();
+  auto loops_count = size_t{0};
+
+  const auto tolerance = desc.tolerance / std::min(texel_size.x, texel_size.y);
+  const auto emit      = [&](const eray::math::Vec2f& texel, float h) {
+    auto p = to_world(texel);
+    points.emplace_back(p.x, h, p.y);
+  };
+
+  for (auto [idx, offset] : std::views::enumerate(offsets | std::views::reverse)) {
+    auto contours = IsoContours::extract(sdf, width, height, -(offset + half_texel), ctx);
+    if (ctx.is_cancelled()) {
+      return ToolPath{};
+    }
+    ctx.report(0.2F + 0.8F * static_cast<float>(idx + 1) / static_cast<float>(offsets.size()));
+
+    auto loops = std::vector<std::vector<eray::math::Vec2f>>();
+    loops.reserve(contours.size());
+    loops_count += contours.size();
+    for (const auto& contour : contours) {
+      path.stats.raw_points_count += contour.points.size() + 1;
+      loops.push_back(IsoContours::simplify(contour.points, tolerance));
+    }
+
+    // Greedy ordering: the next loop is the one with the point nearest to the current position, the loop is rotated
+    // to start at that point
+    auto done = std::vector<bool>(loops.size(), false);
+    for (auto remaining = loops.size(); remaining > 0; --remaining) {
+      auto best      = size_t{0};
+      auto best_idx  = size_t{0};
+      auto best_dist = std::numeric_limits<float>::max();
+      for (auto l = size_t{0}; l < loops.size(); ++l) {
+        if (done[l]) {
+          continue;
+        }
+        for (auto i = size_t{0}; i < loops[l].size(); ++i) {
+          auto dist = current ? eray::math::length(loops[l][i] - *current) : 0.F;
+          if (dist < best_dist) {
+            best      = l;
+            best_idx  = i;
+            best_dist = dist;
+          }
+        }
+      }
+      done[best] = true;
+
+      auto& loop = loops[best];
+      std::ranges::rotate(loop, loop.begin() + static_cast<std::ptrdiff_t>(best_idx));
+      if (!current || !is_safe(*current, loop.front())) {
+        if (current) {
+          emit(*current, desc.safe_height);
+        }
+        emit(loop.front(), desc.safe_height);
+        path.stats.raw_points_count += current ? 2 : 1;
+      }
+
+      for (const auto& p : loop) {
+        emit(p, desc.level);
+      }
+      emit(loop.front(), desc.level);
+      current = loop.front();
+    }
+  }
+
+  if (current) {
+    emit(*current, desc.safe_height);
+    path.stats.raw_points_count += 1;
+  }
+
+  path.stats.points_count = points.size();
+  for (auto i = size_t{1}; i < points.size(); ++i) {
+    path.stats.length += eray::math::distance(points[i - 1], points[i]);
+  }
+
+  eray::util::Logger::info("Generated flat finishing path with {} loops of {} offsets, {} points ({} before "
+                           "simplification), length: {}",
+                           loops_count, offsets.size(), path.stats.points_count, path.stats.raw_points_count,
+                           path.stats.length);
+  return path;
+}
+
+}  // namespace mini
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <cstdint>
+#include <libminicad/algorithm/height_field.hpp>
+#include <libminicad/algorithm/paths_generator.hpp>
+#include <libminicad/algorithm/tool_path.hpp>
+#include <libminicad/jobs/job_context.hpp>
+
+namespace mini {
+
+struct FlatFinishingDesc {
+  /**
+   * @brief Height of the flat region, the texels above it are the obstacles the cutter goes around. Should be a bit
+   * above the flat base, so that the sampling noise is not treated as an obstacle.
+   *
+   */
+  float level = 0.001F;
+
+  float cutter_radius = 0.5F;
+
+  /**
+   * @brief Distance between the neighbouring offset contours, should be smaller than the cutter diameter.
+   *
+   */
+  float step_over = 0.8F;
+
+  /**
+   * @brief Max number of the offset contours, 0 means as many as needed to cover the whole flat region.
+   *
+   */
+  uint32_t max_passes = 0;
+
+  /**
+   * @brief Height of the moves between the contours that cannot be joined at the level, must be above the model.
+   *
+   */
+  float safe_height = 6.F;
+
+  /**
+   * @brief Max distance of the removed points from the simplified contours.
+   *
+   */
+  float tolerance = 1e-3F;
+};
+
+/**
+ * @brief Generates the contour-parallel finishing paths of the flat region around the model for a flat cutter. The
+ * obstacles, the texels above the level, are turned into a signed Euclidean distance field. Its iso-contours at the
+ * cutter radius plus the multiples of the step-over are the offsets of the obstacle boundaries: outward around the
+ * islands and inward in the pockets, without the self-intersections of the polyline offsetting. The contours are
+ * ordered from the farthest one to the one touching the walls, the nearest contour is milled next.
+ *
+ */
+class FlatFinishingPaths {
+ public:
+  /**
+   * @brief The heights are the raw surface heights, see `HeightMap::sample`. Returns an empty path if the job is
+   * cancelled.
+   *
+   */
+  static ToolPath generate(const TiledHeightField& heights, const MillingDesc& milling, const FlatFinishingDesc& desc,
+                           const JobContext& ctx = {});
+};
+
+}  // namespace mini
@@ -0,0 +1,274 @@
+#include <algorithm>
+#include <libminicad/algorithm/height_field.hpp>
+#include <limits>
+
+namespace mini {
+
+TiledHeightField::TiledHeightField(uint32_t width, uint32_t height, float background)
+    : width_(width),
+      height_(height),
+      tiles_x_((width + kTileSize - 1) / kTileSize),
+      tiles_y_((height + kTileSize - 1) / kTileSize),
+      background_(background),
+      tiles_(static_cast<size_t>(tiles_x_) * tiles_y_) {
+  build_levels();
+}
+
+TiledHeightField TiledHeightField::from_dense(uint32_t width, uint32_t height, float background,
+                                              std::span<const float> data) {
+  auto field = TiledHeightField(width, height, background);
+  if (data.size() < field.size()) {
+    return field;
+  }
+
+  for (auto ty = 0U; ty < field.tiles_y_; ++ty) {
+    auto y0 = ty * kTileSize;
+    auto y1 = std::min(y0 + kTileSize, height);
+    field.store_tile_row(ty, data.subspan(static_cast<size_t>(y0) * width, static_cast<size_t>(y1 - y0) * width));
+  }
+
+  field.build_levels();
+  return field;
+}
+
+size_t TiledHeightField::allocated_tiles() const {
+  return static_cast<size_t>(std::ranges::count_if(tiles_, [](const auto& tile) { return !tile.empty(); }));
+}
+
+float TiledHeightField::at(uint32_t x, uint32_t y) const {
+  const auto& tile = tiles_[tile_index(x, y)];
+  return tile.empty() ? background_ : tile[texel_index(x, y)];
+}
+
+void TiledHeightField::set(uint32_t x, uint32_t y, float h) {
+  auto old = at(x, y);
+  if (h == old) {
+    return;
+  }
+
+  tile_for_write(tile_index(x, y))[texel_index(x, y)] = h;
+  if (h > old) {
+    raise_levels(x, y, h);
+  } else {
+    refresh_levels(x, y);
+  }
+}
+
+void TiledHeightField::max_with(uint32_t x, uint32_t y, float h) {
+  if (h <= at(x, y)) {
+    return;
+  }
+
+  tile_for_write(tile_index(x, y))[texel_index(x, y)] = h;
+  raise_levels(x, y, h);
+}
+
+void TiledHeightField::merge_max(const TiledHeightField& other) {
+  if (other.width_ != width_ || other.height_ != height_) {
+    return;
+  }
+
+  for (auto t = size_t{0}; t < tiles_.size(); ++t) {
+    const auto& src = other.tiles_[t];
+    if (src.empty()) {
+      continue;
+    }
+
+    auto& dst = tiles_[t];
+    if (dst.empty()) {
+      dst = src;
+    } else {
+      std::ranges::transform(dst, src, dst.begin(), [](float a, float b) { return std::max(a, b); });
+    }
+
+    auto tile_max = other.levels_.front().max[t];
+    raise_levels(static_cast<uint32_t>(t % tiles_x_) * kTileSize, static_cast<uint32_t>(t / tiles_x_) * kTileSize,
+                 tile_max);
+  }
+}
+
+float TiledHeightField::range_max(uint32_t x0, uint32_t y0, uint32_t x1, uint32_t y1) const {
+  x1 = std::min(x1, width_);
+  y1 = std::min(y1, height_);
+  if (x0 >= x1 || y0 >= y1 || levels_.empty()) {
+    return std::numeric_limits<float>::lowest();
+  }
+
+  return cell_max(levels_.size() - 1, 0, 0, x0, y0, x1, y1);
+}
+
+void TiledHeightField::read_row(uint32_t y, uint32_t x0, std::span<float> out) const {
+  auto x = x0;
+  while (x < x0 + out.size()) {
+    auto end         = std::min<uint32_t>((x / kTileSize + 1) * kTileSize, x0 + static_cast<uint32_t>(out.size()));
+    const auto& tile = tiles_[tile_index(x, y)];
+    auto target      = out.subspan(x - x0, end - x);
+    if (tile.empty()) {
+      std::ranges::fill(target, background_);
+    } else {
+      auto begin = tile.begin() + static_cast<std::ptrdiff_t>(texel_index(x, y));
+      std::ranges::copy(begin, begin + static_cast<std::ptrdiff_t>(target.size()), target.begin());
+    }
+    x = end;
+  }
+}
+
+std::vector<float> TiledHeightField::to_dense() const {
+  auto result = std::vector<float>(size());
+  for (auto y = 0U; y < height_; ++y) {
+    read_row(y, 0, std::span<float>(result).subspan(static_cast<size_t>(y) * width_, width_));
+  }
+  return result;
+}
+
+std::vector<float>& TiledHeightField::tile_for_write(size_t tile) {
+  if (tiles_[tile].empty()) {
+    tiles_[tile].assign(static_cast<size_t>(kTileSize) * kTileSize, background_);
+  }
+  return tiles_[tile];
+}
+
+void TiledHeightField::store_tile_row(uint32_t ty, std::span<const float> rows) {
+  const auto y0 = ty * kTileSize;
+  const auto y1 = std::min(y0 + kTileSize, height_);
+  for (auto tx = 0U; tx < tiles_x_; ++tx) {
+    auto x0 = tx * kTileSize;
+    auto x1 = std::min(x0 + kTileSize, width_);
+
+    auto occupied = false;
+    for (auto y = y0; y < y1 && !occupied; ++y) {
+      auto row = rows.subspan(static_cast<size_t>(y - y0) * width_ + x0, x1 - x0);
+      occupied = std::ranges::any_of(row, [this](float h) { return h != background_; });
+    }
+    if (!occupied) {
+      continue;
+    }
+
+    auto& tile = tile_for_write(tile_index(x0, y0));
+    for (auto y = y0; y < y1; ++y) {
+      std::ranges::copy(rows.subspan(static_cast<size_t>(y - y0) * width_ + x0, x1 - x0),
+                        tile.begin() + static_cast<std::ptrdiff_t>(texel_index(x0, y)));
+    }
+  }
+}
+
+void TiledHeightField::build_levels() {
+  levels_.clear();
+  if (tiles_.empty()) {
+    return;
+  }
+
+  auto base = Level{.width = tiles_x_, .height = tiles_y_, .max = std::vector<float>(tiles_.size(), background_)};
+  for (auto ty = 0U; ty < tiles_y_; ++ty) {
+    for (auto tx = 0U; tx < tiles_x_; ++tx) {
+      base.max[static_cast<size_t>(ty) * tiles_x_ + tx] =
+          range_max_in_tile(tx, ty, tx * kTileSize, ty * kTileSize, width_, height_);
+    }
+  }
+  levels_.push_back(std::move(base));
+
+  while (levels_.back().width > 1 || levels_.back().height > 1) {
+    const auto& prev = levels_.back();
+    auto next = Level{.width = (prev.width + 1) / 2, .height = (prev.height + 1) / 2, .max = {}};
+    next.max.resize(static_cast<size_t>(next.width) * next.height);
+    for (auto cy = 0U; cy < next.height; ++cy) {
+      for (auto cx = 0U; cx < next.width; ++cx) {
+        next.max[static_cast<size_t>(cy) * next.width + cx] = children_max(prev, cx, cy);
+      }
+    }
+    levels_.push_back(std::move(next));
+  }
+}
+
+void TiledHeightField::raise_levels(uint32_t x, uint32_t y, float h) {
+  auto cx = x / kTileSize;
+  auto cy = y / kTileSize;
+  for (auto& level : levels_) {
+    auto& cell = level.max[static_cast<size_t>(cy) * level.width + cx];
+    if (cell >= h) {
+      return;
+    }
+    cell = h;
+    cx /= 2;
+    cy /= 2;
+  }
+}
+
+void TiledHeightField::refresh_levels(uint32_t x, uint32_t y) {
+  auto cx = x / kTileSize;
+  auto cy = y / kTileSize;
+  levels_.front().max[static_cast<size_t>(cy) * tiles_x_ + cx] =
+      range_max_in_tile(cx, cy, cx * kTileSize, cy * kTileSize, width_, height_);
+
+  for (auto l = size_t{1}; l < levels_.size(); ++l) {
+    cx /= 2;
+    cy /= 2;
+    auto& level = levels_[l];
+    level.max[static_cast<size_t>(cy) * level.width + cx] = children_max(levels_[l - 1], cx, cy);
+  }
+}
+
+float TiledHeightField::range_max_in_tile(uint32_t tx, uint32_t ty, uint32_t x0, uint32_t y0, uint32_t x1,
+                                          uint32_t y1) const {
+  x0 = std::max(x0, tx * kTileSize);
+  y0 = std::max(y0, ty * kTileSize);
+  x1 = std::min({x1, (tx + 1) * kTileSize, width_});
+  y1 = std::min({y1, (ty + 1) * kTileSize, height_});
+
+  const auto& tile = tiles_[static_cast<size_t>(ty) * tiles_x_ + tx];
+  if (tile.empty()) {
+    return background_;
+  }
+
+  auto result = std::numeric_limits<float>::lowest();
+  for (auto y = y0; y < y1; ++y) {
+    auto begin = tile.begin() + static_cast<std::ptrdiff_t>(texel_index(x0, y));
+    result     = std::max(result, *std::max_element(begin, begin + static_cast<std::ptrdiff_t>(x1 - x0)));
+  }
+  return result;
+}
+
+float TiledHeightField::children_max(const Level& children, uint32_t cx, uint32_t cy) {
+  auto result = std::numeric_limits<float>::lowest();
+  for (auto y = 2 * cy; y < std::min(2 * cy + 2, children.height); ++y) {
+    for (auto x = 2 * cx; x < std::min(2 * cx + 2, children.width); ++x) {
+      result = std::max(result, children.max[static_cast<size_t>(y) * children.width + x]);
+    }
+  }
+  return result;
+}
+
+float TiledHeightField::cell_max(size_t level, uint32_t cx, uint32_t cy, uint32_t x0, uint32_t y0, uint32_t x1,
+                                 uint32_t y1) const {
+  const auto& lvl = levels_[level];
+  if (cx >= lvl.width || cy >= lvl.height) {
+    return std::numeric_limits<float>::lowest();
+  }
+
+  auto cell_size = static_cast<uint64_t>(kTileSize) << level;
+  auto bx0       = cx * cell_size;
+  auto by0       = cy * cell_size;
+  auto bx1       = std::min<uint64_t>(bx0 + cell_size, width_);
+  auto by1       = std::min<uint64_t>(by0 + cell_size, height_);
+  if (bx1 <= x0 || by1 <= y0 || bx0 >= x1 || by0 >= y1) {
+    return std::numeric_limits<float>::lowest();
+  }
+
+  if (bx0 >= x0 && by0 >= y0 && bx1 <= x1 && by1 <= y1) {
+    return lvl.max[static_cast<size_t>(cy) * lvl.width + cx];
+  }
+
+  if (level == 0) {
+    return range_max_in_tile(cx, cy, x0, y0, x1, y1);
+  }
+
+  auto result = std::numeric_limits<float>::lowest();
+  for (auto dy = 0U; dy < 2; ++dy) {
+    for (auto dx = 0U; dx < 2; ++dx) {
+      result = std::max(result, cell_max(level - 1, 2 * cx + dx, 2 * cy + dy, x0, y0, x1, y1));
+    }
+  }
+  return result;
+}
+
+}  // namespace mini
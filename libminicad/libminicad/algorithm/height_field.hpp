@@ -0,0 +1,144 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <libminicad/algorithm/parallel.hpp>
+#include <limits>
+#include <span>
+#include <vector>
+
+namespace mini {
+
+/**
+ * @brief Row-major grid of heights stored in square tiles. A tile is allocated only once a texel inside it is raised
+ * above the background height, so the stock area not covered by the model costs no memory.
+ *
+ * On top of the tiles there is a pyramid of max-reduced levels: level 0 holds the max of every tile and every next
+ * level the max of 2x2 cells of the previous one, up to a single cell. The pyramid is kept exact on every write, so
+ * `range_max` answers rectangle queries by descending only into the cells crossing the rectangle border.
+ *
+ */
+class TiledHeightField {
+ public:
+  static constexpr uint32_t kTileSize = 64;
+
+  TiledHeightField() = default;
+  TiledHeightField(uint32_t width, uint32_t height, float background);
+
+  /**
+   * @brief Builds the field from a dense row-major array, the tiles with all of the texels equal to the background are
+   * not allocated.
+   *
+   */
+  static TiledHeightField from_dense(uint32_t width, uint32_t height, float background, std::span<const float> data);
+
+  /**
+   * @brief Builds the field from bands of `kTileSize` rows computed in parallel, without a dense copy of the whole
+   * field. `fill(y0, y1, rows)` writes the rows [y0, y1) to the row-major `rows` and returns false if it left them at
+   * the background, then the band allocates no tiles. Of the filled bands only the non-background tiles are stored.
+   *
+   */
+  template <typename Fn>
+  static TiledHeightField generate_rows(uint32_t width, uint32_t height, float background, Fn&& fill) {
+    auto field = TiledHeightField(width, height, background);
+    parallel_for(field.tiles_y_, 1, [&](size_t begin, size_t end) {
+      auto rows = std::vector<float>(static_cast<size_t>(kTileSize) * width);
+      for (auto ty = static_cast<uint32_t>(begin); ty < end; ++ty) {
+        auto y0   = ty * kTileSize;
+        auto y1   = std::min(y0 + kTileSize, height);
+        auto band = std::span<float>(rows).first(static_cast<size_t>(y1 - y0) * width);
+        std::ranges::fill(band, background);
+        if (fill(y0, y1, band)) {
+          // Every band writes only its own row of tiles
+          field.store_tile_row(ty, band);
+        }
+      }
+    });
+
+    field.build_levels();
+    return field;
+  }
+
+  [[nodiscard]] uint32_t width() const { return width_; }
+  [[nodiscard]] uint32_t height() const { return height_; }
+  [[nodiscard]] float background() const { return background_; }
+  [[nodiscard]] size_t size() const { return static_cast<size_t>(width_) * height_; }
+
+  [[nodiscard]] size_t allocated_tiles() const;
+  [[nodiscard]] size_t tiles_count() const { return tiles_.size(); }
+
+  /**
+   * @brief Number of the max-reduced levels, level 0 holds the tile maxima and the last level is a single cell.
+   *
+   */
+  [[nodiscard]] size_t pyramid_levels() const { return levels_.size(); }
+
+  [[nodiscard]] float at(uint32_t x, uint32_t y) const;
+  void set(uint32_t x, uint32_t y, float h);
+
+  /**
+   * @brief Raises the texel to `h` if it's lower, the texels are never lowered.
+   *
+   */
+  void max_with(uint32_t x, uint32_t y, float h);
+
+  /**
+   * @brief Raises every texel to the texel of the other field if it's lower. The fields must have the same dimensions
+   * and background. Used to join the fields filled by the parallel workers.
+   *
+   */
+  void merge_max(const TiledHeightField& other);
+
+  /**
+   * @brief Max height in the rectangle [x0, x1) x [y0, y1), the rectangle is clamped to the field. Returns the lowest
+   * float for an empty rectangle.
+   *
+   */
+  [[nodiscard]] float range_max(uint32_t x0, uint32_t y0, uint32_t x1, uint32_t y1) const;
+
+  [[nodiscard]] float max() const { return levels_.empty() ? background_ : levels_.back().max.front(); }
+
+  /**
+   * @brief Copies the row [x0, x0 + out.size()) of the row y to the output.
+   *
+   */
+  void read_row(uint32_t y, uint32_t x0, std::span<float> out) const;
+
+  [[nodiscard]] std::vector<float> to_dense() const;
+
+ private:
+  struct Level {
+    uint32_t width;
+    uint32_t height;
+    std::vector<float> max;
+  };
+
+  [[nodiscard]] size_t tile_index(uint32_t x, uint32_t y) const {
+    return static_cast<size_t>(y / kTileSize) * tiles_x_ + x / kTileSize;
+  }
+
+  [[nodiscard]] static size_t texel_index(uint32_t x, uint32_t y) {
+    return static_cast<size_t>(y % kTileSize) * kTileSize + x % kTileSize;
+  }
+
+  std::vector<float>& tile_for_write(size_t tile);
+  void store_tile_row(uint32_t ty, std::span<const float> rows);
+  void build_levels();
+  void raise_levels(uint32_t x, uint32_t y, float h);
+  void refresh_levels(uint32_t x, uint32_t y);
+  [[nodiscard]] float range_max_in_tile(uint32_t tx, uint32_t ty, uint32_t x0, uint32_t y0, uint32_t x1,
+                                        uint32_t y1) const;
+  [[nodiscard]] static float children_max(const Level& children, uint32_t cx, uint32_t cy);
+  [[nodiscard]] float cell_max(size_t level, uint32_t cx, uint32_t cy, uint32_t x0, uint32_t y0, uint32_t x1,
+                               uint32_t y1) const;
+
+  uint32_t width_   = 0;
+  uint32_t height_  = 0;
+  uint32_t tiles_x_ = 0;
+  uint32_t tiles_y_ = 0;
+  float background_ = 0.F;
+  std::vector<std::vector<float>> tiles_;  // empty vector means the tile is not allocated
+  std::vector<Level> levels_;
+};
+
+}  // namespace mini
@@ -4,14 +4,17 @@
 #include <liberay/math/vec.hpp>
 #include <liberay/math/vec_fwd.hpp>
 #include <liberay/util/logger.hpp>
+#include <liberay/util/variant_match.hpp>
 #include <libminicad/algorithm/intersection_finder.hpp>
 #include <libminicad/renderer/scene_renderer.hpp>
 #include <libminicad/scene/patch_surface.hpp>
 #include <libminicad/scene/scene.hpp>
+#include <libminicad/scene/scene_snapshot.hpp>
 #include <limits>
 #include <optional>
 #include <random>
 #include <ranges>
+#include <variant>
 #include <vector>
 
 namespace mini {
@@ -397,40 +400,151 @@ std::optional<eray::math::Vec4f> IntersectionFinder::newton_next_point(const flo
   return result;
 }
 
+void IntersectionFinder::ParamSurface::sample_grid(std::span<const float> us, std::span<const float> vs,
+                                                   std::span<eray::math::Vec3f> out) const {
+  if (eval_grid) {
+    eval_grid(us, vs, out);
+    return;
+  }
+
+  for (auto i = 0U; i < us.size(); ++i) {
+    for (auto j = 0U; j < vs.size(); ++j) {
+      out[i * vs.size() + j] = eval(us[i], vs[j]);
+    }
+  }
+}
+
 eray::math::Vec4f IntersectionFinder::find_init_point(ParamSurface& s1, ParamSurface& s2, eray::math::Vec3f init) {
   const auto sectors = 20;
-  auto min_dist      = std::numeric_limits<float>::max();
-  auto result        = eray::math::Vec4f();
 
+  auto params = std::vector<float>(sectors);
   for (auto i = 0; i < sectors; ++i) {
-    for (auto j = 0; j < sectors; ++j) {
-      auto x = static_cast<float>(i) / static_cast<float>(sectors);
-      auto y = static_cast<float>(j) / static_cast<float>(sectors);
-
-      for (auto ii = 0; ii < sectors; ++ii) {
-        for (auto jj = 0; jj < sectors; ++jj) {
-          auto z = static_cast<float>(ii) / static_cast<float>(sectors);
-          auto w = static_cast<float>(jj) / static_cast<float>(sectors);
-
-          auto p1   = s1.eval(x, y);
-          auto p2   = s2.eval(z, w);
-          auto dist = math::distance(p1, init) + math::distance(p2, init);
-          if (dist < min_dist) {
-            min_dist = dist;
-            result   = eray::math::Vec4f(x, y, z, w);
-          }
-        }
-      }
+    params[i] = static_cast<float>(i) / static_cast<float>(sectors);
+  }
+
+  // The summed distance is separable, so it's enough to find the closest sample of each surface independently
+  auto closest_sample = [&](const ParamSurface& s) {
+    auto samples = std::vector<eray::math::Vec3f>(sectors * sectors);
+    s.sample_grid(params, params, samples);
+
+    auto dists = samples | std::views::transform([&](const auto& p) { return math::distance(p, init); });
+    auto idx   = static_cast<size_t>(std::ranges::distance(dists.begin(), std::ranges::min_element(dists)));
+    return eray::math::Vec2f(params[idx / sectors], params[idx % sectors]);
+  };
+
+  auto uv1 = closest_sample(s1);
+  auto uv2 = closest_sample(s2);
+
+  return eray::math::Vec4f(uv1.x, uv1.y, uv2.x, uv2.y);
+}
+
+namespace {
+
+struct SnapshotSurface {
+  IntersectionFinder::ParamSurface surface;
+  std::pair<eray::math::Vec3f, eray::math::Vec3f> aabb;
+  std::optional<OrientedBoundingBox> obb;
+};
+
+std::optional<SnapshotSurface> snapshot_surface(ISceneRenderer& renderer, const SceneSnapshot& snapshot,
+                                                const ParametricSurfaceHandle& handle) {
+  auto from_patch_surface = [&](const PatchSurfaceHandle& h) -> std::optional<SnapshotSurface> {
+    auto view = snapshot.patch_surface(h);
+    if (!view) {
+      return std::nullopt;
+    }
+
+    return SnapshotSurface{
+        .surface =
+            IntersectionFinder::ParamSurface{
+                .temp_rend = renderer,
+                .wrap_u    = false,
+                .wrap_v    = false,
+                .eval      = [view = *view](float u, float v) { return view.evaluate(u, v); },
+                .evald     = [view = *view](float u, float v) { return view.evaluate_derivatives(u, v); },
+                .eval_grid = {},
+            },
+        .aabb = view->aabb_bounding_box(),
+        .obb  = std::nullopt,
+    };
+  };
+
+  auto from_param_primitive = [&](const ParamPrimitiveHandle& h) -> std::optional<SnapshotSurface> {
+    auto view = snapshot.param_primitive(h);
+    if (!view) {
+      return std::nullopt;
     }
+
+    const auto& entry = view->entry.get();
+    auto eval_grid    = [&entry](auto us, auto vs, auto out) {
+      std::visit(eray::util::match([&](const CParamPrimitiveType auto& param) {
+                   param.evaluate_grid(entry.matrices, us, vs, out);
+                 }),
+                 entry.object);
+    };
+
+    return SnapshotSurface{
+        .surface =
+            IntersectionFinder::ParamSurface{
+                .temp_rend = renderer,
+                .wrap_u    = true,
+                .wrap_v    = true,
+                .eval      = [view = *view](float u, float v) { return view.evaluate(u, v); },
+                .evald     = [view = *view](float u, float v) { return view.evaluate_derivatives(u, v); },
+                .eval_grid = std::move(eval_grid),
+            },
+        .aabb = view->aabb_bounding_box(),
+        .obb  = view->oriented_bounding_box(),
+    };
+  };
+
+  return std::visit(eray::util::match{from_patch_surface, from_param_primitive}, handle);
+}
+
+}  // namespace
+
+std::optional<IntersectionFinder::Curve> IntersectionFinder::find_intersection(
+    ISceneRenderer& renderer, const SceneSnapshot& snapshot, const ParametricSurfaceHandle& h1,
+    const ParametricSurfaceHandle& h2, std::optional<eray::math::Vec3f> init, float accuracy, const JobContext& ctx) {
+  auto ss1 = snapshot_surface(renderer, snapshot, h1);
+  auto ss2 = snapshot_surface(renderer, snapshot, h2);
+  if (!ss1 || !ss2) {
+    eray::util::Logger::warn("Could not find the surfaces in the scene snapshot");
+    return std::nullopt;
   }
 
-  return result;
+  if (!aabb_intersects(ss1->aabb, ss2->aabb)) {
+    return std::nullopt;
+  }
+  if (ss1->obb && ss2->obb && !obb_intersects(*ss1->obb, *ss2->obb)) {
+    return std::nullopt;
+  }
+
+  return find_intersections(ss1->surface, ss2->surface, init, accuracy, false, ctx);
+}
+
+std::optional<IntersectionFinder::Curve> IntersectionFinder::find_self_intersection(
+    ISceneRenderer& renderer, const SceneSnapshot& snapshot, const ParametricSurfaceHandle& handle,
+    std::optional<eray::math::Vec3f> init, float accuracy, const JobContext& ctx) {
+  if (std::holds_alternative<ParamPrimitiveHandle>(handle)) {
+    return std::nullopt;
+  }
+
+  auto ss1 = snapshot_surface(renderer, snapshot, handle);
+  auto ss2 = snapshot_surface(renderer, snapshot, handle);
+  if (!ss1 || !ss2) {
+    eray::util::Logger::warn("Could not find the surface in the scene snapshot");
+    return std::nullopt;
+  }
+
+  return find_intersections(ss1->surface, ss2->surface, init, accuracy, true, ctx);
 }
 
 std::optional<IntersectionFinder::Curve> IntersectionFinder::find_intersections(ParamSurface& s1, ParamSurface& s2,
                                                                                 std::optional<eray::math::Vec3f> init,
                                                                                 float accuracy,
-                                                                                bool self_intersection) {
+                                                                                bool self_intersection,
+                                                                                const JobContext& ctx) {
   fix_wrap_flags(s1);
   fix_wrap_flags(s2);
 
@@ -523,7 +637,18 @@ std::optional<IntersectionFinder::Curve> IntersectionFinder::find_intersections(
   if (self_intersection) {
     found = false;
   }
-  for (const auto& init : gradient_descent_init_points) {
+
+  // The start point search takes roughly the first half of the time, the marching in both directions takes the rest
+  static constexpr auto kStartPointProgress = 0.5F;
+  static constexpr auto kMarchingSteps      = 10000U;
+
+  ctx.report(0.F, "Searching for a start point");
+  for (auto [i, init] : std::views::enumerate(gradient_descent_init_points)) {
+    if (ctx.is_cancelled()) {
+      return std::nullopt;
+    }
+    ctx.report(kStartPointProgress * static_cast<float>(i) / static_cast<float>(gradient_descent_init_points.size()));
+
     auto new_result =
         gradient_descent(init, kGradDescLearningRate, kGradDescTolerance, kGradDescMaxIterations, err_func);
 
@@ -666,10 +791,23 @@ std::optional<IntersectionFinder::Curve> IntersectionFinder::find_intersections(
     return curr;
   };
 
+  auto report_marching = [&](uint32_t step, bool reverse) {
+    static constexpr auto kDirectionProgress = (1.F - kStartPointProgress) / 2.F;
+    auto begin = reverse ? kStartPointProgress + kDirectionProgress : kStartPointProgress;
+    ctx.report(begin + kDirectionProgress * static_cast<float>(step) / static_cast<float>(kMarchingSteps));
+  };
+
+  ctx.report(kStartPointProgress, "Tracing the intersection curve");
+
   auto next_point       = start_point;
   auto end_point        = start_point;
   bool closure_detected = false;
-  for (auto i = 0U; i < 10000; ++i) {
+  for (auto i = 0U; i < kMarchingSteps; ++i) {
+    if (ctx.is_cancelled()) {
+      return std::nullopt;
+    }
+    report_marching(i, false);
+
     auto prev_point     = next_point;
     auto next_point_opt = try_newton_next_step(next_point);
     if (!next_point_opt) {
@@ -705,7 +843,12 @@ std::optional<IntersectionFinder::Curve> IntersectionFinder::find_intersections(
     curve.reverse();
     end_point  = next_point;
     next_point = start_point;
-    for (auto i = 0U; i < 10000; ++i) {
+    for (auto i = 0U; i < kMarchingSteps; ++i) {
+      if (ctx.is_cancelled()) {
+        return std::nullopt;
+      }
+      report_marching(i, true);
+
       auto prev_point     = next_point;
       auto next_point_opt = try_newton_next_step(next_point, true);
       if (!next_point_opt) {
@@ -1,14 +1,18 @@
 #pragma once
 
 #include <liberay/math/vec_fwd.hpp>
+#include <libminicad/jobs/job_context.hpp>
+#include <libminicad/math/obb.hpp>
 #include <libminicad/renderer/scene_renderer.hpp>
 #include <libminicad/scene/handles.hpp>
 #include <libminicad/scene/types.hpp>
 #include <optional>
+#include <span>
 
 namespace mini {
 
 class PatchSurface;
+class SceneSnapshot;
 
 class IntersectionFinder {
  public:
@@ -18,6 +22,15 @@ class IntersectionFinder {
     bool wrap_v = false;
     std::function<eray::math::Vec3f(float, float)> eval;
     std::function<std::pair<eray::math::Vec3f, eray::math::Vec3f>(float, float)> evald;
+
+    /**
+     * @brief Optional batch evaluation on the us x vs grid, the result for (us[i], vs[j]) is stored at
+     * out[i * vs.size() + j].
+     *
+     */
+    std::function<void(std::span<const float>, std::span<const float>, std::span<eray::math::Vec3f>)> eval_grid;
+
+    void sample_grid(std::span<const float> us, std::span<const float> vs, std::span<eray::math::Vec3f> out) const;
   };
 
   struct ParamSpace {
@@ -65,6 +78,7 @@ class IntersectionFinder {
         .wrap_v    = false,
         .eval      = std::move(eval),
         .evald     = std::move(evald),
+        .eval_grid = {},
     };
     auto s2 = ParamSurface{
         .temp_rend = renderer,
@@ -72,6 +86,7 @@ class IntersectionFinder {
         .wrap_v    = false,
         .eval      = std::move(eval),
         .evald     = std::move(evald),
+        .eval_grid = {},
     };
 
     return find_intersections(s1, s2, init, accuracy, true);
@@ -93,6 +108,11 @@ class IntersectionFinder {
     if (!aabb_intersects(bb1, bb2)) {
       return std::nullopt;
     }
+    if constexpr (std::is_same_v<T1, ParamPrimitive> && std::is_same_v<T2, ParamPrimitive>) {
+      if (!obb_intersects(ps1.oriented_bounding_box(), ps2.oriented_bounding_box())) {
+        return std::nullopt;
+      }
+    }
 
     auto eval1  = [&](float u, float v) { return ps1.evaluate(u, v); };
     auto evald1 = [&](float u, float v) { return ps1.evaluate_derivatives(u, v); };
@@ -116,6 +136,7 @@ class IntersectionFinder {
         .wrap_v    = wrap1,
         .eval      = std::move(eval1),
         .evald     = std::move(evald1),
+        .eval_grid = {},
     };
     auto s2 = ParamSurface{
         .temp_rend = renderer,
@@ -123,14 +144,44 @@ class IntersectionFinder {
         .wrap_v    = wrap2,
         .eval      = std::move(eval2),
         .evald     = std::move(evald2),
+        .eval_grid = {},
     };
 
+    if constexpr (std::is_same_v<T1, ParamPrimitive>) {
+      s1.eval_grid = [&](auto us, auto vs, auto out) { ps1.evaluate_grid(us, vs, out); };
+    }
+    if constexpr (std::is_same_v<T2, ParamPrimitive>) {
+      s2.eval_grid = [&](auto us, auto vs, auto out) { ps2.evaluate_grid(us, vs, out); };
+    }
+
     return find_intersections(s1, s2, init, accuracy, false);
   }
 
+  /**
+   * @brief Finds intersection between two parametric surfaces of the snapshot. Does not touch the scene, so it may be
+   * run as a job. Returns nullopt if no intersections are found, the surfaces are not in the snapshot or the job has
+   * been cancelled.
+   *
+   */
+  [[nodiscard]] static std::optional<Curve> find_intersection(ISceneRenderer& renderer, const SceneSnapshot& snapshot,
+                                                              const ParametricSurfaceHandle& h1,
+                                                              const ParametricSurfaceHandle& h2,
+                                                              std::optional<eray::math::Vec3f> init = std::nullopt,
+                                                              float accuracy = 0.1F, const JobContext& ctx = {});
+
+  /**
+   * @brief Finds self intersection of a parametric surface of the snapshot. See the snapshot `find_intersection`.
+   *
+   */
+  [[nodiscard]] static std::optional<Curve> find_self_intersection(ISceneRenderer& renderer,
+                                                                   const SceneSnapshot& snapshot,
+                                                                   const ParametricSurfaceHandle& handle,
+                                                                   std::optional<eray::math::Vec3f> init = std::nullopt,
+                                                                   float accuracy = 0.1F, const JobContext& ctx = {});
+
   static std::optional<Curve> find_intersections(ParamSurface& s1, ParamSurface& s2,
                                                  std::optional<eray::math::Vec3f> init, float accuracy = 0.1F,
-                                                 bool self_intersection = false);
+                                                 bool self_intersection = false, const JobContext& ctx = {});
 
   static constexpr auto kIntersectionThreshold = 0.1F;
 
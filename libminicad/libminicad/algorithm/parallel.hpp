@@ -0,0 +1,44 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+namespace mini {
+
+/**
+ * @brief Calls `fn(begin, end)` for the consecutive blocks of `grain` indices of [0, count) on all of the hardware
+ * threads. The blocks are taken from a shared counter, so the threads that got cheap blocks pick up more of them.
+ * Returns after all of the blocks are processed. With a single block the function is called on the calling thread.
+ *
+ */
+template <typename Fn>
+void parallel_for(size_t count, size_t grain, Fn&& fn) {
+  grain             = std::max<size_t>(grain, 1);
+  auto blocks_count = (count + grain - 1) / grain;
+  if (blocks_count <= 1) {
+    if (count > 0) {
+      fn(size_t{0}, count);
+    }
+    return;
+  }
+
+  auto next_block = std::atomic<size_t>(0);
+  auto worker     = [&]() {
+    for (auto block = next_block.fetch_add(1); block < blocks_count; block = next_block.fetch_add(1)) {
+      fn(block * grain, std::min(count, (block + 1) * grain));
+    }
+  };
+
+  auto threads_count = std::min<size_t>(std::max<size_t>(std::thread::hardware_concurrency(), 1), blocks_count);
+  auto threads       = std::vector<std::jthread>();
+  threads.reserve(threads_count - 1);
+  for (auto i = size_t{1}; i < threads_count; ++i) {
+    threads.emplace_back(worker);
+  }
+  worker();
+}
+
+}  // namespace mini
@@ -1,7 +1,18 @@
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cmath>
+#include <cstdint>
+#include <fstream>
 #include <iostream>
+#include <limits>
+#include <libminicad/algorithm/parallel.hpp>
 #include <libminicad/algorithm/paths_generator.hpp>
 #include <libminicad/scene/patch_surface.hpp>
 #include <libminicad/scene/scene.hpp>
+#include <mutex>
+#include <ranges>
+#include <span>
 
 #include "liberay/res/image.hpp"
 #include "liberay/util/logger.hpp"
@@ -9,82 +20,281 @@
 namespace mini {
 
 HeightMap HeightMap::create(Scene& scene, std::vector<PatchSurfaceHandle>& handles, const MillingDesc& desc) {
-  // Stage 1: Create the height map
-  auto height_map = std::vector<float>();
-  height_map.resize(kHeightMapSize * kHeightMapSize, desc.center.y);
+  return from_samples(scene, sample(*scene.snapshot(), handles, desc), desc);
+}
+
+eray::math::Vec2f MillingDesc::texel_center(uint32_t x, uint32_t z, uint32_t res_x, uint32_t res_z) const {
+  return eray::math::Vec2f((static_cast<float>(x) + 0.5F) / static_cast<float>(res_x) * width - width / 2.F,
+                           (static_cast<float>(z) + 0.5F) / static_cast<float>(res_z) * height - height / 2.F);
+}
+
+std::pair<uint32_t, uint32_t> HeightMap::resolution(const MillingDesc& desc) {
+  auto texel_size = static_cast<double>(std::max(desc.texel_size, std::numeric_limits<float>::min()));
+  auto to_texels  = [&](float extent) {
+    return static_cast<uint32_t>(
+        std::clamp(std::ceil(static_cast<double>(extent) / texel_size), 1.0, static_cast<double>(kMaxResolution)));
+  };
+
+  return {to_texels(desc.width), to_texels(desc.height)};
+}
+
+TiledHeightField HeightMap::sample(const SceneSnapshot& snapshot, std::span<const PatchSurfaceHandle> handles,
+                                   const MillingDesc& desc, const JobContext& ctx) {
+  auto [res_x, res_z] = resolution(desc);
+  auto heights        = TiledHeightField(res_x, res_z, desc.center.y);
 
   auto half_width  = desc.width / 2.F;
   auto half_height = desc.height / 2.F;
 
-  static constexpr uint32_t kSamples      = 4000;
-  static constexpr auto kHeightMapSizeFlt = static_cast<float>(kHeightMapSize);
-
-  auto max_h = 0.F;
-  for (auto handle : handles) {
-    if (auto obj = scene.arena<PatchSurface>().get_obj(handle)) {
-      auto& patch_surface = obj.value();
-      for (auto i = 0U; i < kSamples; ++i) {
-        for (auto j = 0U; j < kSamples; ++j) {
-          auto u     = static_cast<float>(i) / static_cast<float>(kSamples);
-          auto v     = static_cast<float>(j) / static_cast<float>(kSamples);
-          auto val   = patch_surface->evaluate(u, v);
-          bool valid = val.x > -half_width && val.x < half_width && val.z > -half_height && val.z < half_height;
-          if (!valid) {
-            continue;
-          }
+  // At least 2 samples per texel along the longer side, so that the finer height maps do not get holes
+  static constexpr uint32_t kMinSamples = 4000;
+  const auto samples                    = std::max(kMinSamples, 2 * std::max(res_x, res_z));
+  const auto res_x_flt                  = static_cast<float>(res_x);
+  const auto res_z_flt                  = static_cast<float>(res_z);
 
-          //  x,z -> [0, kHeightMapSize)
-          float x_f = (val.x + half_width) / desc.width * kHeightMapSizeFlt;
-          float z_f = (val.z + half_height) / desc.height * kHeightMapSizeFlt;
+  // Every parallel task samples its rows into its own sparse field and merges it into the result, so the workers never
+  // write to the same tiles
+  static constexpr size_t kRowsPerBlock = 64;
+  auto merge_mtx                        = std::mutex();
 
-          auto h_ind = static_cast<size_t>(z_f) * kHeightMapSize + static_cast<size_t>(x_f);
+  for (auto [k, handle] : std::views::enumerate(handles)) {
+    if (auto patch_surface = snapshot.patch_surface(handle)) {
+      auto surface_ctx = ctx.subrange(static_cast<float>(k) / static_cast<float>(handles.size()),
+                                      static_cast<float>(k + 1) / static_cast<float>(handles.size()));
+      auto rows_done   = uint32_t{0};
+      parallel_for(samples, kRowsPerBlock, [&](size_t begin, size_t end) {
+        auto block = TiledHeightField(res_x, res_z, desc.center.y);
+        for (auto i = begin; i < end && !ctx.is_cancelled(); ++i) {
+          for (auto j = 0U; j < samples; ++j) {
+            auto u     = static_cast<float>(i) / static_cast<float>(samples);
+            auto v     = static_cast<float>(j) / static_cast<float>(samples);
+            auto val   = patch_surface->evaluate(u, v);
+            bool valid = val.x > -half_width && val.x < half_width && val.z > -half_height && val.z < half_height;
+            if (!valid) {
+              continue;
+            }
 
-          if (h_ind < kHeightMapSize * kHeightMapSize) {
-            height_map[h_ind] = std::max(height_map[h_ind], val.y);
-            max_h             = std::max(max_h, val.y);
+            //  x,z -> [0, res_x) x [0, res_z)
+            auto x = static_cast<uint32_t>((val.x + half_width) / desc.width * res_x_flt);
+            auto z = static_cast<uint32_t>((val.z + half_height) / desc.height * res_z_flt);
+            if (x < res_x && z < res_z) {
+              block.max_with(x, z, val.y);
+            }
           }
         }
+
+        auto lock = std::scoped_lock(merge_mtx);
+        heights.merge_max(block);
+        rows_done += static_cast<uint32_t>(end - begin);
+        surface_ctx.report(static_cast<float>(rows_done) / static_cast<float>(samples));
+      });
+
+      if (ctx.is_cancelled()) {
+        return heights;
       }
     }
   }
 
-  // height map texture
+  return heights;
+}
+
+eray::math::Vec2f HeightMap::texel_size() const {
+  return eray::math::Vec2f(desc.width / static_cast<float>(std::max(width(), 1U)),
+                           desc.height / static_cast<float>(std::max(height(), 1U)));
+}
+
+TiledHeightField HeightMap::cutter_offset(const Cutter& cutter, const JobContext& ctx) const {
+  return CutterOffset::compute(heights, texel_size(), cutter, ctx);
+}
+
+HeightMap HeightMap::from_samples(Scene& scene, TiledHeightField&& heights, const MillingDesc& desc) {
+  auto max_h = std::max(0.F, heights.max());
+
+  // Every preview texel shows the max of the block of `step` x `step` height map texels
+  auto step           = (std::max(heights.width(), heights.height()) + kPreviewSize - 1) / kPreviewSize;
+  auto preview_width  = (heights.width() + step - 1) / step;
+  auto preview_height = (heights.height() + step - 1) / step;
+
   auto temp_texture = std::vector<uint32_t>();
-  temp_texture.resize(kHeightMapSize * kHeightMapSize);
+  temp_texture.resize(static_cast<size_t>(preview_width) * preview_height);
   if (max_h > 0.F) {
-    for (auto i = 0U; i < kHeightMapSize; ++i) {
-      for (auto j = 0U; j < kHeightMapSize; ++j) {
-        auto v                               = height_map[i * kHeightMapSize + j] / max_h;
-        temp_texture[i * kHeightMapSize + j] = eray::res::Color::from_rgb_norm(v, v, v);
+    for (auto i = 0U; i < preview_height; ++i) {
+      auto row = std::span(temp_texture).subspan(static_cast<size_t>(i) * preview_width, preview_width);
+      for (auto j = 0U; j < preview_width; ++j) {
+        auto v = heights.range_max(j * step, i * step, (j + 1) * step, (i + 1) * step) / max_h;
+        row[j] = eray::res::Color::from_rgb_norm(v, v, v);
       }
     }
   }
-  auto txt_handle = scene.renderer().upload_texture(temp_texture, kHeightMapSize, kHeightMapSize);
+  auto txt_handle = scene.renderer().upload_texture(temp_texture, preview_width, preview_height);
 
   return HeightMap{
-      .height_map        = std::move(height_map),
+      .heights           = std::move(heights),
       .height_map_handle = txt_handle,
-      .width             = kHeightMapSize,
-      .height            = kHeightMapSize,
+      .preview_width     = preview_width,
+      .preview_height    = preview_height,
+      .desc              = desc,
   };
 }
 
-bool HeightMap::save_to_file(const std::filesystem::path& filename) {
-  std::ofstream file(filename);
+namespace {
+
+// Binary height map layout, all of the values are little-endian:
+//   magic (8 bytes), version (u32), width (u32), height (u32), center (3 x f32), stock width (f32),
+//   stock height (f32), texel scale x (f32), texel scale z (f32), checksum (u64), heights (width * height x f32)
+constexpr auto kFileMagic      = std::array<char, 8>{'M', 'C', 'H', 'M', 'A', 'P', '\0', '\0'};
+constexpr size_t kHeaderSize   = kFileMagic.size() + 3 * sizeof(uint32_t) + 7 * sizeof(float) + sizeof(uint64_t);
+constexpr auto kIsLittleEndian = std::endian::native == std::endian::little;
+
+template <typename T>
+void write_le(std::vector<char>& out, T value) {
+  auto bits = std::bit_cast<std::array<char, sizeof(T)>>(value);
+  if constexpr (!kIsLittleEndian) {
+    std::ranges::reverse(bits);
+  }
+  out.insert(out.end(), bits.begin(), bits.end());
+}
+
+template <typename T>
+T read_le(std::span<const char>& in) {
+  auto bits = std::array<char, sizeof(T)>();
+  std::ranges::copy(in.first(sizeof(T)), bits.begin());
+  if constexpr (!kIsLittleEndian) {
+    std::ranges::reverse(bits);
+  }
+  in = in.subspan(sizeof(T));
+  return std::bit_cast<T>(bits);
+}
+
+/**
+ * @brief FNV-1a over the 32-bit words of the little-endian heights, so the checksum does not depend on the host.
+ *
+ */
+uint64_t heights_checksum(std::span<const float> heights) {
+  static constexpr uint64_t kOffsetBasis = 14695981039346656037ULL;
+  static constexpr uint64_t kPrime       = 1099511628211ULL;
+
+  auto hash = kOffsetBasis;
+  for (auto h : heights) {
+    hash ^= std::bit_cast<uint32_t>(h);
+    hash *= kPrime;
+  }
+  return hash;
+}
+
+void swap_bytes(std::span<float> heights) {
+  for (auto& h : heights) {
+    h = std::bit_cast<float>(std::byteswap(std::bit_cast<uint32_t>(h)));
+  }
+}
+
+}  // namespace
+
+bool HeightMap::save_to_file(const std::filesystem::path& filename) const {
+  std::ofstream file(filename, std::ios::binary);
   if (!file.is_open()) {
     eray::util::Logger::info("Failed to open the file with path {}", filename.string());
     return false;
   }
 
-  file << width << " " << height << "\n";
-  for (float h : height_map) {
-    file << h << "\n";
+  auto header = std::vector<char>();
+  header.reserve(kHeaderSize);
+  header.insert(header.end(), kFileMagic.begin(), kFileMagic.end());
+  write_le(header, kFileVersion);
+  write_le(header, width());
+  write_le(header, height());
+  write_le(header, desc.center.x);
+  write_le(header, desc.center.y);
+  write_le(header, desc.center.z);
+  write_le(header, desc.width);
+  write_le(header, desc.height);
+  write_le(header, desc.width / static_cast<float>(width()));
+  write_le(header, desc.height / static_cast<float>(height()));
+
+  auto height_map = heights.to_dense();
+  write_le(header, heights_checksum(height_map));
+  file.write(header.data(), static_cast<std::streamsize>(header.size()));
+
+  if constexpr (kIsLittleEndian) {
+    file.write(reinterpret_cast<const char*>(height_map.data()),
+               static_cast<std::streamsize>(height_map.size() * sizeof(float)));
+  } else {
+    swap_bytes(height_map);
+    file.write(reinterpret_cast<const char*>(height_map.data()),
+               static_cast<std::streamsize>(height_map.size() * sizeof(float)));
+  }
+
+  if (!file) {
+    eray::util::Logger::err("Failed to write the height map to {}", filename.string());
+    return false;
   }
 
   return true;
 }
 
 std::optional<HeightMap> HeightMap::load_from_file(Scene& scene, const std::filesystem::path& filename) {
+  std::ifstream file(filename, std::ios::binary);
+  if (!file.is_open()) {
+    eray::util::Logger::info("Failed to load file with path {}", filename.string());
+    return std::nullopt;
+  }
+
+  auto header_bytes = std::array<char, kHeaderSize>();
+  file.read(header_bytes.data(), static_cast<std::streamsize>(header_bytes.size()));
+  if (file.gcount() != static_cast<std::streamsize>(header_bytes.size()) ||
+      !std::ranges::equal(std::span(header_bytes).first(kFileMagic.size()), kFileMagic)) {
+    eray::util::Logger::info("No binary height map header in {}, reading it as a text height map", filename.string());
+    file.close();
+    return load_from_text_file(scene, filename);
+  }
+
+  auto header  = std::span<const char>(header_bytes).subspan(kFileMagic.size());
+  auto version = read_le<uint32_t>(header);
+  if (version != kFileVersion) {
+    eray::util::Logger::err("Unsupported height map file version {}", version);
+    return std::nullopt;
+  }
+
+  auto width  = read_le<uint32_t>(header);
+  auto height = read_le<uint32_t>(header);
+
+  auto desc     = MillingDesc{};
+  desc.center.x = read_le<float>(header);
+  desc.center.y = read_le<float>(header);
+  desc.center.z = read_le<float>(header);
+  desc.width    = read_le<float>(header);
+  desc.height   = read_le<float>(header);
+  read_le<float>(header);  // texel scale x, derived from the stock width
+  read_le<float>(header);  // texel scale z, derived from the stock height
+  auto checksum = read_le<uint64_t>(header);
+
+  if (width == 0 || height == 0 || width > kMaxResolution || height > kMaxResolution) {
+    eray::util::Logger::err("Height map dimensions {}x{} exceed the max dimensions {}x{}", width, height,
+                            kMaxResolution, kMaxResolution);
+    return std::nullopt;
+  }
+
+  // A single bulk read straight into the height map, there is no per value parsing
+  auto height_map = std::vector<float>(static_cast<size_t>(width) * height);
+  auto data_size  = static_cast<std::streamsize>(height_map.size() * sizeof(float));
+  file.read(reinterpret_cast<char*>(height_map.data()), data_size);
+  if (file.gcount() != data_size) {
+    eray::util::Logger::err("Height map file {} is truncated", filename.string());
+    return std::nullopt;
+  }
+  if constexpr (!kIsLittleEndian) {
+    swap_bytes(height_map);
+  }
+
+  if (heights_checksum(height_map) != checksum) {
+    eray::util::Logger::err("Height map file {} is corrupted, the checksum does not match", filename.string());
+    return std::nullopt;
+  }
+
+  return from_samples(scene, TiledHeightField::from_dense(width, height, desc.center.y, height_map), desc);
+}
+
+std::optional<HeightMap> HeightMap::load_from_text_file(Scene& scene, const std::filesystem::path& filename) {
   std::ifstream file(filename);
   if (!file.is_open()) {
     eray::util::Logger::info("Failed to load file with path {}", filename.string());
@@ -94,42 +304,24 @@ std::optional<HeightMap> HeightMap::load_from_file(Scene& scene, const std::file
   uint32_t width  = 0;
   uint32_t height = 0;
   file >> width >> height;
-  if (height > kHeightMapSize || width > kHeightMapSize) {
+  if (width == 0 || height == 0 || height > kMaxResolution || width > kMaxResolution) {
     eray::util::Logger::err("Height map dimensions exceed the max dimensions");
     return std::nullopt;
   }
 
   auto height_map = std::vector<float>();
-  height_map.reserve(kHeightMapSize * kHeightMapSize);
-  float h     = 0.F;
-  float max_h = 0.F;
+  height_map.reserve(static_cast<size_t>(width) * height);
+  float h = 0.F;
   while (file >> h) {
     height_map.push_back(h);
-    max_h = std::max(h, max_h);
   }
 
-  auto temp_texture = std::vector<uint32_t>();
-  temp_texture.resize(kHeightMapSize * kHeightMapSize);
-  if (max_h > 0.F) {
-    for (auto i = 0U; i < kHeightMapSize; ++i) {
-      for (auto j = 0U; j < kHeightMapSize; ++j) {
-        auto v                               = height_map[i * kHeightMapSize + j] / max_h;
-        temp_texture[i * kHeightMapSize + j] = eray::res::Color::from_rgb_norm(v, v, v);
-      }
-    }
-  }
-  auto txt_handle = scene.renderer().upload_texture(temp_texture, kHeightMapSize, kHeightMapSize);
-
   if (height_map.size() != width * height) {
     eray::util::Logger::warn("Expected {} but read {}", (width * height), height_map.size());
   }
+  height_map.resize(static_cast<size_t>(width) * height, 0.F);
 
-  return HeightMap{
-      .height_map        = std::move(height_map),
-      .height_map_handle = txt_handle,
-      .width             = width,
-      .height            = height,
-  };
+  return from_samples(scene, TiledHeightField::from_dense(width, height, MillingDesc{}.center.y, height_map));
 }
 
 }  // namespace mini
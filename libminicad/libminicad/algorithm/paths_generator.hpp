@@ -2,8 +2,14 @@
 
 #include <filesystem>
 #include <liberay/math/vec_fwd.hpp>
+#include <libminicad/algorithm/cutter_offset.hpp>
+#include <libminicad/algorithm/height_field.hpp>
+#include <libminicad/jobs/job_context.hpp>
 #include <libminicad/renderer/scene_renderer.hpp>
 #include <libminicad/scene/patch_surface.hpp>
+#include <libminicad/scene/scene_snapshot.hpp>
+#include <span>
+#include <utility>
 #include <vector>
 
 namespace mini {
@@ -12,24 +18,104 @@ struct MillingDesc {
   eray::math::Vec3f center = eray::math::Vec3f{0.F, 0.F, 0.F};
   float width              = 15.F;
   float height             = 15.F;
+
+  /**
+   * @brief Target size of a single height map texel, the height map resolution is derived from the stock extents.
+   *
+   */
+  float texel_size = 15.F / 2048.F;
+
+  /**
+   * @brief World x and z of the center of the texel (x, z) of a height map with the given resolution, the inverse of
+   * the mapping used by `HeightMap::sample`.
+   *
+   */
+  [[nodiscard]] eray::math::Vec2f texel_center(uint32_t x, uint32_t z, uint32_t res_x, uint32_t res_z) const;
 };
 
 struct HeightMap {
-  static constexpr uint32_t kHeightMapSize = 2048;
+  static constexpr uint32_t kMaxResolution = 16384;
+
+  /**
+   * @brief Max side of the preview texture, larger height maps are max-reduced.
+   *
+   */
+  static constexpr uint32_t kPreviewSize = 1024;
 
-  std::vector<float> height_map;
+  /**
+   * @brief Version of the binary height map file format written by `save_to_file`.
+   *
+   */
+  static constexpr uint32_t kFileVersion = 1;
+
+  TiledHeightField heights;
   TextureHandle height_map_handle;
-  uint32_t width  = kHeightMapSize;
-  uint32_t height = kHeightMapSize;
+  uint32_t preview_width  = 0;
+  uint32_t preview_height = 0;
+  MillingDesc desc        = MillingDesc{};
+
+  [[nodiscard]] uint32_t width() const { return heights.width(); }
+  [[nodiscard]] uint32_t height() const { return heights.height(); }
+
+  /**
+   * @brief World size of a single texel along x and z.
+   *
+   */
+  [[nodiscard]] eray::math::Vec2f texel_size() const;
 
+  /**
+   * @brief Heights of the cutter tip that do not gouge the sampled surfaces, see `CutterOffset`.
+   *
+   */
+  [[nodiscard]] TiledHeightField cutter_offset(const Cutter& cutter, const JobContext& ctx = {}) const;
+
+  /**
+   * @brief Resolution of the height map along x and z: the stock extents divided by the texel size, clamped to
+   * [1, kMaxResolution].
+   *
+   */
+  static std::pair<uint32_t, uint32_t> resolution(const MillingDesc& desc);
+
+  /**
+   * @brief Loads the binary height map, the data is read with a single bulk read. Files without the binary header are
+   * parsed with the legacy text reader, so the old height maps can be migrated by loading and saving them again.
+   *
+   */
   static std::optional<HeightMap> load_from_file(Scene& scene, const std::filesystem::path& filename);
+
+  /**
+   * @brief Legacy format: the dimensions followed by one height per line.
+   *
+   */
+  static std::optional<HeightMap> load_from_text_file(Scene& scene, const std::filesystem::path& filename);
   static HeightMap create(Scene& scene, std::vector<PatchSurfaceHandle>& handles,
                           const MillingDesc& desc = MillingDesc{
                               .center = eray::math::Vec3f{0.F, 0.F, 0.F},
                               .width  = 15.F,
                               .height = 15.F,
                           });
-  bool save_to_file(const std::filesystem::path& filename);
+
+  /**
+   * @brief Samples the surfaces into a tiled height map with the resolution given by `resolution(desc)`. Reads only the
+   * snapshot, so it may run on a worker thread while the scene is being edited. Returns a partially filled map if the
+   * job is cancelled.
+   *
+   */
+  static TiledHeightField sample(const SceneSnapshot& snapshot, std::span<const PatchSurfaceHandle> handles,
+                                 const MillingDesc& desc, const JobContext& ctx = {});
+
+  /**
+   * @brief Uploads the height map preview texture. Must be called on the main thread.
+   *
+   */
+  static HeightMap from_samples(Scene& scene, TiledHeightField&& heights, const MillingDesc& desc = MillingDesc{});
+
+  /**
+   * @brief Saves the height map in the binary format: a header with the dimensions, the milling description, the texel
+   * scale and the checksum of the data followed by the raw little-endian floats.
+   *
+   */
+  bool save_to_file(const std::filesystem::path& filename) const;
 };
 
 }  // namespace mini
@@ -0,0 +1,199 @@
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <liberay/math/vec.hpp>
+#include <liberay/util/logger.hpp>
+#include <libminicad/algorithm/parallel.hpp>
+#include <libminicad/algorithm/roughing_paths.hpp>
+#include <limits>
+#include <ranges>
+#include <span>
+
+namespace mini {
+
+namespace {
+
+// Number of passes generated by a single parallel task
+constexpr size_t kPassesPerBlock = 4;
+
+// Point of a path lying in a vertical plane: the position along the plane and the height
+struct ProfilePoint {
+  float s;
+  float h;
+};
+
+/**
+ * @brief Removes the points lying within the tolerance from the segment joining the ends of their run. The positions
+ * must be strictly increasing. Every run keeps the cone of slopes from its first point that satisfy all of the points
+ * added so far, the run ends when the next point falls out of the cone, so the pass is simplified in a single sweep.
+ *
+ */
+std::vector<ProfilePoint> simplify_profile(std::span<const ProfilePoint> profile, float tolerance) {
+  auto result = std::vector<ProfilePoint>();
+  if (profile.empty()) {
+    return result;
+  }
+
+  result.push_back(profile.front());
+  auto anchor = profile.front();
+  auto lo     = std::numeric_limits<float>::lowest();
+  auto hi     = std::numeric_limits<float>::max();
+  for (auto i = size_t{1}; i < profile.size(); ++i) {
+    const auto& p = profile[i];
+    auto slope    = (p.h - anchor.h) / (p.s - anchor.s);
+    if (slope < lo || slope > hi) {
+      anchor = profile[i - 1];
+      result.push_back(anchor);
+      lo = std::numeric_limits<float>::lowest();
+      hi = std::numeric_limits<float>::max();
+    }
+
+    auto ds = p.s - anchor.s;
+    lo      = std::max(lo, (p.h - tolerance - anchor.h) / ds);
+    hi      = std::min(hi, (p.h + tolerance - anchor.h) / ds);
+  }
+
+  if (profile.size() > 1) {
+    result.push_back(profile.back());
+  }
+  return result;
+}
+
+/**
+ * @brief Rows of the height field the passes go along, spaced by the step-over. The last row is always included, so
+ * the whole stock is covered.
+ *
+ */
+std::vector<uint32_t> pass_rows(uint32_t height, float texel_z, float step_over) {
+  auto rows = std::vector<uint32_t>();
+  auto step = std::max(step_over / texel_z, 1.F);
+  for (auto i = 0U;; ++i) {
+    auto row = static_cast<uint32_t>(std::lround(static_cast<float>(i) * step));
+    if (row >= height) {
+      break;
+    }
+    if (rows.empty() || rows.back() != row) {
+      rows.push_back(row);
+    }
+  }
+
+  if (rows.back() != height - 1) {
+    rows.push_back(height - 1);
+  }
+  return rows;
+}
+
+struct Pass {
+  std::vector<ProfilePoint> profile;  // along x, from the left to the right
+  std::vector<ProfilePoint> link;     // along z at the end column of the pass, to the next pass
+  size_t raw_points_count;
+};
+
+}  // namespace
+
+ToolPath RoughingPaths::generate(const TiledHeightField& offset_heights, const MillingDesc& milling,
+                                 const RoughingDesc& desc, const JobContext& ctx) {
+  const auto width  = offset_heights.width();
+  const auto height = offset_heights.height();
+  if (width == 0 || height == 0 || desc.layer_depths.empty()) {
+    return ToolPath{};
+  }
+
+  const auto rows         = pass_rows(height, milling.height / static_cast<float>(height), desc.step_over);
+  const auto passes_count = rows.size();
+  const auto tasks_count  = desc.layer_depths.size() * passes_count;
+  const auto texel_center = [&](uint32_t x, uint32_t z) { return milling.texel_center(x, z, width, height); };
+
+  auto passes     = std::vector<Pass>(tasks_count);
+  auto tasks_done = std::atomic<size_t>(0);
+  parallel_for(tasks_count, kPassesPerBlock, [&](size_t begin, size_t end) {
+    auto row     = std::vector<float>(width);
+    auto profile = std::vector<ProfilePoint>();
+    for (auto task = begin; task < end; ++task) {
+      if (ctx.is_cancelled()) {
+        return;
+      }
+
+      // The cutter never goes below the layer nor below the cutter-offset heights
+      const auto layer_h = desc.stock_top - desc.layer_depths[task / passes_count];
+      const auto p       = task % passes_count;
+      auto& pass         = passes[task];
+
+      offset_heights.read_row(rows[p], 0, row);
+      profile.clear();
+      for (auto x = 0U; x < width; ++x) {
+        profile.push_back(ProfilePoint{.s = texel_center(x, rows[p]).x, .h = std::max(layer_h, row[x])});
+      }
+      pass.profile          = simplify_profile(profile, desc.tolerance);
+      pass.raw_points_count = profile.size();
+
+      // The even passes go from the left to the right, so they are linked to the next pass at the right border
+      if (p + 1 < passes_count) {
+        const auto column = p % 2 == 0 ? width - 1 : 0;
+        profile.clear();
+        for (auto z = rows[p]; z <= rows[p + 1]; ++z) {
+          profile.push_back(ProfilePoint{.s = texel_center(column, z).y,
+                                         .h = std::max(layer_h, offset_heights.at(column, z))});
+        }
+        pass.link = simplify_profile(profile, desc.tolerance);
+        pass.raw_points_count += profile.size() - 2;
+      }
+    }
+
+    auto done = tasks_done.fetch_add(end - begin) + (end - begin);
+    ctx.report(static_cast<float>(done) / static_cast<float>(tasks_count));
+  });
+
+  if (ctx.is_cancelled()) {
+    return ToolPath{};
+  }
+
+  auto path          = ToolPath{};
+  auto& points       = path.points;
+  const auto safe_h  = desc.stock_top + desc.clearance;
+  const auto left_x  = texel_center(0, 0).x;
+  const auto right_x = texel_center(width - 1, 0).x;
+  for (auto layer = size_t{0}; layer < desc.layer_depths.size(); ++layer) {
+    for (auto p = size_t{0}; p < passes_count; ++p) {
+      const auto& pass   = passes[layer * passes_count + p];
+      const auto forward = p % 2 == 0;
+      const auto z       = texel_center(0, rows[p]).y;
+
+      if (p == 0) {
+        points.emplace_back(pass.profile.front().s, safe_h, z);
+      }
+
+      if (forward) {
+        for (const auto& point : pass.profile) {
+          points.emplace_back(point.s, point.h, z);
+        }
+      } else {
+        for (const auto& point : pass.profile | std::views::reverse) {
+          points.emplace_back(point.s, point.h, z);
+        }
+      }
+
+      // The ends of the link are the ends of the passes it joins
+      const auto link_x = forward ? right_x : left_x;
+      for (auto i = size_t{1}; i + 1 < pass.link.size(); ++i) {
+        points.emplace_back(link_x, pass.link[i].h, pass.link[i].s);
+      }
+      path.stats.raw_points_count += pass.raw_points_count;
+    }
+
+    auto last = points.back();
+    points.emplace_back(last.x, safe_h, last.z);
+  }
+
+  path.stats.raw_points_count += 2 * desc.layer_depths.size();
+  path.stats.points_count = points.size();
+  for (auto i = size_t{1}; i < points.size(); ++i) {
+    path.stats.length += eray::math::distance(points[i - 1], points[i]);
+  }
+
+  eray::util::Logger::info("Generated roughing path with {} points ({} before simplification), length: {}",
+                           path.stats.points_count, path.stats.raw_points_count, path.stats.length);
+  return path;
+}
+
+}  // namespace mini
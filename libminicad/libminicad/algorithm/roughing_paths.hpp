@@ -0,0 +1,61 @@
+#pragma once
+
+#include <libminicad/algorithm/height_field.hpp>
+#include <libminicad/algorithm/paths_generator.hpp>
+#include <libminicad/algorithm/tool_path.hpp>
+#include <libminicad/jobs/job_context.hpp>
+#include <vector>
+
+namespace mini {
+
+struct RoughingDesc {
+  /**
+   * @brief Height of the top of the stock, the cutter approaches and leaves every layer above it.
+   *
+   */
+  float stock_top = 5.F;
+
+  /**
+   * @brief Depths of the consecutive layers below the stock top.
+   *
+   */
+  std::vector<float> layer_depths = {1.75F, 3.5F};
+
+  /**
+   * @brief Distance between the neighbouring zig-zag passes in world units.
+   *
+   */
+  float step_over = 0.5F;
+
+  /**
+   * @brief Height above the stock top of the moves between the layers.
+   *
+   */
+  float clearance = 1.F;
+
+  /**
+   * @brief Max vertical distance of the removed points from the simplified path.
+   *
+   */
+  float tolerance = 1e-4F;
+};
+
+/**
+ * @brief Generates the zig-zag roughing paths from a cutter-offset height field. Every layer is a sequence of passes
+ * along x spaced by the step-over along z, the cutter never goes below the layer depth nor below the cutter-offset
+ * heights, so the passes follow the model wherever it sticks out of the layer. The points of a pass are emitted per
+ * texel and the runs of collinear points are merged, so a flat pass is reduced to its ends.
+ *
+ */
+class RoughingPaths {
+ public:
+  /**
+   * @brief The offset heights must be computed for the cutter that mills the path, see `CutterOffset`. The milling
+   * description maps the texels to world space. Returns an empty path if the job is cancelled.
+   *
+   */
+  static ToolPath generate(const TiledHeightField& offset_heights, const MillingDesc& milling,
+                           const RoughingDesc& desc, const JobContext& ctx = {});
+};
+
+}  // namespace mini
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstddef>
+#include <liberay/math/vec.hpp>
+#include <vector>
+
+namespace mini {
+
+struct ToolPathStats {
+  /**
+   * @brief Number of the points before the collinear runs were simplified.
+   *
+   */
+  size_t raw_points_count = 0;
+  size_t points_count     = 0;
+
+  /**
+   * @brief Total length of the path in world units, including the retract and plunge moves.
+   *
+   */
+  float length = 0.F;
+};
+
+/**
+ * @brief Positions of the cutter tip in world space, the cutter moves along straight segments between the consecutive
+ * points.
+ *
+ */
+struct ToolPath {
+  std::vector<eray::math::Vec3f> points;
+  ToolPathStats stats;
+};
+
+}  // namespace mini
@@ -0,0 +1,118 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <stop_token>
+#include <string>
+#include <utility>
+
+namespace mini {
+
+enum class JobStatus : uint8_t {
+  Queued   = 0,
+  Running  = 1,
+  Finished = 2,
+};
+
+enum class JobError : uint8_t {
+  Cancelled = 0,
+  Failed    = 1,
+};
+
+/**
+ * @brief State shared between a running job, its handle and the scheduler. The progress and the status are atomics, so
+ * they can be read on the main thread while a worker updates them.
+ *
+ */
+class JobState {
+ public:
+  explicit JobState(std::string name) : name_(std::move(name)) {}
+  virtual ~JobState() = default;
+
+  JobState(const JobState&)            = delete;
+  JobState(JobState&&)                 = delete;
+  JobState& operator=(const JobState&) = delete;
+  JobState& operator=(JobState&&)      = delete;
+
+  [[nodiscard]] const std::string& name() const { return name_; }
+
+  [[nodiscard]] JobStatus status() const { return status_.load(std::memory_order_acquire); }
+  void set_status(JobStatus status) { status_.store(status, std::memory_order_release); }
+
+  [[nodiscard]] float progress() const { return progress_.load(std::memory_order_relaxed); }
+  void set_progress(float progress) { progress_.store(std::clamp(progress, 0.F, 1.F), std::memory_order_relaxed); }
+
+  [[nodiscard]] std::string message() const {
+    auto lock = std::scoped_lock(message_mtx_);
+    return message_;
+  }
+  void set_message(std::string message) {
+    auto lock = std::scoped_lock(message_mtx_);
+    message_  = std::move(message);
+  }
+
+  void request_cancel() { stop_source_.request_stop(); }
+  [[nodiscard]] bool is_cancel_requested() const { return stop_source_.stop_requested(); }
+  [[nodiscard]] std::stop_token stop_token() const { return stop_source_.get_token(); }
+
+ private:
+  std::string name_;
+  std::stop_source stop_source_;
+  std::atomic<JobStatus> status_ = JobStatus::Queued;
+  std::atomic<float> progress_   = 0.F;
+
+  mutable std::mutex message_mtx_;
+  std::string message_;
+};
+
+/**
+ * @brief Passed to the job function. Lets the job report its progress and poll for the cooperative cancellation.
+ * A default constructed context is detached: it is never cancelled and the reports are dropped, so the long running
+ * algorithms may take it as an optional parameter and still be called synchronously.
+ *
+ */
+class JobContext {
+ public:
+  JobContext() = default;
+  explicit JobContext(std::shared_ptr<JobState> state) : state_(std::move(state)) {}
+
+  [[nodiscard]] bool is_cancelled() const { return state_ && state_->is_cancel_requested(); }
+
+  /**
+   * @brief Reports the progress in the [0, 1] range.
+   *
+   */
+  void report(float progress) const {
+    if (state_) {
+      state_->set_progress(begin_ + (end_ - begin_) * progress);
+    }
+  }
+
+  void report(float progress, std::string message) const {
+    if (state_) {
+      state_->set_progress(begin_ + (end_ - begin_) * progress);
+      state_->set_message(std::move(message));
+    }
+  }
+
+  /**
+   * @brief Returns a context that maps the [0, 1] progress of a sub task onto the [begin, end] range of this context.
+   *
+   */
+  [[nodiscard]] JobContext subrange(float begin, float end) const {
+    auto ctx   = JobContext(state_);
+    ctx.begin_ = begin_ + (end_ - begin_) * begin;
+    ctx.end_   = begin_ + (end_ - begin_) * end;
+    return ctx;
+  }
+
+ private:
+  std::shared_ptr<JobState> state_;
+  float begin_ = 0.F;
+  float end_   = 1.F;
+};
+
+}  // namespace mini
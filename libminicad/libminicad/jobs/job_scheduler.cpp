@@ -0,0 +1,113 @@
+#include <algorithm>
+#include <liberay/util/logger.hpp>
+#include <libminicad/jobs/job_scheduler.hpp>
+#include <mutex>
+#include <ranges>
+#include <thread>
+
+namespace mini {
+
+JobScheduler JobScheduler::create(size_t worker_count) {
+  if (worker_count == 0) {
+    worker_count = std::max<size_t>(std::thread::hardware_concurrency(), 2) - 1;
+  }
+
+  auto m = Members{
+      .queue   = std::make_unique<Queue>(),
+      .pending = {},
+      .workers = {},
+  };
+
+  m.workers.reserve(worker_count);
+  for (auto i = 0U; i < worker_count; ++i) {
+    m.workers.emplace_back(
+        [queue = m.queue.get()](const std::stop_token& stop_token) { worker_loop(stop_token, *queue); });
+  }
+
+  eray::util::Logger::info("Job scheduler started with {} workers", worker_count);
+
+  return JobScheduler(std::move(m));
+}
+
+JobScheduler::~JobScheduler() {
+  if (!m_.queue) {
+    return;
+  }
+
+  // The workers finish the jobs that are already running, cancelling lets them return early
+  cancel_all();
+  for (auto& worker : m_.workers) {
+    worker.request_stop();
+  }
+}
+
+void JobScheduler::worker_loop(const std::stop_token& stop_token, Queue& queue) {
+  while (true) {
+    auto task = Task{};
+    {
+      auto lock = std::unique_lock(queue.mtx);
+      if (!queue.cv.wait(lock, stop_token, [&queue] { return !queue.tasks.empty(); })) {
+        return;
+      }
+      task = std::move(queue.tasks.front());
+      queue.tasks.pop_front();
+    }
+
+    task.state->set_status(JobStatus::Running);
+    task.work();
+    task.state->set_status(JobStatus::Finished);
+  }
+}
+
+void JobScheduler::enqueue(std::shared_ptr<JobState> state, std::function<void()>&& work,
+                           std::function<void()>&& apply) {
+  m_.pending.push_back(PendingJob{.state = state, .apply = std::move(apply)});
+  {
+    auto lock = std::scoped_lock(m_.queue->mtx);
+    m_.queue->tasks.push_back(Task{.state = std::move(state), .work = std::move(work)});
+  }
+  m_.queue->cv.notify_one();
+}
+
+void JobScheduler::poll() {
+  // The completion callbacks may submit new jobs, so the finished ones are extracted before being applied
+  auto finished = std::vector<PendingJob>();
+  std::erase_if(m_.pending, [&finished](PendingJob& job) {
+    if (job.state->status() != JobStatus::Finished) {
+      return false;
+    }
+    finished.push_back(std::move(job));
+    return true;
+  });
+
+  for (auto& job : finished) {
+    job.apply();
+  }
+}
+
+void JobScheduler::cancel_all() {
+  for (auto& job : m_.pending) {
+    job.state->request_cancel();
+  }
+}
+
+std::vector<JobInfo> JobScheduler::jobs() const {
+  return m_.pending | std::views::transform([](const PendingJob& job) {
+           return JobInfo{
+               .name             = job.state->name(),
+               .message          = job.state->message(),
+               .progress         = job.state->progress(),
+               .status           = job.state->status(),
+               .cancel_requested = job.state->is_cancel_requested(),
+           };
+         }) |
+         std::ranges::to<std::vector>();
+}
+
+void JobScheduler::cancel(size_t job_index) {
+  if (job_index < m_.pending.size()) {
+    m_.pending[job_index].state->request_cancel();
+  }
+}
+
+}  // namespace mini
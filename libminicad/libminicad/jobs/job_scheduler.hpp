@@ -0,0 +1,209 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <expected>
+#include <functional>
+#include <liberay/util/logger.hpp>
+#include <libminicad/jobs/job_context.hpp>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace mini {
+
+template <typename T>
+using JobResult = std::expected<T, JobError>;
+
+/**
+ * @brief Typed handle to a submitted job. The handle may be kept by the UI to display the progress, to cancel the job
+ * and, if no completion callback was provided on submission, to take the result once the scheduler has polled it.
+ *
+ */
+template <typename T>
+class JobHandle {
+ public:
+  struct State : public JobState {
+    explicit State(std::string name) : JobState(std::move(name)) {}
+
+    std::optional<JobResult<T>> result;
+    bool applied = false;
+  };
+
+  JobHandle() = default;
+  explicit JobHandle(std::shared_ptr<State> state) : state_(std::move(state)) {}
+
+  [[nodiscard]] bool is_valid() const { return state_ != nullptr; }
+  [[nodiscard]] bool is_finished() const { return state_ && state_->status() == JobStatus::Finished; }
+  [[nodiscard]] float progress() const { return state_ ? state_->progress() : 0.F; }
+  [[nodiscard]] std::string message() const { return state_ ? state_->message() : std::string(); }
+
+  void cancel() {
+    if (state_) {
+      state_->request_cancel();
+    }
+  }
+
+  /**
+   * @brief Moves the result out of the handle. Returns nullopt until the job is finished and polled by the scheduler.
+   * Must be called on the main thread.
+   *
+   */
+  std::optional<JobResult<T>> try_take() {
+    if (!state_ || !state_->applied || !state_->result) {
+      return std::nullopt;
+    }
+    auto result = std::move(state_->result);
+    state_->result.reset();
+    return result;
+  }
+
+ private:
+  std::shared_ptr<State> state_;
+};
+
+struct JobInfo {
+  std::string name;
+  std::string message;
+  float progress;
+  JobStatus status;
+  bool cancel_requested;
+};
+
+/**
+ * @brief Fixed pool of worker threads running long operations off the main thread. The jobs must not touch the scene,
+ * they should work on a `SceneSnapshot` instead. The results are delivered by `poll()`, which is expected to be called
+ * once per frame on the main thread, so the completion callbacks are free to modify the scene.
+ *
+ */
+class JobScheduler {
+ public:
+  JobScheduler() = delete;
+
+  /**
+   * @brief Creates the scheduler with a fixed number of workers. The hardware concurrency minus one (for the main
+   * thread) is used if the worker count is zero.
+   *
+   */
+  static JobScheduler create(size_t worker_count = 0);
+
+  JobScheduler(JobScheduler&&) noexcept        = default;
+  JobScheduler(const JobScheduler&)            = delete;
+  JobScheduler& operator=(JobScheduler&&)      = delete;
+  JobScheduler& operator=(const JobScheduler&) = delete;
+
+  ~JobScheduler();
+
+  /**
+   * @brief Enqueues the job. The job function is called on a worker thread. The completion callback is called on the
+   * main thread by `poll()`, a cancelled job reports `JobError::Cancelled` even if the function returned a value.
+   *
+   */
+  template <typename T>
+  JobHandle<T> submit(std::string name, std::function<T(const JobContext&)> job,
+                      std::function<void(JobResult<T>&&)> on_done = {}) {
+    auto state = std::make_shared<typename JobHandle<T>::State>(std::move(name));
+
+    auto work = [state, job = std::move(job)]() {
+      if (state->is_cancel_requested()) {
+        state->result = std::unexpected(JobError::Cancelled);
+        return;
+      }
+
+      auto run = [&]() -> JobResult<T> {
+        if constexpr (std::is_void_v<T>) {
+          job(JobContext(state));
+          return {};
+        } else {
+          return job(JobContext(state));
+        }
+      };
+
+      try {
+        auto result = run();
+        if (state->is_cancel_requested()) {
+          state->result = std::unexpected(JobError::Cancelled);
+        } else {
+          state->set_progress(1.F);
+          state->result = std::move(result);
+        }
+      } catch (const std::exception& e) {
+        eray::util::Logger::err("Job \"{}\" failed: {}", state->name(), e.what());
+        state->result = std::unexpected(JobError::Failed);
+      } catch (...) {
+        // Anything escaping the worker thread would terminate the application
+        eray::util::Logger::err("Job \"{}\" failed with an unknown exception", state->name());
+        state->result = std::unexpected(JobError::Failed);
+      }
+    };
+
+    auto apply = [state, on_done = std::move(on_done)]() {
+      state->applied = true;
+      if (on_done && state->result) {
+        on_done(std::move(*state->result));
+        state->result.reset();
+      }
+    };
+
+    enqueue(state, std::move(work), std::move(apply));
+    return JobHandle<T>(std::move(state));
+  }
+
+  /**
+   * @brief Applies the results of the finished jobs. Must be called on the main thread.
+   *
+   */
+  void poll();
+
+  void cancel_all();
+
+  /**
+   * @brief Returns the queued and running jobs in the submission order.
+   *
+   */
+  [[nodiscard]] std::vector<JobInfo> jobs() const;
+  void cancel(size_t job_index);
+
+  [[nodiscard]] bool is_idle() const { return m_.pending.empty(); }
+  [[nodiscard]] size_t worker_count() const { return m_.workers.size(); }
+
+ private:
+  struct Task {
+    std::shared_ptr<JobState> state;
+    std::function<void()> work;
+  };
+
+  struct Queue {
+    std::mutex mtx;
+    std::condition_variable_any cv;
+    std::deque<Task> tasks;
+  };
+
+  struct PendingJob {
+    std::shared_ptr<JobState> state;
+    std::function<void()> apply;
+  };
+
+  struct Members {
+    std::unique_ptr<Queue> queue;
+    std::vector<PendingJob> pending;
+
+    // Declared last, so the workers are joined before the queue is destroyed
+    std::vector<std::jthread> workers;
+  } m_;
+
+  explicit JobScheduler(Members&& m) : m_(std::move(m)) {}
+
+  void enqueue(std::shared_ptr<JobState> state, std::function<void()>&& work, std::function<void()>&& apply);
+
+  static void worker_loop(const std::stop_token& stop_token, Queue& queue);
+};
+
+}  // namespace mini
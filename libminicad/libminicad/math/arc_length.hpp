@@ -0,0 +1,178 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <liberay/math/vec.hpp>
+#include <libminicad/math/bezier3.hpp>
+#include <span>
+#include <vector>
+
+namespace mini {
+
+/**
+ * @brief Length of the [t0, t1] part of a cubic Bezier segment, computed with the 5-point Gauss-Legendre quadrature.
+ *
+ */
+inline float bezier3_length(const Vec3f& p0, const Vec3f& p1, const Vec3f& p2, const Vec3f& p3, float t0, float t1) {
+  static constexpr auto kNodes   = std::array<float, 5>{0.F, -0.538469310F, 0.538469310F, -0.906179846F, 0.906179846F};
+  static constexpr auto kWeights = std::array<float, 5>{0.568888889F, 0.478628670F, 0.478628670F, 0.236926885F,
+                                                        0.236926885F};
+
+  auto half = (t1 - t0) / 2.F;
+  auto mid  = (t1 + t0) / 2.F;
+
+  auto result = 0.F;
+  for (auto i = 0U; i < kNodes.size(); ++i) {
+    result += kWeights[i] * eray::math::length(bezier3_dt(p0, p1, p2, p3, mid + half * kNodes[i]));
+  }
+
+  return result * half;
+}
+
+/**
+ * @brief Cumulative arc length of a multisegment Bezier curve sampled at uniformly distributed values of the curve
+ * parameter. Every segment is split into `kSubdivisions` intervals, so the inverse lookup is a binary search over the
+ * table followed by a few Newton iterations inside a single interval.
+ *
+ */
+class ArcLengthTable {
+ public:
+  static constexpr size_t kSubdivisions     = 8;
+  static constexpr int kNewtonIterations    = 4;
+  static constexpr float kDerivativeEpsilon = 1e-6F;
+
+  static ArcLengthTable build(std::span<const Vec3f> bezier3_points) {
+    auto table = ArcLengthTable();
+    if (bezier3_points.empty()) {
+      return table;
+    }
+
+    table.segments_count_ = std::max<size_t>(bezier3_points.size() / 4, 1);
+    table.lengths_.reserve(table.segments_count_ * kSubdivisions + 1);
+    table.lengths_.push_back(0.F);
+
+    for (auto segment = size_t{0}; segment < table.segments_count_; ++segment) {
+      table.push_segment(bezier3_points, segment);
+    }
+
+    return table;
+  }
+
+  /**
+   * @brief Rebuilds the table after the segments between the first `valid_prefix` and the last `valid_suffix`
+   * segments have changed. The lengths of the valid segments are reused instead of being integrated again.
+   *
+   */
+  void splice(std::span<const Vec3f> bezier3_points, size_t valid_prefix, size_t valid_suffix) {
+    auto segments_count = bezier3_points.size() / 4;
+    if (lengths_.empty() || segments_count == 0 || valid_prefix + valid_suffix > segments_count ||
+        valid_prefix + valid_suffix > segments_count_) {
+      *this = build(bezier3_points);
+      return;
+    }
+
+    auto suffix_lengths = std::vector<float>();
+    suffix_lengths.reserve(valid_suffix * kSubdivisions);
+    for (auto i = lengths_.size() - valid_suffix * kSubdivisions; i < lengths_.size(); ++i) {
+      suffix_lengths.push_back(lengths_[i] - lengths_[i - 1]);
+    }
+
+    lengths_.resize(valid_prefix * kSubdivisions + 1);
+    lengths_.reserve(segments_count * kSubdivisions + 1);
+    segments_count_ = segments_count;
+
+    for (auto segment = valid_prefix; segment < segments_count - valid_suffix; ++segment) {
+      push_segment(bezier3_points, segment);
+    }
+    for (auto length : suffix_lengths) {
+      lengths_.push_back(lengths_.back() + length);
+    }
+  }
+
+  [[nodiscard]] bool empty() const { return lengths_.empty(); }
+  [[nodiscard]] float total_length() const { return lengths_.empty() ? 0.F : lengths_.back(); }
+
+  /**
+   * @brief Returns the curve parameter in [0, 1] at which the arc length is equal to `s`. The arc length is clamped to
+   * the curve length. The points must be the ones the table has been built from.
+   *
+   */
+  [[nodiscard]] float param_at_length(std::span<const Vec3f> bezier3_points, float s) const {
+    if (lengths_.size() < 2) {
+      return 0.F;
+    }
+
+    s = std::clamp(s, 0.F, total_length());
+
+    auto it   = std::ranges::upper_bound(lengths_.begin(), lengths_.end() - 1, s);
+    auto node = static_cast<size_t>(std::max<std::ptrdiff_t>(std::distance(lengths_.begin(), it) - 1, 0));
+    return solve(bezier3_points, node, s);
+  }
+
+  /**
+   * @brief Fills the output with curve parameters of samples equally spaced along the curve, including both curve
+   * ends. The table is walked once, so it's cheaper than calling `param_at_length` for each sample.
+   *
+   */
+  void equally_spaced_params(std::span<const Vec3f> bezier3_points, std::span<float> out) const {
+    if (out.empty()) {
+      return;
+    }
+    if (lengths_.size() < 2) {
+      std::ranges::fill(out, 0.F);
+      return;
+    }
+
+    auto step = out.size() > 1 ? total_length() / static_cast<float>(out.size() - 1) : 0.F;
+    auto node = size_t{0};
+    for (auto i = 0U; i < out.size(); ++i) {
+      auto s = std::min(step * static_cast<float>(i), total_length());
+      while (node + 2 < lengths_.size() && lengths_[node + 1] <= s) {
+        ++node;
+      }
+      out[i] = solve(bezier3_points, node, s);
+    }
+  }
+
+ private:
+  void push_segment(std::span<const Vec3f> bezier3_points, size_t segment) {
+    const auto& [p0, p1, p2, p3] = bezier3_segment(bezier3_points, segment);
+    for (auto k = 0U; k < kSubdivisions; ++k) {
+      auto t0 = static_cast<float>(k) / static_cast<float>(kSubdivisions);
+      auto t1 = static_cast<float>(k + 1) / static_cast<float>(kSubdivisions);
+      lengths_.push_back(lengths_.back() + bezier3_length(p0, p1, p2, p3, t0, t1));
+    }
+  }
+
+  /**
+   * @brief Finds the parameter for the arc length `s` inside the interval starting at the `node` of the table.
+   *
+   */
+  [[nodiscard]] float solve(std::span<const Vec3f> bezier3_points, size_t node, float s) const {
+    auto segment = node / kSubdivisions;
+    auto t0      = static_cast<float>(node % kSubdivisions) / static_cast<float>(kSubdivisions);
+    auto t1      = t0 + 1.F / static_cast<float>(kSubdivisions);
+
+    const auto& [p0, p1, p2, p3] = bezier3_segment(bezier3_points, segment);
+
+    // Linear interpolation in the table gives the initial guess
+    auto target   = s - lengths_[node];
+    auto interval = lengths_[node + 1] - lengths_[node];
+    auto t        = interval > 0.F ? t0 + (t1 - t0) * std::clamp(target / interval, 0.F, 1.F) : t0;
+
+    for (auto i = 0; i < kNewtonIterations; ++i) {
+      auto speed = eray::math::length(bezier3_dt(p0, p1, p2, p3, t));
+      if (speed < kDerivativeEpsilon) {
+        break;
+      }
+      t = std::clamp(t - (bezier3_length(p0, p1, p2, p3, t0, t) - target) / speed, t0, t1);
+    }
+
+    return (static_cast<float>(segment) + t) / static_cast<float>(segments_count_);
+  }
+
+  size_t segments_count_ = 0;
+  std::vector<float> lengths_;
+};
+
+}  // namespace mini
@@ -1,6 +1,10 @@
 #pragma once
 
+#include <algorithm>
+#include <array>
 #include <liberay/math/vec.hpp>
+#include <span>
+#include <utility>
 
 namespace mini {
 
@@ -25,4 +29,119 @@ inline Vec3f bezier3_dtt(const Vec3f& p0, const Vec3f& p1, const Vec3f& p2, cons
   return 6.0F * u * (p2 - 2.0F * p1 + p0) + 6.0F * t * (p3 - 2.0F * p2 + p1);
 }
 
+/**
+ * @brief Returns control points of the segment of a multisegment Bezier curve stored as 4 points per segment. The
+ * missing points of an incomplete segment are replaced with the last available one.
+ *
+ */
+inline std::array<Vec3f, 4> bezier3_segment(std::span<const Vec3f> points, size_t segment_ind) {
+  auto i         = segment_ind * 4U;
+  const auto& p0 = points[i];
+  ++i;
+  const auto& p1 = i >= points.size() ? p0 : points[i];
+  ++i;
+  const auto& p2 = i >= points.size() ? p1 : points[i];
+  ++i;
+  const auto& p3 = i >= points.size() ? p2 : points[i];
+
+  return {p0, p1, p2, p3};
+}
+
+/**
+ * @brief Evaluates a multisegment Bezier curve stored as 4 points per segment. The parameter is split uniformly across
+ * the segments, the last segment may be incomplete.
+ *
+ */
+inline Vec3f bezier3_segments(std::span<const Vec3f> points, float t) {
+  if (points.empty() || t > 1.F) {
+    return Vec3f::filled(0.F);
+  }
+
+  auto segments_count = std::max<size_t>(points.size() / 4, 1);
+  auto segment_len    = 1.F / static_cast<float>(segments_count);
+  auto segment_ind    = std::min(static_cast<size_t>(t / segment_len), segments_count - 1);
+
+  // Map to to the segment
+  t = (t - static_cast<float>(segment_ind) * segment_len) / segment_len;
+
+  const auto& [p0, p1, p2, p3] = bezier3_segment(points, segment_ind);
+  return bezier3(p0, p1, p2, p3, t);
+}
+
+/**
+ * @brief Finds the patch containing the global (u, v) parameter and maps the parameter to the patch.
+ *
+ */
+inline std::pair<eray::math::Vec2f, eray::math::Vec2u> bezier3_patches_find(eray::math::Vec2u dim, float u, float v) {
+  auto param = eray::math::Vec2f(u, v);
+
+  auto patch_size   = 1.F / eray::math::Vec2f(static_cast<float>(dim.x), static_cast<float>(dim.y));
+  auto patch_coords = param / patch_size;
+
+  const auto coord_x =
+      static_cast<uint32_t>(std::clamp(static_cast<int>(patch_coords.x), 0, static_cast<int>(dim.x) - 1));
+  const auto coord_y =
+      static_cast<uint32_t>(std::clamp(static_cast<int>(patch_coords.y), 0, static_cast<int>(dim.y) - 1));
+
+  patch_coords = eray::math::Vec2f(static_cast<float>(coord_x), static_cast<float>(coord_y));
+
+  // Map to to the patch
+  param = (param - patch_coords * patch_size) / patch_size;
+
+  return std::make_pair(param, eray::math::Vec2u(coord_x, coord_y));
+}
+
+/**
+ * @brief Evaluates a surface built of `dim` bicubic Bezier patches, stored row-major with 16 points per patch.
+ *
+ */
+inline Vec3f bezier3_patches(std::span<const Vec3f> points, eray::math::Vec2u dim, float u, float v) {
+  static constexpr auto kPatchSize = 4U;
+
+  if (points.empty()) {
+    return Vec3f::filled(0.F);
+  }
+
+  auto [param, patch_coords] = bezier3_patches_find(dim, u, v);
+
+  auto pu  = std::array<Vec3f, kPatchSize>();
+  auto idx = kPatchSize * kPatchSize * dim.x * patch_coords.y + kPatchSize * kPatchSize * patch_coords.x;
+  for (auto i = 0U; i < kPatchSize; ++i) {
+    auto curr_row_idx = idx + kPatchSize * i;
+    pu[i] = bezier3(points[curr_row_idx], points[curr_row_idx + 1], points[curr_row_idx + 2], points[curr_row_idx + 3],
+                    param.x);
+  }
+  return bezier3(pu[0], pu[1], pu[2], pu[3], param.y);
+}
+
+/**
+ * @brief Partial derivatives of the surface evaluated with `bezier3_patches`, in the patch parameter space.
+ *
+ */
+inline std::pair<Vec3f, Vec3f> bezier3_patches_derivatives(std::span<const Vec3f> points, eray::math::Vec2u dim,
+                                                           float u, float v) {
+  static constexpr auto kPatchSize = 4U;
+
+  if (points.empty()) {
+    return std::make_pair(Vec3f::filled(0.F), Vec3f::filled(0.F));
+  }
+
+  auto [param, patch_coords] = bezier3_patches_find(dim, u, v);
+
+  auto pu  = std::array<Vec3f, kPatchSize>();
+  auto pv  = std::array<Vec3f, kPatchSize>();
+  auto idx = kPatchSize * kPatchSize * dim.x * patch_coords.y + kPatchSize * kPatchSize * patch_coords.x;
+  for (auto i = 0U; i < kPatchSize; ++i) {
+    auto pu_idx = idx + kPatchSize * i;
+    pu[i]       = bezier3(points[pu_idx], points[pu_idx + 1], points[pu_idx + 2], points[pu_idx + 3], param.x);
+
+    auto pv_idx = idx + i;
+    pv[i]       = bezier3(points[pv_idx], points[pv_idx + kPatchSize], points[pv_idx + 2 * kPatchSize],
+                          points[pv_idx + 3 * kPatchSize], param.y);
+  }
+
+  return std::make_pair(bezier3_dt(pv[0], pv[1], pv[2], pv[3], param.x),
+                        bezier3_dt(pu[0], pu[1], pu[2], pu[3], param.y));
+}
+
 }  // namespace mini
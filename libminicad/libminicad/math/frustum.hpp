@@ -0,0 +1,79 @@
+#pragma once
+
+#include <array>
+#include <liberay/math/mat.hpp>
+#include <liberay/math/vec.hpp>
+#include <limits>
+#include <span>
+#include <utility>
+
+namespace mini {
+
+using AxisAlignedBoundingBox = std::pair<eray::math::Vec3f, eray::math::Vec3f>;
+
+/**
+ * @brief Axis aligned bounding box of the points, an inverted (empty) box is returned for no points.
+ *
+ */
+inline AxisAlignedBoundingBox points_aabb(std::span<const eray::math::Vec3f> points) {
+  static constexpr auto kFltLowest = std::numeric_limits<float>::lowest();
+  static constexpr auto kFltMax    = std::numeric_limits<float>::max();
+
+  auto min = eray::math::Vec3f::filled(kFltMax);
+  auto max = eray::math::Vec3f::filled(kFltLowest);
+  for (const auto& p : points) {
+    min = eray::math::min(p, min);
+    max = eray::math::max(p, max);
+  }
+
+  return std::make_pair(min, max);
+}
+
+/**
+ * @brief View frustum given by 6 planes pointing inside. The planes are extracted from the projection-view matrix
+ * (Gribb-Hartmann), so the test works for both the perspective and the orthographic projection.
+ *
+ */
+class Frustum {
+ public:
+  static Frustum from_matrix(const eray::math::Mat4f& pv_mat) {
+    // The matrix is column major, the row i is (m[0][i], m[1][i], m[2][i], m[3][i])
+    auto row = [&](int i) { return eray::math::Vec4f(pv_mat[0][i], pv_mat[1][i], pv_mat[2][i], pv_mat[3][i]); };
+    auto r0  = row(0);
+    auto r1  = row(1);
+    auto r2  = row(2);
+    auto r3  = row(3);
+
+    return Frustum({r3 + r0, r3 - r0, r3 + r1, r3 - r1, r3 + r2, r3 - r2});
+  }
+
+  /**
+   * @brief Conservative test, returns false only if the box lies entirely outside of one of the planes. Empty boxes
+   * are never visible.
+   *
+   */
+  [[nodiscard]] bool intersects(const AxisAlignedBoundingBox& aabb) const {
+    const auto& [min, max] = aabb;
+    if (min.x > max.x || min.y > max.y || min.z > max.z) {
+      return false;
+    }
+
+    for (const auto& plane : planes_) {
+      // The box corner furthest along the plane normal
+      auto p = eray::math::Vec3f(plane.x >= 0.F ? max.x : min.x, plane.y >= 0.F ? max.y : min.y,
+                                 plane.z >= 0.F ? max.z : min.z);
+      if (plane.x * p.x + plane.y * p.y + plane.z * p.z + plane.w < 0.F) {
+        return false;
+      }
+    }
+
+    return true;
+  }
+
+ private:
+  explicit Frustum(const std::array<eray::math::Vec4f, 6>& planes) : planes_(planes) {}
+
+  std::array<eray::math::Vec4f, 6> planes_;
+};
+
+}  // namespace mini
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <array>
+#include <cmath>
+#include <liberay/math/vec.hpp>
+
+namespace mini {
+
+/**
+ * @brief Oriented bounding box. The axes are unit vectors and the half extents are measured along them.
+ *
+ */
+struct OrientedBoundingBox {
+  eray::math::Vec3f center;
+  std::array<eray::math::Vec3f, 3> axes;
+  eray::math::Vec3f half_extents;
+
+  /**
+   * @brief Radius of the box projection onto the (not necessarily normalized) axis.
+   *
+   */
+  [[nodiscard]] float projected_radius(const eray::math::Vec3f& axis) const {
+    return half_extents.x * std::abs(eray::math::dot(axes[0], axis)) +
+           half_extents.y * std::abs(eray::math::dot(axes[1], axis)) +
+           half_extents.z * std::abs(eray::math::dot(axes[2], axis));
+  }
+};
+
+/**
+ * @brief Separating axis test for two oriented bounding boxes. Tests the 3 + 3 face normals and the 9 edge cross
+ * products.
+ *
+ */
+inline bool obb_intersects(const OrientedBoundingBox& a, const OrientedBoundingBox& b) {
+  static constexpr auto kParallelEpsilon = 1e-6F;
+
+  const auto d = b.center - a.center;
+
+  auto separates = [&](const eray::math::Vec3f& axis) {
+    return std::abs(eray::math::dot(d, axis)) > a.projected_radius(axis) + b.projected_radius(axis);
+  };
+
+  for (const auto& axis : a.axes) {
+    if (separates(axis)) {
+      return false;
+    }
+  }
+  for (const auto& axis : b.axes) {
+    if (separates(axis)) {
+      return false;
+    }
+  }
+  for (const auto& axis_a : a.axes) {
+    for (const auto& axis_b : b.axes) {
+      auto axis = eray::math::cross(axis_a, axis_b);
+      if (eray::math::dot(axis, axis) < kParallelEpsilon) {
+        // Parallel edges, the case is already covered by the face normals
+        continue;
+      }
+      if (separates(axis)) {
+        return false;
+      }
+    }
+  }
+
+  return true;
+}
+
+}  // namespace mini
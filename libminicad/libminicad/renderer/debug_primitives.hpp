@@ -0,0 +1,129 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <liberay/math/vec.hpp>
+#include <span>
+#include <utility>
+#include <vector>
+
+namespace mini {
+
+/**
+ * @brief Plain float triple, the debug arrays are uploaded to the GPU as they are, so the layout must not depend on
+ * the math library vector types.
+ *
+ */
+using DebugVec3 = std::array<float, 3>;
+
+struct DebugBox {
+  DebugVec3 min;
+  DebugVec3 max;
+};
+
+/**
+ * @brief Coordinate frame drawn as 3 segments starting at the origin, the axes are already scaled.
+ *
+ */
+struct DebugFrame {
+  DebugVec3 origin;
+  DebugVec3 x_axis;
+  DebugVec3 y_axis;
+  DebugVec3 z_axis;
+};
+
+/**
+ * @brief CPU side accumulation of the debug primitives. Every kind of primitive is kept in its own contiguous array, so
+ * the renderer uploads each of them at once and draws it with a single instanced call, no matter how many primitives
+ * have been added. The class doesn't touch OpenGL.
+ *
+ */
+class DebugPrimitives {
+ public:
+  enum class Kind : uint8_t {
+    Points = 0,
+    Lines  = 1,
+    Boxes  = 2,
+    Frames = 3,
+  };
+  static constexpr size_t kKindCount = 4;
+
+  void add_point(const eray::math::Vec3f& pos) {
+    points_.push_back(to_debug_vec(pos));
+    mark_dirty(Kind::Points);
+  }
+
+  void add_line(const eray::math::Vec3f& start, const eray::math::Vec3f& end) {
+    lines_.push_back(to_debug_vec(start));
+    lines_.push_back(to_debug_vec(end));
+    mark_dirty(Kind::Lines);
+  }
+
+  void add_box(const eray::math::Vec3f& min, const eray::math::Vec3f& max) {
+    boxes_.push_back(DebugBox{.min = to_debug_vec(min), .max = to_debug_vec(max)});
+    mark_dirty(Kind::Boxes);
+  }
+
+  void add_frame(const eray::math::Vec3f& origin, const eray::math::Vec3f& x_axis, const eray::math::Vec3f& y_axis,
+                 const eray::math::Vec3f& z_axis, float scale = 1.F) {
+    frames_.push_back(DebugFrame{
+        .origin = to_debug_vec(origin),
+        .x_axis = to_debug_vec(scale * x_axis),
+        .y_axis = to_debug_vec(scale * y_axis),
+        .z_axis = to_debug_vec(scale * z_axis),
+    });
+    mark_dirty(Kind::Frames);
+  }
+
+  void clear() {
+    if (!points_.empty()) {
+      mark_dirty(Kind::Points);
+    }
+    if (!lines_.empty()) {
+      mark_dirty(Kind::Lines);
+    }
+    if (!boxes_.empty()) {
+      mark_dirty(Kind::Boxes);
+    }
+    if (!frames_.empty()) {
+      mark_dirty(Kind::Frames);
+    }
+
+    points_.clear();
+    lines_.clear();
+    boxes_.clear();
+    frames_.clear();
+  }
+
+  [[nodiscard]] std::span<const DebugVec3> points() const { return points_; }
+
+  /**
+   * @brief Line segments, two consecutive vertices per segment.
+   *
+   */
+  [[nodiscard]] std::span<const DebugVec3> lines() const { return lines_; }
+  [[nodiscard]] std::span<const DebugBox> boxes() const { return boxes_; }
+  [[nodiscard]] std::span<const DebugFrame> frames() const { return frames_; }
+
+  [[nodiscard]] bool empty() const { return points_.empty() && lines_.empty() && boxes_.empty() && frames_.empty(); }
+
+  /**
+   * @brief Returns true if the primitives of the kind changed since the last `take_dirty` call for the kind and resets
+   * the flag, so the renderer reuploads only the arrays that changed.
+   *
+   */
+  bool take_dirty(Kind kind) { return std::exchange(dirty_[static_cast<size_t>(kind)], false); }
+
+ private:
+  static DebugVec3 to_debug_vec(const eray::math::Vec3f& v) { return DebugVec3{v.x, v.y, v.z}; }
+
+  void mark_dirty(Kind kind) { dirty_[static_cast<size_t>(kind)] = true; }
+
+  std::vector<DebugVec3> points_;
+  std::vector<DebugVec3> lines_;
+  std::vector<DebugBox> boxes_;
+  std::vector<DebugFrame> frames_;
+  std::array<bool, kKindCount> dirty_{};
+};
+
+}  // namespace mini
@@ -1,13 +1,19 @@
 #include <libminicad/renderer/gl/approx_curve_renderer.hpp>
 #include <libminicad/scene/approx_curve.hpp>
+#include <span>
 
 namespace mini::gl {
 
-std::generator<eray::math::Vec3f> ApproxCurveRSCommandHandler::lines_generator(ref<ApproxCurve> curve) {
+size_t ApproxCurveRSCommandHandler::lines_count(ref<ApproxCurve> curve) {
+  auto points_count = curve.get().points().size();
+  return points_count < 2 ? 0 : 2 * (points_count - 1);
+}
+
+void ApproxCurveRSCommandHandler::write_lines(ref<ApproxCurve> curve, std::span<eray::math::Vec3f> out) {
   auto points = curve.get().points();
-  for (auto i = 0U; i < points.size() - 1; ++i) {
-    co_yield points[i];
-    co_yield points[i + 1];
+  for (auto i = 0U; i + 1 < points.size(); ++i) {
+    out[2 * i]     = points[i];
+    out[2 * i + 1] = points[i + 1];
   }
 }
 
@@ -16,7 +22,8 @@ void ApproxCurveRSCommandHandler::operator()(const ApproxCurveRSCommand::Interna
 
   if (auto opt = scene.arena<ApproxCurve>().get_obj(handle)) {
     auto& obj = **opt;
-    renderer.m_.curves.update_chunk(handle, lines_generator(obj), obj.points().size() * 2);
+    renderer.m_.curves.update_chunk(handle, lines_count(obj),
+                                    [&](std::span<eray::math::Vec3f> out) { write_lines(obj, out); });
   }
 }
 
@@ -7,6 +7,7 @@
 #include <libminicad/renderer/rendering_state.hpp>
 #include <libminicad/scene/scene_object.hpp>
 #include <libminicad/scene/handles.hpp>
+#include <span>
 
 namespace mini::gl {
 
@@ -17,7 +18,8 @@ struct ApproxCurveRSCommandHandler {
                                        Scene& _scene)
       : cmd_ctx(_cmd_ctx), renderer(_renderer), scene(_scene) {}
 
-  std::generator<eray::math::Vec3f> lines_generator(ref<ApproxCurve> curve);
+  static size_t lines_count(ref<ApproxCurve> curve);
+  static void write_lines(ref<ApproxCurve> curve, std::span<eray::math::Vec3f> out);
 
   void operator()(const ApproxCurveRSCommand::Internal::AddObject&);
   void operator()(const ApproxCurveRSCommand::Internal::DeleteObject&);
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <algorithm>
+#include <concepts>
 #include <generator>
 #include <liberay/driver/gl/buffer.hpp>
 #include <liberay/driver/gl/gl_handle.hpp>
@@ -8,15 +9,42 @@
 #include <liberay/math/vec.hpp>
 #include <liberay/util/generator.hpp>
 #include <liberay/util/ruleof.hpp>
+#include <libminicad/math/frustum.hpp>
+#include <libminicad/renderer/gl/staging_buffer.hpp>
 #include <libminicad/scene/handles.hpp>
 #include <optional>
 #include <ranges>
+#include <span>
 #include <unordered_map>
 #include <unordered_set>
+#include <utility>
 #include <vector>
 
 namespace mini::gl {
 
+/**
+ * @brief Uploads the pending changes of the staging buffer to the DSA buffer. The storage is reallocated only when the
+ * staging buffer outgrew it, otherwise only the merged dirty ranges are written.
+ *
+ */
+template <typename T>
+void sync_staging_buffer(StagingBuffer<T>& staging, const eray::driver::gl::BufferHandle& dsa_buffer_handle) {
+  staging.sync(
+      [&](size_t capacity, std::span<const T> data) {
+        ERAY_GL_CALL(glNamedBufferData(dsa_buffer_handle.get(), static_cast<GLsizeiptr>(capacity * sizeof(T)), nullptr,
+                                       GL_DYNAMIC_DRAW));
+        if (!data.empty()) {
+          ERAY_GL_CALL(glNamedBufferSubData(dsa_buffer_handle.get(), 0, static_cast<GLsizeiptr>(data.size_bytes()),
+                                            reinterpret_cast<const void*>(data.data())));
+        }
+      },
+      [&](size_t offset, std::span<const T> data) {
+        ERAY_GL_CALL(glNamedBufferSubData(dsa_buffer_handle.get(), static_cast<GLintptr>(offset * sizeof(T)),
+                                          static_cast<GLsizeiptr>(data.size_bytes()),
+                                          reinterpret_cast<const void*>(data.data())));
+      });
+}
+
 struct Chunk {
   size_t begin_idx;  // inclusive
   size_t end_idx;    // non-inclusive
@@ -24,6 +52,45 @@ struct Chunk {
   size_t size() const { return end_idx - begin_idx; }
 };
 
+/**
+ * @brief Element ranges of a single `glMultiDrawArrays` call. The ranges are pushed in the buffer order, so the
+ * neighbouring ones are merged into a single range.
+ *
+ */
+struct MultiDrawRanges {
+  std::vector<GLint> first;
+  std::vector<GLsizei> count;
+
+  void clear() {
+    first.clear();
+    count.clear();
+  }
+
+  void push(size_t first_elem, size_t count_elem) {
+    if (count_elem == 0) {
+      return;
+    }
+
+    if (!first.empty() && static_cast<size_t>(first.back()) + static_cast<size_t>(count.back()) == first_elem) {
+      count.back() += static_cast<GLsizei>(count_elem);
+      return;
+    }
+
+    first.push_back(static_cast<GLint>(first_elem));
+    count.push_back(static_cast<GLsizei>(count_elem));
+  }
+
+  [[nodiscard]] bool empty() const { return first.empty(); }
+
+  void draw(GLenum mode) const {
+    if (first.empty()) {
+      return;
+    }
+
+    ERAY_GL_CALL(glMultiDrawArrays(mode, first.data(), count.data(), static_cast<GLsizei>(first.size())));
+  }
+};
+
 /**
  * @brief Represents a generic contiguous buffer of GPU primitives organized into chunks stored on CPU. Each
  * chunk corresponds to rendered entity. This class is particularily useful for batched rendering. To synchronize
@@ -51,7 +118,8 @@ class ChunksBuffer {
 
   /**
    * @brief Synchronizes CPU and GPU buffers when the CPU buffer is dirty. Call it after
-   * all of the required buffer modifications are applied. DSA buffer is expected.
+   * all of the required buffer modifications are applied. DSA buffer is expected. If only `modify_data` changed the
+   * buffer, just the modified ranges are uploaded.
    *
    */
   void sync(const eray::driver::gl::BufferHandle& dsa_buffer_handle) {
@@ -62,12 +130,45 @@ class ChunksBuffer {
       ERAY_GL_CALL(glNamedBufferData(dsa_buffer_handle.get(),
                                      static_cast<GLsizeiptr>(data_.size() * sizeof(GPUTargetPrimitiveType)),
                                      reinterpret_cast<const void*>(data_.data()), GL_STATIC_DRAW));
+    } else {
+      for (const auto& range : modified_ranges_) {
+        ERAY_GL_CALL(glNamedBufferSubData(dsa_buffer_handle.get(),
+                                          static_cast<GLintptr>(range.begin_idx * sizeof(GPUTargetPrimitiveType)),
+                                          static_cast<GLsizeiptr>(range.size() * sizeof(GPUTargetPrimitiveType)),
+                                          reinterpret_cast<const void*>(data_.data() + range.begin_idx)));
+      }
     }
+    modified_ranges_.clear();
     is_dirty_ = false;
   }
 
   void update_chunk(const ChunkOwnerHandle& owner, const std::vector<CPUSourceType>& data) {
-    update_chunk(owner, std::move(eray::util::container_to_generator(std::ref(data))), data.size());
+    update_chunk(owner, std::span<const CPUSourceType>(data));
+  }
+
+  /**
+   * @brief Replaces the chunk contents with the contiguous block of elements. The chunk is resized once and the
+   * elements are converted in a single tight loop.
+   *
+   */
+  void update_chunk(const ChunkOwnerHandle& owner, std::span<const CPUSourceType> data) {
+    auto* target = resize_chunk(owner, data.size());
+    for (const auto& p : data) {
+      TypeInserter(p, target);
+      target += kGPUTargetPrimitiveCount;
+    }
+  }
+
+  /**
+   * @brief Lets the writer fill exactly `count` elements of a reusable staging buffer and replaces the chunk contents
+   * with them. Use it with the `write_*` methods of the scene objects instead of the generators.
+   *
+   */
+  template <std::invocable<std::span<CPUSourceType>> Writer>
+  void update_chunk(const ChunkOwnerHandle& owner, size_t count, Writer&& writer) {
+    staging_.resize(count);
+    std::forward<Writer>(writer)(std::span<CPUSourceType>(staging_));
+    update_chunk(owner, std::span<const CPUSourceType>(staging_));
   }
 
   void update_chunk(const ChunkOwnerHandle& owner, std::generator<CPUSourceType> data, size_t count) {
@@ -88,8 +189,152 @@ class ChunksBuffer {
     is_dirty_ = true;
   }
 
+  /**
+   * @brief Updates the chunk whose first `valid_prefix` and last `valid_suffix` elements have not changed, only the
+   * elements in between are rewritten. The chunk may change its size only if it's the last one in the buffer. Returns
+   * false if the update is not possible, `update_chunk` should be used then.
+   *
+   */
+  bool update_chunk_range(const ChunkOwnerHandle& owner, std::span<const CPUSourceType> data, size_t valid_prefix,
+                          size_t valid_suffix) {
+    auto it = chunk_range_.find(owner);
+    if (it == chunk_range_.end() || expired_chunks_.contains(owner)) {
+      return false;
+    }
+
+    auto& range    = it->second;
+    auto old_count = range.size() / kGPUTargetPrimitiveCount;
+    if (valid_prefix + valid_suffix > std::min(old_count, data.size())) {
+      return false;
+    }
+
+    if (data.size() != old_count) {
+      if (range.end_idx != data_.size()) {
+        return false;
+      }
+
+      // Shift the unchanged suffix to its new place
+      auto suffix_begin = range.end_idx - valid_suffix * kGPUTargetPrimitiveCount;
+      auto new_end_idx  = range.begin_idx + data.size() * kGPUTargetPrimitiveCount;
+      if (new_end_idx > range.end_idx) {
+        data_.resize(new_end_idx);
+        std::move_backward(data_.begin() + static_cast<std::ptrdiff_t>(suffix_begin),
+                           data_.begin() + static_cast<std::ptrdiff_t>(range.end_idx),
+                           data_.begin() + static_cast<std::ptrdiff_t>(new_end_idx));
+      } else {
+        std::move(data_.begin() + static_cast<std::ptrdiff_t>(suffix_begin),
+                  data_.begin() + static_cast<std::ptrdiff_t>(range.end_idx),
+                  data_.begin() + static_cast<std::ptrdiff_t>(new_end_idx - valid_suffix * kGPUTargetPrimitiveCount));
+        data_.resize(new_end_idx);
+      }
+      range.end_idx = new_end_idx;
+    }
+
+    for (auto i = valid_prefix; i < data.size() - valid_suffix; ++i) {
+      TypeInserter(data[i], &data_[range.begin_idx + i * kGPUTargetPrimitiveCount]);
+    }
+
+    is_dirty_ = true;
+    return true;
+  }
+
+  /**
+   * @brief Overwrites the elements of the chunk starting at the element `offset`, the chunk size does not change.
+   * Returns false if the chunk does not exist or the elements do not fit in the chunk.
+   *
+   */
+  bool update_chunk_subrange(const ChunkOwnerHandle& owner, size_t offset, std::span<const CPUSourceType> data) {
+    auto* target = chunk_subrange(owner, offset, data.size());
+    if (target == nullptr) {
+      return false;
+    }
+
+    for (const auto& p : data) {
+      TypeInserter(p, target);
+      target += kGPUTargetPrimitiveCount;
+    }
+    return true;
+  }
+
+  template <std::invocable<std::span<CPUSourceType>> Writer>
+  bool update_chunk_subrange(const ChunkOwnerHandle& owner, size_t offset, size_t count, Writer&& writer) {
+    staging_.resize(count);
+    std::forward<Writer>(writer)(std::span<CPUSourceType>(staging_));
+    return update_chunk_subrange(owner, offset, std::span<const CPUSourceType>(staging_));
+  }
+
+  /**
+   * @brief Overwrites `count` elements of the chunk starting at the element `offset`, the chunk size does not change.
+   * Returns false if the chunk does not exist or the elements do not fit in the chunk.
+   *
+   */
+  bool update_chunk_subrange(const ChunkOwnerHandle& owner, size_t offset, std::generator<CPUSourceType> data,
+                             size_t count) {
+    auto* target = chunk_subrange(owner, offset, count);
+    if (target == nullptr) {
+      return false;
+    }
+
+    for (const auto& p : data) {
+      TypeInserter(p, target);
+      target += kGPUTargetPrimitiveCount;
+    }
+    return true;
+  }
+
   void delete_chunk(const ChunkOwnerHandle& owner) { expired_chunks_.insert(owner); }
 
+  /**
+   * @brief Sets the world space bounds of the chunk used by `visible_ranges`. The chunks without bounds are never
+   * culled.
+   *
+   */
+  void set_chunk_bounds(const ChunkOwnerHandle& owner, const AxisAlignedBoundingBox& aabb) {
+    bounds_.insert_or_assign(owner, aabb);
+  }
+
+  void set_chunk_bounds(const ChunkOwnerHandle& owner, std::span<const CPUSourceType> points)
+    requires std::convertible_to<CPUSourceType, eray::math::Vec3f>
+  {
+    bounds_.insert_or_assign(owner, points_aabb(points));
+  }
+
+  /**
+   * @brief Fills the draw ranges (in elements) with the chunks intersecting the frustum. Call it after `sync()`, so the
+   * chunk ranges match the GPU buffer.
+   *
+   */
+  void visible_ranges(const Frustum& frustum, MultiDrawRanges& out) const {
+    out.clear();
+    visible_.clear();
+    for (const auto& [owner, chunk] : chunk_range_) {
+      auto it = bounds_.find(owner);
+      if (it == bounds_.end() || frustum.intersects(it->second)) {
+        visible_.push_back(chunk);
+      }
+    }
+
+    std::ranges::sort(visible_, {}, &Chunk::begin_idx);
+    for (const auto& chunk : visible_) {
+      out.push(chunk.begin_idx / kGPUTargetPrimitiveCount, chunk.size() / kGPUTargetPrimitiveCount);
+    }
+  }
+
+  /**
+   * @brief Lets the writer modify the converted data of all of the chunks in place, e.g. to refresh values depending on
+   * the camera. The writer appends the [begin_idx, end_idx) primitive ranges it changed, the next sync uploads only
+   * these ranges unless the whole buffer has to be uploaded anyway.
+   *
+   */
+  template <std::invocable<std::span<GPUTargetPrimitiveType>, std::vector<Chunk>&> Writer>
+  void modify_data(Writer&& writer) {
+    if (data_.empty()) {
+      return;
+    }
+
+    std::forward<Writer>(writer)(std::span<GPUTargetPrimitiveType>(data_), modified_ranges_);
+  }
+
   std::optional<std::pair<ChunkOwnerHandle, size_t>> find_by_idx(size_t idx) const {
     auto primitive_idx = idx * kGPUTargetPrimitiveCount;
     // TODO(migoox): optimize it
@@ -109,6 +354,60 @@ class ChunksBuffer {
  private:
   ChunksBuffer() = default;
 
+  /**
+   * @brief Makes the chunk hold exactly `count` elements and marks the buffer dirty. The chunk is rewritten in place if
+   * its size does not change, otherwise it's moved to the end of the buffer. Returns the first primitive of the chunk.
+   *
+   */
+  GPUTargetPrimitiveType* resize_chunk(const ChunkOwnerHandle& owner, size_t count) {
+    auto new_size = count * kGPUTargetPrimitiveCount;
+    auto it       = chunk_range_.find(owner);
+    if (it != chunk_range_.end() && it->second.size() != new_size) {
+      auto range = it->second;
+      std::move(data_.begin() + static_cast<std::ptrdiff_t>(range.end_idx), data_.end(),
+                data_.begin() + static_cast<std::ptrdiff_t>(range.begin_idx));
+      data_.resize(data_.size() - range.size());
+
+      for (auto& r : chunk_range_ | std::views::values) {
+        if (r.begin_idx > range.begin_idx) {
+          r.begin_idx -= range.size();
+          r.end_idx -= range.size();
+        }
+      }
+      chunk_range_.erase(it);
+      it = chunk_range_.end();
+    }
+
+    if (it == chunk_range_.end()) {
+      auto begin_idx = data_.size();
+      data_.resize(begin_idx + new_size);
+      it = chunk_range_.emplace(owner, Chunk{.begin_idx = begin_idx, .end_idx = begin_idx + new_size}).first;
+    }
+
+    is_dirty_ = true;
+    return data_.data() + it->second.begin_idx;
+  }
+
+  /**
+   * @brief Returns the primitive of the element `offset` of the chunk or nullptr if the chunk does not exist or does
+   * not hold the elements [offset, offset + count).
+   *
+   */
+  GPUTargetPrimitiveType* chunk_subrange(const ChunkOwnerHandle& owner, size_t offset, size_t count) {
+    auto it = chunk_range_.find(owner);
+    if (it == chunk_range_.end() || expired_chunks_.contains(owner)) {
+      return nullptr;
+    }
+
+    const auto& range = it->second;
+    if ((offset + count) * kGPUTargetPrimitiveCount > range.size()) {
+      return nullptr;
+    }
+
+    is_dirty_ = true;
+    return data_.data() + range.begin_idx + offset * kGPUTargetPrimitiveCount;
+  }
+
   void update_chunk_values(const ChunkOwnerHandle& owner, std::generator<CPUSourceType> data, size_t count) {
     auto it = chunk_range_.find(owner);
     if (it == chunk_range_.end()) {
@@ -150,48 +449,52 @@ class ChunksBuffer {
     is_dirty_ = true;
   }
 
+  /**
+   * @brief Removes the expired chunks and moves the remaining ones towards the buffer beginning, keeping their order.
+   *
+   */
   void delete_expired_chunks() {
-    namespace v = std::views;
-    namespace r = std::ranges;
-
     if (expired_chunks_.empty()) {
       return;
     }
 
-    auto point_its = expired_chunks_                                                         //
-                     | v::transform([&](const auto& h) { return chunk_range_.find(h); })     //
-                     | v::filter([&](const auto& it) { return it != chunk_range_.end(); });  //
-
-    auto point_ranges = point_its                                                   //
-                        | v::transform([&](const auto& it) { return it->second; })  //
-                        | r::to<std::vector<Chunk>>();                              //
-
-    r::sort(point_ranges, [](const auto& pr1, const auto& pr2) { return pr1.begin_idx < pr2.begin_idx; });
-    point_ranges.push_back({
-        .begin_idx = data_.size(),
-        .end_idx   = data_.size(),
-    });
-
-    auto point_ranges_pairs   = point_ranges | v::adjacent<2>;
-    auto removed_points_count = 0U;
-    for (const auto& [left, right] : point_ranges_pairs) {
-      for (auto i = left.begin_idx, j = right.begin_idx; j < right.end_idx; ++i, ++j) {
-        data_[i] = data_[j];
-      }
-      removed_points_count += left.size();
+    for (const auto& owner : expired_chunks_) {
+      chunk_range_.erase(owner);
+      bounds_.erase(owner);
     }
-    data_.resize(data_.size() - removed_points_count);
+    expired_chunks_.clear();
 
-    for (auto it : point_its) {
-      chunk_range_.erase(it);
+    auto chunks = std::vector<Chunk*>();
+    chunks.reserve(chunk_range_.size());
+    for (auto& chunk : chunk_range_ | std::views::values) {
+      chunks.push_back(&chunk);
     }
-    expired_chunks_.clear();
+    std::ranges::sort(chunks, {}, [](const Chunk* c) { return c->begin_idx; });
+
+    auto end_idx = size_t{0};
+    for (auto* chunk : chunks) {
+      auto size = chunk->size();
+      if (chunk->begin_idx != end_idx) {
+        std::move(data_.begin() + static_cast<std::ptrdiff_t>(chunk->begin_idx),
+                  data_.begin() + static_cast<std::ptrdiff_t>(chunk->end_idx),
+                  data_.begin() + static_cast<std::ptrdiff_t>(end_idx));
+      }
+      chunk->begin_idx = end_idx;
+      chunk->end_idx   = end_idx + size;
+      end_idx += size;
+    }
+    data_.resize(end_idx);
+    is_dirty_ = true;
   }
 
  private:
   std::vector<GPUTargetPrimitiveType> data_;
   std::unordered_set<ChunkOwnerHandle> expired_chunks_;
   std::unordered_map<ChunkOwnerHandle, Chunk> chunk_range_;
+  std::unordered_map<ChunkOwnerHandle, AxisAlignedBoundingBox> bounds_;
+  std::vector<CPUSourceType> staging_;
+  std::vector<Chunk> modified_ranges_;
+  mutable std::vector<Chunk> visible_;
   bool is_dirty_{};
 };
 
@@ -3,6 +3,7 @@
 #include <liberay/driver/gl/buffer.hpp>
 #include <liberay/driver/gl/vertex_array.hpp>
 #include <liberay/util/variant_match.hpp>
+#include <libminicad/math/frustum.hpp>
 #include <libminicad/renderer/gl/buffer.hpp>
 #include <libminicad/renderer/gl/curves_renderer.hpp>
 #include <libminicad/renderer/rendering_command.hpp>
@@ -11,12 +12,25 @@
 #include <libminicad/scene/scene.hpp>
 #include <libminicad/scene/scene_object.hpp>
 #include <libminicad/scene/handles.hpp>
+#include <span>
 #include <variant>
 
 namespace mini::gl {
 
 namespace util = eray::util;
 
+void CurveRSCommandHandler::update_polyline(const Curve& obj) {
+  renderer.m_.polylines.update_chunk(obj.handle(), obj.polyline_points_count(), [&](std::span<eray::math::Vec3f> out) {
+    obj.write_polyline_points(out);
+    renderer.m_.polylines.set_chunk_bounds(obj.handle(), out);
+  });
+}
+
+void CurveRSCommandHandler::update_curve(Curve& obj) {
+  renderer.m_.curves.update_chunk(obj.handle(), obj.bezier3_points());
+  renderer.m_.curves.set_chunk_bounds(obj.handle(), obj.bezier3_points());
+}
+
 void CurveRSCommandHandler::operator()(const CurveRSCommand::Internal::AddObject&) {
   const auto& handle = cmd_ctx.handle;
 
@@ -25,8 +39,8 @@ void CurveRSCommandHandler::operator()(const CurveRSCommand::Internal::AddObject
   if (auto o = scene.arena<Curve>().get_obj(handle)) {
     auto& obj = *o.value();
 
-    renderer.m_.curves.update_chunk(handle, obj.bezier3_points());
-    renderer.m_.polylines.update_chunk(handle, obj.polyline_points(), obj.polyline_points_count());
+    update_curve(obj);
+    update_polyline(obj);
   }
 }
 
@@ -43,9 +57,44 @@ void CurveRSCommandHandler::operator()(const CurveRSCommand::Internal::UpdateCon
   if (auto o = scene.arena<Curve>().get_obj(handle)) {
     auto& obj = *o.value();
 
-    renderer.m_.curves.update_chunk(handle, obj.bezier3_points());
+    update_curve(obj);
     if (renderer.rs_.at(handle).show_polyline) {
-      renderer.m_.polylines.update_chunk(handle, obj.polyline_points(), obj.polyline_points_count());
+      update_polyline(obj);
+    }
+  } else {
+    renderer.push_cmd(CurveRSCommand(handle, CurveRSCommand::Internal::DeleteObject{}));
+  }
+}
+
+void CurveRSCommandHandler::operator()(const CurveRSCommand::Internal::UpdateSegments&) {
+  const auto& handle = cmd_ctx.handle;
+  if (auto o = scene.arena<Curve>().get_obj(handle)) {
+    auto& obj = *o.value();
+
+    // The curves buffer stores 4 points per segment, the helper points buffer stores the bernstein points, 3 per
+    // segment plus the last one
+    auto [valid_prefix, valid_suffix] = obj.take_unchanged_bezier3_segments();
+    const auto& bezier3_points        = obj.bezier3_points();
+    if (!renderer.m_.curves.update_chunk_range(handle, bezier3_points, 4 * valid_prefix, 4 * valid_suffix)) {
+      renderer.m_.curves.update_chunk(handle, bezier3_points);
+    }
+    renderer.m_.curves.set_chunk_bounds(handle, bezier3_points);
+
+    std::visit(eray::util::match{
+                   [&](const BSplineCurve& curve) {
+                     const auto& bernstein_points = curve.bernstein_points();
+                     if (!renderer.m_.helper_points.update_chunk_range(handle, bernstein_points, 3 * valid_prefix,
+                                                                       3 * valid_suffix)) {
+                       renderer.m_.helper_points.update_chunk(handle, bernstein_points);
+                     }
+                     renderer.m_.helper_points.set_chunk_bounds(handle, bernstein_points);
+                   },
+                   [](const auto&) {},
+               },
+               obj.object);
+
+    if (renderer.rs_.at(handle).show_polyline) {
+      update_polyline(obj);
     }
   } else {
     renderer.push_cmd(CurveRSCommand(handle, CurveRSCommand::Internal::DeleteObject{}));
@@ -84,7 +133,7 @@ void CurveRSCommandHandler::operator()(const CurveRSCommand::ShowPolyline& cmd)
   } else {
     if (auto o = scene.arena<Curve>().get_obj(handle)) {
       auto& obj = *o.value();
-      renderer.m_.polylines.update_chunk(handle, obj.polyline_points(), obj.polyline_points_count());
+      update_polyline(obj);
     }
   }
 }
@@ -99,14 +148,14 @@ void CurveRSCommandHandler::operator()(const CurveRSCommand::UpdateHelperPoints&
     auto& obj = *o.value();
     std::visit(eray::util::match{
                    [&](const BSplineCurve& curve) {
-                     renderer.m_.helper_points.update_chunk(handle, curve.unique_bezier3_points(obj),
-                                                            curve.unique_bezier3_points_count(obj));
+                     renderer.m_.helper_points.update_chunk(handle, curve.bernstein_points());
+                     renderer.m_.helper_points.set_chunk_bounds(handle, curve.bernstein_points());
                    },
                    [](const auto&) {},
                },
                obj.object);
-    renderer.m_.curves.update_chunk(obj.handle(), obj.bezier3_points());
-    renderer.m_.polylines.update_chunk(obj.handle(), obj.polyline_points(), obj.polyline_points_count());
+    update_curve(obj);
+    update_polyline(obj);
   } else {
     renderer.push_cmd(CurveRSCommand(handle, CurveRSCommand::Internal::DeleteObject{}));
   }
@@ -125,12 +174,15 @@ CurvesRenderer CurvesRenderer::create() {
                                                           eray::driver::gl::ElementBuffer::create());
 
   return CurvesRenderer(Members{
-      .helper_points_vao = std::move(helper_points_vao),
-      .helper_points     = PointsChunksBuffer::create(),
-      .polylines_vao     = std::move(polylines_vao),
-      .polylines         = PointsChunksBuffer::create(),
-      .curves_vao        = std::move(curves_vao),
-      .curves            = PointsChunksBuffer::create(),
+      .helper_points_vao    = std::move(helper_points_vao),
+      .helper_points        = PointsChunksBuffer::create(),
+      .helper_points_ranges = MultiDrawRanges(),
+      .polylines_vao        = std::move(polylines_vao),
+      .polylines            = PointsChunksBuffer::create(),
+      .polylines_ranges     = MultiDrawRanges(),
+      .curves_vao           = std::move(curves_vao),
+      .curves               = PointsChunksBuffer::create(),
+      .curves_ranges        = MultiDrawRanges(),
   });
 }
 
@@ -142,24 +194,30 @@ void CurvesRenderer::update_impl(Scene& /*scene*/) {
   m_.helper_points.sync(m_.helper_points_vao.vbo().handle());
 }
 
+void CurvesRenderer::cull(const Frustum& frustum) {
+  m_.polylines.visible_ranges(frustum, m_.polylines_ranges);
+  m_.curves.visible_ranges(frustum, m_.curves_ranges);
+  m_.helper_points.visible_ranges(frustum, m_.helper_points_ranges);
+}
+
 std::optional<std::pair<CurveHandle, size_t>> CurvesRenderer::find_helper_point_by_idx(size_t idx) const {
   return m_.helper_points.find_by_idx(idx);
 }
 
 void CurvesRenderer::render_polylines() const {
   m_.polylines_vao.bind();
-  ERAY_GL_CALL(glDrawArrays(GL_LINES, 0, static_cast<GLsizei>(m_.polylines.count())));
+  m_.polylines_ranges.draw(GL_LINES);
 }
 
 void CurvesRenderer::render_curves() const {
   ERAY_GL_CALL(glPatchParameteri(GL_PATCH_VERTICES, 4));
   m_.curves_vao.bind();
-  ERAY_GL_CALL(glDrawArrays(GL_PATCHES, 0, static_cast<GLsizei>(m_.curves.count())));
+  m_.curves_ranges.draw(GL_PATCHES);
 }
 
 void CurvesRenderer::render_helper_points() const {
   m_.helper_points_vao.bind();
-  ERAY_GL_CALL(glDrawArrays(GL_POINTS, 0, static_cast<GLsizei>(m_.helper_points.count())));
+  m_.helper_points_ranges.draw(GL_POINTS);
 }
 
 }  // namespace mini::gl
@@ -1,6 +1,7 @@
 #pragma once
 #include <liberay/driver/gl/vertex_array.hpp>
 #include <liberay/util/ruleof.hpp>
+#include <libminicad/math/frustum.hpp>
 #include <libminicad/renderer/gl/buffer.hpp>
 #include <libminicad/renderer/gl/subrenderer.hpp>
 #include <libminicad/renderer/rendering_command.hpp>
@@ -18,12 +19,25 @@ struct CurveRSCommandHandler {
 
   void operator()(const CurveRSCommand::Internal::AddObject&);
   void operator()(const CurveRSCommand::Internal::UpdateControlPoints&);
+  void operator()(const CurveRSCommand::Internal::UpdateSegments&);
   void operator()(const CurveRSCommand::Internal::DeleteObject&);
   void operator()(const CurveRSCommand::UpdateObjectVisibility&);
   void operator()(const CurveRSCommand::ShowPolyline&);
   void operator()(const CurveRSCommand::ShowBernsteinControlPoints&);
   void operator()(const CurveRSCommand::UpdateHelperPoints&);
 
+  /**
+   * @brief Writes the polyline of the curve directly into the staging buffer of the polylines chunk.
+   *
+   */
+  void update_polyline(const Curve& obj);
+
+  /**
+   * @brief Replaces the Bezier points of the curve chunk and updates its bounds.
+   *
+   */
+  void update_curve(Curve& obj);
+
   // NOLINTBEGIN
   const CurveRSCommand& cmd_ctx;
   CurvesRenderer& renderer;
@@ -48,6 +62,12 @@ class CurvesRenderer : public SubRenderer<CurvesRenderer, CurveHandle, CurveRS,
 
   std::optional<std::pair<CurveHandle, size_t>> find_helper_point_by_idx(size_t idx) const;
 
+  /**
+   * @brief Computes the draw ranges of the chunks intersecting the frustum, the render methods draw only these.
+   *
+   */
+  void cull(const Frustum& frustum);
+
   void render_polylines() const;
   void render_curves() const;
   void render_helper_points() const;
@@ -58,12 +78,15 @@ class CurvesRenderer : public SubRenderer<CurvesRenderer, CurveHandle, CurveRS,
   struct Members {
     eray::driver::gl::VertexArray helper_points_vao;
     PointsChunksBuffer helper_points;
+    MultiDrawRanges helper_points_ranges;
 
     eray::driver::gl::VertexArray polylines_vao;
     PointsChunksBuffer polylines;
+    MultiDrawRanges polylines_ranges;
 
     eray::driver::gl::VertexArray curves_vao;
     PointsChunksBuffer curves;
+    MultiDrawRanges curves_ranges;
   } m_;
 
   explicit CurvesRenderer(Members&& m);
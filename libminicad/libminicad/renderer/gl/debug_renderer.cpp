@@ -0,0 +1,159 @@
+#include <glad/gl.h>
+
+#include <array>
+#include <liberay/driver/gl/buffer.hpp>
+#include <liberay/driver/gl/gl_error.hpp>
+#include <liberay/driver/gl/vertex_array.hpp>
+#include <liberay/util/zstring_view.hpp>
+#include <libminicad/renderer/debug_primitives.hpp>
+#include <libminicad/renderer/gl/debug_renderer.hpp>
+#include <span>
+#include <unordered_map>
+
+namespace mini::gl {
+
+namespace {
+
+// 12 edges of the unit cube, the box corners are interpolated between the min and max corner
+constexpr auto kBoxEdgeCorners = std::array<float, 24 * 3>{
+    0, 0, 0, 1, 0, 0,  1, 0, 0, 1, 1, 0,  1, 1, 0, 0, 1, 0,  0, 1, 0, 0, 0, 0,  // bottom
+    0, 0, 1, 1, 0, 1,  1, 0, 1, 1, 1, 1,  1, 1, 1, 0, 1, 1,  0, 1, 1, 0, 0, 1,  // top
+    0, 0, 0, 0, 0, 1,  1, 0, 0, 1, 0, 1,  1, 1, 0, 1, 1, 1,  0, 1, 0, 0, 1, 1,  // sides
+};
+constexpr auto kBoxVertexCount = static_cast<GLsizei>(kBoxEdgeCorners.size() / 3);
+
+// Axis index and the position along the axis of the 3 frame segments
+constexpr auto kFrameAxisVertices = std::array<float, 6 * 2>{
+    0, 0, 0, 1,  //
+    1, 0, 1, 1,  //
+    2, 0, 2, 1,  //
+};
+constexpr auto kFrameVertexCount = static_cast<GLsizei>(kFrameAxisVertices.size() / 2);
+
+eray::driver::gl::VertexArray create_positions_vao() {
+  // The storage is allocated by the first sync
+  auto data = std::array<float, 3>();
+
+  auto vbo_layout = eray::driver::gl::VertexBuffer::Layout();
+  vbo_layout.add_attribute<float>("pos", 0, 3);
+  auto vbo = eray::driver::gl::VertexBuffer::create(std::move(vbo_layout));
+  vbo.buffer_data<float>(data, eray::driver::gl::DataUsage::StaticDraw);
+
+  return eray::driver::gl::VertexArray::create(std::move(vbo), eray::driver::gl::ElementBuffer::create());
+}
+
+template <size_t N>
+eray::driver::gl::VertexArrays create_instanced_vao(const std::array<float, N>& base_vertices,
+                                                    eray::driver::gl::VertexBuffer::Layout&& base_layout,
+                                                    eray::driver::gl::VertexBuffer::Layout&& instances_layout) {
+  auto base_vbo = eray::driver::gl::VertexBuffer::create(std::move(base_layout));
+  base_vbo.buffer_data<float>(base_vertices, eray::driver::gl::DataUsage::StaticDraw);
+
+  // The storage is allocated by the first sync
+  auto data          = std::array<float, 3>();
+  auto instances_vbo = eray::driver::gl::VertexBuffer::create(std::move(instances_layout));
+  instances_vbo.buffer_data<float>(data, eray::driver::gl::DataUsage::StaticDraw);
+
+  auto m = std::unordered_map<zstring_view, eray::driver::gl::VertexBuffer>();
+  m.emplace("base", std::move(base_vbo));
+  m.emplace("instances", std::move(instances_vbo));
+  auto vao = eray::driver::gl::VertexArrays::create(std::move(m), eray::driver::gl::ElementBuffer::create());
+
+  vao.set_binding_divisor("base", 0);
+  vao.set_binding_divisor("instances", 1);
+
+  return vao;
+}
+
+eray::driver::gl::VertexArrays create_boxes_vao() {
+  auto base_layout = eray::driver::gl::VertexBuffer::Layout();
+  base_layout.add_attribute<float>("corner", 0, 3);
+
+  auto instances_layout = eray::driver::gl::VertexBuffer::Layout();
+  instances_layout.add_attribute<float>("min", 1, 3);
+  instances_layout.add_attribute<float>("max", 2, 3);
+
+  return create_instanced_vao(kBoxEdgeCorners, std::move(base_layout), std::move(instances_layout));
+}
+
+eray::driver::gl::VertexArrays create_frames_vao() {
+  auto base_layout = eray::driver::gl::VertexBuffer::Layout();
+  base_layout.add_attribute<float>("axisVertex", 0, 2);
+
+  auto instances_layout = eray::driver::gl::VertexBuffer::Layout();
+  instances_layout.add_attribute<float>("origin", 1, 3);
+  instances_layout.add_attribute<float>("xAxis", 2, 3);
+  instances_layout.add_attribute<float>("yAxis", 3, 3);
+  instances_layout.add_attribute<float>("zAxis", 4, 3);
+
+  return create_instanced_vao(kFrameAxisVertices, std::move(base_layout), std::move(instances_layout));
+}
+
+template <typename T>
+void upload(const eray::driver::gl::BufferHandle& dsa_buffer_handle, std::span<const T> data) {
+  ERAY_GL_CALL(glNamedBufferData(dsa_buffer_handle.get(), static_cast<GLsizeiptr>(data.size_bytes()),
+                                 reinterpret_cast<const void*>(data.data()), GL_DYNAMIC_DRAW));
+}
+
+}  // namespace
+
+DebugRenderer DebugRenderer::create() {
+  static_assert(sizeof(DebugBox) == 6 * sizeof(float), "DebugBox must match the boxes instances VBO layout");
+  static_assert(sizeof(DebugFrame) == 12 * sizeof(float), "DebugFrame must match the frames instances VBO layout");
+
+  return DebugRenderer(Members{
+      .points_vao         = create_positions_vao(),
+      .points_count       = 0,
+      .lines_vao          = create_positions_vao(),
+      .lines_vertex_count = 0,
+      .boxes_vao          = create_boxes_vao(),
+      .boxes_count        = 0,
+      .frames_vao         = create_frames_vao(),
+      .frames_count       = 0,
+  });
+}
+
+DebugRenderer::DebugRenderer(Members&& members) : m_(std::move(members)) {}
+
+void DebugRenderer::sync(DebugPrimitives& primitives) {
+  using Kind = DebugPrimitives::Kind;
+
+  if (primitives.take_dirty(Kind::Points)) {
+    upload(m_.points_vao.vbo().handle(), primitives.points());
+    m_.points_count = primitives.points().size();
+  }
+  if (primitives.take_dirty(Kind::Lines)) {
+    upload(m_.lines_vao.vbo().handle(), primitives.lines());
+    m_.lines_vertex_count = primitives.lines().size();
+  }
+  if (primitives.take_dirty(Kind::Boxes)) {
+    upload(m_.boxes_vao.vbo("instances").handle(), primitives.boxes());
+    m_.boxes_count = primitives.boxes().size();
+  }
+  if (primitives.take_dirty(Kind::Frames)) {
+    upload(m_.frames_vao.vbo("instances").handle(), primitives.frames());
+    m_.frames_count = primitives.frames().size();
+  }
+}
+
+void DebugRenderer::render_points() const {
+  m_.points_vao.bind();
+  ERAY_GL_CALL(glDrawArrays(GL_POINTS, 0, static_cast<GLsizei>(m_.points_count)));
+}
+
+void DebugRenderer::render_lines() const {
+  m_.lines_vao.bind();
+  ERAY_GL_CALL(glDrawArrays(GL_LINES, 0, static_cast<GLsizei>(m_.lines_vertex_count)));
+}
+
+void DebugRenderer::render_boxes() const {
+  m_.boxes_vao.bind();
+  ERAY_GL_CALL(glDrawArraysInstanced(GL_LINES, 0, kBoxVertexCount, static_cast<GLsizei>(m_.boxes_count)));
+}
+
+void DebugRenderer::render_frames() const {
+  m_.frames_vao.bind();
+  ERAY_GL_CALL(glDrawArraysInstanced(GL_LINES, 0, kFrameVertexCount, static_cast<GLsizei>(m_.frames_count)));
+}
+
+}  // namespace mini::gl
@@ -0,0 +1,52 @@
+#pragma once
+#include <liberay/driver/gl/vertex_array.hpp>
+#include <libminicad/renderer/debug_primitives.hpp>
+
+namespace mini::gl {
+
+/**
+ * @brief Draws the debug primitives accumulated in `DebugPrimitives`, one draw call per kind of primitive. The points
+ * are expanded into sprites by the geometry shader, the boxes and the frames are instanced line lists.
+ *
+ */
+class DebugRenderer {
+ public:
+  DebugRenderer() = delete;
+
+  static DebugRenderer create();
+
+  /**
+   * @brief Uploads the arrays of the primitives that changed since the last sync.
+   *
+   */
+  void sync(DebugPrimitives& primitives);
+
+  void render_points() const;
+  void render_lines() const;
+  void render_boxes() const;
+  void render_frames() const;
+
+  [[nodiscard]] bool has_points() const { return m_.points_count > 0; }
+  [[nodiscard]] bool has_lines() const { return m_.lines_vertex_count > 0; }
+  [[nodiscard]] bool has_boxes() const { return m_.boxes_count > 0; }
+  [[nodiscard]] bool has_frames() const { return m_.frames_count > 0; }
+
+ private:
+  struct Members {
+    eray::driver::gl::VertexArray points_vao;
+    size_t points_count;
+
+    eray::driver::gl::VertexArray lines_vao;
+    size_t lines_vertex_count;
+
+    eray::driver::gl::VertexArrays boxes_vao;
+    size_t boxes_count;
+
+    eray::driver::gl::VertexArrays frames_vao;
+    size_t frames_count;
+  } m_;
+
+  explicit DebugRenderer(Members&& m);
+};
+
+}  // namespace mini::gl
@@ -0,0 +1,175 @@
+#pragma once
+
+#include <cstdint>
+#include <generator>
+#include <limits>
+#include <optional>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace mini::gl {
+
+/**
+ * @brief Map from the object handles to values, indexed directly by the object id. The arena ids are dense, so the
+ * lookup is a pair of array accesses instead of hashing. The stored handle is compared with the queried one, so a
+ * handle of a removed object whose id has been reused by the arena (different timestamp or owner) is not found.
+ *
+ * The values are kept in insertion order. Erasing leaves a hole which is skipped during iteration, the holes are
+ * compacted once they outnumber the values. Compaction happens only in `erase` and invalidates the references.
+ *
+ */
+template <typename Handle, typename Value>
+class DenseHandleMap {
+ public:
+  [[nodiscard]] bool contains(const Handle& handle) const { return slot(handle).has_value(); }
+
+  [[nodiscard]] Value* find(const Handle& handle) {
+    auto s = slot(handle);
+    return s ? &dense_[*s]->value : nullptr;
+  }
+
+  [[nodiscard]] const Value* find(const Handle& handle) const {
+    auto s = slot(handle);
+    return s ? &dense_[*s]->value : nullptr;
+  }
+
+  Value& at(const Handle& handle) {
+    if (auto* value = find(handle)) {
+      return *value;
+    }
+    throw std::out_of_range("DenseHandleMap::at: no value for the handle");
+  }
+
+  const Value& at(const Handle& handle) const {
+    if (const auto* value = find(handle)) {
+      return *value;
+    }
+    throw std::out_of_range("DenseHandleMap::at: no value for the handle");
+  }
+
+  /**
+   * @brief Inserts the value if there is no value for the handle yet. A value left by a stale handle with the same
+   * object id is replaced. Returns false if the handle already had a value.
+   *
+   */
+  bool emplace(const Handle& handle, Value value) {
+    if (contains(handle)) {
+      return false;
+    }
+
+    insert(handle, std::move(value));
+    return true;
+  }
+
+  void insert_or_assign(const Handle& handle, Value value) {
+    if (auto* current = find(handle)) {
+      *current = std::move(value);
+      return;
+    }
+
+    insert(handle, std::move(value));
+  }
+
+  bool erase(const Handle& handle) {
+    auto s = slot(handle);
+    if (!s) {
+      return false;
+    }
+
+    dense_[*s].reset();
+    sparse_[handle.obj_id] = kNoSlot;
+    --size_;
+
+    if (dense_.size() - size_ > size_) {
+      compact();
+    }
+    return true;
+  }
+
+  /**
+   * @brief Removes all of the values. Only the used ids are reset, so the cost does not depend on the largest id.
+   *
+   */
+  void clear() {
+    for (const auto& entry : dense_) {
+      if (entry) {
+        sparse_[entry->handle.obj_id] = kNoSlot;
+      }
+    }
+    dense_.clear();
+    size_ = 0;
+  }
+
+  [[nodiscard]] size_t size() const { return size_; }
+  [[nodiscard]] bool empty() const { return size_ == 0; }
+
+  /**
+   * @brief Yields the handles and the values in insertion order.
+   *
+   */
+  std::generator<std::pair<const Handle&, Value&>> items() {
+    for (auto& entry : dense_) {
+      if (entry) {
+        co_yield {entry->handle, entry->value};
+      }
+    }
+  }
+
+ private:
+  static constexpr auto kNoSlot = std::numeric_limits<uint32_t>::max();
+
+  struct Entry {
+    Handle handle;
+    Value value;
+  };
+
+  [[nodiscard]] std::optional<size_t> slot(const Handle& handle) const {
+    if (handle.obj_id >= sparse_.size() || sparse_[handle.obj_id] == kNoSlot) {
+      return std::nullopt;
+    }
+
+    auto s = static_cast<size_t>(sparse_[handle.obj_id]);
+    if (dense_[s]->handle != handle) {
+      return std::nullopt;
+    }
+    return s;
+  }
+
+  void insert(const Handle& handle, Value&& value) {
+    if (handle.obj_id >= sparse_.size()) {
+      sparse_.resize(static_cast<size_t>(handle.obj_id) + 1, kNoSlot);
+    }
+
+    if (sparse_[handle.obj_id] != kNoSlot) {
+      dense_[sparse_[handle.obj_id]].reset();
+      --size_;
+    }
+
+    sparse_[handle.obj_id] = static_cast<uint32_t>(dense_.size());
+    dense_.emplace_back(Entry{.handle = handle, .value = std::move(value)});
+    ++size_;
+  }
+
+  void compact() {
+    auto last = size_t{0};
+    for (auto i = size_t{0}; i < dense_.size(); ++i) {
+      if (!dense_[i]) {
+        continue;
+      }
+
+      sparse_[dense_[i]->handle.obj_id] = static_cast<uint32_t>(last);
+      if (i != last) {
+        dense_[last] = std::move(dense_[i]);
+      }
+      ++last;
+    }
+    dense_.resize(last);
+  }
+
+  std::vector<uint32_t> sparse_;
+  std::vector<std::optional<Entry>> dense_;
+  size_t size_ = 0;
+};
+
+}  // namespace mini::gl
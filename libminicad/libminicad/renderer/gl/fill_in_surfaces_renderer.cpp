@@ -1,18 +1,24 @@
 #include <glad/gl.h>
 
+#include <algorithm>
+#include <libminicad/math/frustum.hpp>
 #include <libminicad/renderer/gl/fill_in_surfaces_renderer.hpp>
 #include <libminicad/scene/fill_in_suface.hpp>
+#include <span>
 
 namespace mini::gl {
 
-std::generator<eray::math::Vec3f> FillInSurfaceRSCommandHandler::rational_bezier_patch_generator(
-    ref<FillInSurface> surface) {
+void FillInSurfaceRSCommandHandler::write_rational_bezier_patches(ref<FillInSurface> surface,
+                                                                  std::span<eray::math::Vec3f> out) {
+  static constexpr auto kPatchPoints = static_cast<std::ptrdiff_t>(FillInSurface::kPatchPointsCount);
+
   const auto& rbp = surface.get().rational_bezier_points();
-  for (auto i = 0U; i < FillInSurface::kNeighbors; ++i) {
-    for (auto j = 0U; j < FillInSurface::kPatchPointsCount; ++j) {
-      co_yield rbp[FillInSurface::kPatchPointsCount * i + j];
-    }
-    co_yield eray::math::Vec3f(static_cast<float>(surface.get().tess_level()), 0.F, 0.F);
+  auto meta       = eray::math::Vec3f(static_cast<float>(surface.get().tess_level()), 0.F, 0.F);
+
+  auto target = out.begin();
+  for (auto i = 0; i < static_cast<int>(FillInSurface::kNeighbors); ++i) {
+    target    = std::ranges::copy_n(rbp.begin() + kPatchPoints * i, kPatchPoints, target).out;
+    *target++ = meta;
   }
 }
 
@@ -20,6 +26,19 @@ size_t FillInSurfaceRSCommandHandler::rational_bezier_patch_count(ref<FillInSurf
   return surface.get().rational_bezier_points().size() + FillInSurface::kNeighbors;
 }
 
+void FillInSurfaceRSCommandHandler::update_chunks(ref<FillInSurface> surface) {
+  const auto& handle = surface.get().handle();
+  renderer.m_.surfaces.update_chunk(
+      handle, rational_bezier_patch_count(surface),
+      [&](std::span<eray::math::Vec3f> out) { write_rational_bezier_patches(surface, out); });
+  renderer.m_.surfaces.set_chunk_bounds(handle, surface.get().rational_bezier_points());
+  renderer.m_.control_grids.update_chunk(handle, surface.get().tangent_grid_points_count(),
+                                         [&](std::span<eray::math::Vec3f> out) {
+                                           surface.get().write_tangent_grid_points(out);
+                                           renderer.m_.control_grids.set_chunk_bounds(handle, out);
+                                         });
+}
+
 void FillInSurfaceRSCommandHandler::operator()(const FillInSurfaceRSCommand::Internal::AddObject&) {
   const auto& handle = cmd_ctx.handle;
 
@@ -27,8 +46,7 @@ void FillInSurfaceRSCommandHandler::operator()(const FillInSurfaceRSCommand::Int
 
   if (auto o = scene.arena<FillInSurface>().get_obj(handle)) {
     auto& obj = *o.value();
-    renderer.m_.surfaces.update_chunk(handle, rational_bezier_patch_generator(obj), rational_bezier_patch_count(obj));
-    renderer.m_.control_grids.update_chunk(handle, obj.tangent_grid_points(), obj.tangent_grid_points_count());
+    update_chunks(obj);
   }
 }
 
@@ -43,8 +61,7 @@ void FillInSurfaceRSCommandHandler::operator()(const FillInSurfaceRSCommand::Int
   const auto& handle = cmd_ctx.handle;
   if (auto o = scene.arena<FillInSurface>().get_obj(handle)) {
     auto& obj = *o.value();
-    renderer.m_.surfaces.update_chunk(handle, rational_bezier_patch_generator(obj), rational_bezier_patch_count(obj));
-    renderer.m_.control_grids.update_chunk(handle, obj.tangent_grid_points(), obj.tangent_grid_points_count());
+    update_chunks(obj);
   } else {
     renderer.push_cmd(FillInSurfaceRSCommand(handle, FillInSurfaceRSCommand::Internal::DeleteObject{}));
   }
@@ -65,10 +82,12 @@ FillInSurfaceRenderer FillInSurfaceRenderer::create() {
       eray::driver::gl::ElementBuffer::create());
 
   return FillInSurfaceRenderer(Members{
-      .surfaces_vao      = std::move(surfaces_vao),
-      .surfaces          = PointsChunksBuffer::create(),
-      .control_grids_vao = std::move(control_grids_vao),
-      .control_grids     = PointsChunksBuffer::create(),
+      .surfaces_vao         = std::move(surfaces_vao),
+      .surfaces             = PointsChunksBuffer::create(),
+      .surfaces_ranges      = MultiDrawRanges(),
+      .control_grids_vao    = std::move(control_grids_vao),
+      .control_grids        = PointsChunksBuffer::create(),
+      .control_grids_ranges = MultiDrawRanges(),
   });
 }
 
@@ -79,15 +98,20 @@ void FillInSurfaceRenderer::update_impl(Scene& /*scene*/) {
   m_.control_grids.sync(m_.control_grids_vao.vbo().handle());
 }
 
+void FillInSurfaceRenderer::cull(const Frustum& frustum) {
+  m_.surfaces.visible_ranges(frustum, m_.surfaces_ranges);
+  m_.control_grids.visible_ranges(frustum, m_.control_grids_ranges);
+}
+
 void FillInSurfaceRenderer::render_control_grids() const {
   m_.control_grids_vao.bind();
-  ERAY_GL_CALL(glDrawArrays(GL_LINES, 0, static_cast<GLsizei>(m_.control_grids.count())));
+  m_.control_grids_ranges.draw(GL_LINES);
 }
 
 void FillInSurfaceRenderer::render_fill_in_surfaces() const {
   ERAY_GL_CALL(glPatchParameteri(GL_PATCH_VERTICES, 21));
   m_.surfaces_vao.bind();
-  ERAY_GL_CALL(glDrawArrays(GL_PATCHES, 0, static_cast<GLsizei>(m_.surfaces.count())));
+  m_.surfaces_ranges.draw(GL_PATCHES);
 }
 
 }  // namespace mini::gl
@@ -1,12 +1,14 @@
 #pragma once
 #include <liberay/driver/gl/vertex_array.hpp>
 #include <liberay/util/ruleof.hpp>
+#include <libminicad/math/frustum.hpp>
 #include <libminicad/renderer/gl/buffer.hpp>
 #include <libminicad/renderer/gl/subrenderer.hpp>
 #include <libminicad/renderer/rendering_command.hpp>
 #include <libminicad/renderer/rendering_state.hpp>
 #include <libminicad/scene/scene_object.hpp>
 #include <libminicad/scene/handles.hpp>
+#include <span>
 
 namespace mini::gl {
 
@@ -30,8 +32,9 @@ struct FillInSurfaceRSCommandHandler {
   // NOLINTEND
 
  protected:
-  static std::generator<eray::math::Vec3f> rational_bezier_patch_generator(ref<FillInSurface> surface);
+  static void write_rational_bezier_patches(ref<FillInSurface> surface, std::span<eray::math::Vec3f> out);
   static size_t rational_bezier_patch_count(ref<FillInSurface> surface);
+  void update_chunks(ref<FillInSurface> surface);
 };
 
 class FillInSurfaceRenderer : public SubRenderer<FillInSurfaceRenderer, FillInSurfaceHandle, FillInSurfaceRS,
@@ -53,6 +56,12 @@ class FillInSurfaceRenderer : public SubRenderer<FillInSurfaceRenderer, FillInSu
 
   void update_impl(Scene& scene);
 
+  /**
+   * @brief Computes the draw ranges of the surfaces intersecting the frustum, the render methods draw only these.
+   *
+   */
+  void cull(const Frustum& frustum);
+
   void render_control_grids() const;
   void render_fill_in_surfaces() const;
 
@@ -62,9 +71,11 @@ class FillInSurfaceRenderer : public SubRenderer<FillInSurfaceRenderer, FillInSu
   struct Members {
     eray::driver::gl::VertexArray surfaces_vao;
     PointsChunksBuffer surfaces;
+    MultiDrawRanges surfaces_ranges;
 
     eray::driver::gl::VertexArray control_grids_vao;
     PointsChunksBuffer control_grids;
+    MultiDrawRanges control_grids_ranges;
   } m_;
 
   explicit FillInSurfaceRenderer(Members&& m);
@@ -8,10 +8,11 @@
 #include <liberay/util/logger.hpp>
 #include <liberay/util/try.hpp>
 #include <liberay/util/variant_match.hpp>
+#include <libminicad/math/frustum.hpp>
 #include <libminicad/renderer/gl/approx_curve_renderer.hpp>
 #include <libminicad/renderer/gl/curves_renderer.hpp>
+#include <libminicad/renderer/gl/debug_renderer.hpp>
 #include <libminicad/renderer/gl/fill_in_surfaces_renderer.hpp>
-#include <libminicad/renderer/gl/line_buffer.hpp>
 #include <libminicad/renderer/gl/opengl_scene_renderer.hpp>
 #include <libminicad/renderer/gl/param_primitive_renderer.hpp>
 #include <libminicad/renderer/gl/patch_surface_renderer.hpp>
@@ -159,6 +160,18 @@ OpenGLSceneRenderer::create(const std::filesystem::path& assets_path, eray::math
   TRY_UNWRAP_PROGRAM(lines_prog,
                      gl::RenderingShaderProgram::create("lines_shader", std::move(lines_vert), std::move(lines_frag)));
 
+  TRY_UNWRAP_ASSET(debug_boxes_vert, manager.load_shader(shaders_path / "utils" / "debug_box.vert"));
+  TRY_UNWRAP_ASSET(debug_boxes_frag, manager.load_shader(shaders_path / "utils" / "solid_color.frag"));
+  TRY_UNWRAP_PROGRAM(debug_boxes_prog,
+                     gl::RenderingShaderProgram::create("debug_boxes_shader", std::move(debug_boxes_vert),
+                                                        std::move(debug_boxes_frag)));
+
+  TRY_UNWRAP_ASSET(debug_frames_vert, manager.load_shader(shaders_path / "utils" / "debug_frame.vert"));
+  TRY_UNWRAP_ASSET(debug_frames_frag, manager.load_shader(shaders_path / "utils" / "debug_frame.frag"));
+  TRY_UNWRAP_PROGRAM(debug_frames_prog,
+                     gl::RenderingShaderProgram::create("debug_frames_shader", std::move(debug_frames_vert),
+                                                        std::move(debug_frames_frag)));
+
   auto shaders = Shaders{
       .param                = std::move(param_prog),                      //
       .grid                 = std::move(grid_prog),                       //
@@ -171,13 +184,14 @@ OpenGLSceneRenderer::create(const std::filesystem::path& assets_path, eray::math
       .instanced_sprite     = std::move(instanced_sprite_prog),           //
       .helper_points        = std::move(instanced_no_state_sprite_prog),  //
       .screen_quad          = std::move(screen_quad_prog),                //
-      .anaglyph_merger      = std::move(anaglyph_merger_prog)             //
+      .anaglyph_merger      = std::move(anaglyph_merger_prog),            //
+      .debug_boxes          = std::move(debug_boxes_prog),                //
+      .debug_frames         = std::move(debug_frames_prog)                //
   };
 
   auto global_rs = GlobalRS{
-      .billboards             = {},                   //
-      .debug_points           = {},                   //
-      .debug_lines            = PointsVAO::create(),  //
+      .billboards             = {},  //
+      .debug                  = {},  //
       .textures               = {},
       .point_txt              = create_texture(point_img),         //
       .helper_point_txt       = create_texture(helper_point_img),  //
@@ -197,6 +211,7 @@ OpenGLSceneRenderer::create(const std::filesystem::path& assets_path, eray::math
       .patch_surface_renderer_       = PatchSurfaceRenderer::create(),    //
       .fill_in_surface_renderer_     = FillInSurfaceRenderer::create(),   //
       .intersection_curves_renderer_ = ApproxCurvesRenderer::create(),    //
+      .debug_renderer_               = DebugRenderer::create(),           //
   };
 
   return std::unique_ptr<ISceneRenderer>(
@@ -291,6 +306,17 @@ void OpenGLSceneRenderer::update(Scene& scene) {
   renderers_.param_primitive_renderer_.update(scene);
 }
 
+RSCommandStats OpenGLSceneRenderer::rs_command_stats() const {
+  auto stats = RSCommandStats{};
+  stats += renderers_.point_renderer_.last_cmd_stats();
+  stats += renderers_.curve_renderer_.last_cmd_stats();
+  stats += renderers_.patch_surface_renderer_.last_cmd_stats();
+  stats += renderers_.intersection_curves_renderer_.last_cmd_stats();
+  stats += renderers_.fill_in_surface_renderer_.last_cmd_stats();
+  stats += renderers_.param_primitive_renderer_.last_cmd_stats();
+  return stats;
+}
+
 TextureHandle OpenGLSceneRenderer::upload_texture(const std::vector<uint32_t>& texture, size_t size_x, size_t size_y) {
   GLuint tex_id = 0;
   glGenTextures(1, &tex_id);
@@ -389,18 +415,29 @@ void OpenGLSceneRenderer::clear() {
   clear_debug();
 }
 
-void OpenGLSceneRenderer::debug_point(const eray::math::Vec3f& pos) { global_rs_.debug_points.push_back(pos); }
+void OpenGLSceneRenderer::debug_point(const eray::math::Vec3f& pos) { global_rs_.debug.add_point(pos); }
 
 void OpenGLSceneRenderer::debug_line(const eray::math::Vec3f& start, const eray::math::Vec3f& end) {
-  global_rs_.debug_lines.add(start, end);
+  global_rs_.debug.add_line(start, end);
+}
+
+void OpenGLSceneRenderer::debug_box(const eray::math::Vec3f& min, const eray::math::Vec3f& max) {
+  global_rs_.debug.add_box(min, max);
 }
 
-void OpenGLSceneRenderer::clear_debug() {
-  global_rs_.debug_lines.clear();
-  global_rs_.debug_points.clear();
+void OpenGLSceneRenderer::debug_frame(const eray::math::Vec3f& origin, const eray::math::Vec3f& x_axis,
+                                      const eray::math::Vec3f& y_axis, const eray::math::Vec3f& z_axis, float scale) {
+  global_rs_.debug.add_frame(origin, x_axis, y_axis, z_axis, scale);
 }
 
+void OpenGLSceneRenderer::clear_debug() { global_rs_.debug.clear(); }
+
 void OpenGLSceneRenderer::render(const Camera& camera) {
+  renderers_.debug_renderer_.sync(global_rs_.debug);
+  renderers_.patch_surface_renderer_.update_tessellation(
+      camera.proj_matrix() * camera.view_matrix(),
+      math::Vec2f(static_cast<float>(framebuffer_->width()), static_cast<float>(framebuffer_->height())));
+
   if (!is_anaglyph_rendering_enabled()) {
     render_internal(*framebuffer_, camera, camera.view_matrix(), camera.proj_matrix(),
                     math::Vec3f(0.09F, 0.05F, 0.09F));
@@ -449,6 +486,12 @@ void OpenGLSceneRenderer::render_internal(eray::driver::gl::ViewportFramebuffer&
   fb.bind();
   fb.clear_pick_render();
 
+  // Skip the chunks outside of the view, each eye of the anaglyph mode is culled separately
+  auto frustum = Frustum::from_matrix(proj_mat * view_mat);
+  renderers_.curve_renderer_.cull(frustum);
+  renderers_.patch_surface_renderer_.cull(frustum);
+  renderers_.fill_in_surface_renderer_.cull(frustum);
+
   // Prepare the framebuffer
   ERAY_GL_CALL(glPolygonMode(GL_FRONT_AND_BACK, GL_LINE));
   ERAY_GL_CALL(glEnable(GL_DEPTH_TEST));
@@ -572,27 +615,37 @@ void OpenGLSceneRenderer::render_internal(eray::driver::gl::ViewportFramebuffer&
   shaders_.polyline->set_uniform("u_color", RendererColors::kApproxCurve);
   renderers_.intersection_curves_renderer_.render_curves();
 
-  // Render debug helpers
+  // Render debug helpers, a single draw call per kind of primitive
   ERAY_GL_CALL(glDisable(GL_DEPTH_TEST));
-  shaders_.sprite->bind();
-  for (auto& pos : global_rs_.debug_points) {
+  if (renderers_.debug_renderer_.has_points()) {
+    ERAY_GL_CALL(glActiveTexture(GL_TEXTURE0));
     ERAY_GL_CALL(glBindTexture(GL_TEXTURE_2D, global_rs_.helper_point_txt.get()));
-    shaders_.sprite->set_uniform("u_worldPos", pos);
-    shaders_.sprite->set_uniform("u_pvMat", proj_mat * view_mat);
-    shaders_.sprite->set_uniform("u_aspectRatio", camera.aspect_ratio());
-    shaders_.sprite->set_uniform("u_scale", 0.02F);
-    shaders_.sprite->set_uniform("u_textureSampler", 0);
-    ERAY_GL_CALL(glDrawArrays(GL_TRIANGLES, 0, 6));
+    shaders_.helper_points->set_uniform("u_pvMat", proj_mat * view_mat);
+    shaders_.helper_points->set_uniform("u_scale", 0.02F);
+    shaders_.helper_points->set_uniform("u_aspectRatio", camera.aspect_ratio());
+    shaders_.helper_points->set_uniform("u_textureSampler", 0);
+    shaders_.helper_points->bind();
+    renderers_.debug_renderer_.render_points();
   }
 
-  if (global_rs_.debug_lines.vertex_count() > 0) {
-    ERAY_GL_CALL(glDisable(GL_DEPTH_TEST));
+  if (renderers_.debug_renderer_.has_lines()) {
     shaders_.polyline->bind();
     shaders_.polyline->set_uniform("u_pvMat", proj_mat * view_mat);
     shaders_.polyline->set_uniform("u_color", RendererColors::kDebugLines);
-    global_rs_.debug_lines.sync();
-    global_rs_.debug_lines.bind();
-    ERAY_GL_CALL(glDrawArrays(GL_LINES, 0, global_rs_.debug_lines.vertex_count()));
+    renderers_.debug_renderer_.render_lines();
+  }
+
+  if (renderers_.debug_renderer_.has_boxes()) {
+    shaders_.debug_boxes->bind();
+    shaders_.debug_boxes->set_uniform("u_pvMat", proj_mat * view_mat);
+    shaders_.debug_boxes->set_uniform("u_color", RendererColors::kDebugBoxes);
+    renderers_.debug_renderer_.render_boxes();
+  }
+
+  if (renderers_.debug_renderer_.has_frames()) {
+    shaders_.debug_frames->bind();
+    shaders_.debug_frames->set_uniform("u_pvMat", proj_mat * view_mat);
+    renderers_.debug_renderer_.render_frames();
   }
 
   ERAY_GL_CALL(glBindTexture(GL_TEXTURE_2D, 0));
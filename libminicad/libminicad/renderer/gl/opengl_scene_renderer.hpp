@@ -6,10 +6,11 @@
 #include <liberay/driver/gl/shader_program.hpp>
 #include <liberay/driver/gl/vertex_array.hpp>
 #include <liberay/math/vec_fwd.hpp>
+#include <libminicad/renderer/debug_primitives.hpp>
 #include <libminicad/renderer/gl/approx_curve_renderer.hpp>
 #include <libminicad/renderer/gl/curves_renderer.hpp>
+#include <libminicad/renderer/gl/debug_renderer.hpp>
 #include <libminicad/renderer/gl/fill_in_surfaces_renderer.hpp>
-#include <libminicad/renderer/gl/line_buffer.hpp>
 #include <libminicad/renderer/gl/opengl_scene_renderer.hpp>
 #include <libminicad/renderer/gl/param_primitive_renderer.hpp>
 #include <libminicad/renderer/gl/patch_surface_renderer.hpp>
@@ -73,9 +74,13 @@ class OpenGLSceneRenderer final : public ISceneRenderer {
 
   void debug_point(const eray::math::Vec3f& pos) final;
   void debug_line(const eray::math::Vec3f& start, const eray::math::Vec3f& end) final;
+  void debug_box(const eray::math::Vec3f& min, const eray::math::Vec3f& max) final;
+  void debug_frame(const eray::math::Vec3f& origin, const eray::math::Vec3f& x_axis, const eray::math::Vec3f& y_axis,
+                   const eray::math::Vec3f& z_axis, float scale) final;
   void clear_debug() final;
 
   void update(Scene& scene) final;
+  RSCommandStats rs_command_stats() const final;
   void render(const Camera& camera) final;
   void clear() final;
 
@@ -101,13 +106,14 @@ class OpenGLSceneRenderer final : public ISceneRenderer {
     std::unique_ptr<eray::driver::gl::RenderingShaderProgram> helper_points;
     std::unique_ptr<eray::driver::gl::RenderingShaderProgram> screen_quad;
     std::unique_ptr<eray::driver::gl::RenderingShaderProgram> anaglyph_merger;
+    std::unique_ptr<eray::driver::gl::RenderingShaderProgram> debug_boxes;
+    std::unique_ptr<eray::driver::gl::RenderingShaderProgram> debug_frames;
   } shaders_;
 
   struct GlobalRS {
     std::unordered_map<zstring_view, BillboardRS> billboards;
 
-    std::vector<eray::math::Vec3f> debug_points;
-    PointsVAO debug_lines;
+    DebugPrimitives debug;
 
     std::unordered_map<TextureHandle, std::pair<eray::driver::gl::TextureHandle, Texture>> textures;
 
@@ -132,6 +138,7 @@ class OpenGLSceneRenderer final : public ISceneRenderer {
     PatchSurfaceRenderer patch_surface_renderer_;
     FillInSurfaceRenderer fill_in_surface_renderer_;
     ApproxCurvesRenderer intersection_curves_renderer_;
+    DebugRenderer debug_renderer_;
   } renderers_;
 
   std::unique_ptr<eray::driver::gl::ViewportFramebuffer> framebuffer_;
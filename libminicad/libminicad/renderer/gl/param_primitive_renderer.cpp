@@ -1,5 +1,6 @@
 #include <liberay/util/logger.hpp>
 #include <liberay/util/variant_match.hpp>
+#include <libminicad/renderer/gl/buffer.hpp>
 #include <libminicad/renderer/gl/param_primitive_renderer.hpp>
 #include <libminicad/renderer/gl/rendering_state.hpp>
 #include <libminicad/renderer/gl/trimming_texture_manager.hpp>
@@ -12,7 +13,6 @@
 namespace mini::gl {
 
 namespace util = eray::util;
-namespace math = eray::math;
 
 void ParamPrimitiveRSCommandHandler::operator()(const ParamPrimitiveRSCommand::Internal::AddObject&) {
   if (auto opt = scene.arena<ParamPrimitive>().get_obj(cmd_ctx.handle)) {
@@ -21,8 +21,12 @@ void ParamPrimitiveRSCommandHandler::operator()(const ParamPrimitiveRSCommand::I
     renderer.rs_.emplace(cmd_ctx.handle, ParamPrimitiveRS());
     auto ind = renderer.m_.transferred_torus_buff.size();
     renderer.m_.textures_manager.update(obj);
-    renderer.m_.transferred_torus_ind.insert({cmd_ctx.handle, ind});
+    renderer.m_.transferred_torus_ind.emplace(cmd_ctx.handle, ind);
     renderer.m_.transferred_torus_buff.push_back(cmd_ctx.handle);
+
+    renderer.m_.instances.resize(ind + 1);
+    renderer.m_.instances.write(ind).state = static_cast<int>(ParamPrimitiveRS().visibility);
+    write_instance(obj, ind);
   }
 }
 
@@ -34,14 +38,14 @@ void ParamPrimitiveRSCommandHandler::operator()(const ParamPrimitiveRSCommand::I
     return;
   }
 
-  auto ind = static_cast<GLuint>(renderer.m_.transferred_torus_ind.at(handle));
+  auto ind = renderer.m_.transferred_torus_ind.at(handle);
 
   if (auto opt = scene.arena<ParamPrimitive>().get_obj(handle)) {
     auto& obj = **opt;
 
     auto id = static_cast<int>(renderer.m_.textures_manager.get_id(obj));
     renderer.m_.textures_manager.update(obj);
-    renderer.m_.torus_vao.vbo("matrices").set_attribute_value(ind, "id", &id);
+    renderer.m_.instances.write(ind).id = id;
   }
 }
 
@@ -53,26 +57,8 @@ void ParamPrimitiveRSCommandHandler::operator()(const ParamPrimitiveRSCommand::U
     return;
   }
 
-  auto ind = static_cast<GLuint>(renderer.m_.transferred_torus_ind.at(handle));
-
   if (auto opt = scene.arena<ParamPrimitive>().get_obj(handle)) {
-    auto& obj = **opt;
-
-    auto torus_visitor = [&](const Torus& t) {
-      auto mat  = obj.transform().local_to_world_matrix();
-      auto r    = math::Vec2f(t.minor_radius, t.major_radius);
-      auto tess = t.tess_level;
-      auto id   = static_cast<int>(renderer.m_.textures_manager.get_id(obj));
-      renderer.m_.torus_vao.vbo("matrices").set_attribute_value(ind, "radii", r.raw_ptr());
-      renderer.m_.torus_vao.vbo("matrices").set_attribute_value(ind, "tessLevel", tess.raw_ptr());
-      renderer.m_.torus_vao.vbo("matrices").set_attribute_value(ind, "worldMat", mat[0].raw_ptr());
-      renderer.m_.torus_vao.vbo("matrices").set_attribute_value(ind, "worldMat1", mat[1].raw_ptr());
-      renderer.m_.torus_vao.vbo("matrices").set_attribute_value(ind, "worldMat2", mat[2].raw_ptr());
-      renderer.m_.torus_vao.vbo("matrices").set_attribute_value(ind, "worldMat3", mat[3].raw_ptr());
-      renderer.m_.torus_vao.vbo("matrices").set_attribute_value(ind, "id", &id);
-    };
-
-    std::visit(util::match{torus_visitor}, obj.object);
+    write_instance(**opt, renderer.m_.transferred_torus_ind.at(handle));
   }
 }
 
@@ -87,10 +73,9 @@ void ParamPrimitiveRSCommandHandler::operator()(const ParamPrimitiveRSCommand::U
   auto& obj_rs = renderer.rs_.at(handle);
 
   obj_rs.visibility = cmd.new_visibility_state;
-  auto vs           = static_cast<int>(obj_rs.visibility);
 
-  auto ind = static_cast<GLuint>(renderer.m_.transferred_torus_ind.at(handle));
-  renderer.m_.torus_vao.vbo("matrices").set_attribute_value(ind, "state", &vs);
+  auto ind                               = renderer.m_.transferred_torus_ind.at(handle);
+  renderer.m_.instances.write(ind).state = static_cast<int>(obj_rs.visibility);
 }
 
 void ParamPrimitiveRSCommandHandler::operator()(const ParamPrimitiveRSCommand::Internal::DeleteObject&) {
@@ -100,42 +85,35 @@ void ParamPrimitiveRSCommandHandler::operator()(const ParamPrimitiveRSCommand::I
     return;
   }
 
-  if (renderer.m_.transferred_torus_buff.size() - 1 == renderer.m_.transferred_torus_ind.at(handle)) {
-    renderer.m_.transferred_torus_buff.pop_back();
-    renderer.m_.transferred_torus_ind.erase(handle);
-    return;
+  // The instance data of the last primitive is moved into the place of the removed one
+  auto ind  = renderer.m_.transferred_torus_ind.at(handle);
+  auto last = renderer.m_.instances.swap_remove(ind);
+  if (ind != last) {
+    renderer.m_.transferred_torus_buff[ind] = renderer.m_.transferred_torus_buff[last];
+    renderer.m_.transferred_torus_ind.insert_or_assign(renderer.m_.transferred_torus_buff[ind], ind);
   }
-
-  auto ind = static_cast<GLuint>(renderer.m_.transferred_torus_ind[handle]);
-  renderer.m_.transferred_torus_ind.erase(handle);
-  renderer.m_.transferred_torus_buff[ind] =
-      renderer.m_.transferred_torus_buff[renderer.m_.transferred_torus_buff.size() - 1];
-  renderer.m_.transferred_torus_ind[renderer.m_.transferred_torus_buff[ind]] = ind;
   renderer.m_.transferred_torus_buff.pop_back();
+  renderer.m_.transferred_torus_ind.erase(handle);
   renderer.m_.textures_manager.remove(handle);
+  renderer.rs_.erase(handle);
+}
 
-  if (auto o2 = scene.arena<ParamPrimitive>().get_obj(renderer.m_.transferred_torus_buff[ind])) {
-    auto mat = o2.value()->transform().local_to_world_matrix();
-    std::visit(
-        eray::util::match{
-            [&](const Torus& t) {
-              auto r    = math::Vec2f(t.minor_radius, t.major_radius);
-              auto tess = t.tess_level;
-              renderer.m_.torus_vao.vbo("matrices").set_attribute_value(ind, "radii", r.raw_ptr());
-              renderer.m_.torus_vao.vbo("matrices").set_attribute_value(ind, "tessLevel", tess.raw_ptr());
-            },
-        },
-        o2.value()->object);
-
-    auto id = static_cast<int>(renderer.m_.textures_manager.get_id(*o2.value()));
-    renderer.m_.torus_vao.vbo("matrices").set_attribute_value(ind, "worldMat", mat[0].raw_ptr());
-    renderer.m_.torus_vao.vbo("matrices").set_attribute_value(ind, "worldMat1", mat[1].raw_ptr());
-    renderer.m_.torus_vao.vbo("matrices").set_attribute_value(ind, "worldMat2", mat[2].raw_ptr());
-    renderer.m_.torus_vao.vbo("matrices").set_attribute_value(ind, "worldMat3", mat[3].raw_ptr());
-    renderer.m_.torus_vao.vbo("matrices").set_attribute_value(ind, "id", &id);
-  }
+void ParamPrimitiveRSCommandHandler::write_instance(ParamPrimitive& obj, std::size_t ind) {
+  auto& instance = renderer.m_.instances.write(ind);
 
-  renderer.rs_.erase(handle);
+  auto torus_visitor = [&](const Torus& t) {
+    instance.radii      = {t.minor_radius, t.major_radius};
+    instance.tess_level = {t.tess_level.x, t.tess_level.y};
+  };
+  std::visit(util::match{torus_visitor}, obj.object);
+
+  const auto& mat = obj.world_matrix();
+  for (auto col = 0U; col < 4; ++col) {
+    for (auto row = 0U; row < 4; ++row) {
+      instance.world_mat[col * 4 + row] = mat[col][row];
+    }
+  }
+  instance.id = static_cast<int>(renderer.m_.textures_manager.get_id(obj));
 }
 
 }  // namespace mini::gl
@@ -170,7 +148,8 @@ eray::driver::gl::VertexArrays create_torus_vao(float width = 1.F, float height
   mat_vbo_layout.add_attribute<int>("state", 8, 1);
   auto mat_vbo = eray::driver::gl::VertexBuffer::create(std::move(mat_vbo_layout));
 
-  auto data = std::vector<float>(21 * mini::Scene::kMaxObjects, 0.F);
+  // The storage is allocated by the first sync of the instances staging buffer
+  auto data = std::array<float, 22>();
   mat_vbo.buffer_data(std::span<float>{data}, eray::driver::gl::DataUsage::StaticDraw);
 
   auto ebo = eray::driver::gl::ElementBuffer::create();
@@ -194,6 +173,7 @@ namespace mini::gl {
 ParamPrimitiveRenderer ParamPrimitiveRenderer::create() {
   return ParamPrimitiveRenderer(Members{
       .torus_vao              = create_torus_vao(),                                 //
+      .instances              = {},                                                 //
       .transferred_torus_buff = {},                                                 //
       .transferred_torus_ind  = {},                                                 //
       .textures_manager       = TrimmingTexturesManager<ParamPrimitive>::create(),  //
@@ -202,7 +182,12 @@ ParamPrimitiveRenderer ParamPrimitiveRenderer::create() {
 
 ParamPrimitiveRenderer::ParamPrimitiveRenderer(Members&& members) : m_(std::move(members)) {}
 
-void ParamPrimitiveRenderer::update_impl(Scene& /*scene*/) {}
+void ParamPrimitiveRenderer::update_impl(Scene& /*scene*/) {
+  static_assert(sizeof(PrimitiveInstance) == 22 * sizeof(float),
+                "PrimitiveInstance must match the instances VBO layout");
+
+  sync_staging_buffer(m_.instances, m_.torus_vao.vbo("matrices").handle());
+}
 
 void ParamPrimitiveRenderer::render_parameterized_surfaces() const {
   ERAY_GL_CALL(glActiveTexture(GL_TEXTURE0));
@@ -210,7 +195,7 @@ void ParamPrimitiveRenderer::render_parameterized_surfaces() const {
   ERAY_GL_CALL(glPolygonMode(GL_FRONT_AND_BACK, GL_LINE));
   m_.torus_vao.bind();
   glDrawElementsInstanced(GL_PATCHES, static_cast<GLsizei>(m_.torus_vao.ebo().count()), GL_UNSIGNED_INT, nullptr,
-                          static_cast<GLsizei>(m_.transferred_torus_buff.size()));
+                          static_cast<GLsizei>(m_.instances.size()));
 }
 
 void ParamPrimitiveRenderer::render_parameterized_surfaces_filled() const {
@@ -220,7 +205,7 @@ void ParamPrimitiveRenderer::render_parameterized_surfaces_filled() const {
   ERAY_GL_CALL(glDepthMask(GL_FALSE));
   m_.torus_vao.bind();
   glDrawElementsInstanced(GL_PATCHES, static_cast<GLsizei>(m_.torus_vao.ebo().count()), GL_UNSIGNED_INT, nullptr,
-                          static_cast<GLsizei>(m_.transferred_torus_buff.size()));
+                          static_cast<GLsizei>(m_.instances.size()));
   ERAY_GL_CALL(glDepthMask(GL_TRUE));
 }
 
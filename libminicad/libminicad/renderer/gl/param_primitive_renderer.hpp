@@ -1,6 +1,9 @@
 #pragma once
 
+#include <array>
 #include <liberay/driver/gl/vertex_array.hpp>
+#include <libminicad/renderer/gl/dense_handle_map.hpp>
+#include <libminicad/renderer/gl/staging_buffer.hpp>
 #include <libminicad/renderer/gl/subrenderer.hpp>
 #include <libminicad/renderer/gl/texture_array.hpp>
 #include <libminicad/renderer/gl/trimming_texture_manager.hpp>
@@ -22,6 +25,8 @@ struct ParamPrimitiveRSCommandHandler {
   void operator()(const ParamPrimitiveRSCommand::UpdateObjectVisibility&);
   void operator()(const ParamPrimitiveRSCommand::Internal::DeleteObject&);
 
+  void write_instance(ParamPrimitive& obj, std::size_t ind);
+
   // NOLINTBEGIN
   const ParamPrimitiveRSCommand& cmd_ctx;
   ParamPrimitiveRenderer& renderer;
@@ -42,10 +47,23 @@ class ParamPrimitiveRenderer : public SubRenderer<ParamPrimitiveRenderer, ParamP
  private:
   friend ParamPrimitiveRSCommandHandler;
 
+  /**
+   * @brief Layout of the per instance VBO.
+   *
+   */
+  struct PrimitiveInstance {
+    std::array<float, 2> radii;
+    std::array<int, 2> tess_level;
+    std::array<float, 16> world_mat;
+    int id;
+    int state;
+  };
+
   struct Members {
     eray::driver::gl::VertexArrays torus_vao;
+    StagingBuffer<PrimitiveInstance> instances;
     std::vector<ParamPrimitiveHandle> transferred_torus_buff;
-    std::unordered_map<ParamPrimitiveHandle, std::size_t> transferred_torus_ind;
+    DenseHandleMap<ParamPrimitiveHandle, std::size_t> transferred_torus_ind;
     TrimmingTexturesManager<ParamPrimitive> textures_manager;
   } m_;
 
@@ -1,35 +1,88 @@
 #include <glad/gl.h>
 
+#include <algorithm>
+#include <array>
 #include <liberay/driver/gl/buffer.hpp>
 #include <liberay/driver/gl/vertex_array.hpp>
 #include <liberay/util/variant_match.hpp>
+#include <libminicad/math/frustum.hpp>
 #include <libminicad/renderer/gl/buffer.hpp>
 #include <libminicad/renderer/gl/patch_surface_renderer.hpp>
 #include <libminicad/renderer/gl/texture_array.hpp>
 #include <libminicad/renderer/gl/trimming_texture_manager.hpp>
+#include <libminicad/renderer/patch_tessellation.hpp>
 #include <libminicad/renderer/rendering_command.hpp>
 #include <libminicad/renderer/rendering_state.hpp>
 #include <libminicad/renderer/visibility_state.hpp>
 #include <libminicad/scene/handles.hpp>
 #include <libminicad/scene/scene.hpp>
 #include <libminicad/scene/scene_object.hpp>
+#include <span>
+#include <vector>
 
 namespace mini::gl {
 
-std::generator<eray::math::Vec3f> PatchSurfaceRSCommandHandler::bezier_patch_generator(ref<PatchSurface> surface) {
+namespace {
+
+// Every patch is stored as its 16 Bezier points followed by 2 points of metadata
+constexpr auto kPatchPoints = static_cast<size_t>(PatchSurface::kPatchSize * PatchSurface::kPatchSize);
+constexpr auto kPatchStride = kPatchPoints + 2;
+
+// The tessellation factor is the last coordinate of the second metadata point
+constexpr auto kTessFactorOffset = (kPatchPoints + 1) * 3 + 2;
+
+bool same_camera(const eray::math::Mat4f& a, const eray::math::Mat4f& b) {
+  for (auto col = 0U; col < 4; ++col) {
+    for (auto row = 0U; row < 4; ++row) {
+      if (a[col][row] != b[col][row]) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+}  // namespace
+
+void PatchSurfaceRSCommandHandler::write_bezier_patches(ref<PatchSurface> surface, std::span<eray::math::Vec3f> out,
+                                                        size_t begin_patch, size_t end_patch) {
   const auto& rbp = surface.get().bezier3_points();
 
+  // A non positive factor makes the shader use the full tessellation until the first frame is rendered
+  auto has_camera = renderer.m_.tess_viewport.x > 0.F && renderer.m_.tess_viewport.y > 0.F;
+
   auto tex_id   = static_cast<float>(renderer.m_.textures_manager.get_id(surface.get()));
-  auto patch_id = 0;
-  for (auto i = 0U; i < rbp.size();) {
-    for (auto j = 0U; j < PatchSurface::kPatchSize * PatchSurface::kPatchSize; ++j) {
-      co_yield rbp[i++];
+  auto tess     = static_cast<float>(surface.get().tess_level());
+  auto dim_meta = eray::math::Vec3f(surface.get().dimensions().x, surface.get().dimensions().y, 0.F);
+  end_patch     = std::min(end_patch, rbp.size() / kPatchPoints);
+  for (auto patch_id = begin_patch, i = size_t{0}; patch_id < end_patch; ++patch_id, i += kPatchStride) {
+    auto hull = std::span<const eray::math::Vec3f>(rbp).subspan(patch_id * kPatchPoints, kPatchPoints);
+    std::ranges::copy(hull, out.begin() + static_cast<std::ptrdiff_t>(i));
+    out[i + kPatchPoints]     = eray::math::Vec3f(tess, tex_id, static_cast<float>(patch_id));
+    out[i + kPatchPoints + 1] = dim_meta;
+    if (has_camera) {
+      out[i + kPatchPoints + 1].z = PatchTessellation::factor(hull, renderer.m_.tess_pv_mat, renderer.m_.tess_viewport);
     }
-    co_yield eray::math::Vec3f(static_cast<float>(surface.get().tess_level()), tex_id, patch_id++);
-    co_yield eray::math::Vec3f(surface.get().dimensions().x, surface.get().dimensions().y, 0.F);
   }
 }
 
+void PatchSurfaceRSCommandHandler::update_surface_chunk(ref<PatchSurface> surface) {
+  renderer.m_.surfaces.update_chunk(
+      surface.get().handle(), bezier_patch_count(surface), [&](std::span<eray::math::Vec3f> out) {
+        write_bezier_patches(surface, out, 0, surface.get().dimensions().x * surface.get().dimensions().y);
+      });
+  renderer.m_.surfaces.set_chunk_bounds(surface.get().handle(), surface.get().aabb_bounding_box());
+}
+
+void PatchSurfaceRSCommandHandler::update_control_grid_chunk(ref<PatchSurface> surface) {
+  renderer.m_.control_grids.update_chunk(
+      surface.get().handle(), surface.get().control_grid_points_count(),
+      [&](std::span<eray::math::Vec3f> out) {
+        surface.get().write_control_grid_points(out);
+        renderer.m_.control_grids.set_chunk_bounds(surface.get().handle(), out);
+      });
+}
+
 size_t PatchSurfaceRSCommandHandler::bezier_patch_count(ref<PatchSurface> surface) {
   return surface.get().bezier3_points().size() + surface.get().dimensions().x * surface.get().dimensions().y * 2;
 }
@@ -43,8 +96,8 @@ void PatchSurfaceRSCommandHandler::operator()(const PatchSurfaceRSCommand::Inter
     auto& obj = *o.value();
 
     renderer.m_.textures_manager.update(obj);
-    renderer.m_.surfaces.update_chunk(handle, bezier_patch_generator(obj), bezier_patch_count(obj));
-    renderer.m_.control_grids.update_chunk(handle, obj.control_grid_points(), obj.control_grid_points_count());
+    update_surface_chunk(obj);
+    update_control_grid_chunk(obj);
   }
 }
 
@@ -57,8 +110,8 @@ void PatchSurfaceRSCommandHandler::operator()(const PatchSurfaceRSCommand::Inter
     auto& obj = *o.value();
 
     renderer.m_.textures_manager.update(obj);
-    renderer.m_.surfaces.update_chunk(handle, bezier_patch_generator(obj), bezier_patch_count(obj));
-    renderer.m_.control_grids.update_chunk(handle, obj.control_grid_points(), obj.control_grid_points_count());
+    update_surface_chunk(obj);
+    update_control_grid_chunk(obj);
   }
 }
 
@@ -75,8 +128,33 @@ void PatchSurfaceRSCommandHandler::operator()(const PatchSurfaceRSCommand::Inter
   const auto& handle = cmd_ctx.handle;
   if (auto o = scene.arena<PatchSurface>().get_obj(handle)) {
     auto& obj = *o.value();
-    renderer.m_.surfaces.update_chunk(handle, bezier_patch_generator(obj), bezier_patch_count(obj));
-    renderer.m_.control_grids.update_chunk(handle, obj.control_grid_points(), obj.control_grid_points_count());
+    update_surface_chunk(obj);
+    update_control_grid_chunk(obj);
+  } else {
+    renderer.push_cmd(PatchSurfaceRSCommand(handle, PatchSurfaceRSCommand::Internal::DeleteObject{}));
+  }
+}
+
+void PatchSurfaceRSCommandHandler::operator()(const PatchSurfaceRSCommand::Internal::UpdatePatches&) {
+  const auto& handle = cmd_ctx.handle;
+  if (auto o = scene.arena<PatchSurface>().get_obj(handle)) {
+    auto& obj = *o.value();
+
+    // The patches are stored row by row, so the rows of the dirty rectangle are uploaded as one contiguous range
+    auto range = obj.take_dirty_patch_range();
+    if (!range.empty()) {
+      auto dim         = obj.dimensions();
+      auto begin_patch = static_cast<size_t>(range.begin.y) * dim.x + range.begin.x;
+      auto end_patch   = static_cast<size_t>(range.end.y - 1) * dim.x + range.end.x;
+      if (!renderer.m_.surfaces.update_chunk_subrange(
+              handle, begin_patch * kPatchStride, (end_patch - begin_patch) * kPatchStride,
+              [&](std::span<eray::math::Vec3f> out) { write_bezier_patches(obj, out, begin_patch, end_patch); })) {
+        update_surface_chunk(obj);
+      } else {
+        renderer.m_.surfaces.set_chunk_bounds(handle, obj.aabb_bounding_box());
+      }
+    }
+    update_control_grid_chunk(obj);
   } else {
     renderer.push_cmd(PatchSurfaceRSCommand(handle, PatchSurfaceRSCommand::Internal::DeleteObject{}));
   }
@@ -97,11 +175,15 @@ PatchSurfaceRenderer PatchSurfaceRenderer::create() {
       eray::driver::gl::ElementBuffer::create());
 
   return PatchSurfaceRenderer(Members{
-      .surfaces_vao      = std::move(surfaces_vao),
-      .surfaces          = PointsChunksBuffer::create(),
-      .textures_manager  = TrimmingTexturesManager<PatchSurface>::create(),
-      .control_grids_vao = std::move(control_grids_vao),
-      .control_grids     = PointsChunksBuffer::create(),
+      .surfaces_vao         = std::move(surfaces_vao),
+      .surfaces             = PointsChunksBuffer::create(),
+      .surfaces_ranges      = MultiDrawRanges(),
+      .textures_manager     = TrimmingTexturesManager<PatchSurface>::create(),
+      .control_grids_vao    = std::move(control_grids_vao),
+      .control_grids        = PointsChunksBuffer::create(),
+      .control_grids_ranges = MultiDrawRanges(),
+      .tess_pv_mat          = eray::math::Mat4f::identity(),
+      .tess_viewport        = eray::math::Vec2f(0.F, 0.F),
   });
 }
 
@@ -112,9 +194,47 @@ void PatchSurfaceRenderer::update_impl(Scene& /*scene*/) {
   m_.control_grids.sync(m_.control_grids_vao.vbo().handle());
 }
 
+void PatchSurfaceRenderer::update_tessellation(const eray::math::Mat4f& pv_mat, const eray::math::Vec2f& viewport) {
+  if (viewport.x == m_.tess_viewport.x && viewport.y == m_.tess_viewport.y && same_camera(pv_mat, m_.tess_pv_mat)) {
+    return;
+  }
+  m_.tess_pv_mat   = pv_mat;
+  m_.tess_viewport = viewport;
+
+  m_.surfaces.modify_data([&](std::span<float> data, std::vector<Chunk>& modified) {
+    auto hull = std::array<eray::math::Vec3f, kPatchPoints>();
+    for (auto patch = size_t{0}; (patch + 1) * kPatchStride * 3 <= data.size(); ++patch) {
+      auto* p = &data[patch * kPatchStride * 3];
+      for (auto i = 0U; i < kPatchPoints; ++i) {
+        hull[i] = eray::math::Vec3f(p[3 * i], p[3 * i + 1], p[3 * i + 2]);
+      }
+
+      auto factor = PatchTessellation::factor(hull, pv_mat, viewport);
+      if (p[kTessFactorOffset] == factor) {
+        continue;
+      }
+      p[kTessFactorOffset] = factor;
+
+      // Only the factor is uploaded, the factors of the consecutive patches are uploaded as one range
+      auto idx = patch * kPatchStride * 3 + kTessFactorOffset;
+      if (!modified.empty() && idx - modified.back().end_idx < kPatchStride * 3) {
+        modified.back().end_idx = idx + 1;
+      } else {
+        modified.push_back(Chunk{.begin_idx = idx, .end_idx = idx + 1});
+      }
+    }
+  });
+  m_.surfaces.sync(m_.surfaces_vao.vbo().handle());
+}
+
+void PatchSurfaceRenderer::cull(const Frustum& frustum) {
+  m_.surfaces.visible_ranges(frustum, m_.surfaces_ranges);
+  m_.control_grids.visible_ranges(frustum, m_.control_grids_ranges);
+}
+
 void PatchSurfaceRenderer::render_control_grids() const {
   m_.control_grids_vao.bind();
-  ERAY_GL_CALL(glDrawArrays(GL_LINES, 0, static_cast<GLsizei>(m_.control_grids.count())));
+  m_.control_grids_ranges.draw(GL_LINES);
 }
 
 void PatchSurfaceRenderer::render_surfaces() const {
@@ -122,7 +242,7 @@ void PatchSurfaceRenderer::render_surfaces() const {
   ERAY_GL_CALL(glActiveTexture(GL_TEXTURE0));
   m_.surfaces_vao.bind();
   m_.textures_manager.txt_array().bind();
-  ERAY_GL_CALL(glDrawArrays(GL_PATCHES, 0, static_cast<GLsizei>(m_.surfaces.count())));
+  m_.surfaces_ranges.draw(GL_PATCHES);
 }
 
 }  // namespace mini::gl
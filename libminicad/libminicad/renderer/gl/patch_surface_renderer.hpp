@@ -1,6 +1,7 @@
 #pragma once
 #include <liberay/driver/gl/vertex_array.hpp>
 #include <liberay/util/ruleof.hpp>
+#include <libminicad/math/frustum.hpp>
 #include <libminicad/renderer/gl/buffer.hpp>
 #include <libminicad/renderer/gl/subrenderer.hpp>
 #include <libminicad/renderer/gl/texture_array.hpp>
@@ -9,6 +10,7 @@
 #include <libminicad/renderer/rendering_state.hpp>
 #include <libminicad/scene/handles.hpp>
 #include <libminicad/scene/scene_object.hpp>
+#include <span>
 
 namespace mini::gl {
 
@@ -19,10 +21,19 @@ struct PatchSurfaceRSCommandHandler {
                                         Scene& _scene)
       : cmd_ctx(_cmd_ctx), renderer(_renderer), scene(_scene) {}
 
-  std::generator<eray::math::Vec3f> bezier_patch_generator(ref<PatchSurface>);
+  /**
+   * @brief Writes the patches [begin_patch, end_patch) with their metadata to the output, which must hold
+   * `kPatchSize * kPatchSize + 2` points per patch.
+   *
+   */
+  void write_bezier_patches(ref<PatchSurface>, std::span<eray::math::Vec3f> out, size_t begin_patch,
+                            size_t end_patch);
   size_t bezier_patch_count(ref<PatchSurface>);
+  void update_surface_chunk(ref<PatchSurface>);
+  void update_control_grid_chunk(ref<PatchSurface>);
   void operator()(const PatchSurfaceRSCommand::Internal::AddObject&);
   void operator()(const PatchSurfaceRSCommand::Internal::UpdateControlPoints&);
+  void operator()(const PatchSurfaceRSCommand::Internal::UpdatePatches&);
   void operator()(const PatchSurfaceRSCommand::Internal::DeleteObject&);
   void operator()(const PatchSurfaceRSCommand::Internal::UpdateTrimmingTextures&);
   void operator()(const PatchSurfaceRSCommand::UpdateObjectVisibility&);
@@ -54,19 +65,38 @@ class PatchSurfaceRenderer : public SubRenderer<PatchSurfaceRenderer, PatchSurfa
 
   void update_impl(Scene& scene);
 
+  /**
+   * @brief Computes the draw ranges of the surfaces intersecting the frustum, the render methods draw only these.
+   *
+   */
+  void cull(const Frustum& frustum);
+
   void render_control_grids() const;
   void render_surfaces() const;
 
+  /**
+   * @brief Recomputes the screen space tessellation factors of all of the patches, does nothing if neither the camera
+   * matrix nor the viewport changed since the last call. The patches written in between use the last camera.
+   *
+   */
+  void update_tessellation(const eray::math::Mat4f& pv_mat, const eray::math::Vec2f& viewport);
+
  private:
   friend PatchSurfaceRSCommandHandler;
 
   struct Members {
     eray::driver::gl::VertexArray surfaces_vao;
     PointsChunksBuffer surfaces;
+    MultiDrawRanges surfaces_ranges;
     TrimmingTexturesManager<PatchSurface> textures_manager;
 
     eray::driver::gl::VertexArray control_grids_vao;
     PointsChunksBuffer control_grids;
+    MultiDrawRanges control_grids_ranges;
+
+    // Camera used for the tessellation factors, the viewport is empty until the first frame is rendered
+    eray::math::Mat4f tess_pv_mat;
+    eray::math::Vec2f tess_viewport;
   } m_;
 
   explicit PatchSurfaceRenderer(Members&& m);
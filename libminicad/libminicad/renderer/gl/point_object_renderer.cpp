@@ -1,5 +1,6 @@
 #include <liberay/util/logger.hpp>
 #include <liberay/util/variant_match.hpp>
+#include <libminicad/renderer/gl/buffer.hpp>
 #include <libminicad/renderer/gl/point_object_renderer.hpp>
 #include <libminicad/renderer/gl/rendering_state.hpp>
 #include <libminicad/renderer/rendering_command.hpp>
@@ -15,10 +16,14 @@ void PointObjectRSCommandHandler::operator()(const PointObjectRSCommand::Interna
   if (auto o = scene.arena<PointObject>().get_obj(cmd_ctx.handle)) {
     renderer.rs_.emplace(cmd_ctx.handle, PointObjectRS());
 
-    auto i   = cmd_ctx.handle.obj_id;
-    auto ind = static_cast<GLuint>(renderer.m_.transferred_points_buff.size());
-    renderer.m_.points_vao.ebo().sub_buffer_data(ind, std::span<uint32_t>(&i, 1));
-    renderer.m_.transferred_point_ind.insert({cmd_ctx.handle, ind});
+    auto p      = o.value()->transform().pos();
+    auto& point = renderer.m_.points.write(cmd_ctx.handle.obj_id);
+    point.pos   = {p.x, p.y, p.z};
+    point.state = static_cast<int>(PointObjectRS().visibility);
+
+    auto ind = renderer.m_.transferred_points_buff.size();
+    renderer.m_.indices.push_back(cmd_ctx.handle.obj_id);
+    renderer.m_.transferred_point_ind.emplace(cmd_ctx.handle, ind);
     renderer.m_.transferred_points_buff.push_back(cmd_ctx.handle);
   }
 }
@@ -33,7 +38,8 @@ void PointObjectRSCommandHandler::operator()(const PointObjectRSCommand::UpdateO
 
   if (auto o = scene.arena<PointObject>().get_obj(cmd_ctx.handle)) {
     auto p = o.value()->transform().pos();
-    renderer.m_.points_vao.vbo().set_attribute_value(handle.obj_id, "pos", p.raw_ptr());
+
+    renderer.m_.points.write(handle.obj_id).pos = {p.x, p.y, p.z};
   }
 }
 
@@ -48,8 +54,8 @@ void PointObjectRSCommandHandler::operator()(const PointObjectRSCommand::UpdateO
   auto& obj_rs = renderer.rs_.at(handle);
 
   obj_rs.visibility = cmd.new_visibility_state;
-  auto vs           = static_cast<int>(obj_rs.visibility);
-  renderer.m_.points_vao.vbo().set_attribute_value(handle.obj_id, "state", &vs);
+
+  renderer.m_.points.write(handle.obj_id).state = static_cast<int>(obj_rs.visibility);
 }
 
 void PointObjectRSCommandHandler::operator()(const PointObjectRSCommand::Internal::DeleteObject&) {
@@ -59,29 +65,24 @@ void PointObjectRSCommandHandler::operator()(const PointObjectRSCommand::Interna
     return;
   }
 
-  if (renderer.m_.transferred_points_buff.size() - 1 == renderer.m_.transferred_point_ind.at(handle)) {
-    renderer.m_.transferred_points_buff.pop_back();
-    renderer.m_.transferred_point_ind.erase(handle);
-    return;
+  // The index of the last point is moved into the place of the removed one
+  auto ind  = renderer.m_.transferred_point_ind.at(handle);
+  auto last = renderer.m_.indices.swap_remove(ind);
+  if (ind != last) {
+    renderer.m_.transferred_points_buff[ind] = renderer.m_.transferred_points_buff[last];
+    renderer.m_.transferred_point_ind.insert_or_assign(renderer.m_.transferred_points_buff[ind], ind);
   }
-
-  auto ind = static_cast<GLuint>(renderer.m_.transferred_point_ind.at(handle));
-  renderer.m_.transferred_point_ind.erase(handle);
-  renderer.m_.transferred_points_buff[ind] =
-      renderer.m_.transferred_points_buff[renderer.m_.transferred_points_buff.size() - 1];
-  renderer.m_.transferred_point_ind[renderer.m_.transferred_points_buff[ind]] = ind;
   renderer.m_.transferred_points_buff.pop_back();
-
-  auto i = renderer.m_.transferred_points_buff[ind].obj_id;
-  renderer.m_.points_vao.ebo().sub_buffer_data(ind, std::span<uint32_t>(&i, 1));
+  renderer.m_.transferred_point_ind.erase(handle);
   renderer.rs_.erase(handle);
 }
 
 namespace {
 
 eray::driver::gl::VertexArray create_points_vao() {
-  auto points  = std::array<float, 3 * Scene::kMaxObjects>();
-  auto indices = std::array<uint32_t, Scene::kMaxObjects>();
+  // The storage is allocated by the first sync of the staging buffers
+  auto points  = std::array<float, 4>();
+  auto indices = std::array<uint32_t, 1>();
 
   auto vbo_layout = eray::driver::gl::VertexBuffer::Layout();
   vbo_layout.add_attribute<float>("pos", 0, 3);
@@ -102,6 +103,8 @@ eray::driver::gl::VertexArray create_points_vao() {
 PointObjectRenderer PointObjectRenderer::create() {
   return PointObjectRenderer(Members{
       .points_vao              = create_points_vao(),  //
+      .points                  = {},
+      .indices                 = {},
       .transferred_points_buff = {},
       .transferred_point_ind   = {},
   });
@@ -109,11 +112,16 @@ PointObjectRenderer PointObjectRenderer::create() {
 
 PointObjectRenderer::PointObjectRenderer(Members&& members) : m_(std::move(members)) {}
 
-void PointObjectRenderer::update_impl(Scene& /*scene*/) {}
+void PointObjectRenderer::update_impl(Scene& /*scene*/) {
+  static_assert(sizeof(PointVertex) == 4 * sizeof(float), "PointVertex must match the points VBO layout");
+
+  sync_staging_buffer(m_.points, m_.points_vao.vbo().handle());
+  sync_staging_buffer(m_.indices, m_.points_vao.ebo().handle());
+}
 
 void PointObjectRenderer::render_control_points() const {
   m_.points_vao.bind();
-  ERAY_GL_CALL(glDrawElements(GL_POINTS, m_.transferred_points_buff.size(), GL_UNSIGNED_INT, nullptr));
+  ERAY_GL_CALL(glDrawElements(GL_POINTS, static_cast<GLsizei>(m_.indices.size()), GL_UNSIGNED_INT, nullptr));
 }
 
 }  // namespace mini::gl
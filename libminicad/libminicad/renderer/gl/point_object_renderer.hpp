@@ -1,6 +1,9 @@
 #pragma once
 
+#include <array>
 #include <liberay/driver/gl/vertex_array.hpp>
+#include <libminicad/renderer/gl/dense_handle_map.hpp>
+#include <libminicad/renderer/gl/staging_buffer.hpp>
 #include <libminicad/renderer/gl/subrenderer.hpp>
 #include <libminicad/renderer/rendering_command.hpp>
 #include <libminicad/renderer/rendering_state.hpp>
@@ -38,10 +41,21 @@ class PointObjectRenderer : public SubRenderer<PointObjectRenderer, PointObjectH
  private:
   friend PointObjectRSCommandHandler;
 
+  /**
+   * @brief Layout of the points VBO, the vertices are indexed by the point object id.
+   *
+   */
+  struct PointVertex {
+    std::array<float, 3> pos;
+    int state;
+  };
+
   struct Members {
     eray::driver::gl::VertexArray points_vao;
+    StagingBuffer<PointVertex> points;
+    StagingBuffer<uint32_t> indices;
     std::vector<PointObjectHandle> transferred_points_buff;
-    std::unordered_map<PointObjectHandle, std::size_t> transferred_point_ind;
+    DenseHandleMap<PointObjectHandle, std::size_t> transferred_point_ind;
   } m_;
 
   explicit PointObjectRenderer(Members&& members);
@@ -0,0 +1,193 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <span>
+#include <utility>
+#include <vector>
+
+namespace mini::gl {
+
+struct DirtyRange {
+  size_t begin;  // inclusive
+  size_t end;    // non-inclusive
+
+  size_t size() const { return end - begin; }
+};
+
+/**
+ * @brief CPU copy of a GPU buffer of fixed size elements. The writes mark dirty element ranges which are merged and
+ * handed to the upload callback on `sync()`, so a frame that moves many neighbouring elements ends with a few
+ * contiguous uploads instead of one call per element. The GPU capacity is doubled when the size outgrows it.
+ *
+ * The class doesn't touch OpenGL, the GPU side is provided by the callbacks passed to `sync()`.
+ *
+ * @tparam T trivially copyable element type matching the GPU buffer layout
+ */
+template <typename T>
+class StagingBuffer {
+ public:
+  static constexpr size_t kInitialCapacity = 64;
+
+  /**
+   * @brief Dirty ranges separated by at most this many clean elements are uploaded together.
+   *
+   */
+  static constexpr size_t kMergeGap = 16;
+
+  StagingBuffer() = default;
+  explicit StagingBuffer(size_t initial_capacity) : capacity_(std::max<size_t>(initial_capacity, 1)) {}
+
+  [[nodiscard]] size_t size() const { return data_.size(); }
+  [[nodiscard]] bool empty() const { return data_.empty(); }
+
+  /**
+   * @brief Number of elements the GPU storage has been (or will be on the next sync) allocated for.
+   *
+   */
+  [[nodiscard]] size_t capacity() const { return capacity_; }
+  [[nodiscard]] bool is_dirty() const { return needs_reallocation_ || !dirty_.empty(); }
+
+  [[nodiscard]] std::span<const T> data() const { return data_; }
+  [[nodiscard]] const T& operator[](size_t index) const { return data_[index]; }
+
+  /**
+   * @brief Resizes the buffer, new elements are value initialized and marked dirty.
+   *
+   */
+  void resize(size_t count) {
+    if (count > data_.size()) {
+      mark_dirty(data_.size(), count);
+    }
+    data_.resize(count);
+    reserve(count);
+  }
+
+  /**
+   * @brief Returns the element for writing, the buffer grows if the index is out of range.
+   *
+   */
+  T& write(size_t index) {
+    if (index >= data_.size()) {
+      resize(index + 1);
+    }
+    mark_dirty(index, index + 1);
+    return data_[index];
+  }
+
+  /**
+   * @brief Returns the contiguous block of elements for writing, the buffer grows if the block is out of range.
+   *
+   */
+  std::span<T> write(size_t offset, size_t count) {
+    if (offset + count > data_.size()) {
+      resize(offset + count);
+    }
+    mark_dirty(offset, offset + count);
+    return std::span<T>(data_).subspan(offset, count);
+  }
+
+  void push_back(const T& value) { write(data_.size()) = value; }
+
+  /**
+   * @brief Removes the last element. The GPU copy is left as it is, the element is simply not drawn anymore.
+   *
+   */
+  void pop_back() {
+    data_.pop_back();
+    std::erase_if(dirty_, [this](const DirtyRange& r) { return r.begin >= data_.size(); });
+    for (auto& r : dirty_) {
+      r.end = std::min(r.end, data_.size());
+    }
+  }
+
+  /**
+   * @brief Removes the element by moving the last one into its place. Returns the index the last element has been
+   * moved from, which equals `index` if the removed element was the last one.
+   *
+   */
+  size_t swap_remove(size_t index) {
+    auto last = data_.size() - 1;
+    if (index != last) {
+      write(index) = data_[last];
+    }
+    pop_back();
+    return last;
+  }
+
+  void clear() {
+    data_.clear();
+    dirty_.clear();
+  }
+
+  /**
+   * @brief Hands the pending changes to the GPU side. If the buffer outgrew the GPU storage `reallocate(capacity,
+   * data)` is called once and must allocate `capacity` elements and upload the data. Otherwise `upload(offset, data)`
+   * is called once per merged dirty range.
+   *
+   */
+  template <typename Reallocate, typename Upload>
+  void sync(Reallocate&& reallocate, Upload&& upload) {
+    if (needs_reallocation_) {
+      std::forward<Reallocate>(reallocate)(capacity_, std::span<const T>(data_));
+      needs_reallocation_ = false;
+      dirty_.clear();
+      return;
+    }
+
+    for (const auto& range : merged_dirty_ranges()) {
+      std::forward<Upload>(upload)(range.begin, std::span<const T>(data_).subspan(range.begin, range.size()));
+    }
+    dirty_.clear();
+  }
+
+  /**
+   * @brief Sorts and merges the dirty ranges, the ranges separated by at most `kMergeGap` clean elements are joined.
+   *
+   */
+  std::vector<DirtyRange> merged_dirty_ranges() const {
+    auto ranges = dirty_;
+    std::ranges::sort(ranges, {}, &DirtyRange::begin);
+
+    auto result = std::vector<DirtyRange>();
+    for (const auto& r : ranges) {
+      if (!result.empty() && r.begin <= result.back().end + kMergeGap) {
+        result.back().end = std::max(result.back().end, r.end);
+      } else {
+        result.push_back(r);
+      }
+    }
+
+    return result;
+  }
+
+ private:
+  void reserve(size_t count) {
+    if (count <= capacity_) {
+      return;
+    }
+
+    while (capacity_ < count) {
+      capacity_ *= 2;
+    }
+    needs_reallocation_ = true;
+  }
+
+  void mark_dirty(size_t begin, size_t end) {
+    // Sequential writes extend the last range, so the list stays short in the common case
+    if (!dirty_.empty() && begin <= dirty_.back().end && end >= dirty_.back().begin) {
+      dirty_.back().begin = std::min(dirty_.back().begin, begin);
+      dirty_.back().end   = std::max(dirty_.back().end, end);
+      return;
+    }
+
+    dirty_.push_back(DirtyRange{.begin = begin, .end = end});
+  }
+
+  std::vector<T> data_;
+  std::vector<DirtyRange> dirty_;
+  size_t capacity_         = kInitialCapacity;
+  bool needs_reallocation_ = true;
+};
+
+}  // namespace mini::gl
@@ -1,46 +1,135 @@
 #pragma once
 #include <algorithm>
+#include <array>
+#include <libminicad/renderer/gl/dense_handle_map.hpp>
 #include <libminicad/renderer/rendering_command.hpp>
 #include <libminicad/scene/scene.hpp>
 #include <optional>
-#include <unordered_map>
+#include <utility>
+#include <variant>
 #include <vector>
 
 namespace mini::gl {
 
+/**
+ * @brief Base of the renderers of a single scene object type. The commands are queued into per priority buckets, so the
+ * insertion is O(1) and the commands with the same priority are applied in the order they were pushed. Repeated update
+ * commands of the same kind for the same handle are coalesced into the last one and a delete cancels all the pending
+ * updates of the handle.
+ *
+ * The per object rendering state is kept in a `DenseHandleMap` indexed by the object id.
+ *
+ */
 template <typename SubRendererImpl, typename Handle, typename RenderingState, typename RenderingStateCommand,
           typename RenderingStateCommandHandler>
 class SubRenderer {
  public:
-  void push_cmd(const RenderingStateCommand& cmd) { cmds_.emplace_back(cmd); }
+  void push_cmd(const RenderingStateCommand& cmd) {
+    using AddObject    = typename RenderingStateCommand::Internal::AddObject;
+    using DeleteObject = typename RenderingStateCommand::Internal::DeleteObject;
+
+    ++pushed_count_;
+    if (std::holds_alternative<AddObject>(cmd.variant)) {
+      enqueue(cmd);
+      return;
+    }
+
+    if (std::holds_alternative<DeleteObject>(cmd.variant)) {
+      if (!deleted_.emplace(cmd.handle, std::monostate{})) {
+        return;
+      }
+      cancel_pending_updates(cmd.handle);
+      enqueue(cmd);
+      return;
+    }
+
+    // The object is removed at the end of the update anyway
+    if (deleted_.contains(cmd.handle)) {
+      return;
+    }
+
+    pending_updates_.emplace(cmd.handle, std::vector<PendingSlot>());
+    auto& slots = pending_updates_.at(cmd.handle);
+    auto kind   = cmd.variant.index();
+    if (auto it = std::ranges::find(slots, kind, &PendingSlot::kind); it != slots.end()) {
+      buckets_[it->bucket][it->index] = cmd;
+      return;
+    }
+
+    auto [bucket, index] = enqueue(cmd);
+    slots.push_back(PendingSlot{.kind = kind, .bucket = bucket, .index = index});
+  }
 
   std::optional<RenderingState> object_rs(const Handle& handle) {
-    auto it = rs_.find(handle);
-    if (it == rs_.end()) {
-      return std::nullopt;
+    if (const auto* state = rs_.find(handle)) {
+      return *state;
     }
-    return it->second;
+    return std::nullopt;
   }
 
-  void set_object_rs(const Handle& handle, const RenderingState& state) { rs_[handle] = state; }
+  void set_object_rs(const Handle& handle, const RenderingState& state) { rs_.insert_or_assign(handle, state); }
 
   void update(Scene& scene) {
-    std::ranges::sort(cmds_, [](const auto& x, const auto& y) {
-      return std::visit(kRSCommandPriorityComparer, x.variant, y.variant);
-    });
+    // The handlers are allowed to push commands, these are queued for the next update
+    auto buckets = std::exchange(buckets_, {});
+    stats_       = RSCommandStats{.pushed = std::exchange(pushed_count_, 0), .applied = 0};
+    pending_updates_.clear();
+    deleted_.clear();
+
+    for (const auto& bucket : buckets) {
+      for (const auto& cmd : bucket) {
+        if (!cmd) {
+          continue;
+        }
 
-    for (const auto& cmd : cmds_) {
-      auto handler = RenderingStateCommandHandler(cmd, *static_cast<SubRendererImpl*>(this), scene);
-      std::visit(handler, cmd.variant);
+        auto handler = RenderingStateCommandHandler(*cmd, *static_cast<SubRendererImpl*>(this), scene);
+        std::visit(handler, cmd->variant);
+        ++stats_.applied;
+      }
     }
-    cmds_.clear();
 
     static_cast<SubRendererImpl*>(this)->update_impl(scene);
   }
 
+  /**
+   * @brief Numbers of the commands pushed before the last update and applied by it.
+   *
+   */
+  const RSCommandStats& last_cmd_stats() const { return stats_; }
+
+ private:
+  struct PendingSlot {
+    size_t kind;
+    size_t bucket;
+    size_t index;
+  };
+
+  std::pair<size_t, size_t> enqueue(const RenderingStateCommand& cmd) {
+    auto bucket = std::visit(kRSCommandBucket, cmd.variant);
+    buckets_[bucket].emplace_back(cmd);
+    return {bucket, buckets_[bucket].size() - 1};
+  }
+
+  void cancel_pending_updates(const Handle& handle) {
+    const auto* slots = pending_updates_.find(handle);
+    if (slots == nullptr) {
+      return;
+    }
+
+    for (const auto& slot : *slots) {
+      buckets_[slot.bucket][slot.index].reset();
+    }
+    pending_updates_.erase(handle);
+  }
+
+  std::array<std::vector<std::optional<RenderingStateCommand>>, kRSCommandBucketCount> buckets_;
+  DenseHandleMap<Handle, std::vector<PendingSlot>> pending_updates_;
+  DenseHandleMap<Handle, std::monostate> deleted_;
+  size_t pushed_count_ = 0;
+  RSCommandStats stats_;
+
  protected:
-  std::vector<RenderingStateCommand> cmds_;
-  std::unordered_map<Handle, RenderingState> rs_;
+  DenseHandleMap<Handle, RenderingState> rs_;
 };
 
 }  // namespace mini::gl
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <liberay/math/mat.hpp>
+#include <liberay/math/vec.hpp>
+#include <span>
+
+namespace mini {
+
+/**
+ * @brief Screen space level of detail of the bicubic Bezier patches. The factor scales the tessellation set by the
+ * user on the surface, so it never exceeds the user setting, and it only depends on the patch control hull, the camera
+ * matrix and the viewport size.
+ *
+ */
+struct PatchTessellation {
+  static constexpr size_t kHullSize = 16;
+
+  /**
+   * @brief Longest projected control hull row or column (in pixels) that is drawn with the full user tessellation.
+   *
+   */
+  static constexpr float kFullDetailPixels = 512.F;
+  static constexpr float kMinFactor        = 1.F / 16.F;
+  static constexpr float kMinW             = 1e-4F;
+
+  /**
+   * @brief The factor is rounded up to a multiple of 1 / kFactorSteps, the shader draws at most 64 segments per
+   * isoline, so a finer factor would not change the tessellation. A small camera move leaves most factors unchanged.
+   *
+   */
+  static constexpr float kFactorSteps = 64.F;
+
+  /**
+   * @brief Returns the factor in [kMinFactor, 1] for the 16 control points of a patch stored row by row. Patches
+   * crossing the camera plane get the full detail, the ones entirely behind the camera get the minimal one.
+   *
+   */
+  static float factor(std::span<const eray::math::Vec3f> hull, const eray::math::Mat4f& pv_mat,
+                      const eray::math::Vec2f& viewport) {
+    if (hull.size() < kHullSize) {
+      return 1.F;
+    }
+
+    auto screen = std::array<eray::math::Vec2f, kHullSize>();
+    auto behind = 0U;
+    for (auto i = 0U; i < kHullSize; ++i) {
+      auto p = pv_mat * eray::math::Vec4f(hull[i], 1.F);
+      if (p.w < kMinW) {
+        ++behind;
+        continue;
+      }
+      screen[i] = eray::math::Vec2f(0.5F * viewport.x * (p.x / p.w + 1.F), 0.5F * viewport.y * (p.y / p.w + 1.F));
+    }
+    if (behind == kHullSize) {
+      return kMinFactor;
+    }
+    if (behind > 0) {
+      return 1.F;
+    }
+
+    auto longest = 0.F;
+    for (auto i = 0U; i < 4; ++i) {
+      auto row = 0.F;
+      auto col = 0.F;
+      for (auto j = 0U; j < 3; ++j) {
+        row += eray::math::length(screen[i * 4 + j + 1] - screen[i * 4 + j]);
+        col += eray::math::length(screen[(j + 1) * 4 + i] - screen[j * 4 + i]);
+      }
+      longest = std::max({longest, row, col});
+    }
+
+    return std::clamp(std::ceil(longest / kFullDetailPixels * kFactorSteps) / kFactorSteps, kMinFactor, 1.F);
+  }
+};
+
+}  // namespace mini
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <algorithm>
 #include <libminicad/renderer/visibility_state.hpp>
 #include <libminicad/scene/handles.hpp>
 
@@ -36,6 +37,43 @@ constexpr auto kRSCommandPriorityComparer = [](auto&& arg_x, auto&& arg_y) {
          RSCommandPriority<std::decay_t<decltype(arg_y)>>::kValue;
 };
 
+/**
+ * @brief Number of the command queue buckets, one bucket per generic priority.
+ *
+ */
+constexpr size_t kRSCommandBucketCount = 5;
+
+/**
+ * @brief Maps the command priority to the command queue bucket. The buckets are processed in the increasing index
+ * order, so the commands with the highest priority land in the first one.
+ *
+ */
+constexpr size_t rs_command_bucket(int priority) {
+  static constexpr auto kStep = ImmediatePriority::kValue - HighPriority::kValue;
+  auto clamped                = std::clamp(priority, DeferredPriority::kValue, ImmediatePriority::kValue);
+  return static_cast<size_t>((ImmediatePriority::kValue - clamped + kStep - 1) / kStep);
+}
+
+constexpr auto kRSCommandBucket = [](auto&& arg) {
+  return rs_command_bucket(RSCommandPriority<std::decay_t<decltype(arg)>>::kValue);
+};
+
+/**
+ * @brief Numbers of the rendering state commands pushed to the renderer and applied by it during the last update. The
+ * difference is the number of commands removed by coalescing.
+ *
+ */
+struct RSCommandStats {
+  size_t pushed  = 0;
+  size_t applied = 0;
+
+  RSCommandStats& operator+=(const RSCommandStats& other) {
+    pushed += other.pushed;
+    applied += other.applied;
+    return *this;
+  }
+};
+
 // ---------------------------------------------------------------------------------------------------------------------
 // - SceneObjectRSCommand ----------------------------------------------------------------------------------------------
 // ---------------------------------------------------------------------------------------------------------------------
@@ -123,6 +161,12 @@ struct CurveRSCommand {
     struct AddObject {};
     struct DeleteObject {};
     struct UpdateControlPoints {};
+
+    /**
+     * @brief Uploads only the Bezier segments spliced since the last upload, the range is tracked by the curve.
+     *
+     */
+    struct UpdateSegments {};
   };
 
   struct UpdateObjectVisibility {
@@ -151,8 +195,8 @@ struct CurveRSCommand {
   struct UpdateHelperPoints {};
 
   using CommandVariant =
-      std::variant<Internal::DeleteObject, Internal::AddObject, Internal::UpdateControlPoints, UpdateObjectVisibility,
-                   ShowPolyline, ShowBernsteinControlPoints, UpdateHelperPoints>;
+      std::variant<Internal::DeleteObject, Internal::AddObject, Internal::UpdateControlPoints, Internal::UpdateSegments,
+                   UpdateObjectVisibility, ShowPolyline, ShowBernsteinControlPoints, UpdateHelperPoints>;
 
   explicit CurveRSCommand(CurveHandle _handle, CommandVariant _cmd) : handle(_handle), variant(_cmd) {}
   CurveRSCommand() = delete;
@@ -171,6 +215,11 @@ struct RSCommandPriority<CurveRSCommand::Internal::UpdateControlPoints> {
   static constexpr int kValue = HighPriority::kValue;
 };
 
+template <>
+struct RSCommandPriority<CurveRSCommand::Internal::UpdateSegments> {
+  static constexpr int kValue = HighPriority::kValue;
+};
+
 template <>
 struct RSCommandPriority<CurveRSCommand::UpdateHelperPoints> {
   static constexpr int kValue = MediumPriority::kValue;
@@ -190,6 +239,12 @@ struct PatchSurfaceRSCommand {
     struct AddObject {};
     struct DeleteObject {};
     struct UpdateControlPoints {};
+
+    /**
+     * @brief Uploads only the patches that depend on the moved control points, the range is tracked by the surface.
+     *
+     */
+    struct UpdatePatches {};
     struct UpdateTrimmingTextures {};
   };
 
@@ -208,8 +263,9 @@ struct PatchSurfaceRSCommand {
     bool show;
   };
 
-  using CommandVariant = std::variant<Internal::DeleteObject, Internal::AddObject, Internal::UpdateControlPoints,
-                                      Internal::UpdateTrimmingTextures, UpdateObjectVisibility, ShowPolyline>;
+  using CommandVariant =
+      std::variant<Internal::DeleteObject, Internal::AddObject, Internal::UpdateControlPoints, Internal::UpdatePatches,
+                   Internal::UpdateTrimmingTextures, UpdateObjectVisibility, ShowPolyline>;
 
   explicit PatchSurfaceRSCommand(PatchSurfaceHandle _handle, CommandVariant _cmd) : handle(_handle), variant(_cmd) {}
   PatchSurfaceRSCommand() = delete;
@@ -228,6 +284,11 @@ struct RSCommandPriority<PatchSurfaceRSCommand::Internal::UpdateControlPoints> {
   static constexpr int kValue = HighPriority::kValue;
 };
 
+template <>
+struct RSCommandPriority<PatchSurfaceRSCommand::Internal::UpdatePatches> {
+  static constexpr int kValue = HighPriority::kValue;
+};
+
 template <>
 struct RSCommandPriority<PatchSurfaceRSCommand::Internal::DeleteObject> {
   static constexpr int kValue = DeferredPriority::kValue;
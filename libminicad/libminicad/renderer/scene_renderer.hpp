@@ -26,6 +26,7 @@ struct RendererColors {
   static constexpr auto kPolylinesColor = eray::math::Vec4f(0.843F, 0.894F, 0.949F, 1.F);
   static constexpr auto kVectors        = eray::math::Vec4f(0.62F, 0.867F, 1.F, 1.F);
   static constexpr auto kDebugLines     = eray::math::Vec4f(0.8F, 0.2F, 0.4F, 1.F);
+  static constexpr auto kDebugBoxes     = eray::math::Vec4f(1.F, 0.8F, 0.2F, 1.F);
   static constexpr auto kApproxCurve    = eray::math::Vec4f(0.1F, 0.6F, 1.F, 1.F);
 };
 
@@ -80,12 +81,31 @@ class ISceneRenderer {
 
   virtual void update(Scene& scene) = 0;
 
+  /**
+   * @brief Numbers of the rendering state commands pushed before the last update and applied by it, summed over all
+   * of the object types.
+   *
+   */
+  virtual RSCommandStats rs_command_stats() const = 0;
+
   virtual void render(const Camera& camera) = 0;
 
+  /**
+   * @brief The debug primitives are accumulated until `clear_debug()` and drawn with a single call per kind.
+   *
+   */
   virtual void debug_point(const eray::math::Vec3f& pos)                                = 0;
   virtual void debug_line(const eray::math::Vec3f& start, const eray::math::Vec3f& end) = 0;
+  virtual void debug_box(const eray::math::Vec3f& min, const eray::math::Vec3f& max)    = 0;
   virtual void clear_debug()                                                            = 0;
 
+  /**
+   * @brief Draws the coordinate frame as 3 colored segments, the axes are multiplied by the scale.
+   *
+   */
+  virtual void debug_frame(const eray::math::Vec3f& origin, const eray::math::Vec3f& x_axis,
+                           const eray::math::Vec3f& y_axis, const eray::math::Vec3f& z_axis, float scale) = 0;
+
   virtual void clear() = 0;
 };
 
@@ -1,4 +1,7 @@
+#include <algorithm>
+#include <cmath>
 #include <expected>
+#include <liberay/math/vec.hpp>
 #include <liberay/util/logger.hpp>
 #include <liberay/util/object_handle.hpp>
 #include <liberay/util/variant_match.hpp>
@@ -17,6 +20,13 @@ ApproxCurve::ApproxCurve(ApproxCurveHandle handle, Scene& scene)
 void ApproxCurve::set_points(const std::vector<eray::math::Vec3f>& points, bool is_closed) {
   is_closed_ = is_closed;
   points_    = points;
+
+  chord_lengths_.clear();
+  chord_lengths_.reserve(vertices_count());
+  for (auto i = 0U; i < vertices_count(); ++i) {
+    chord_lengths_.push_back(i == 0 ? 0.F : chord_lengths_.back() + eray::math::distance(vertex(i - 1), vertex(i)));
+  }
+
   scene().renderer().push_object_rs_cmd(ApproxCurveRSCommand(handle_, ApproxCurveRSCommand::Internal::AddObject{}));
 }
 
@@ -34,18 +44,83 @@ void ApproxCurve::on_delete() {
 bool ApproxCurve::can_be_deleted() const { return true; }
 
 std::vector<eray::math::Vec3f> ApproxCurve::get_equidistant_points(size_t count) {
-  auto step = points_.size() / count;
-  auto v    = std::vector<eray::math::Vec3f>();
-  v.reserve(count);
-  for (auto i = 0U; i < points_.size() - step; i += step) {
-    v.push_back(points_.at(i));
+  return resample(chord_lengths_, count);
+}
+
+std::vector<eray::math::Vec3f> ApproxCurve::get_curvature_weighted_points(size_t count, float curvature_weight) {
+  curvature_weight = std::clamp(curvature_weight, 0.F, 1.F);
+
+  const auto n = vertices_count();
+  if (n < 3 || chord_lengths_.back() <= 0.F) {
+    return resample(chord_lengths_, count);
+  }
+
+  // Turning angle at each vertex, the ends of an open curve do not turn
+  auto turning = std::vector<float>(n, 0.F);
+  for (auto i = 0U; i < n; ++i) {
+    if (!is_closed_ && (i == 0 || i == n - 1)) {
+      continue;
+    }
+    auto prev = vertex(i == 0 ? points_.size() - 1 : i - 1);
+    auto next = vertex(i + 1);
+    auto a    = vertex(i) - prev;
+    auto b    = next - vertex(i);
+    auto len  = eray::math::length(a) * eray::math::length(b);
+    if (len > 0.F) {
+      turning[i] = std::acos(std::clamp(eray::math::dot(a, b) / len, -1.F, 1.F));
+    }
+  }
+
+  // Each chord gets half of the turning of both of its ends
+  auto turning_prefix = std::vector<float>(n, 0.F);
+  for (auto i = 1U; i < n; ++i) {
+    turning_prefix[i] = turning_prefix[i - 1] + (turning[i - 1] + turning[i]) / 2.F;
+  }
+
+  const auto total_length  = chord_lengths_.back();
+  const auto total_turning = turning_prefix.back();
+  if (total_turning <= 0.F) {
+    return resample(chord_lengths_, count);
+  }
+
+  auto measure = std::vector<float>(n);
+  for (auto i = 0U; i < n; ++i) {
+    measure[i] = (1.F - curvature_weight) * chord_lengths_[i] / total_length +
+                 curvature_weight * turning_prefix[i] / total_turning;
   }
-  v.push_back(points_.back());
-  if (is_closed_) {
-    v.push_back(points_.front());
+
+  return resample(measure, count);
+}
+
+std::vector<eray::math::Vec3f> ApproxCurve::resample(std::span<const float> measure, size_t count) const {
+  auto result = std::vector<eray::math::Vec3f>();
+  if (count == 0 || points_.empty()) {
+    return result;
+  }
+  result.reserve(count);
+
+  const auto n     = measure.size();
+  const auto total = measure.back();
+  if (n < 2 || total <= 0.F) {
+    result.resize(count, points_.front());
+    return result;
+  }
+
+  // Both the samples and the measure are non-decreasing, so a single walk over the vertices is enough
+  auto step = count > 1 ? total / static_cast<float>(count - 1) : 0.F;
+  auto seg  = size_t{0};
+  for (auto i = 0U; i < count; ++i) {
+    auto target = i + 1 == count ? total : step * static_cast<float>(i);
+    while (seg + 2 < n && measure[seg + 1] < target) {
+      ++seg;
+    }
+
+    auto seg_measure = measure[seg + 1] - measure[seg];
+    auto t           = seg_measure > 0.F ? std::clamp((target - measure[seg]) / seg_measure, 0.F, 1.F) : 0.F;
+    result.push_back(vertex(seg) + (vertex(seg + 1) - vertex(seg)) * t);
   }
 
-  return v;
+  return result;
 }
 
 }  // namespace mini
@@ -3,6 +3,7 @@
 #include <libminicad/renderer/scene_renderer.hpp>
 #include <libminicad/scene/handles.hpp>
 #include <libminicad/scene/scene_object.hpp>
+#include <span>
 #include <variant>
 #include <vector>
 
@@ -26,8 +27,21 @@ class ApproxCurve : public ObjectBase<ApproxCurve, ApproxCurveVariant> {
 
   void set_points(const std::vector<eray::math::Vec3f>& points, bool is_closed = false);
 
+  /**
+   * @brief Resamples the polyline into `count` points equally spaced by the chord length, including both ends. For a
+   * closed curve the last point closes the loop. Runs in O(n + count).
+   *
+   */
   std::vector<eray::math::Vec3f> get_equidistant_points(size_t count);
 
+  /**
+   * @brief Like `get_equidistant_points`, but the samples are distributed according to a blend of the chord length
+   * and the turning angle, so more samples land where the curve bends. The weight 0 gives the chord length spacing,
+   * 1 spaces the samples by the turning angle only.
+   *
+   */
+  std::vector<eray::math::Vec3f> get_curvature_weighted_points(size_t count, float curvature_weight);
+
   const std::vector<eray::math::Vec3f>& points();
 
   void update();
@@ -37,8 +51,24 @@ class ApproxCurve : public ObjectBase<ApproxCurve, ApproxCurveVariant> {
 
   bool is_closed() const { return is_closed_; }
 
+ private:
+  /**
+   * @brief Returns the point at the given position of a non-decreasing per-vertex measure of the polyline.
+   *
+   */
+  std::vector<eray::math::Vec3f> resample(std::span<const float> measure, size_t count) const;
+
+  eray::math::Vec3f vertex(size_t idx) const { return points_[idx % points_.size()]; }
+  size_t vertices_count() const { return points_.empty() ? 0 : points_.size() + (is_closed_ ? 1 : 0); }
+
  private:
   std::vector<eray::math::Vec3f> points_;
+
+  /**
+   * @brief Prefix sums of the chord lengths, the closing chord of a closed curve included.
+   *
+   */
+  std::vector<float> chord_lengths_;
   bool is_closed_;
 };
 
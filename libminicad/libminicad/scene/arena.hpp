@@ -1,5 +1,7 @@
 #pragma once
 
+#include <algorithm>
+#include <bit>
 #include <cstdint>
 #include <expected>
 #include <generator>
@@ -7,12 +9,18 @@
 #include <liberay/util/ruleof.hpp>
 #include <libminicad/scene/fill_in_suface.hpp>
 #include <libminicad/scene/scene_object.hpp>
+#include <memory>
 #include <optional>
 #include <stack>
 #include <vector>
 
 namespace mini {
 
+/**
+ * @brief Owns the scene objects of a single type. The storage grows by doubling, block by block, up to the max number
+ * of objects, so the objects never move in memory and the references stay valid while other objects are created.
+ *
+ */
 template <CObject Object>
 class Arena {
  public:
@@ -24,19 +32,19 @@ class Arena {
   enum class ObjectCreationError : uint8_t { ReachedMaxObjects = 0 };
 
   std::optional<Handle> handle_by_obj_id(std::uint32_t id) const {
-    if (id >= max_objs_) {
+    if (id >= next_obj_id_) {
       return std::nullopt;
     }
 
-    if (!objects_[id]) {
+    if (!slot(id)) {
       return std::nullopt;
     }
 
-    return objects_[id]->first.handle();
+    return slot(id)->first.handle();
   }
 
   [[nodiscard]] ObserverPtr<Object> unsafe_get_obj(const Handle& handle) {
-    return ObserverPtr<Object>(objects_[handle.obj_id]->first);
+    return ObserverPtr<Object>(slot(handle.obj_id)->first);
   }
 
   [[nodiscard]] OptionalObserverPtr<Object> get_obj(const Handle& handle) {
@@ -44,7 +52,7 @@ class Arena {
       return std::nullopt;
     }
 
-    return OptionalObserverPtr<Object>(objects_[handle.obj_id]->first);
+    return OptionalObserverPtr<Object>(slot(handle.obj_id)->first);
   }
 
   [[nodiscard]] OptionalObserverPtr<const Object> get_obj(const Handle& handle) const {
@@ -52,7 +60,7 @@ class Arena {
       return std::nullopt;
     }
 
-    return OptionalObserverPtr<const Object>(objects_[handle.obj_id]->first);
+    return OptionalObserverPtr<const Object>(slot(handle.obj_id)->first);
   }
 
   /**
@@ -62,15 +70,15 @@ class Arena {
    * @return OptionalObserverPtr<Object>
    */
   [[nodiscard]] OptionalObserverPtr<Object> get_obj_by_id(uint32_t obj_id) {
-    if (obj_id >= max_objs_) {
+    if (obj_id >= next_obj_id_) {
       return std::nullopt;
     }
 
-    if (!objects_[obj_id]) {
+    if (!slot(obj_id)) {
       return std::nullopt;
     }
 
-    return OptionalObserverPtr<Object>(objects_[obj_id]->first);
+    return OptionalObserverPtr<Object>(slot(obj_id)->first);
   }
 
   /**
@@ -80,15 +88,15 @@ class Arena {
    * @return OptionalObserverPtr<Object>
    */
   [[nodiscard]] OptionalObserverPtr<const Object> get_obj_by_id(uint32_t obj_id) const {
-    if (obj_id >= max_objs_) {
+    if (obj_id >= next_obj_id_) {
       return std::nullopt;
     }
 
-    if (!objects_[obj_id]) {
+    if (!slot(obj_id)) {
       return std::nullopt;
     }
 
-    return OptionalObserverPtr<const Object>(objects_[obj_id]->first);
+    return OptionalObserverPtr<const Object>(slot(obj_id)->first);
   }
 
   [[nodiscard]] bool exists(const Handle& handle) const {
@@ -96,15 +104,15 @@ class Arena {
       return false;
     }
 
-    if (handle.obj_id > max_objs_) {
+    if (handle.obj_id >= next_obj_id_) {
       return false;
     }
 
-    if (!objects_[handle.obj_id]) {
+    if (!slot(handle.obj_id)) {
       return false;
     }
 
-    if (objects_[handle.obj_id]->first.handle().timestamp != handle.timestamp) {
+    if (slot(handle.obj_id)->first.handle().timestamp != handle.timestamp) {
       return false;
     }
 
@@ -115,17 +123,23 @@ class Arena {
 
   auto objs() const {
     return objects_order_ | std::ranges::views::transform([this](const Handle& handle) -> const Object& {
-             return objects_[handle.obj_id]->first;
+             return slot(handle.obj_id)->first;
            });
   }
 
   auto objs() {
     return objects_order_ | std::ranges::views::transform(
-                                [this](const Handle& handle) -> Object& { return objects_[handle.obj_id]->first; });
+                                [this](const Handle& handle) -> Object& { return slot(handle.obj_id)->first; });
   }
 
   std::uint32_t curr_obj_idx() const { return object_idx_; }
 
+  /**
+   * @brief Number of the object slots allocated so far, never exceeds the max number of objects.
+   *
+   */
+  std::size_t capacity() const { return capacity_; }
+
   void clear() {
     auto cpy = std::vector(objects_order_);
     delete_many(cpy);
@@ -134,27 +148,26 @@ class Arena {
  protected:
   friend Scene;
 
+  /**
+   * @brief The slots are allocated on demand, only the max number of objects is fixed here.
+   *
+   */
   void init(std::size_t max_objs, std::uint32_t signature) {
     max_objs_  = max_objs;
     signature_ = signature;
-    for (auto i = max_objs; i >= 1; --i) {
-      objects_freed_.push(static_cast<uint32_t>(i));
-    }
-    objects_freed_.push(0U);
-    objects_.resize(max_objs);
   }
 
   std::expected<ObserverPtr<Object>, ObjectCreationError> create_and_get(Scene& scene, Object::Variant&& variant) {
-    if (objects_freed_.empty()) {
+    if (available() == 0) {
       eray::util::Logger::warn("Reached limit of objects. Available {}. Requested {}.", 0, 1);
       return std::unexpected(ObjectCreationError::ReachedMaxObjects);
     }
     auto h = unsafe_create(scene, std::move(variant));
-    return ObserverPtr<Object>(objects_[h.obj_id]->first);
+    return ObserverPtr<Object>(slot(h.obj_id)->first);
   }
 
   std::expected<Handle, ObjectCreationError> create(Scene& scene, Object::Variant&& variant) {
-    if (objects_freed_.empty()) {
+    if (available() == 0) {
       eray::util::Logger::warn("Reached limit of objects. Available {}. Requested {}.", 0, 1);
       return std::unexpected(ObjectCreationError::ReachedMaxObjects);
     }
@@ -164,8 +177,8 @@ class Arena {
 
   std::expected<std::vector<Handle>, ObjectCreationError> create_many(ref<Scene> scene, Object::Variant variant,
                                                                       size_t count) {
-    if (objects_freed_.size() < count) {
-      eray::util::Logger::warn("Reached limit of objects. Available {}. Requested {}.", objects_freed_.size(), count);
+    if (available() < count) {
+      eray::util::Logger::warn("Reached limit of objects. Available {}. Requested {}.", available(), count);
       return std::unexpected(ObjectCreationError::ReachedMaxObjects);
     }
 
@@ -182,23 +195,24 @@ class Arena {
     if (!exists(handle)) {
       return false;
     }
-    if (!objects_[handle.obj_id]->first.can_be_deleted()) {
+    auto& obj_slot = slot(handle.obj_id);
+    if (!obj_slot->first.can_be_deleted()) {
       eray::util::Logger::warn("Requested deletion of an object, however it cannot be deleted.");
       return false;
     }
-    objects_[handle.obj_id]->first.on_delete();
+    obj_slot->first.on_delete();
 
-    auto ind = objects_[handle.obj_id]->second;
+    auto ind = obj_slot->second;
     for (size_t i = ind + 1; i < objects_order_.size(); ++i) {
-      --objects_[objects_order_[i].obj_id]->second;
+      --slot(objects_order_[i].obj_id)->second;
     }
     objects_order_.erase(objects_order_.begin() + static_cast<int>(ind));
 
     // save info for logger
-    auto name      = std::move(objects_[handle.obj_id]->first.name);
-    auto type_name = objects_[handle.obj_id]->first.type_name();
+    auto name      = std::move(obj_slot->first.name);
+    auto type_name = obj_slot->first.type_name();
 
-    objects_[handle.obj_id] = std::nullopt;
+    obj_slot = std::nullopt;
     objects_freed_.push(handle.obj_id);
 
     eray::util::Logger::info(R"(Deleted object "{}" of type "{}" with id "{}")", name, type_name, handle.obj_id);
@@ -213,9 +227,9 @@ class Arena {
       }
       ++count;
 
-      auto idx                   = objects_[h.obj_id]->second;
+      auto idx                   = slot(h.obj_id)->second;
       objects_order_[idx].obj_id = static_cast<uint32_t>(max_objs_);  // mark handle as invalid
-      objects_[h.obj_id]         = std::nullopt;
+      slot(h.obj_id)             = std::nullopt;
       objects_freed_.push(h.obj_id);
     }
 
@@ -227,37 +241,83 @@ class Arena {
     objects_order_.resize(objects_order_.size() - count, Handle(0U, 0U, 0U));
 
     for (auto i = 0U; auto& h : objects_order_) {
-      objects_[h.obj_id]->second = i++;
+      slot(h.obj_id)->second = i++;
     }
 
     return count > 0;
   }
 
-  Object& unsafe_at(const Handle& handle) { return objects_.at(handle.obj_id)->first; }
+  Object& unsafe_at(const Handle& handle) { return slot(handle.obj_id)->first; }
 
  private:
+  using Slot = std::optional<std::pair<Object, std::uint32_t>>;
+
+  // The first block holds 2^kFirstBlockBits slots and every next block doubles the capacity
+  static constexpr std::uint32_t kFirstBlockBits = 6;
+  static constexpr std::size_t kFirstBlockSize   = std::size_t{1} << kFirstBlockBits;
+
   std::uint32_t timestamp() { return curr_timestamp_++; }
 
+  Slot& slot(std::uint32_t obj_id) {
+    auto block = static_cast<std::size_t>(std::bit_width(obj_id >> kFirstBlockBits));
+    return blocks_[block][block == 0 ? obj_id : obj_id - (kFirstBlockSize << (block - 1))];
+  }
+
+  const Slot& slot(std::uint32_t obj_id) const {
+    auto block = static_cast<std::size_t>(std::bit_width(obj_id >> kFirstBlockBits));
+    return blocks_[block][block == 0 ? obj_id : obj_id - (kFirstBlockSize << (block - 1))];
+  }
+
+  /**
+   * @brief Number of the objects that can still be created: the freed ids and the ids that have never been used.
+   *
+   */
+  std::size_t available() const { return objects_freed_.size() + (max_objs_ - next_obj_id_); }
+
+  /**
+   * @brief Returns the most recently freed id or the next unused one, the storage is doubled when it's full.
+   *
+   */
+  std::uint32_t acquire_obj_id() {
+    if (!objects_freed_.empty()) {
+      auto obj_id = objects_freed_.top();
+      objects_freed_.pop();
+      return obj_id;
+    }
+
+    if (next_obj_id_ == capacity_) {
+      auto block      = blocks_.size();
+      auto block_size = block == 0 ? kFirstBlockSize : kFirstBlockSize << (block - 1);
+      block_size      = std::min(block_size, max_objs_ - capacity_);
+      blocks_.push_back(std::make_unique<Slot[]>(block_size));
+      capacity_ += block_size;
+    }
+
+    return next_obj_id_++;
+  }
+
   Handle unsafe_create(ref<Scene> scene, Object::Variant&& variant) {
-    auto obj_id = objects_freed_.top();
-    objects_freed_.pop();
-    auto h = Handle(signature_, timestamp(), obj_id);
+    auto obj_id    = acquire_obj_id();
+    auto h         = Handle(signature_, timestamp(), obj_id);
+    auto& obj_slot = slot(obj_id);
     objects_order_.push_back(h);
-    objects_[obj_id].emplace(std::piecewise_construct, std::forward_as_tuple(h, scene.get()),
-                             std::forward_as_tuple(objects_order_.size() - 1));
-    objects_[obj_id]->first.object = std::move(variant);
-    objects_[obj_id]->first.set_name(std::format("{} {}", objects_[obj_id]->first.type_name(), object_idx_++));
+    obj_slot.emplace(std::piecewise_construct, std::forward_as_tuple(h, scene.get()),
+                     std::forward_as_tuple(objects_order_.size() - 1));
+    obj_slot->first.object = std::move(variant);
+    obj_slot->first.set_name(std::format("{} {}", obj_slot->first.type_name(), object_idx_++));
     return h;
   }
 
  private:
   std::size_t max_objs_{0};
+  std::size_t capacity_{0};
+  std::uint32_t next_obj_id_{0};
   std::uint32_t signature_{0};
   std::uint32_t curr_timestamp_{0};
   std::uint32_t object_idx_{0};
 
   std::vector<Handle> objects_order_;
-  std::vector<std::optional<std::pair<Object, std::uint32_t>>> objects_;
+  std::vector<std::unique_ptr<Slot[]>> blocks_;
   std::stack<std::uint32_t> objects_freed_;
 };
 
@@ -1,16 +1,32 @@
+#include <algorithm>
+#include <cmath>
 #include <liberay/math/mat.hpp>
 #include <liberay/math/vec.hpp>
+#include <liberay/util/panic.hpp>
 #include <libminicad/math/bezier3.hpp>
 #include <libminicad/renderer/rendering_command.hpp>
 #include <libminicad/scene/curve.hpp>
 #include <libminicad/scene/scene.hpp>
 #include <limits>
+#include <utility>
 
 namespace mini {
 
 namespace math = eray::math;
 namespace util = eray::util;
 
+namespace {
+
+// The const overloads read the caches without refreshing them, so evaluating a modified object would race with the
+// refresh on the other threads
+void ensure_prepared(bool prepared) {
+  if (!prepared) {
+    util::panic("The curve is evaluated before prepare()");
+  }
+}
+
+}  // namespace
+
 Curve::Curve(const CurveHandle& handle, Scene& scene)
     : ObjectBase<Curve, CurveVariant>(handle, scene), bezier_dirty_(true) {
   scene.renderer().push_object_rs_cmd(CurveRSCommand(handle, CurveRSCommand::Internal::AddObject{}));
@@ -77,15 +93,11 @@ std::expected<void, Curve::SceneObjectError> Curve::push_back(const PointObjectH
 
       obj.curves_.insert(handle_);
 
-      if (std::holds_alternative<BSplineCurve>(this->object)) {
-        std::get<BSplineCurve>(this->object).reset_bernstein_points(*this);
-        scene().renderer().push_object_rs_cmd(CurveRSCommand(handle_, CurveRSCommand::UpdateHelperPoints{}));
-      }
-      std::visit(eray::util::match{[&](auto& o) { o.on_point_remove(*this, obj, obj.unsafe_get_variant<Point>()); }},
+      auto idx = points_.size() - 1;
+      std::visit(eray::util::match{[&](auto& o) { o.on_point_add(*this, obj, obj.unsafe_get_variant<Point>(), idx); }},
                  this->object);
-      scene().renderer().push_object_rs_cmd(CurveRSCommand(handle_, CurveRSCommand::Internal::UpdateControlPoints{}));
+      on_point_list_changed();
 
-      mark_bezier3_dirty();
       return {};
     }
     auto obj_type_name = std::visit(util::match{[&](auto& p) { return p.type_name(); }}, obj.object);
@@ -105,10 +117,13 @@ std::expected<void, Curve::SceneObjectError> Curve::move_before(size_t dest_idx,
     return std::unexpected(static_cast<SceneObjectError>(result.error()));
   }
 
-  std::visit(eray::util::match{[&](auto& o) { o.on_curve_reorder(*this); }}, this->object);
-  scene().renderer().push_object_rs_cmd(CurveRSCommand(handle_, CurveRSCommand::Internal::UpdateControlPoints{}));
+  if (*result) {
+    auto begin_idx = std::min(dest_idx, source_idx);
+    auto end_idx   = std::min(std::max(dest_idx, source_idx) + 1, points_.size());
+    std::visit(eray::util::match{[&](auto& o) { o.on_curve_reorder(*this, begin_idx, end_idx); }}, this->object);
+    on_point_list_changed();
+  }
 
-  mark_bezier3_dirty();
   return {};
 }
 
@@ -120,20 +135,26 @@ std::expected<void, Curve::SceneObjectError> Curve::remove(const PointObjectHand
   if (auto o = scene().arena<PointObject>().get_obj(handle)) {
     auto& obj = *o.value();
     if (obj.has_type<Point>()) {
-      auto result = points_.remove(obj);
+      auto idx        = point_idx(handle);
+      auto prev_count = points_.size();
+      auto result     = points_.remove(obj);
       if (!result) {
         return std::unexpected(static_cast<SceneObjectError>(result.error()));
       }
+      if (prev_count - points_.size() != 1) {
+        // The point occurred more than once
+        idx = std::nullopt;
+      }
 
       auto obj_it = obj.curves_.find(handle_);
       if (obj_it != obj.curves_.end()) {
         obj.curves_.erase(obj_it);
       }
-      std::visit(eray::util::match{[&](auto& o) { o.on_point_remove(*this, obj, obj.unsafe_get_variant<Point>()); }},
-                 this->object);
-      scene().renderer().push_object_rs_cmd(CurveRSCommand(handle_, CurveRSCommand::Internal::UpdateControlPoints{}));
+      std::visit(
+          eray::util::match{[&](auto& o) { o.on_point_remove(*this, obj, obj.unsafe_get_variant<Point>(), idx); }},
+          this->object);
+      on_point_list_changed();
 
-      mark_bezier3_dirty();
       return {};
     }
 
@@ -149,27 +170,130 @@ std::expected<void, Curve::SceneObjectError> Curve::move_after(size_t dest_idx,
     return std::unexpected(static_cast<SceneObjectError>(result.error()));
   }
 
-  std::visit(eray::util::match{[&](auto& o) { o.on_curve_reorder(*this); }}, this->object);
-  scene().renderer().push_object_rs_cmd(CurveRSCommand(handle_, CurveRSCommand::Internal::UpdateControlPoints{}));
+  if (*result) {
+    auto begin_idx = std::min(dest_idx, source_idx);
+    auto end_idx   = std::min(std::max(dest_idx, source_idx) + 1, points_.size());
+    std::visit(eray::util::match{[&](auto& o) { o.on_curve_reorder(*this, begin_idx, end_idx); }}, this->object);
+    on_point_list_changed();
+  }
 
-  mark_bezier3_dirty();
   return {};
 }
 
-void Curve::refresh_bezier3_if_dirty() {
+void Curve::prepare() {
+  refresh_bezier3();
+  if (!arc_length_dirty_) {
+    return;
+  }
+
+  auto [valid_prefix, valid_suffix] = arc_length_valid_range_;
+  if (valid_prefix + valid_suffix == 0) {
+    arc_length_ = ArcLengthTable::build(bezier3_points_);
+  } else {
+    arc_length_.splice(bezier3_points_, valid_prefix, valid_suffix);
+  }
+  arc_length_dirty_ = false;
+}
+
+void Curve::refresh_bezier3() {
+  if (!bezier_dirty_) {
+    return;
+  }
+
+  auto spliced = std::visit(
+      eray::util::match{[&]<CCurveType T>(const T& o) {
+        if constexpr (CSplicedCurveType<T>) {
+          auto old_segments_count = bezier3_points_.size() / 4;
+          auto new_segments_count = o.bezier3_points_count(*this) / 4;
+          auto [valid_prefix, valid_suffix] = bezier_valid_range_;
+          if (valid_prefix + valid_suffix == 0 ||
+              valid_prefix + valid_suffix > std::min(old_segments_count, new_segments_count)) {
+            return false;
+          }
+
+          // Only the middle part of the cache is replaced, the valid suffix is shifted once
+          auto old_middle = static_cast<std::ptrdiff_t>(4 * (old_segments_count - valid_prefix - valid_suffix));
+          auto new_middle = static_cast<std::ptrdiff_t>(4 * (new_segments_count - valid_prefix - valid_suffix));
+          auto middle_it  = bezier3_points_.begin() + static_cast<std::ptrdiff_t>(4 * valid_prefix);
+          if (new_middle > old_middle) {
+            bezier3_points_.insert(middle_it, static_cast<size_t>(new_middle - old_middle),
+                                   eray::math::Vec3f::filled(0.F));
+          } else if (new_middle < old_middle) {
+            bezier3_points_.erase(middle_it, middle_it + (old_middle - new_middle));
+          }
+
+          for (auto segment = valid_prefix; segment < new_segments_count - valid_suffix; ++segment) {
+            auto bezier_segment = o.bezier3_segment(*this, segment);
+            std::ranges::copy(bezier_segment, bezier3_points_.begin() + static_cast<std::ptrdiff_t>(4 * segment));
+          }
+          return true;
+        } else {
+          return false;
+        }
+      }},
+      this->object);
+
+  if (!spliced) {
+    std::visit(eray::util::match{[&](const auto& o) {
+                 bezier3_points_.resize(o.bezier3_points_count(*this));
+                 o.write_bezier3_points(*this, bezier3_points_);
+               }},
+               this->object);
+  }
+
+  // The segments changed by all the refreshes since the last build are integrated again when the table is needed
+  if (!spliced) {
+    arc_length_valid_range_ = {0, 0};
+  } else if (arc_length_dirty_) {
+    arc_length_valid_range_.first  = std::min(arc_length_valid_range_.first, bezier_valid_range_.first);
+    arc_length_valid_range_.second = std::min(arc_length_valid_range_.second, bezier_valid_range_.second);
+  } else {
+    arc_length_valid_range_ = bezier_valid_range_;
+  }
+
+  arc_length_dirty_ = true;
+  bezier_dirty_     = false;
+}
+
+void Curve::mark_bezier3_segments_dirty(size_t begin_segment, size_t end_segment, size_t segments_count) {
+  auto valid = ValidSegments{begin_segment, segments_count - std::min(end_segment, segments_count)};
+  auto merge = [&valid](ValidSegments& range) {
+    range.first  = std::min(range.first, valid.first);
+    range.second = std::min(range.second, valid.second);
+  };
+
   if (bezier_dirty_) {
-    bezier3_points_.clear();
-    auto bezier3_points =
-        std::visit(eray::util::match{[&](const auto& o) { return o.bezier3_points(*this); }}, this->object);
-    for (const auto& p : bezier3_points) {
-      bezier3_points_.push_back(p);
-    }
-    bezier_dirty_ = false;
+    merge(bezier_valid_range_);
+  } else {
+    bezier_valid_range_ = valid;
   }
+  merge(rendered_valid_range_);
+  bezier_dirty_ = true;
+
+  scene().renderer().push_object_rs_cmd(CurveRSCommand(handle_, CurveRSCommand::Internal::UpdateSegments{}));
+}
+
+std::pair<size_t, size_t> Curve::take_unchanged_bezier3_segments() {
+  refresh_bezier3();
+  auto segments_count = bezier3_points_.size() / 4;
+  auto prefix         = std::min(rendered_valid_range_.first, segments_count);
+  auto suffix         = std::min(rendered_valid_range_.second, segments_count - prefix);
+
+  rendered_valid_range_ = kAllSegmentsValid;
+  return {prefix, suffix};
+}
+
+void Curve::on_point_list_changed() {
+  std::visit(eray::util::match{[&]<CCurveType T>(const T&) {
+               if constexpr (!CSplicedCurveType<T>) {
+                 update();
+               }
+             }},
+             this->object);
 }
 
 const std::vector<eray::math::Vec3f>& Curve::bezier3_points() {
-  refresh_bezier3_if_dirty();
+  refresh_bezier3();
   return bezier3_points_;
 }
 
@@ -181,7 +305,15 @@ std::generator<eray::math::Vec3f> Curve::polyline_points() const {
   }
 }
 
-size_t Curve::polyline_points_count() const { return 2 * (points_.size() - 1); }
+size_t Curve::polyline_points_count() const { return points_.size() < 2 ? 0 : 2 * (points_.size() - 1); }
+
+void Curve::write_polyline_points(std::span<eray::math::Vec3f> out) const {
+  auto&& points = this->points();
+  for (auto i = size_t{0}; i + 1 < points.size(); ++i) {
+    out[2 * i]     = points[i];
+    out[2 * i + 1] = points[i + 1];
+  }
+}
 
 std::generator<eray::math::Vec3f> Polyline::bezier3_points(ref<const Curve> base) const {
   auto&& points = base.get().points();
@@ -194,7 +326,20 @@ std::generator<eray::math::Vec3f> Polyline::bezier3_points(ref<const Curve> base
   }
 }
 
-size_t Polyline::bezier3_points_count(ref<const Curve> base) const { return (base.get().points().size() - 1) * 4; }
+size_t Polyline::bezier3_points_count(ref<const Curve> base) const {
+  auto points_count = base.get().points().size();
+  return points_count < 2 ? 0 : (points_count - 1) * 4;
+}
+
+void Polyline::write_bezier3_points(ref<const Curve> base, std::span<eray::math::Vec3f> out) const {
+  auto&& points = base.get().points();
+  for (auto i = size_t{0}; i + 1 < points.size(); ++i) {
+    out[4 * i]     = points[i];
+    out[4 * i + 1] = points[i + 1];
+    out[4 * i + 2] = points[i + 1];
+    out[4 * i + 3] = points[i + 1];
+  }
+}
 
 std::generator<eray::math::Vec3f> MultisegmentBezierCurve::bezier3_points(ref<const Curve> base) const {
   auto&& points = base.get().points();
@@ -228,10 +373,33 @@ size_t MultisegmentBezierCurve::bezier3_points_count(ref<const Curve> base) cons
     return 0;
   }
 
-  if ((cp_count - 1) % 3 != 0) {
-    return cp_count / 3 * 4 + 4;
+  // The last incomplete segment is filled up with the last point
+  return (cp_count - 1) / 3 * 4 + ((cp_count - 1) % 3 != 0 ? 4 : 0);
+}
+
+void MultisegmentBezierCurve::write_bezier3_points(ref<const Curve> base, std::span<eray::math::Vec3f> out) const {
+  auto&& points = base.get().points();
+  auto count    = points.size();
+  if (count == 0) {
+    return;
+  }
+
+  auto idx = size_t{0};
+  for (auto segment = size_t{0}; segment < (count - 1) / 3; ++segment) {
+    for (auto k = size_t{0}; k < 4; ++k) {
+      out[idx++] = points[3 * segment + k];
+    }
+  }
+
+  auto reminder = (count - 1) % 3;
+  if (reminder > 0) {
+    for (auto i = count - (reminder + 1); i < count; ++i) {
+      out[idx++] = points[i];
+    }
+    for (auto i = 0U; i < 3 - reminder; ++i) {
+      out[idx++] = points[count - 1];
+    }
   }
-  return cp_count / 3 * 4;
 }
 
 void BSplineCurve::reset_bernstein_points(const Curve& base) {
@@ -330,31 +498,98 @@ void BSplineCurve::on_point_update(Curve& base, const PointObject& point, const
   base.scene().renderer().push_object_rs_cmd(CurveRSCommand(base.handle(), CurveRSCommand::UpdateHelperPoints{}));
 }
 
-void BSplineCurve::on_point_add(Curve& base, const PointObject&, const Point&) {
+void BSplineCurve::on_points_update(Curve& base) {
   reset_bernstein_points(base);
   base.scene().renderer().push_object_rs_cmd(CurveRSCommand(base.handle(), CurveRSCommand::UpdateHelperPoints{}));
 }
 
-void BSplineCurve::on_point_remove(Curve& base, const PointObject&, const Point&) {
-  reset_bernstein_points(base);
-  base.scene().renderer().push_object_rs_cmd(CurveRSCommand(base.handle(), CurveRSCommand::UpdateHelperPoints{}));
+void BSplineCurve::on_point_add(Curve& base, const PointObject&, const Point&, size_t idx) {
+  splice_bernstein_points(base, idx, 0, 1);
 }
 
-void BSplineCurve::on_curve_reorder(Curve& base) {
+void BSplineCurve::on_point_remove(Curve& base, const PointObject&, const Point&, std::optional<size_t> idx) {
+  if (idx) {
+    splice_bernstein_points(base, *idx, 1, 0);
+    return;
+  }
+
   reset_bernstein_points(base);
-  base.scene().renderer().push_object_rs_cmd(CurveRSCommand(base.handle(), CurveRSCommand::UpdateHelperPoints{}));
+  auto segments_count = bezier_points_.size() / 3;
+  base.mark_bezier3_segments_dirty(0, segments_count, segments_count);
+}
+
+void BSplineCurve::on_curve_reorder(Curve& base, size_t begin_idx, size_t end_idx) {
+  splice_bernstein_points(base, begin_idx, end_idx - begin_idx, end_idx - begin_idx);
+}
+
+void BSplineCurve::splice_bernstein_points(Curve& base, size_t first_idx, size_t removed, size_t inserted) {
+  // Bernstein point 3k depends on the de Boor points k, k+1, k+2, the points 3k+1, 3k+2 (present unless k is the last
+  // triple) depend on the de Boor points k+1, k+2.
+  auto de_boor_points_count = base.point_objects().size();
+  if (de_boor_points_count < 4 || bezier_points_.empty()) {
+    reset_bernstein_points(base);
+    auto segments_count = bezier_points_.size() / 3;
+    base.mark_bezier3_segments_dirty(0, segments_count, segments_count);
+    return;
+  }
+
+  // Any position inside the dirty part keeps the unchanged suffix aligned
+  auto pos = std::min(3 * (std::max<size_t>(first_idx, 2) - 2), bezier_points_.size());
+  if (inserted > removed) {
+    bezier_points_.insert(bezier_points_.begin() + static_cast<std::ptrdiff_t>(pos), 3 * (inserted - removed),
+                          eray::math::Vec3f::filled(0.F));
+  } else if (removed > inserted) {
+    pos        = std::min(pos, bezier_points_.size() - 3 * (removed - inserted));
+    auto first = bezier_points_.begin() + static_cast<std::ptrdiff_t>(pos);
+    bezier_points_.erase(first, first + static_cast<std::ptrdiff_t>(3 * (removed - inserted)));
+  }
+
+  // The triple preceding the change is included, as it gains or loses its inner points when the change is at the end
+  auto last_triple  = de_boor_points_count - 3;
+  auto begin_triple = std::min(std::max<size_t>(first_idx, 3) - 3, last_triple);
+  auto end_triple   = std::min(first_idx + inserted, last_triple + 1);
+
+  auto de_boor_points = base.point_objects();
+  for (auto k = begin_triple; k < end_triple; ++k) {
+    auto p0 = de_boor_points[k].transform().pos();
+    auto p1 = de_boor_points[k + 1].transform().pos();
+    auto p2 = de_boor_points[k + 2].transform().pos();
+
+    bezier_points_[3 * k] = (p0 + 4 * p1 + p2) / 6.0;
+    if (k < last_triple) {
+      bezier_points_[3 * k + 1] = (4 * p1 + 2 * p2) / 6.0;
+      bezier_points_[3 * k + 2] = (2 * p1 + 4 * p2) / 6.0;
+    }
+  }
+
+  // Segment s spans the bernstein points [3s, 3s + 3]
+  auto segments_count = last_triple;
+  base.mark_bezier3_segments_dirty(std::max<size_t>(begin_triple, 1) - 1, std::min(end_triple, segments_count),
+                                   segments_count);
 }
 
 std::generator<eray::math::Vec3f> BSplineCurve::bezier3_points(ref<const Curve> /*base*/) const {
   for (auto i = 0U; const auto& b : bezier_points_) {
     co_yield b;
-    if (i % 3 == 0 && i != 0) {
+    if (i % 3 == 0 && i != 0 && i + 1 != bezier_points_.size()) {
       co_yield b;
     }
     ++i;
   }
 }
 
+void BSplineCurve::write_bezier3_points(ref<const Curve> base, std::span<eray::math::Vec3f> out) const {
+  for (auto segment = size_t{0}; segment < bezier_points_.size() / 3; ++segment) {
+    auto bezier_segment = bezier3_segment(base, segment);
+    std::ranges::copy(bezier_segment, out.begin() + static_cast<std::ptrdiff_t>(4 * segment));
+  }
+}
+
+std::array<eray::math::Vec3f, 4> BSplineCurve::bezier3_segment(ref<const Curve> /*base*/, size_t segment_idx) const {
+  return {bezier_points_[3 * segment_idx], bezier_points_[3 * segment_idx + 1], bezier_points_[3 * segment_idx + 2],
+          bezier_points_[3 * segment_idx + 3]};
+}
+
 std::generator<eray::math::Vec3f> BSplineCurve::unique_bezier3_points(ref<const Curve> /*base*/) const {
   for (const auto& b : bezier_points_) {
     co_yield b;
@@ -373,6 +608,7 @@ void NaturalSplineCurve::reset_segments(Curve& base) {
     return;
   }
 
+  // The buffers keep their capacity, so the updates do not allocate unless the point count grows
   unique_points_.clear();
   unique_points_.reserve(all_points_count);
   for (const auto& [p0, p1] : base.points() | std::views::adjacent<2>) {
@@ -389,7 +625,6 @@ void NaturalSplineCurve::reset_segments(Curve& base) {
   //   - segments: 0, 1, ..., n-2
   //   - matrix coefficients: 0, 1, ..., n-3
 
-  segments_.clear();
   segments_.resize(n - 1, {});
   if (n == 2) {
     auto p0                   = unique_points_.front();
@@ -405,69 +640,81 @@ void NaturalSplineCurve::reset_segments(Curve& base) {
     return;
   }
 
-  // Find the lengths
-  for (const auto& [i, ps] : unique_points_ | std::views::adjacent<2> | std::views::enumerate) {
-    auto [p0, p1] = ps;
-    auto idx      = static_cast<size_t>(i);
+  update_factorization();
+  solve();
+}
 
-    segments_[idx].chord_length = math::distance(p0, p1);
+void NaturalSplineCurve::update_factorization() {
+  auto n    = unique_points_.size();
+  auto rows = n - 2;
+  auto& f   = factorization_;
+
+  // Row i of the matrix depends on the chords i and i + 1, so a changed chord invalidates the elimination from the
+  // preceding row onwards
+  auto first_row = rows;
+  if (f.chord_lengths.size() != n - 1) {
+    f.chord_lengths.resize(n - 1);
+    f.lower.resize(rows);
+    f.upper.resize(rows);
+    f.inv_pivot.resize(rows);
+    first_row = 0;
+  }
+
+  for (auto i = 0U; i < n - 1; ++i) {
+    auto length = math::distance(unique_points_[i], unique_points_[i + 1]);
+    if (first_row == 0 || std::abs(length - f.chord_lengths[i]) > kChordLengthTolerance * f.chord_lengths[i]) {
+      f.chord_lengths[i] = length;
+      first_row          = std::min<size_t>(first_row, i == 0 ? 0 : i - 1);
+    }
   }
 
-  // Find the tridiagonal matrix coefficients, using the Segment struct to avoid additional memory allocation:
+  // Forward elimination. Based on: https://en.wikipedia.org/wiki/Tridiagonal_matrix_algorithm
   //  - The diagonal itself has all cell values equal 2
-  //  - a.x denotes the lower diagonal coefficients
-  //  - a.y denotes the upper diagonal coefficients
+  //  - lower denotes the lower diagonal coefficients, we assume that the c_0=c_{n-1}=0, so lower_0 = 0
+  //  - upper denotes the new upper diagonal coefficients, the last one is 0 for the same reason
+  for (auto i = first_row; i < rows; ++i) {
+    auto l0    = f.chord_lengths[i];
+    auto l1    = f.chord_lengths[i + 1];
+    auto denom = l0 + l1;
+
+    f.lower[i]     = i == 0 ? 0.F : l0 / denom;
+    f.inv_pivot[i] = 1.F / (2.F - (i == 0 ? 0.F : f.lower[i] * f.upper[i - 1]));
+    f.upper[i]     = i == rows - 1 ? 0.F : l1 / denom * f.inv_pivot[i];
+  }
+}
+
+void NaturalSplineCurve::solve() {
+  auto n        = unique_points_.size();
+  const auto& f = factorization_;
+
+  for (auto i = 0U; i < n - 1; ++i) {
+    segments_[i].chord_length = f.chord_lengths[i];
+  }
+
+  // The right hand side and the forward substitution in a single pass, d denotes the new right hand coefficients
   for (auto i = 0U; i < n - 2; ++i) {
-    float denom      = segments_[i].chord_length + segments_[i + 1].chord_length;
-    segments_[i].a.x = segments_[i].chord_length / denom;
-    segments_[i].a.y = segments_[i + 1].chord_length / denom;
-  }
-  segments_[0].a.x     = 0;  // not used, we assume that the c_0=c_{n-1}=0
-  segments_[n - 3].a.y = 0;
-
-  // b denotes the right hand 3-dimensional coefficient vector
-  for (const auto& [i, ps] : unique_points_ | std::views::adjacent<3> | std::views::enumerate) {
-    const auto& [p0, p1, p2] = ps;
-    auto idx                 = static_cast<size_t>(i);
-
-    auto nom         = (p2 - p1) / segments_[idx + 1].chord_length - (p1 - p0) / segments_[idx].chord_length;
-    auto denom       = segments_[idx + 1].chord_length + segments_[idx].chord_length;
-    segments_[idx].b = 3.F * nom / denom;
-  }
-
-  // Solving the tridiagonal matrix. Based on: https://en.wikipedia.org/wiki/Tridiagonal_matrix_algorithm
-  //
-  // 1. Find the new coefficients
-  //
-  // a.z denotes the new upper diagonal coefficients
-  segments_[0].a.z = segments_[0].a.y / 2.F;
-  for (auto i = 1U; i < n - 2; ++i) {
-    segments_[i].a.z = segments_[i].a.y / (2.F - segments_[i].a.x * segments_[i - 1].a.z);
-  }
-  //
-  // d denotes the new right hand 3-dimensional coefficients vector
-  //
-  segments_[0].d = segments_[0].b / 2.F;
-  for (auto i = 1U; i < n - 2; ++i) {
-    auto nom       = segments_[i].b - segments_[i].a.x * segments_[i - 1].d;
-    auto denom     = 2.F - segments_[i].a.x * segments_[i - 1].a.z;
-    segments_[i].d = nom / denom;
-  }
-  //
-  // 2. Find the solution -- c power basis coefficients
-  //
+    const auto& p0 = unique_points_[i];
+    const auto& p1 = unique_points_[i + 1];
+    const auto& p2 = unique_points_[i + 2];
+    auto l0        = f.chord_lengths[i];
+    auto l1        = f.chord_lengths[i + 1];
+
+    auto rhs       = 3.F * ((p2 - p1) / l1 - (p1 - p0) / l0) / (l0 + l1);
+    auto prev      = i == 0 ? eray::math::Vec3f::filled(0.F) : segments_[i - 1].d;
+    segments_[i].d = (rhs - f.lower[i] * prev) * f.inv_pivot[i];
+  }
+
+  // Back substitution -- c power basis coefficients
   segments_[0].c     = eray::math::Vec3f::filled(0.F);  // from assumption that c_0=c_{n-1}=0
   segments_[n - 2].c = segments_[n - 3].d;
   for (auto i = static_cast<int>(n) - 3; i >= 1; --i) {
     auto idx         = static_cast<size_t>(i);
-    segments_[idx].c = segments_[idx - 1].d - segments_[idx - 1].a.z * segments_[idx + 1].c;
+    segments_[idx].c = segments_[idx - 1].d - f.upper[idx - 1] * segments_[idx + 1].c;
   }
 
   // Find the a power basis coefficients from the fact that a_i = P_i, (interpolation constraint)
-  auto points_without_start_end = unique_points_ | std::views::take(n - 1);  // skip the last point
-  for (auto it = segments_.begin(); const auto& p : points_without_start_end) {
-    it->a = p;
-    ++it;
+  for (auto i = 0U; i < n - 1; ++i) {
+    segments_[i].a = unique_points_[i];
   }
 
   // Find the d power basis coefficients from the C^2 constraint (excluding n-2)
@@ -476,20 +723,18 @@ void NaturalSplineCurve::reset_segments(Curve& base) {
   }
 
   // Find the b power basis coefficients from the C^0 constraint (excluding n-2)
-  auto point_it = ++unique_points_.cbegin();  // skip the first point
   for (auto i = 0U; i < n - 2; ++i) {
-    segments_[i].b = (*point_it - segments_[i].a) / segments_[i].chord_length -
+    segments_[i].b = (unique_points_[i + 1] - segments_[i].a) / segments_[i].chord_length -
                      segments_[i].c * segments_[i].chord_length -
                      segments_[i].d * segments_[i].chord_length * segments_[i].chord_length;
-    ++point_it;
   }
 
   // Find the constrains for n-2
   segments_[n - 2].b = segments_[n - 3].b + 2.F * segments_[n - 3].c * segments_[n - 3].chord_length +
                        3.F * segments_[n - 3].d * segments_[n - 3].chord_length * segments_[n - 3].chord_length;
 
-  auto last_point = *(--unique_points_.cend());
-  auto l          = segments_[n - 2].chord_length;
+  const auto& last_point = unique_points_.back();
+  auto l                 = segments_[n - 2].chord_length;
   segments_[n - 2].d =
       (last_point - segments_[n - 2].a) / (l * l * l) - segments_[n - 2].b / (l * l) - segments_[n - 2].c / l;
 
@@ -518,33 +763,57 @@ std::generator<eray::math::Vec3f> NaturalSplineCurve::bezier3_points(ref<const C
 
 size_t NaturalSplineCurve::bezier3_points_count(ref<const Curve> /*base*/) const { return segments_.size() * 4; }
 
-eray::math::Vec3f Curve::evaluate(float t) {
-  refresh_bezier3_if_dirty();
-  if (bezier3_points_.empty() || t > 1.F) {
-    return math::Vec3f::filled(0.F);
+void NaturalSplineCurve::write_bezier3_points(ref<const Curve> /*base*/, std::span<eray::math::Vec3f> out) const {
+  for (auto i = size_t{0}; const auto& s : segments_) {
+    out[i++] = s.a;
+    out[i++] = s.b;
+    out[i++] = s.c;
+    out[i++] = s.d;
   }
+}
 
-  auto segments_count = bezier3_points_.size() / 4;
-  auto segment_len    = 1.F / static_cast<float>(segments_count);
-  auto segment_ind    = static_cast<size_t>(t / segment_len);
+eray::math::Vec3f Curve::evaluate(float t) {
+  refresh_bezier3();
+  return std::as_const(*this).evaluate(t);
+}
 
-  // Map to to the segment
-  t = (t - static_cast<float>(segment_ind) * segment_len) / segment_len;
+eray::math::Mat4f Curve::frenet_frame(float t) {
+  refresh_bezier3();
+  return std::as_const(*this).frenet_frame(t);
+}
 
-  auto i         = segment_ind * 4U;
-  const auto& p0 = bezier3_points_[i];
-  ++i;
-  const auto& p1 = i >= bezier3_points_.size() ? p0 : bezier3_points_[i];
-  ++i;
-  const auto& p2 = i >= bezier3_points_.size() ? p1 : bezier3_points_[i];
-  ++i;
-  const auto& p3 = i >= bezier3_points_.size() ? p2 : bezier3_points_[i];
+std::pair<eray::math::Vec3f, eray::math::Vec3f> Curve::aabb_bounding_box() {
+  refresh_bezier3();
+  return std::as_const(*this).aabb_bounding_box();
+}
 
-  return bezier3(p0, p1, p2, p3, t);
+float Curve::length() {
+  prepare();
+  return std::as_const(*this).length();
 }
 
-eray::math::Mat4f Curve::frenet_frame(float t) {
-  refresh_bezier3_if_dirty();
+eray::math::Vec3f Curve::evaluate_at_length(float s) {
+  prepare();
+  return std::as_const(*this).evaluate_at_length(s);
+}
+
+eray::math::Mat4f Curve::frenet_frame_at_length(float s) {
+  prepare();
+  return std::as_const(*this).frenet_frame_at_length(s);
+}
+
+std::vector<eray::math::Vec3f> Curve::equally_spaced_points(size_t count) {
+  prepare();
+  return std::as_const(*this).equally_spaced_points(count);
+}
+
+eray::math::Vec3f Curve::evaluate(float t) const {
+  ensure_prepared(is_bezier3_prepared());
+  return bezier3_segments(bezier3_points_, t);
+}
+
+eray::math::Mat4f Curve::frenet_frame(float t) const {
+  ensure_prepared(is_bezier3_prepared());
   if (bezier3_points_.empty()) {
     return math::Mat4f::identity();
   }
@@ -556,14 +825,7 @@ eray::math::Mat4f Curve::frenet_frame(float t) {
   // Map to to the segment
   t = (t - static_cast<float>(segment_ind) * segment_len) / segment_len;
 
-  auto i         = segment_ind * 4U;
-  const auto& p0 = bezier3_points_[i];
-  ++i;
-  const auto& p1 = i >= bezier3_points_.size() ? p0 : bezier3_points_[i];
-  ++i;
-  const auto& p2 = i >= bezier3_points_.size() ? p1 : bezier3_points_[i];
-  ++i;
-  const auto& p3 = i >= bezier3_points_.size() ? p2 : bezier3_points_[i];
+  const auto& [p0, p1, p2, p3] = bezier3_segment(bezier3_points_, segment_ind);
 
   auto val     = bezier3(p0, p1, p2, p3, t);
   auto val_dt  = bezier3_dt(p0, p1, p2, p3, t);
@@ -578,12 +840,13 @@ eray::math::Mat4f Curve::frenet_frame(float t) {
                      math::Vec4f(val, 1.F)};
 }
 
-std::pair<eray::math::Vec3f, eray::math::Vec3f> Curve::aabb_bounding_box() {
-  static constexpr auto kFltMin = std::numeric_limits<float>::min();
-  static constexpr auto kFltMax = std::numeric_limits<float>::max();
+std::pair<eray::math::Vec3f, eray::math::Vec3f> Curve::aabb_bounding_box() const {
+  ensure_prepared(is_bezier3_prepared());
+  static constexpr auto kFltLowest = std::numeric_limits<float>::lowest();
+  static constexpr auto kFltMax    = std::numeric_limits<float>::max();
 
   auto min = eray::math::Vec3f::filled(kFltMax);
-  auto max = eray::math::Vec3f::filled(kFltMin);
+  auto max = eray::math::Vec3f::filled(kFltLowest);
 
   for (const auto& p : bezier3_points_) {
     min = eray::math::min(p, min);
@@ -593,4 +856,32 @@ std::pair<eray::math::Vec3f, eray::math::Vec3f> Curve::aabb_bounding_box() {
   return std::make_pair(std::move(min), std::move(max));
 }
 
+float Curve::length() const {
+  ensure_prepared(is_prepared());
+  return arc_length_.total_length();
+}
+
+float Curve::param_at_length(float s) const {
+  ensure_prepared(is_prepared());
+  return arc_length_.param_at_length(bezier3_points_, s);
+}
+
+eray::math::Vec3f Curve::evaluate_at_length(float s) const { return evaluate(param_at_length(s)); }
+
+eray::math::Mat4f Curve::frenet_frame_at_length(float s) const { return frenet_frame(param_at_length(s)); }
+
+std::vector<eray::math::Vec3f> Curve::equally_spaced_points(size_t count) const {
+  ensure_prepared(is_prepared());
+  auto params = std::vector<float>(count);
+  arc_length_.equally_spaced_params(bezier3_points_, params);
+
+  auto result = std::vector<eray::math::Vec3f>();
+  result.reserve(count);
+  for (auto t : params) {
+    result.push_back(evaluate(t));
+  }
+
+  return result;
+}
+
 }  // namespace mini
@@ -1,8 +1,14 @@
 #pragma once
 
+#include <array>
 #include <liberay/math/vec_fwd.hpp>
 #include <liberay/util/zstring_view.hpp>
+#include <libminicad/math/arc_length.hpp>
 #include <libminicad/scene/scene_object.hpp>
+#include <limits>
+#include <optional>
+#include <span>
+#include <utility>
 
 #include "libminicad/scene/types.hpp"
 
@@ -15,10 +21,12 @@ struct Polyline {
  public:
   [[nodiscard]] static zstring_view type_name() noexcept { return "Polyline"; }
   void on_point_update(Curve&, const PointObject&, const Point&) {}
-  void on_point_add(Curve&, const PointObject&, const Point&) {}
-  void on_point_remove(Curve&, const PointObject&, const Point&) {}
-  void on_curve_reorder(Curve&) {}
+  void on_points_update(Curve&) {}
+  void on_point_add(Curve&, const PointObject&, const Point&, size_t) {}
+  void on_point_remove(Curve&, const PointObject&, const Point&, std::optional<size_t>) {}
+  void on_curve_reorder(Curve&, size_t, size_t) {}
   std::generator<eray::math::Vec3f> bezier3_points(ref<const Curve> base) const;
+  void write_bezier3_points(ref<const Curve> base, std::span<eray::math::Vec3f> out) const;
   size_t bezier3_points_count(ref<const Curve> base) const;
 };
 
@@ -26,10 +34,12 @@ struct MultisegmentBezierCurve {
  public:
   [[nodiscard]] static zstring_view type_name() noexcept { return "Multisegment C0 Bezier Curve"; }
   void on_point_update(Curve&, const PointObject&, const Point&) {}
-  void on_point_add(Curve&, const PointObject&, const Point&) {}
-  void on_point_remove(Curve&, const PointObject&, const Point&) {}
-  void on_curve_reorder(Curve&) {}
+  void on_points_update(Curve&) {}
+  void on_point_add(Curve&, const PointObject&, const Point&, size_t) {}
+  void on_point_remove(Curve&, const PointObject&, const Point&, std::optional<size_t>) {}
+  void on_curve_reorder(Curve&, size_t, size_t) {}
   std::generator<eray::math::Vec3f> bezier3_points(ref<const Curve> base) const;
+  void write_bezier3_points(ref<const Curve> base, std::span<eray::math::Vec3f> out) const;
   size_t bezier3_points_count(ref<const Curve> base) const;
 };
 
@@ -74,10 +84,13 @@ struct BSplineCurve {
   bool contains(size_t idx) { return bezier_points_.size() > idx; }
 
   void on_point_update(Curve& base, const PointObject&, const Point&);
-  void on_point_add(Curve& base, const PointObject&, const Point&);
-  void on_point_remove(Curve& base, const PointObject&, const Point&);
-  void on_curve_reorder(Curve& base);
+  void on_points_update(Curve& base);
+  void on_point_add(Curve& base, const PointObject&, const Point&, size_t idx);
+  void on_point_remove(Curve& base, const PointObject&, const Point&, std::optional<size_t> idx);
+  void on_curve_reorder(Curve& base, size_t begin_idx, size_t end_idx);
   std::generator<eray::math::Vec3f> bezier3_points(ref<const Curve> base) const;
+  void write_bezier3_points(ref<const Curve> base, std::span<eray::math::Vec3f> out) const;
+  std::array<eray::math::Vec3f, 4> bezier3_segment(ref<const Curve> base, size_t segment_idx) const;
   std::generator<eray::math::Vec3f> unique_bezier3_points(ref<const Curve> base) const;
   size_t bezier3_points_count(ref<const Curve> base) const;
   size_t unique_bezier3_points_count(ref<const Curve> base) const;
@@ -92,6 +105,14 @@ struct BSplineCurve {
    */
   void update_bernstein_segment(const Curve& base, int cp_idx);
 
+  /**
+   * @brief Splices the bernstein points after the de Boor points [first_idx, first_idx + removed) were replaced with
+   * `inserted` new points. Only the bernstein points that depend on the replaced de Boor points are recomputed, then
+   * the changed Bezier segments are reported to the base curve.
+   *
+   */
+  void splice_bernstein_points(Curve& base, size_t first_idx, size_t removed, size_t inserted);
+
  private:
   std::vector<eray::math::Vec3f> bezier_points_;
 };
@@ -121,30 +142,81 @@ class NaturalSplineCurve {
   const std::vector<eray::math::Vec3f>& unique_points() const { return unique_points_; }
 
   void on_point_update(Curve& base, const PointObject&, const Point&) { update(base); }
-  void on_point_add(Curve& base, const PointObject&, const Point&) { update(base); }
-  void on_point_remove(Curve& base, const PointObject&, const Point&) { update(base); }
-  void on_curve_reorder(Curve& base) { update(base); }
+  void on_points_update(Curve& base) { update(base); }
+  void on_point_add(Curve& base, const PointObject&, const Point&, size_t) { update(base); }
+  void on_point_remove(Curve& base, const PointObject&, const Point&, std::optional<size_t>) { update(base); }
+  void on_curve_reorder(Curve& base, size_t, size_t) { update(base); }
   std::generator<eray::math::Vec3f> bezier3_points(ref<const Curve> base) const;
+  void write_bezier3_points(ref<const Curve> base, std::span<eray::math::Vec3f> out) const;
   size_t bezier3_points_count(ref<const Curve> base) const;
 
  private:
   void update(Curve& base);
 
+  /**
+   * @brief Refreshes the cached chord lengths and refactorizes the matrix rows affected by the chords that changed
+   * more than `kChordLengthTolerance`. Expects at least 3 unique points.
+   *
+   */
+  void update_factorization();
+
+  /**
+   * @brief Solves the system for all three coordinates at once using the cached factorization and converts the
+   * result to the Bezier basis.
+   *
+   */
+  void solve();
+
  private:
+  /**
+   * @brief Forward elimination coefficients of the Thomas algorithm. The system matrix depends only on the chord
+   * lengths, so the factorization is reused as long as the chord lengths stay within the tolerance.
+   *
+   */
+  struct Factorization {
+    std::vector<float> chord_lengths;
+    std::vector<float> lower;
+    std::vector<float> upper;
+    std::vector<float> inv_pivot;
+  };
+
+  static constexpr float kChordLengthTolerance = 0.01F;
+
   std::vector<Segment> segments_;
   std::vector<eray::math::Vec3f> unique_points_;
+  Factorization factorization_;
 };
 
+/**
+ * @brief The `write_bezier3_points` fills exactly `bezier3_points_count` points, it's the allocation free counterpart
+ * of the `bezier3_points` generator. The point list hooks get the index of the added or removed point (nullopt if the
+ * removed point occurred more than once) and the [begin_idx, end_idx) range of the reordered points. The
+ * `on_points_update` is called once instead of `on_point_update` when many points of the curve move at once.
+ *
+ */
 template <typename T>
 concept CCurveType = requires(T t, Curve& base, ref<const Curve> base_ref, const PointObject& point_obj,
-                              const Point& point, float tparam) {
+                              const Point& point, size_t idx, std::optional<size_t> opt_idx,
+                              std::span<eray::math::Vec3f> out, float tparam) {
   { T::type_name() } -> std::same_as<zstring_view>;
   { t.on_point_update(base, point_obj, point) } -> std::same_as<void>;
-  { t.on_point_add(base, point_obj, point) } -> std::same_as<void>;
-  { t.on_point_remove(base, point_obj, point) } -> std::same_as<void>;
-  { t.on_curve_reorder(base) } -> std::same_as<void>;
+  { t.on_points_update(base) } -> std::same_as<void>;
+  { t.on_point_add(base, point_obj, point, idx) } -> std::same_as<void>;
+  { t.on_point_remove(base, point_obj, point, opt_idx) } -> std::same_as<void>;
+  { t.on_curve_reorder(base, idx, idx) } -> std::same_as<void>;
   { t.bezier3_points(base_ref) } -> std::same_as<std::generator<eray::math::Vec3f>>;
   { t.bezier3_points_count(base_ref) } -> std::same_as<size_t>;
+  { t.write_bezier3_points(base_ref, out) } -> std::same_as<void>;
+};
+
+/**
+ * @brief Curve types that report the changed Bezier segments to the base curve on their own, when the point list
+ * changes. The base curve splices only these segments into its cache and the renderer uploads only these segments.
+ *
+ */
+template <typename T>
+concept CSplicedCurveType = CCurveType<T> && requires(const T& t, ref<const Curve> base_ref, size_t idx) {
+  { t.bezier3_segment(base_ref, idx) } -> std::same_as<std::array<eray::math::Vec3f, 4>>;
 };
 
 using CurveVariant = std::variant<Polyline, MultisegmentBezierCurve, BSplineCurve, NaturalSplineCurve>;
@@ -165,8 +237,36 @@ class Curve : public ObjectBase<Curve, CurveVariant>, public PointListObjectBase
   std::generator<eray::math::Vec3f> polyline_points() const;
   size_t polyline_points_count() const;
 
+  /**
+   * @brief Writes the polyline segments to the output, which must hold `polyline_points_count()` points.
+   *
+   */
+  void write_polyline_points(std::span<eray::math::Vec3f> out) const;
+
   const std::vector<eray::math::Vec3f>& bezier3_points();
 
+  /**
+   * @brief Finalizes the cached Bezier representation and the arc length table. After this call, and until the curve
+   * is modified, the const evaluation methods are reentrant and can be called concurrently from multiple threads.
+   *
+   */
+  void prepare();
+  bool is_prepared() const { return !bezier_dirty_ && !arc_length_dirty_; }
+
+  /**
+   * @brief Marks the Bezier segments [begin_segment, end_segment) dirty, the rest of the `segments_count` segments
+   * are spliced from the cache. Used by the curve types that satisfy `CSplicedCurveType`.
+   *
+   */
+  void mark_bezier3_segments_dirty(size_t begin_segment, size_t end_segment, size_t segments_count);
+
+  /**
+   * @brief Returns the number of leading and trailing Bezier segments that have not changed since the last call and
+   * resets the tracking. Used by the renderer to upload only the spliced segments.
+   *
+   */
+  std::pair<size_t, size_t> take_unchanged_bezier3_segments();
+
   enum class SceneObjectError : uint8_t {
     NotAPoint     = static_cast<uint8_t>(PointList::OperationError::NotAPoint),
     NotFound      = static_cast<uint8_t>(PointList::OperationError::NotFound),
@@ -196,19 +296,99 @@ class Curve : public ObjectBase<Curve, CurveVariant>, public PointListObjectBase
 
   [[nodiscard]] std::pair<eray::math::Vec3f, eray::math::Vec3f> aabb_bounding_box();
 
+  /**
+   * @brief Total length of the curve.
+   *
+   * @return float
+   */
+  [[nodiscard]] float length();
+
+  /**
+   * @brief Evaluates the curve parameterized by the arc length. The length is clamped to [0, length()].
+   *
+   * @param s
+   * @return eray::math::Vec3f
+   */
+  [[nodiscard]] eray::math::Vec3f evaluate_at_length(float s);
+
+  [[nodiscard]] eray::math::Mat4f frenet_frame_at_length(float s);
+
+  /**
+   * @brief Returns `count` points equally spaced along the curve, including both curve ends.
+   *
+   * @param count
+   * @return std::vector<eray::math::Vec3f>
+   */
+  [[nodiscard]] std::vector<eray::math::Vec3f> equally_spaced_points(size_t count);
+
+  // The const overloads never refresh the Bezier cache nor the arc length table, `prepare()` must be called after the
+  // last modification.
+
+  [[nodiscard]] eray::math::Mat4f frenet_frame(float t) const;
+
+  [[nodiscard]] eray::math::Vec3f evaluate(float t) const;
+
+  [[nodiscard]] std::pair<eray::math::Vec3f, eray::math::Vec3f> aabb_bounding_box() const;
+
+  [[nodiscard]] float length() const;
+
+  /**
+   * @brief Maps the arc length to the curve parameter accepted by `evaluate` and `frenet_frame`.
+   *
+   */
+  [[nodiscard]] float param_at_length(float s) const;
+
+  [[nodiscard]] eray::math::Vec3f evaluate_at_length(float s) const;
+
+  [[nodiscard]] eray::math::Mat4f frenet_frame_at_length(float s) const;
+
+  [[nodiscard]] std::vector<eray::math::Vec3f> equally_spaced_points(size_t count) const;
+
  private:
+  /**
+   * @brief Refreshes only the Bezier cache, the arc length table is rebuilt lazily by `prepare()`. Used by the
+   * renderer refresh path and by the evaluation methods that don't depend on the arc length.
+   *
+   */
+  void refresh_bezier3();
+  bool is_bezier3_prepared() const { return !bezier_dirty_; }
+
   void update_indices_from(size_t start_idx);
-  void mark_bezier3_dirty() { bezier_dirty_ = true; }
-  void refresh_bezier3_if_dirty();
+  void mark_bezier3_dirty() {
+    bezier_dirty_       = true;
+    bezier_valid_range_ = {0, 0};
+  }
+
+  /**
+   * @brief Refreshes the curve after the point list has changed, unless the curve type has already reported the
+   * changed segments.
+   *
+   */
+  void on_point_list_changed();
 
  private:
   friend Scene;
   friend PointObject;
 
+  /**
+   * @brief Number of leading and trailing Bezier segments that are still valid.
+   *
+   */
+  using ValidSegments = std::pair<size_t, size_t>;
+
+  static constexpr auto kAllSegmentsValid =
+      ValidSegments{std::numeric_limits<size_t>::max(), std::numeric_limits<size_t>::max()};
+
   std::vector<eray::math::Vec3f> bezier3_points_;
+  ArcLengthTable arc_length_;
+  ValidSegments bezier_valid_range_     = {0, 0};
+  ValidSegments rendered_valid_range_   = kAllSegmentsValid;
+  ValidSegments arc_length_valid_range_ = {0, 0};
   bool bezier_dirty_;
+  bool arc_length_dirty_ = true;
 };
 
 static_assert(CParametricCurveObject<Curve>);
+static_assert(CConcurrentParametricCurveObject<Curve>);
 
 }  // namespace mini
@@ -1,6 +1,7 @@
 #pragma once
 #include <libminicad/scene/patch_surface.hpp>
 #include <libminicad/scene/scene_object.hpp>
+#include <span>
 
 namespace mini {
 
@@ -45,6 +46,10 @@ class FillInSurface : public ObjectBase<FillInSurface, FillInSurfaceVariant> {
   std::generator<eray::math::Vec3f> tangent_grid_points();
   size_t tangent_grid_points_count() { return kNeighbors * 2 * 4; }
 
+  // The writers fill the outputs of the `*_count()` sizes without the coroutine overhead of the generators above.
+  void write_control_grid_points(std::span<eray::math::Vec3f> out);
+  void write_tangent_grid_points(std::span<eray::math::Vec3f> out);
+
   static constexpr size_t kNeighbors        = 3U;
   static constexpr size_t kPatchPointsCount = 20U;
   static constexpr int kDefaultTessLevel    = 4;
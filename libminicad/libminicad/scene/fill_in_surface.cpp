@@ -1,4 +1,5 @@
 #include <algorithm>
+#include <array>
 #include <expected>
 #include <liberay/util/container_extensions.hpp>
 #include <liberay/util/logger.hpp>
@@ -8,6 +9,24 @@
 
 namespace mini {
 
+namespace {
+
+// Indices of the rational Bezier points forming the lines yielded by `tangent_grid_points`
+constexpr auto kTangentGridIndices = std::array<size_t, FillInSurface::kNeighbors * 2 * 4>{
+    2,  17, 1,  16, 4,  5,  8,  9,   // patch 0
+    24, 25, 28, 29, 33, 38, 34, 39,  // patch 1
+    47, 46, 51, 50, 54, 59, 53, 58,  // patch 2
+};
+
+// Indices of the rational Bezier points of a single patch forming the lines yielded by `control_grid_points`
+constexpr auto kControlGridIndices = std::array<size_t, 2 * FillInSurface::kPatchPointsCount>{
+    0,  1,  1,  2,  2,  3,  12, 13, 13, 14, 14, 15,  // vertical
+    0,  4,  4,  8,  8,  12, 3,  7,  7,  11, 11, 15,  // horizontal
+    4,  5,  6,  7,  8,  9,  10, 11, 13, 18, 14, 19, 1, 16, 2, 17,  // inner
+};
+
+}  // namespace
+
 FillInSurface::SurfaceNeighborhood FillInSurface::SurfaceNeighborhood::create(SurfaceNeighbor&& n0,
                                                                               SurfaceNeighbor&& n1,
                                                                               SurfaceNeighbor&& n2) {
@@ -203,6 +222,21 @@ std::generator<eray::math::Vec3f> FillInSurface::control_grid_points() {
   }
 }
 
+void FillInSurface::write_tangent_grid_points(std::span<eray::math::Vec3f> out) {
+  update();
+  std::ranges::transform(kTangentGridIndices, out.begin(), [this](size_t idx) { return rational_bezier_points_[idx]; });
+}
+
+void FillInSurface::write_control_grid_points(std::span<eray::math::Vec3f> out) {
+  update();
+  auto it = out.begin();
+  for (auto i = 0U; i < kNeighbors; ++i) {
+    it = std::ranges::transform(kControlGridIndices, it, [this, i](size_t idx) {
+           return rational_bezier_points_[kPatchPointsCount * i + idx];
+         }).out;
+  }
+}
+
 const std::vector<eray::math::Vec3f>& FillInSurface::rational_bezier_points() {
   update();
   return rational_bezier_points_;
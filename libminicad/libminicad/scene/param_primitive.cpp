@@ -1,70 +1,216 @@
-#include <liberay/util/logger.hpp>
+#include <cmath>
+#include <liberay/math/mat.hpp>
+#include <liberay/math/vec.hpp>
+#include <liberay/util/panic.hpp>
 #include <libminicad/renderer/rendering_command.hpp>
 #include <libminicad/scene/param_primitive.hpp>
 #include <libminicad/scene/scene.hpp>
-#include <limits>
 #include <numbers>
+#include <utility>
+#include <vector>
 
 namespace mini {
 namespace math = eray::math;
 
-eray::math::Mat4f Torus::frenet_frame(const math::Transform3f& transform, const float u, const float v) const {
-  auto p        = evaluate(transform, u, v);
-  auto [dx, dy] = evaluate_derivatives(transform, u, v);
+namespace {
+
+// The const overloads read the caches without refreshing them, so evaluating a modified object would race with the
+// refresh on the other threads
+void ensure_prepared(bool prepared) {
+  if (!prepared) {
+    eray::util::panic("The parametric primitive is evaluated before prepare()");
+  }
+}
+
+}  // namespace
+
+ParamPrimitiveMatrices ParamPrimitiveMatrices::from_transform(const math::Transform3f& transform) {
+  const auto& inv = transform.world_to_local_matrix();
+
+  return ParamPrimitiveMatrices{
+      .world  = transform.local_to_world_matrix(),
+      .normal = math::Mat4f{math::Vec4f(inv[0][0], inv[1][0], inv[2][0], 0.F),  //
+                            math::Vec4f(inv[0][1], inv[1][1], inv[2][1], 0.F),  //
+                            math::Vec4f(inv[0][2], inv[1][2], inv[2][2], 0.F),  //
+                            math::Vec4f(0.F, 0.F, 0.F, 1.F)},
+  };
+}
+
+eray::math::Mat4f Torus::frenet_frame(const ParamPrimitiveMatrices& mats, const float u, const float v) const {
+  const float x = u * 2.F * std::numbers::pi_v<float>;
+  const float y = v * 2.F * std::numbers::pi_v<float>;
+
+  auto p        = evaluate(mats, u, v);
+  auto [dx, dy] = evaluate_derivatives(mats, u, v);
 
   dx = math::normalize(dx);
   dy = math::normalize(dy);
 
-  auto norm = math::normalize(math::cross(dx, dy));
+  auto local_norm = math::Vec4f(std::cos(x) * std::cos(y), std::sin(y), -std::sin(x) * std::cos(y), 0.F);
+  auto norm       = math::normalize(math::Vec3f(mats.normal * local_norm));
 
   return math::Mat4f{math::Vec4f(dx, 0.F), math::Vec4f(norm, 0.F), math::Vec4f(dy, 0.F), math::Vec4f(p, 1.F)};
 }
 
-eray::math::Vec3f Torus::evaluate(const math::Transform3f& transform, float u, float v) const {
+eray::math::Vec3f Torus::evaluate(const ParamPrimitiveMatrices& mats, float u, float v) const {
   const float x = u * 2.F * std::numbers::pi_v<float>;
   const float y = v * 2.F * std::numbers::pi_v<float>;
 
-  auto pos = transform.local_to_world_matrix() *
-             math::Vec4f(std::cos(x) * (minor_radius * std::cos(y) + major_radius), minor_radius * std::sin(y),
-                         -std::sin(x) * (minor_radius * std::cos(y) + major_radius), 1.F);
-  return eray::math::Vec3f(pos);
+  const float ring = minor_radius * std::cos(y) + major_radius;
+
+  auto pos = mats.world * math::Vec4f(std::cos(x) * ring, minor_radius * std::sin(y), -std::sin(x) * ring, 1.F);
+  return math::Vec3f(pos);
 }
 
-std::pair<eray::math::Vec3f, eray::math::Vec3f> Torus::evaluate_derivatives(const math::Transform3f& transform,
+std::pair<eray::math::Vec3f, eray::math::Vec3f> Torus::evaluate_derivatives(const ParamPrimitiveMatrices& mats,
                                                                             const float u, const float v) const {
   const float x = u * 2.F * std::numbers::pi_v<float>;
   const float y = v * 2.F * std::numbers::pi_v<float>;
 
-  auto scale = transform.scale();
+  const float sin_x = std::sin(x);
+  const float cos_x = std::cos(x);
+  const float sin_y = std::sin(y);
+  const float cos_y = std::cos(y);
+
+  const float ring = cos_y * minor_radius + major_radius;
+
+  auto dx = math::Vec4f(-sin_x * ring, 0.F, -cos_x * ring, 0.F);
+  auto dy = math::Vec4f(-sin_y * cos_x * minor_radius, minor_radius * cos_y, minor_radius * sin_x * sin_y, 0.F);
+
+  return std::make_pair(math::Vec3f(mats.world * dx), math::Vec3f(mats.world * dy));
+}
+
+namespace {
+
+/**
+ * @brief Sines and cosines of the grid lines, stored as separate arrays so that the assembly loops stay trivially
+ * vectorizable.
+ *
+ */
+struct GridLinesTrig {
+  std::vector<float> sin;
+  std::vector<float> cos;
 
-  auto dx = math::Vec3f(                                                     //
-      -std::sin(x) * scale.x * (std::cos(y) * minor_radius + major_radius),  //
-      0.F,                                                                   //
-      -std::cos(x) * scale.z * (std::cos(y) * minor_radius + major_radius)   //
-  );
+  static GridLinesTrig create(std::span<const float> params) {
+    auto result = GridLinesTrig{.sin = std::vector<float>(params.size()), .cos = std::vector<float>(params.size())};
+    for (auto i = 0U; i < params.size(); ++i) {
+      const float angle = params[i] * 2.F * std::numbers::pi_v<float>;
+      result.sin[i]     = std::sin(angle);
+      result.cos[i]     = std::cos(angle);
+    }
+    return result;
+  }
+};
 
-  auto dy = math::Vec3f(                                    //
-      -std::sin(y) * std::cos(x) * minor_radius * scale.x,  //
-      scale.y * minor_radius * std::cos(y),                 //
-      minor_radius * scale.z * std::sin(x) * std::sin(y)    //
-  );
+}  // namespace
 
-  auto rot = transform.rot();
+void Torus::evaluate_grid(const ParamPrimitiveMatrices& mats, std::span<const float> us, std::span<const float> vs,
+                          std::span<eray::math::Vec3f> out) const {
+  if (out.size() < us.size() * vs.size()) {
+    eray::util::panic("Torus grid evaluation output is too small. Expected at least {} elements.",
+                      us.size() * vs.size());
+  }
 
-  dx = rot * dx;
-  dy = rot * dy;
+  const auto u_trig = GridLinesTrig::create(us);
+  const auto v_trig = GridLinesTrig::create(vs);
 
-  return std::make_pair(dx, dy);
+  const auto a0 = math::Vec3f(mats.world[0]);
+  const auto a1 = math::Vec3f(mats.world[1]);
+  const auto a2 = math::Vec3f(mats.world[2]);
+  const auto t  = math::Vec3f(mats.world[3]);
+
+  // p(u, v) = ring(v) * (cos(u) * a0 - sin(u) * a2) + height(v) * a1 + t, where ring and height depend on v only
+  auto ring   = std::vector<float>(vs.size());
+  auto offset = std::vector<math::Vec3f>(vs.size());
+  for (auto j = 0U; j < vs.size(); ++j) {
+    ring[j]   = minor_radius * v_trig.cos[j] + major_radius;
+    offset[j] = (minor_radius * v_trig.sin[j]) * a1 + t;
+  }
+
+  for (auto i = 0U; i < us.size(); ++i) {
+    const auto radial = u_trig.cos[i] * a0 - u_trig.sin[i] * a2;
+    auto* row         = out.data() + i * vs.size();
+    for (auto j = 0U; j < vs.size(); ++j) {
+      row[j] = math::Vec3f(ring[j] * radial.x + offset[j].x,  //
+                           ring[j] * radial.y + offset[j].y,  //
+                           ring[j] * radial.z + offset[j].z);
+    }
+  }
+}
+
+void Torus::evaluate_derivatives_grid(const ParamPrimitiveMatrices& mats, std::span<const float> us,
+                                      std::span<const float> vs, std::span<eray::math::Vec3f> out_du,
+                                      std::span<eray::math::Vec3f> out_dv) const {
+  if (out_du.size() < us.size() * vs.size() || out_dv.size() < us.size() * vs.size()) {
+    eray::util::panic("Torus grid evaluation output is too small. Expected at least {} elements.",
+                      us.size() * vs.size());
+  }
+
+  const auto u_trig = GridLinesTrig::create(us);
+  const auto v_trig = GridLinesTrig::create(vs);
+
+  const auto a0 = math::Vec3f(mats.world[0]);
+  const auto a1 = math::Vec3f(mats.world[1]);
+  const auto a2 = math::Vec3f(mats.world[2]);
+
+  // dp/du = ring(v) * (-sin(u) * a0 - cos(u) * a2)
+  // dp/dv = -r * sin(v) * (cos(u) * a0 - sin(u) * a2) + r * cos(v) * a1
+  auto ring    = std::vector<float>(vs.size());
+  auto dv_rad  = std::vector<float>(vs.size());
+  auto dv_axis = std::vector<math::Vec3f>(vs.size());
+  for (auto j = 0U; j < vs.size(); ++j) {
+    ring[j]    = minor_radius * v_trig.cos[j] + major_radius;
+    dv_rad[j]  = -minor_radius * v_trig.sin[j];
+    dv_axis[j] = (minor_radius * v_trig.cos[j]) * a1;
+  }
+
+  for (auto i = 0U; i < us.size(); ++i) {
+    const auto radial  = u_trig.cos[i] * a0 - u_trig.sin[i] * a2;
+    const auto tangent = -u_trig.sin[i] * a0 - u_trig.cos[i] * a2;
+    auto* row_du       = out_du.data() + i * vs.size();
+    auto* row_dv       = out_dv.data() + i * vs.size();
+    for (auto j = 0U; j < vs.size(); ++j) {
+      row_du[j] = math::Vec3f(ring[j] * tangent.x, ring[j] * tangent.y, ring[j] * tangent.z);
+      row_dv[j] = math::Vec3f(dv_rad[j] * radial.x + dv_axis[j].x,  //
+                              dv_rad[j] * radial.y + dv_axis[j].y,  //
+                              dv_rad[j] * radial.z + dv_axis[j].z);
+    }
+  }
 }
 
-std::pair<eray::math::Vec3f, eray::math::Vec3f> Torus::aabb_bounding_box(const math::Transform3f& /*transform*/) const {
-  // TODO(migoox): implement aabb
-  eray::util::Logger::warn("AABB bounding box is not implemented for torus.");
+std::pair<eray::math::Vec3f, eray::math::Vec3f> Torus::aabb_bounding_box(const ParamPrimitiveMatrices& mats) const {
+  const auto& mat = mats.world;
 
-  constexpr auto kFltMax = std::numeric_limits<float>::max();
-  constexpr auto kFltMin = std::numeric_limits<float>::min();
+  // The support of the torus hull along a world axis is R * |(a_x, a_z)| + r * |a|, where a is the corresponding row of
+  // the linear part of the local to world matrix (the major circle lies in the local XZ plane).
+  auto support = [&](int row) {
+    auto a = math::Vec3f(mat[0][row], mat[1][row], mat[2][row]);
+    return major_radius * std::sqrt(a.x * a.x + a.z * a.z) + minor_radius * math::length(a);
+  };
 
-  return std::make_pair(math::Vec3f::filled(kFltMin), math::Vec3f::filled(kFltMax));
+  auto center       = math::Vec3f(mat[3]);
+  auto half_extents = math::Vec3f(support(0), support(1), support(2));
+
+  return std::make_pair(center - half_extents, center + half_extents);
+}
+
+OrientedBoundingBox Torus::oriented_bounding_box(const ParamPrimitiveMatrices& mats) const {
+  const auto& mat = mats.world;
+
+  auto x = math::Vec3f(mat[0]);
+  auto y = math::Vec3f(mat[1]);
+  auto z = math::Vec3f(mat[2]);
+
+  const auto x_len = math::length(x);
+  const auto y_len = math::length(y);
+  const auto z_len = math::length(z);
+
+  return OrientedBoundingBox{
+      .center       = math::Vec3f(mat[3]),
+      .axes         = {x / x_len, y / y_len, z / z_len},
+      .half_extents = math::Vec3f((major_radius + minor_radius) * x_len, minor_radius * y_len,
+                                  (major_radius + minor_radius) * z_len),
+  };
 }
 
 ParamPrimitive::ParamPrimitive(ParamPrimitiveHandle handle, Scene& scene)
@@ -83,6 +229,7 @@ ParamPrimitive::ParamPrimitive(ParamPrimitiveHandle handle, Scene& scene)
 }
 
 void ParamPrimitive::update() {
+  mark_cache_dirty();
   scene().renderer().push_object_rs_cmd(
       ParamPrimitiveRSCommand(handle_, ParamPrimitiveRSCommand::UpdateObjectMembers{}));
 }
@@ -100,31 +247,118 @@ void ParamPrimitive::clone_to(ParamPrimitive& obj) const {
   obj.object     = this->object;
 }
 
+void ParamPrimitive::prepare() {
+  if (!cache_dirty_) {
+    return;
+  }
+
+  matrices_ = ParamPrimitiveMatrices::from_transform(transform_);
+  std::visit(eray::util::match([&](const CParamPrimitiveType auto& param) {
+               aabb_ = param.aabb_bounding_box(matrices_);
+               obb_  = param.oriented_bounding_box(matrices_);
+             }),
+             object);
+  cache_dirty_ = false;
+}
+
+const eray::math::Mat4f& ParamPrimitive::world_matrix() {
+  prepare();
+  return matrices_.world;
+}
+
+const eray::math::Mat4f& ParamPrimitive::normal_matrix() {
+  prepare();
+  return matrices_.normal;
+}
+
 eray::math::Mat4f ParamPrimitive::frenet_frame(float u, float v) {
+  prepare();
+  return std::as_const(*this).frenet_frame(u, v);
+}
+
+eray::math::Vec3f ParamPrimitive::evaluate(float u, float v) {
+  prepare();
+  return std::as_const(*this).evaluate(u, v);
+}
+
+std::pair<eray::math::Vec3f, eray::math::Vec3f> ParamPrimitive::evaluate_derivatives(float u, float v) {
+  prepare();
+  return std::as_const(*this).evaluate_derivatives(u, v);
+}
+
+void ParamPrimitive::evaluate_grid(std::span<const float> us, std::span<const float> vs,
+                                   std::span<eray::math::Vec3f> out) {
+  prepare();
+  std::as_const(*this).evaluate_grid(us, vs, out);
+}
+
+void ParamPrimitive::evaluate_derivatives_grid(std::span<const float> us, std::span<const float> vs,
+                                               std::span<eray::math::Vec3f> out_du,
+                                               std::span<eray::math::Vec3f> out_dv) {
+  prepare();
+  std::as_const(*this).evaluate_derivatives_grid(us, vs, out_du, out_dv);
+}
+
+std::pair<eray::math::Vec3f, eray::math::Vec3f> ParamPrimitive::aabb_bounding_box() {
+  prepare();
+  return aabb_;
+}
+
+OrientedBoundingBox ParamPrimitive::oriented_bounding_box() {
+  prepare();
+  return obb_;
+}
+
+std::pair<eray::math::Vec3f, eray::math::Vec3f> ParamPrimitive::aabb_bounding_box() const {
+  ensure_prepared(is_prepared());
+  return aabb_;
+}
+
+OrientedBoundingBox ParamPrimitive::oriented_bounding_box() const {
+  ensure_prepared(is_prepared());
+  return obb_;
+}
+
+eray::math::Mat4f ParamPrimitive::frenet_frame(float u, float v) const {
+  ensure_prepared(is_prepared());
   return std::visit(
-      eray::util::match([&](const CParamPrimitiveType auto& param) { return param.frenet_frame(transform_, u, v); }),
+      eray::util::match([&](const CParamPrimitiveType auto& param) { return param.frenet_frame(matrices_, u, v); }),
       object);
 }
 
-eray::math::Vec3f ParamPrimitive::evaluate(float u, float v) {
+eray::math::Vec3f ParamPrimitive::evaluate(float u, float v) const {
+  ensure_prepared(is_prepared());
   return std::visit(
-      eray::util::match([&](const CParamPrimitiveType auto& param) { return param.evaluate(transform_, u, v); }),
+      eray::util::match([&](const CParamPrimitiveType auto& param) { return param.evaluate(matrices_, u, v); }),
       object);
 }
 
-std::pair<eray::math::Vec3f, eray::math::Vec3f> ParamPrimitive::evaluate_derivatives(float u, float v) {
+std::pair<eray::math::Vec3f, eray::math::Vec3f> ParamPrimitive::evaluate_derivatives(float u, float v) const {
+  ensure_prepared(is_prepared());
   return std::visit(eray::util::match([&](const CParamPrimitiveType auto& param) {
-                      return param.evaluate_derivatives(transform_, u, v);
+                      return param.evaluate_derivatives(matrices_, u, v);
                     }),
                     object);
 }
 
-std::pair<eray::math::Vec3f, eray::math::Vec3f> ParamPrimitive::aabb_bounding_box() {
-  return std::visit(
-      eray::util::match([&](const CParamPrimitiveType auto& param) { return param.aabb_bounding_box(transform_); }),
+void ParamPrimitive::evaluate_grid(std::span<const float> us, std::span<const float> vs,
+                                   std::span<eray::math::Vec3f> out) const {
+  ensure_prepared(is_prepared());
+  std::visit(
+      eray::util::match([&](const CParamPrimitiveType auto& param) { param.evaluate_grid(matrices_, us, vs, out); }),
       object);
 }
 
+void ParamPrimitive::evaluate_derivatives_grid(std::span<const float> us, std::span<const float> vs,
+                                               std::span<eray::math::Vec3f> out_du,
+                                               std::span<eray::math::Vec3f> out_dv) const {
+  ensure_prepared(is_prepared());
+  std::visit(eray::util::match([&](const CParamPrimitiveType auto& param) {
+               param.evaluate_derivatives_grid(matrices_, us, vs, out_du, out_dv);
+             }),
+             object);
+}
+
 void ParamPrimitive::update_trimming_txt() {
   trimming_manager_.update_final_txt();
   scene().renderer().reupload_texture(txt_handle_, trimming_manager_.final_txt(), trimming_manager_.width(),
@@ -1,24 +1,62 @@
 #pragma once
 
-#include <liberay/math/mat_fwd.hpp>
+#include <liberay/math/mat.hpp>
 #include <liberay/math/vec_fwd.hpp>
 #include <liberay/util/variant_match.hpp>
+#include <libminicad/math/obb.hpp>
 #include <libminicad/scene/scene_object.hpp>
 #include <libminicad/scene/trimming.hpp>
 #include <libminicad/scene/types.hpp>
+#include <span>
 
 #include "liberay/math/transform3_fwd.hpp"
 
 namespace mini {
+
+/**
+ * @brief Matrices derived from the primitive transform. The ParamPrimitive caches them until the transform changes, so
+ * the primitive types never have to touch the transform hierarchy while evaluating.
+ *
+ */
+struct ParamPrimitiveMatrices {
+  eray::math::Mat4f world;   // local to world
+  eray::math::Mat4f normal;  // transposed world to local, transforms the normals
+
+  static ParamPrimitiveMatrices from_transform(const eray::math::Transform3f& transform);
+};
+
 class Torus {
  public:
   [[nodiscard]] static zstring_view type_name() noexcept { return "Torus"; }
 
-  eray::math::Mat4f frenet_frame(const eray::math::Transform3f& transform, float u, float v) const;
-  eray::math::Vec3f evaluate(const eray::math::Transform3f& transform, float u, float v) const;
-  std::pair<eray::math::Vec3f, eray::math::Vec3f> evaluate_derivatives(const eray::math::Transform3f& transform,
-                                                                       float u, float v) const;
-  std::pair<eray::math::Vec3f, eray::math::Vec3f> aabb_bounding_box(const eray::math::Transform3f& transform) const;
+  eray::math::Mat4f frenet_frame(const ParamPrimitiveMatrices& mats, float u, float v) const;
+  eray::math::Vec3f evaluate(const ParamPrimitiveMatrices& mats, float u, float v) const;
+  std::pair<eray::math::Vec3f, eray::math::Vec3f> evaluate_derivatives(const ParamPrimitiveMatrices& mats, float u,
+                                                                       float v) const;
+
+  /**
+   * @brief Evaluates the torus on the `us` x `vs` grid. The result for (us[i], vs[j]) is stored at `out[i * vs.size() +
+   * j]`. The sine and cosine of every grid line are computed only once.
+   *
+   */
+  void evaluate_grid(const ParamPrimitiveMatrices& mats, std::span<const float> us, std::span<const float> vs,
+                     std::span<eray::math::Vec3f> out) const;
+
+  /**
+   * @brief Same layout as `evaluate_grid`.
+   *
+   */
+  void evaluate_derivatives_grid(const ParamPrimitiveMatrices& mats, std::span<const float> us,
+                                 std::span<const float> vs, std::span<eray::math::Vec3f> out_du,
+                                 std::span<eray::math::Vec3f> out_dv) const;
+
+  /**
+   * @brief Exact world space AABB. The convex hull of a torus is a Minkowski sum of its major circle and a ball of the
+   * minor radius, so the support along each world axis can be computed in closed form from the transform.
+   *
+   */
+  std::pair<eray::math::Vec3f, eray::math::Vec3f> aabb_bounding_box(const ParamPrimitiveMatrices& mats) const;
+  OrientedBoundingBox oriented_bounding_box(const ParamPrimitiveMatrices& mats) const;
 
  public:
   float minor_radius           = 1.F;
@@ -27,14 +65,18 @@ class Torus {
 };
 
 template <typename T>
-concept CParamPrimitiveType = requires(T t, float param1, float param2, const eray::math::Transform3f& transform) {
+concept CParamPrimitiveType = requires(T t, float param1, float param2, const ParamPrimitiveMatrices& mats,
+                                       std::span<const float> params, std::span<eray::math::Vec3f> out) {
   { T::type_name() } -> std::same_as<zstring_view>;
-  { t.frenet_frame(transform, param1, param1) } -> std::same_as<eray::math::Mat4f>;
-  { t.evaluate(transform, param1, param2) } -> std::same_as<eray::math::Vec3f>;
+  { t.frenet_frame(mats, param1, param1) } -> std::same_as<eray::math::Mat4f>;
+  { t.evaluate(mats, param1, param2) } -> std::same_as<eray::math::Vec3f>;
   {
-    t.evaluate_derivatives(transform, param1, param2)
+    t.evaluate_derivatives(mats, param1, param2)
   } -> std::same_as<std::pair<eray::math::Vec3f, eray::math::Vec3f>>;
-  { t.aabb_bounding_box(transform) } -> std::same_as<std::pair<eray::math::Vec3f, eray::math::Vec3f>>;
+  { t.evaluate_grid(mats, params, params, out) } -> std::same_as<void>;
+  { t.evaluate_derivatives_grid(mats, params, params, out, out) } -> std::same_as<void>;
+  { t.aabb_bounding_box(mats) } -> std::same_as<std::pair<eray::math::Vec3f, eray::math::Vec3f>>;
+  { t.oriented_bounding_box(mats) } -> std::same_as<OrientedBoundingBox>;
 };
 
 using ParamPrimitiveVariant = std::variant<Torus>;
@@ -57,23 +99,72 @@ class ParamPrimitive : public ObjectBase<ParamPrimitive, ParamPrimitiveVariant>
   eray::math::Vec3f evaluate(float u, float v);
   std::pair<eray::math::Vec3f, eray::math::Vec3f> evaluate_derivatives(float u, float v);
   std::pair<eray::math::Vec3f, eray::math::Vec3f> aabb_bounding_box();
+  OrientedBoundingBox oriented_bounding_box();
+
+  /**
+   * @brief Batch evaluation on the `us` x `vs` grid, see `Torus::evaluate_grid` for the output layout.
+   *
+   */
+  void evaluate_grid(std::span<const float> us, std::span<const float> vs, std::span<eray::math::Vec3f> out);
+  void evaluate_derivatives_grid(std::span<const float> us, std::span<const float> vs,
+                                 std::span<eray::math::Vec3f> out_du, std::span<eray::math::Vec3f> out_dv);
+
+  const eray::math::Mat4f& world_matrix();
+  const eray::math::Mat4f& normal_matrix();
+
+  /**
+   * @brief Finalizes the cached matrices and bounding volumes. After this call, and until the primitive is modified,
+   * the const evaluation methods are reentrant and can be called concurrently from multiple threads.
+   *
+   */
+  void prepare();
+  bool is_prepared() const { return !cache_dirty_; }
+
+  // The const overloads never refresh the caches, `prepare()` must be called after the last modification.
+
+  eray::math::Mat4f frenet_frame(float u, float v) const;
+  eray::math::Vec3f evaluate(float u, float v) const;
+  std::pair<eray::math::Vec3f, eray::math::Vec3f> evaluate_derivatives(float u, float v) const;
+  std::pair<eray::math::Vec3f, eray::math::Vec3f> aabb_bounding_box() const;
+  OrientedBoundingBox oriented_bounding_box() const;
+  void evaluate_grid(std::span<const float> us, std::span<const float> vs, std::span<eray::math::Vec3f> out) const;
+  void evaluate_derivatives_grid(std::span<const float> us, std::span<const float> vs,
+                                 std::span<eray::math::Vec3f> out_du, std::span<eray::math::Vec3f> out_dv) const;
 
   ParamSpaceTrimmingDataManager& trimming_manager() { return trimming_manager_; }
   const ParamSpaceTrimmingDataManager& trimming_manager() const { return trimming_manager_; }
   void update_trimming_txt();
   const TextureHandle& txt_handle() const { return txt_handle_; }
 
-  eray::math::Transform3f& transform() { return transform_; }
+  /**
+   * @brief Mutable access invalidates the cached matrices and bounding volumes. Changes made through a parent
+   * transform must be followed by `update()`.
+   *
+   */
+  eray::math::Transform3f& transform() {
+    mark_cache_dirty();
+    return transform_;
+  }
   const eray::math::Transform3f& transform() const { return transform_; }
 
+ private:
+  void mark_cache_dirty() { cache_dirty_ = true; }
+
  private:
   eray::math::Transform3f transform_;
+
+  ParamPrimitiveMatrices matrices_;
+  std::pair<eray::math::Vec3f, eray::math::Vec3f> aabb_;
+  OrientedBoundingBox obb_;
+  bool cache_dirty_ = true;
+
   ParamSpaceTrimmingDataManager trimming_manager_;
   TextureHandle txt_handle_;
 };
 
 static_assert(CObject<ParamPrimitive>);
 static_assert(CParametricSurfaceObject<ParamPrimitive>);
+static_assert(CConcurrentParametricSurfaceObject<ParamPrimitive>);
 static_assert(CTransformableObject<ParamPrimitive>);
 
 }  // namespace mini
@@ -1,4 +1,7 @@
+#include <algorithm>
+#include <cstdint>
 #include <liberay/util/logger.hpp>
+#include <liberay/util/panic.hpp>
 #include <libminicad/math/bezier3.hpp>
 #include <libminicad/renderer/rendering_command.hpp>
 #include <libminicad/renderer/scene_renderer.hpp>
@@ -7,6 +10,7 @@
 #include <libminicad/scene/patch_surface.hpp>
 #include <libminicad/scene/scene.hpp>
 #include <libminicad/scene/trimming.hpp>
+#include <utility>
 #include <vector>
 
 #include "liberay/math/mat_fwd.hpp"
@@ -16,6 +20,18 @@ namespace mini {
 namespace util = eray::util;
 namespace math = eray::math;
 
+namespace {
+
+// The const overloads read the caches without refreshing them, so evaluating a modified object would race with the
+// refresh on the other threads
+void ensure_prepared(bool prepared) {
+  if (!prepared) {
+    util::panic("The patch surface is evaluated before prepare()");
+  }
+}
+
+}  // namespace
+
 void PatchSurface::init_cylinder_from_curve(const CurveHandle& handle, CylinderPatchSurfaceStarter starter,
                                             eray::math::Vec2u dim) {
   if (!has_type<BPatches>()) {
@@ -63,11 +79,13 @@ void PatchSurface::init_cylinder_from_curve(const CurveHandle& handle, CylinderP
     auto gamma      = std::numbers::pi_v<float> - 2.F * beta;
     auto r          = starter.radius * (1.F + std::tan(alpha_half) * std::tan(gamma));
 
+    // The rings are distributed evenly along the curve, not along its parameter
+    auto curve_length = curve.length();
     for (auto y = 0U; y < points_dim.y; ++y) {
       auto x_idx = 0U;
 
-      auto t         = static_cast<float>(y) / static_cast<float>(points_dim.y);
-      auto frame_mat = curve.frenet_frame(t);
+      auto s         = curve_length * static_cast<float>(y) / static_cast<float>(points_dim.y);
+      auto frame_mat = curve.frenet_frame_at_length(s);
 
       auto p = eray::math::Vec3f::filled(0.F);
       for (auto x = 0U; x < points_dim.x; ++x) {
@@ -368,12 +386,73 @@ eray::math::Vec2u BezierPatches::unique_control_points_dim(const PatchSurfaceSta
                     starter);
 }
 
-const std::vector<eray::math::Vec3f>& PatchSurface::bezier3_points() {
+void PatchSurface::prepare() {
   if (bezier_dirty_) {
     std::visit(eray::util::match{[this](auto& type) { return type.update_bezier3_points(*this); }}, this->object);
     bezier_dirty_ = false;
+
+    dirty_patches_.clear();
+    dirty_patch_flags_.assign(static_cast<size_t>(dim_.x) * dim_.y, false);
+    return;
+  }
+
+  if (!dirty_patches_.empty()) {
+    std::visit(eray::util::match{[this](auto& type) {
+                 for (auto patch_idx : dirty_patches_) {
+                   type.update_bezier3_patch(*this, patch_idx % dim_.x, patch_idx / dim_.x);
+                   dirty_patch_flags_[patch_idx] = false;
+                 }
+               }},
+               this->object);
+    dirty_patches_.clear();
+  }
+}
+
+void PatchSurface::mark_control_point_dirty(const PointObjectHandle& handle) {
+  auto it = points_.unsafe_points_map().find(handle);
+  if (it == points_.unsafe_points_map().end()) {
+    return;
+  }
+
+  // A point might occur more than once, e.g. the seam of a cylinder
+  auto track_patches = !bezier_dirty_ && dirty_patch_flags_.size() == static_cast<size_t>(dim_.x) * dim_.y;
+  for (auto point_idx : it->second) {
+    auto range = std::visit(
+        eray::util::match{[&](const auto& type) { return type.dependent_patches(point_idx, dim_); }}, this->object);
+    rendered_dirty_range_.merge(range);
+
+    if (!track_patches) {
+      continue;
+    }
+    for (auto y = range.begin.y; y < range.end.y; ++y) {
+      for (auto x = range.begin.x; x < range.end.x; ++x) {
+        auto patch_idx = static_cast<size_t>(y) * dim_.x + x;
+        if (!dirty_patch_flags_[patch_idx]) {
+          dirty_patch_flags_[patch_idx] = true;
+          dirty_patches_.push_back(patch_idx);
+        }
+      }
+    }
   }
 
+  if (!track_patches) {
+    mark_bezier3_dirty();
+  }
+
+  scene().renderer().push_object_rs_cmd(
+      PatchSurfaceRSCommand(handle_, PatchSurfaceRSCommand::Internal::UpdatePatches{}));
+}
+
+PatchRange PatchSurface::take_dirty_patch_range() {
+  auto range = rendered_dirty_range_;
+  range.end  = eray::math::min(range.end, dim_);
+
+  rendered_dirty_range_ = PatchRange{.begin = eray::math::Vec2u(0, 0), .end = eray::math::Vec2u(0, 0)};
+  return range;
+}
+
+const std::vector<eray::math::Vec3f>& PatchSurface::bezier3_points() {
+  prepare();
   return bezier3_points_;
 }
 
@@ -400,12 +479,38 @@ std::generator<eray::math::Vec3f> PatchSurface::control_grid_points() const {
 }
 
 size_t PatchSurface::control_grid_points_count() const {
+  if (dim_.x == 0 || dim_.y == 0) {
+    return 0;
+  }
   auto dim =
       std::visit(eray::util::match{[this](const auto& type) { return type.control_points_dim(dim_); }}, this->object);
 
   return 2 * ((dim.y - 1) * dim.x + dim.y * (dim.x - 1));
 }
 
+void PatchSurface::write_control_grid_points(std::span<eray::math::Vec3f> out) const {
+  if (dim_.x == 0 || dim_.y == 0) {
+    return;
+  }
+  auto dim =
+      std::visit(eray::util::match{[this](const auto& type) { return type.control_points_dim(dim_); }}, this->object);
+
+  auto idx = size_t{0};
+  for (auto row = 0U; row < dim.y; ++row) {
+    for (auto col = 0U; col < dim.x - 1; ++col) {
+      out[idx++] = points_.unsafe_by_idx(dim.x * row + col).transform().pos();
+      out[idx++] = points_.unsafe_by_idx(dim.x * row + col + 1).transform().pos();
+    }
+  }
+
+  for (auto row = 0U; row < dim.y - 1; ++row) {
+    for (auto col = 0U; col < dim.x; ++col) {
+      out[idx++] = points_.unsafe_by_idx(dim.x * row + col).transform().pos();
+      out[idx++] = points_.unsafe_by_idx(dim.x * (row + 1) + col).transform().pos();
+    }
+  }
+}
+
 void PatchSurface::set_tess_level(int tesselation) {
   // fix tesselation
   auto st     = static_cast<int>(std::sqrt(tesselation));
@@ -437,19 +542,40 @@ void BezierPatches::update_bezier3_points(PatchSurface& base) {
   }
 
   base.bezier3_points_.resize(base.dim_.x * base.dim_.y * PatchSurface::kPatchSize * PatchSurface::kPatchSize);
-  auto idx = 0U;
   for (auto row = 0U; row < base.dim_.y; ++row) {
     for (auto col = 0U; col < base.dim_.x; ++col) {
-      for (auto in_row = 0U; in_row < PatchSurface::kPatchSize; ++in_row) {
-        for (auto in_col = 0U; in_col < PatchSurface::kPatchSize; ++in_col) {
-          base.bezier3_points_[idx++] =
-              base.points_.unsafe_by_idx(find_idx(col, row, in_col, in_row, base.dim_.x)).transform().pos();
-        }
-      }
+      update_bezier3_patch(base, col, row);
+    }
+  }
+}
+
+void BezierPatches::update_bezier3_patch(PatchSurface& base, size_t patch_x, size_t patch_y) {
+  auto idx = (patch_y * base.dim_.x + patch_x) * PatchSurface::kPatchSize * PatchSurface::kPatchSize;
+  for (auto in_row = 0U; in_row < PatchSurface::kPatchSize; ++in_row) {
+    for (auto in_col = 0U; in_col < PatchSurface::kPatchSize; ++in_col) {
+      base.bezier3_points_[idx++] =
+          base.points_.unsafe_by_idx(find_idx(patch_x, patch_y, in_col, in_row, base.dim_.x)).transform().pos();
     }
   }
 }
 
+PatchRange BezierPatches::dependent_patches(size_t point_idx, eray::math::Vec2u dim) {
+  // The points on the patch borders are shared by the neighbouring patches
+  static constexpr auto kStep = static_cast<size_t>(PatchSurface::kPatchSize - 1);
+
+  auto size_x = find_size_x(dim.x);
+  auto col    = point_idx % size_x;
+  auto row    = point_idx / size_x;
+
+  auto begin = [](size_t i) { return static_cast<uint32_t>(i == 0 ? 0 : (i - 1) / kStep); };
+  auto end   = [](size_t i, uint32_t patches) { return std::min(static_cast<uint32_t>(i / kStep + 1), patches); };
+
+  return PatchRange{
+      .begin = eray::math::Vec2u(begin(col), begin(row)),
+      .end   = eray::math::Vec2u(end(col, dim.x), end(row, dim.y)),
+  };
+}
+
 size_t BezierPatches::find_idx(size_t patch_x, size_t patch_y, size_t point_x, size_t point_y, size_t dim_x) {
   return ((PatchSurface::kPatchSize - 1) * dim_x + 1) * ((PatchSurface::kPatchSize - 1) * patch_y + point_y) +
          ((PatchSurface::kPatchSize - 1) * patch_x + point_x);
@@ -537,37 +663,60 @@ void BPatches::update_bezier3_points(PatchSurface& base) {
   }
 
   base.bezier3_points_.resize(base.dim_.x * base.dim_.y * PatchSurface::kPatchSize * PatchSurface::kPatchSize);
-
-  math::Vec3f bezier_patch[4][4];
-  auto idx = 0U;
   for (auto y = 0U; y < dim.y; ++y) {
     for (auto x = 0U; x < dim.x; ++x) {
-      for (auto ix = 0U; ix < PatchSurface::kPatchSize; ++ix) {
-        auto p0 = base.points_.unsafe_by_idx(find_idx(x, y, ix, 0, dim.x)).transform().pos();
-        auto p1 = base.points_.unsafe_by_idx(find_idx(x, y, ix, 1, dim.x)).transform().pos();
-        auto p2 = base.points_.unsafe_by_idx(find_idx(x, y, ix, 2, dim.x)).transform().pos();
-        auto p3 = base.points_.unsafe_by_idx(find_idx(x, y, ix, 3, dim.x)).transform().pos();
-
-        bezier_patch[ix][0] = (p0 + 4 * p1 + p2) / 6.0;
-        bezier_patch[ix][1] = (4 * p1 + 2 * p2) / 6.0;
-        bezier_patch[ix][2] = (2 * p1 + 4 * p2) / 6.0;
-        bezier_patch[ix][3] = (p1 + 4 * p2 + p3) / 6.0;
-      }
-      for (auto iy = 0U; iy < PatchSurface::kPatchSize; ++iy) {
-        auto c0 = bezier_patch[0][iy];
-        auto c1 = bezier_patch[1][iy];
-        auto c2 = bezier_patch[2][iy];
-        auto c3 = bezier_patch[3][iy];
-
-        base.bezier3_points_[idx++] = (c0 + 4.0 * c1 + c2) / 6.0;
-        base.bezier3_points_[idx++] = (4.0 * c1 + 2.0 * c2) / 6.0;
-        base.bezier3_points_[idx++] = (2.0 * c1 + 4.0 * c2) / 6.0;
-        base.bezier3_points_[idx++] = (c1 + 4.0 * c2 + c3) / 6.0;
-      }
+      update_bezier3_patch(base, x, y);
     }
   }
 }
 
+void BPatches::update_bezier3_patch(PatchSurface& base, size_t patch_x, size_t patch_y) {
+  auto dim = base.dimensions();
+
+  math::Vec3f bezier_patch[4][4];
+  for (auto ix = 0U; ix < PatchSurface::kPatchSize; ++ix) {
+    auto p0 = base.points_.unsafe_by_idx(find_idx(patch_x, patch_y, ix, 0, dim.x)).transform().pos();
+    auto p1 = base.points_.unsafe_by_idx(find_idx(patch_x, patch_y, ix, 1, dim.x)).transform().pos();
+    auto p2 = base.points_.unsafe_by_idx(find_idx(patch_x, patch_y, ix, 2, dim.x)).transform().pos();
+    auto p3 = base.points_.unsafe_by_idx(find_idx(patch_x, patch_y, ix, 3, dim.x)).transform().pos();
+
+    bezier_patch[ix][0] = (p0 + 4 * p1 + p2) / 6.0;
+    bezier_patch[ix][1] = (4 * p1 + 2 * p2) / 6.0;
+    bezier_patch[ix][2] = (2 * p1 + 4 * p2) / 6.0;
+    bezier_patch[ix][3] = (p1 + 4 * p2 + p3) / 6.0;
+  }
+
+  auto idx = (patch_y * dim.x + patch_x) * PatchSurface::kPatchSize * PatchSurface::kPatchSize;
+  for (auto iy = 0U; iy < PatchSurface::kPatchSize; ++iy) {
+    auto c0 = bezier_patch[0][iy];
+    auto c1 = bezier_patch[1][iy];
+    auto c2 = bezier_patch[2][iy];
+    auto c3 = bezier_patch[3][iy];
+
+    base.bezier3_points_[idx++] = (c0 + 4.0 * c1 + c2) / 6.0;
+    base.bezier3_points_[idx++] = (4.0 * c1 + 2.0 * c2) / 6.0;
+    base.bezier3_points_[idx++] = (2.0 * c1 + 4.0 * c2) / 6.0;
+    base.bezier3_points_[idx++] = (c1 + 4.0 * c2 + c3) / 6.0;
+  }
+}
+
+PatchRange BPatches::dependent_patches(size_t point_idx, eray::math::Vec2u dim) {
+  // Every patch depends on the 4x4 neighbourhood of the de Boor points
+  static constexpr auto kSpan = static_cast<size_t>(PatchSurface::kPatchSize - 1);
+
+  auto size_x = find_size_x(dim.x);
+  auto col    = point_idx % size_x;
+  auto row    = point_idx / size_x;
+
+  auto begin = [](size_t i) { return static_cast<uint32_t>(std::max(i, kSpan) - kSpan); };
+  auto end   = [](size_t i, uint32_t patches) { return std::min(static_cast<uint32_t>(i + 1), patches); };
+
+  return PatchRange{
+      .begin = eray::math::Vec2u(begin(col), begin(row)),
+      .end   = eray::math::Vec2u(end(col, dim.x), end(row, dim.y)),
+  };
+}
+
 size_t BPatches::find_idx(size_t patch_x, size_t patch_y, size_t point_x, size_t point_y, size_t dim_x) {
   return (patch_y + point_y) * (dim_x + PatchSurface::kPatchSize - 1) + (patch_x + point_x);
 }
@@ -671,73 +820,38 @@ void PatchSurface::clone_to(PatchSurface& obj) const {
   obj.update();
 }
 
-std::pair<eray::math::Vec2f, eray::math::Vec2u> PatchSurface::find_bezier3_patch_and_param(float u, float v) const {
-  auto param = eray::math::Vec2f(u, v);
-
-  auto patch_size   = 1.F / eray::math::Vec2f(static_cast<float>(dim_.x), static_cast<float>(dim_.y));
-  auto patch_coords = param / patch_size;
-
-  const auto coord_x =
-      static_cast<uint32_t>(std::clamp(static_cast<int>(patch_coords.x), 0, static_cast<int>(dim_.x) - 1));
-  const auto coord_y =
-      static_cast<uint32_t>(std::clamp(static_cast<int>(patch_coords.y), 0, static_cast<int>(dim_.y) - 1));
-
-  patch_coords = eray::math::Vec2f(static_cast<float>(coord_x), static_cast<float>(coord_y));
-
-  // Map to to the patch
-  param = (param - patch_coords * patch_size) / patch_size;
-
-  return std::make_pair(param, math::Vec2u(coord_x, coord_y));
-}
-
 eray::math::Vec3f PatchSurface::evaluate(float u, float v) {
-  auto points = bezier3_points();
-  if (points.empty()) {
-    return math::Vec3f::zeros();
-  }
-
-  auto [param, patch_coords] = find_bezier3_patch_and_param(u, v);
-
-  auto pu  = std::array<math::Vec3f, kPatchSize>();
-  auto idx = kPatchSize * kPatchSize * dim_.x * patch_coords.y + kPatchSize * kPatchSize * patch_coords.x;
-  for (auto i = 0U; i < kPatchSize; ++i) {
-    auto curr_row_idx = idx + kPatchSize * i;
-    pu[i] = bezier3(points[curr_row_idx], points[curr_row_idx + 1], points[curr_row_idx + 2], points[curr_row_idx + 3],
-                    param.x);
-  }
-  return bezier3(pu[0], pu[1], pu[2], pu[3], param.y);
+  prepare();
+  return std::as_const(*this).evaluate(u, v);
 }
 
 std::pair<eray::math::Vec3f, eray::math::Vec3f> PatchSurface::evaluate_derivatives(float u, float v) {
-  auto points = bezier3_points();
-  if (points.empty()) {
-    return std::make_pair(math::Vec3f::zeros(), math::Vec3f::zeros());
-  }
-
-  auto [param, patch_coords] = find_bezier3_patch_and_param(u, v);
+  prepare();
+  return std::as_const(*this).evaluate_derivatives(u, v);
+}
 
-  auto pu  = std::array<math::Vec3f, kPatchSize>();
-  auto pv  = std::array<math::Vec3f, kPatchSize>();
-  auto idx = kPatchSize * kPatchSize * dim_.x * patch_coords.y + kPatchSize * kPatchSize * patch_coords.x;
-  for (auto i = 0U; i < kPatchSize; ++i) {
-    auto pu_idx = idx + kPatchSize * i;
-    pu[i]       = bezier3(points[pu_idx], points[pu_idx + 1], points[pu_idx + 2], points[pu_idx + 3], param.x);
+std::pair<eray::math::Vec3f, eray::math::Vec3f> PatchSurface::aabb_bounding_box() {
+  prepare();
+  return std::as_const(*this).aabb_bounding_box();
+}
 
-    auto pv_idx = idx + i;
-    pv[i]       = bezier3(points[pv_idx], points[pv_idx + kPatchSize], points[pv_idx + 2 * kPatchSize],
-                          points[pv_idx + 3 * kPatchSize], param.y);
-  }
+eray::math::Vec3f PatchSurface::evaluate(float u, float v) const {
+  ensure_prepared(is_prepared());
+  return bezier3_patches(bezier3_points_, dim_, u, v);
+}
 
-  return std::make_pair(bezier3_dt(pv[0], pv[1], pv[2], pv[3], param.x),
-                        bezier3_dt(pu[0], pu[1], pu[2], pu[3], param.y));
+std::pair<eray::math::Vec3f, eray::math::Vec3f> PatchSurface::evaluate_derivatives(float u, float v) const {
+  ensure_prepared(is_prepared());
+  return bezier3_patches_derivatives(bezier3_points_, dim_, u, v);
 }
 
 std::pair<eray::math::Vec3f, eray::math::Vec3f> PatchSurface::aabb_bounding_box() const {
-  static constexpr auto kFltMin = std::numeric_limits<float>::min();
-  static constexpr auto kFltMax = std::numeric_limits<float>::max();
+  ensure_prepared(is_prepared());
+  static constexpr auto kFltLowest = std::numeric_limits<float>::lowest();
+  static constexpr auto kFltMax    = std::numeric_limits<float>::max();
 
   auto min = eray::math::Vec3f::filled(kFltMax);
-  auto max = eray::math::Vec3f::filled(kFltMin);
+  auto max = eray::math::Vec3f::filled(kFltLowest);
 
   for (const auto& p : bezier3_points_) {
     min = eray::math::min(p, min);
@@ -755,7 +869,7 @@ void PatchSurface::update_trimming_txt() {
       PatchSurfaceRSCommand(handle_, PatchSurfaceRSCommand::Internal::UpdateTrimmingTextures{}));
 }
 
-eray::math::Mat4f PatchSurface::frenet_frame(float /*u*/, float /*v*/) {
+eray::math::Mat4f PatchSurface::frenet_frame(float /*u*/, float /*v*/) const {
   eray::util::Logger::err("Frenet frame not implemented!");
   return math::Mat4f::identity();
 }
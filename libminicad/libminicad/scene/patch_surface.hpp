@@ -7,6 +7,7 @@
 #include <libminicad/scene/scene_object.hpp>
 #include <libminicad/scene/trimming.hpp>
 #include <libminicad/scene/types.hpp>
+#include <span>
 
 namespace mini {
 
@@ -26,6 +27,33 @@ struct CylinderPatchSurfaceStarter {
 
 using PatchSurfaceStarter = std::variant<PlanePatchSurfaceStarter, CylinderPatchSurfaceStarter>;
 
+/**
+ * @brief Rectangle [begin, end) of patches in the patch grid coordinates.
+ *
+ */
+struct PatchRange {
+  eray::math::Vec2u begin;
+  eray::math::Vec2u end;
+
+  [[nodiscard]] bool empty() const { return begin.x >= end.x || begin.y >= end.y; }
+
+  /**
+   * @brief Extends the range, so it contains the other range as well.
+   *
+   */
+  void merge(const PatchRange& other) {
+    if (other.empty()) {
+      return;
+    }
+    if (empty()) {
+      *this = other;
+      return;
+    }
+    begin = eray::math::min(begin, other.begin);
+    end   = eray::math::max(end, other.end);
+  }
+};
+
 struct BezierPatches {
  public:
   [[nodiscard]] static zstring_view type_name() noexcept { return "Bezier Patches"; }
@@ -42,6 +70,18 @@ struct BezierPatches {
    */
   void update_bezier3_points(PatchSurface& base);
 
+  /**
+   * @brief Converts a single patch to the Bezier basis, the patch occupies 16 consecutive Bezier points.
+   *
+   */
+  void update_bezier3_patch(PatchSurface& base, size_t patch_x, size_t patch_y);
+
+  /**
+   * @brief Returns the patches that depend on the control point with the given index in the control points grid.
+   *
+   */
+  [[nodiscard]] static PatchRange dependent_patches(size_t point_idx, eray::math::Vec2u dim);
+
   static size_t find_idx(size_t patch_x, size_t patch_y, size_t point_x, size_t point_y, size_t dim_x);
   static size_t find_patch_offset(size_t patch_x, size_t patch_y, size_t dim_x);
   static size_t find_size_x(size_t dim_x);
@@ -63,6 +103,18 @@ struct BPatches {
    */
   void update_bezier3_points(PatchSurface& base);
 
+  /**
+   * @brief Converts a single patch to the Bezier basis, the patch occupies 16 consecutive Bezier points.
+   *
+   */
+  void update_bezier3_patch(PatchSurface& base, size_t patch_x, size_t patch_y);
+
+  /**
+   * @brief Returns the patches that depend on the control point with the given index in the control points grid.
+   *
+   */
+  [[nodiscard]] static PatchRange dependent_patches(size_t point_idx, eray::math::Vec2u dim);
+
   static size_t find_idx(size_t patch_x, size_t patch_y, size_t point_x, size_t point_y, size_t dim_x);
   static size_t find_patch_offset(size_t patch_x, size_t patch_y, size_t dim_x);
   static size_t find_size_x(size_t dim_x);
@@ -80,7 +132,9 @@ concept CPatchSurfaceType =
       { T::find_idx(idx, idx, idx, idx, idx) } -> std::same_as<size_t>;
       { T::find_patch_offset(idx, idx, idx) } -> std::same_as<size_t>;
       { T::find_size_x(idx) } -> std::same_as<size_t>;
+      { T::dependent_patches(idx, dim) } -> std::same_as<PatchRange>;
       { t.update_bezier3_points(base) } -> std::same_as<void>;
+      { t.update_bezier3_patch(base, idx, idx) } -> std::same_as<void>;
     };
 
 using PatchSurfaceVariant = std::variant<BezierPatches, BPatches>;
@@ -123,8 +177,29 @@ class PatchSurface : public ObjectBase<PatchSurface, PatchSurfaceVariant>, publi
   std::generator<eray::math::Vec3f> control_grid_points() const;
   size_t control_grid_points_count() const;
 
+  /**
+   * @brief Writes the control grid lines to the output, which must hold `control_grid_points_count()` points.
+   *
+   */
+  void write_control_grid_points(std::span<eray::math::Vec3f> out) const;
+
   const std::vector<eray::math::Vec3f>& bezier3_points();
 
+  /**
+   * @brief Finalizes the cached Bezier patches. After this call, and until the surface is modified, the const
+   * evaluation methods are reentrant and can be called concurrently from multiple threads.
+   *
+   */
+  void prepare();
+  bool is_prepared() const { return !bezier_dirty_ && dirty_patches_.empty(); }
+
+  /**
+   * @brief Returns the patches whose control points moved since the last call and resets the tracking. The range is
+   * empty if nothing moved. Used by the renderer to upload only the affected patches.
+   *
+   */
+  PatchRange take_dirty_patch_range();
+
   enum class InitError : uint8_t {
     PointsAndDimensionsMismatch = 0,
     SceneObjectIsNotAPoint      = 1,
@@ -165,12 +240,20 @@ class PatchSurface : public ObjectBase<PatchSurface, PatchSurfaceVariant>, publi
    * @param t
    * @return eray::math::Mat4f
    */
-  [[nodiscard]] eray::math::Mat4f frenet_frame(float u, float v);
+  [[nodiscard]] eray::math::Mat4f frenet_frame(float u, float v) const;
 
   [[nodiscard]] eray::math::Vec3f evaluate(float u, float v);
 
   [[nodiscard]] std::pair<eray::math::Vec3f, eray::math::Vec3f> evaluate_derivatives(float u, float v);
 
+  [[nodiscard]] std::pair<eray::math::Vec3f, eray::math::Vec3f> aabb_bounding_box();
+
+  // The const overloads never refresh the Bezier cache, `prepare()` must be called after the last modification.
+
+  [[nodiscard]] eray::math::Vec3f evaluate(float u, float v) const;
+
+  [[nodiscard]] std::pair<eray::math::Vec3f, eray::math::Vec3f> evaluate_derivatives(float u, float v) const;
+
   [[nodiscard]] std::pair<eray::math::Vec3f, eray::math::Vec3f> aabb_bounding_box() const;
 
   ParamSpaceTrimmingDataManager& trimming_manager() { return trimming_manager_; }
@@ -180,11 +263,17 @@ class PatchSurface : public ObjectBase<PatchSurface, PatchSurfaceVariant>, publi
 
  private:
   void mark_bezier3_dirty() { bezier_dirty_ = true; }
-  void clear();
 
-  std::pair<eray::math::Vec2f, eray::math::Vec2u> find_bezier3_patch_and_param(float u, float v) const;
+  /**
+   * @brief Marks only the patches that depend on the moved control point for the conversion.
+   *
+   */
+  void mark_control_point_dirty(const PointObjectHandle& handle);
+
+  void clear();
 
  private:
+  friend Scene;
   friend PointObject;
   friend Point;
   friend BezierPatches;
@@ -196,11 +285,16 @@ class PatchSurface : public ObjectBase<PatchSurface, PatchSurfaceVariant>, publi
   std::vector<eray::math::Vec3f> bezier3_points_;  // row-major packed patches
   bool bezier_dirty_ = true;
 
+  std::vector<size_t> dirty_patches_;  // row-major indices of the patches waiting for the conversion
+  std::vector<bool> dirty_patch_flags_;
+  PatchRange rendered_dirty_range_ = {.begin = eray::math::Vec2u(0, 0), .end = eray::math::Vec2u(0, 0)};
+
   std::unordered_set<FillInSurfaceHandle> fill_in_surfaces_;
   ParamSpaceTrimmingDataManager trimming_manager_;
   TextureHandle txt_handle_;
 };
 
 static_assert(CParametricSurfaceObject<PatchSurface>);
+static_assert(CConcurrentParametricSurfaceObject<PatchSurface>);
 
 }  // namespace mini
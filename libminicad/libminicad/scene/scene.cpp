@@ -8,7 +8,10 @@
 #include <libminicad/scene/scene_object.hpp>
 #include <memory>
 #include <optional>
+#include <span>
 #include <type_traits>
+#include <unordered_map>
+#include <unordered_set>
 #include <variant>
 
 namespace mini {
@@ -17,7 +20,7 @@ std::uint32_t Scene::next_signature_ = 0;
 
 Scene::Scene(std::unique_ptr<ISceneRenderer>&& renderer)
     : renderer_(std::move(renderer)), signature_(next_signature_++) {
-  arena<PointObject>().init(kMaxObjects, signature_);
+  arena<PointObject>().init(kMaxPointObjects, signature_);
   arena<Curve>().init(kMaxObjects, signature_);
   arena<PatchSurface>().init(kMaxObjects, signature_);
   arena<FillInSurface>().init(kMaxObjects, signature_);
@@ -48,6 +51,73 @@ bool Scene::remove_point_from_curve(const PointObjectHandle& p_handle, const Cur
   return false;
 }
 
+void Scene::update_points(std::span<const PointObjectHandle> handles) {
+  struct CurveUpdate {
+    size_t moved_points;
+    PointObjectHandle last_point;
+  };
+
+  auto curves           = std::unordered_map<CurveHandle, CurveUpdate>();
+  auto fill_in_surfaces = std::unordered_set<FillInSurfaceHandle>();
+
+  for (const auto& handle : handles) {
+    auto p = arena<PointObject>().get_obj(handle);
+    if (!p) {
+      continue;
+    }
+    auto& point = **p;
+    renderer_->push_object_rs_cmd(PointObjectRSCommand(handle, PointObjectRSCommand::UpdateObjectMembers{}));
+
+    // Only points might be a part of the point lists
+    if (!point.has_type<Point>()) {
+      continue;
+    }
+
+    for (const auto& c_h : point.curves_) {
+      auto& update = curves.try_emplace(c_h, CurveUpdate{.moved_points = 0, .last_point = handle}).first->second;
+      ++update.moved_points;
+      update.last_point = handle;
+    }
+
+    // The patch surfaces track the dirty patches per control point, which is cheap enough to do for each point
+    for (const auto& ps_h : point.patch_surfaces_) {
+      if (auto ps = arena<PatchSurface>().get_obj(ps_h)) {
+        ps.value()->mark_control_point_dirty(handle);
+      }
+    }
+
+    fill_in_surfaces.insert(point.fill_in_surfaces_.begin(), point.fill_in_surfaces_.end());
+  }
+
+  for (const auto& [c_h, update] : curves) {
+    auto c = arena<Curve>().get_obj(c_h);
+    if (!c) {
+      continue;
+    }
+    auto& curve = **c;
+
+    curve.mark_bezier3_dirty();
+    renderer_->push_object_rs_cmd(CurveRSCommand(c_h, CurveRSCommand::Internal::UpdateControlPoints{}));
+    if (update.moved_points == 1) {
+      auto& point = arena<PointObject>().unsafe_at(update.last_point);
+      std::visit(eray::util::match{[&](auto& obj) {
+                   obj.on_point_update(curve, point, point.unsafe_get_variant<Point>());
+                 }},
+                 curve.object);
+    } else {
+      std::visit(eray::util::match{[&](auto& obj) { obj.on_points_update(curve); }}, curve.object);
+    }
+  }
+
+  for (const auto& fs_h : fill_in_surfaces) {
+    if (auto fs = arena<FillInSurface>().get_obj(fs_h)) {
+      fs.value()->mark_points_dirty();
+      renderer_->push_object_rs_cmd(
+          FillInSurfaceRSCommand(fs_h, FillInSurfaceRSCommand::Internal::UpdateControlPoints{}));
+    }
+  }
+}
+
 void Scene::remove_from_order(size_t ind) {
   for (size_t i = ind + 1; i < objects_order_.size(); ++i) {
     std::visit(eray::util::match{[&](const auto& handle) {
@@ -57,11 +127,13 @@ void Scene::remove_from_order(size_t ind) {
                objects_order_[i]);
   }
   objects_order_.erase(objects_order_.begin() + static_cast<int>(ind));
+  ++objects_version_;
 }
 
 void Scene::clear() {
   std::apply([](auto&... arena) { ((arena.clear()), ...); }, arenas_);
   objects_order_.clear();
+  ++objects_version_;
   renderer_->clear();
 }
 
@@ -17,8 +17,10 @@
 #include <libminicad/scene/handles.hpp>
 #include <libminicad/scene/param_primitive.hpp>
 #include <libminicad/scene/patch_surface.hpp>
+#include <libminicad/scene/scene_snapshot.hpp>
 #include <libminicad/scene/triangle.hpp>
 #include <memory>
+#include <span>
 #include <vector>
 
 namespace mini {
@@ -49,6 +51,14 @@ class Scene {
   }
 
   bool push_back_point_to_curve(const PointObjectHandle& p_handle, const CurveHandle& c_handle);
+
+  /**
+   * @brief Refreshes the moved points and the objects depending on them. Every dependent curve and fill in surface is
+   * refreshed once, no matter how many of its points have moved, so prefer it over calling `PointObject::update` for
+   * each point of a large selection.
+   *
+   */
+  void update_points(std::span<const PointObjectHandle> handles);
   bool remove_point_from_curve(const PointObjectHandle& p_handle, const CurveHandle& c_handle);
 
   /**
@@ -103,6 +113,7 @@ class Scene {
     auto handle             = obj.value()->handle();
     obj.value()->order_idx_ = objects_order_.size();
     objects_order_.emplace_back(handle);
+    ++objects_version_;
 
     return std::move(*obj);
   }
@@ -117,6 +128,7 @@ class Scene {
     auto& obj          = arena<TObject>().unsafe_at(handle);
     obj.order_idx_     = objects_order_.size();
     objects_order_.emplace_back(handle);
+    ++objects_version_;
 
     return handle;
   }
@@ -133,6 +145,7 @@ class Scene {
       obj.order_idx_ = objects_order_.size();
       objects_order_.emplace_back(handle);
     }
+    ++objects_version_;
 
     return *h;
   }
@@ -167,6 +180,21 @@ class Scene {
 
   const std::vector<ObjectHandle>& handles() const { return objects_order_; }
 
+  /**
+   * @brief Changes whenever an object is added, removed or renamed, so the views of the objects list (e.g. the
+   * filtered list in the UI) may be cached and rebuilt only when this value differs.
+   *
+   */
+  size_t objects_version() const { return objects_version_; }
+
+  /**
+   * @brief Creates an immutable copy of the scene geometry, which can be read by worker threads while the scene is
+   * being edited.
+   *
+   * @return std::shared_ptr<const SceneSnapshot>
+   */
+  std::shared_ptr<const SceneSnapshot> snapshot() { return SceneSnapshot::create(*this); }
+
   /**
    * @brief Calls renderer update, which fetches the commands from the queues and applies the changes
    * to the rendering state.
@@ -179,7 +207,8 @@ class Scene {
   void clear();
 
  public:
-  static constexpr std::size_t kMaxObjects = 10000;
+  static constexpr std::size_t kMaxObjects      = 10000;
+  static constexpr std::size_t kMaxPointObjects = 65536;
 
  private:
   void remove_from_order(size_t ind);
@@ -189,6 +218,9 @@ class Scene {
   friend Curve;
   friend FillInSurface;
 
+  template <typename TObject, typename TVariant>
+  friend class ObjectBase;
+
   std::unique_ptr<ISceneRenderer> renderer_;
 
   static std::uint32_t next_signature_;
@@ -199,8 +231,15 @@ class Scene {
       arenas_;
 
   std::vector<ObjectHandle> objects_order_;
+  size_t objects_version_{0};
 
   std::unordered_set<Triangle> fill_in_surface_triangles_;
 };
 
+template <typename TObject, typename TVariant>
+void ObjectBase<TObject, TVariant>::set_name(std::string&& new_name) {
+  name = std::move(new_name);
+  ++scene_.get().objects_version_;
+}
+
 }  // namespace mini
@@ -13,6 +13,7 @@
 #include <libminicad/scene/scene.hpp>
 #include <libminicad/scene/scene_object.hpp>
 #include <optional>
+#include <span>
 #include <unordered_set>
 #include <variant>
 
@@ -40,51 +41,25 @@ void PointObject::on_delete() {
 
     for (const auto& c_h : curves_) {
       if (auto pl = scene().arena<Curve>().get_obj(c_h)) {
-        if (pl.value()->points_.remove(*this)) {
-          pl.value()->update();
+        auto& curve     = *pl.value();
+        auto idx        = curve.point_idx(handle_);
+        auto prev_count = curve.points_.size();
+        if (curve.points_.remove(*this)) {
+          if (prev_count - curve.points_.size() != 1) {
+            idx = std::nullopt;
+          }
           std::visit(eray::util::match{[&](auto& obj) {
-                       obj.on_point_remove(*pl.value(), *this, unsafe_get_variant<Point>());
+                       obj.on_point_remove(curve, *this, unsafe_get_variant<Point>(), idx);
                      }},
-                     pl.value()->object);
+                     curve.object);
+          curve.on_point_list_changed();
         }
       }
     }
   }
 }
 
-void PointObject::update() {
-  scene().renderer().push_object_rs_cmd(PointObjectRSCommand(handle_, PointObjectRSCommand::UpdateObjectMembers{}));
-
-  // Only points might be a part of the point lists
-  if (has_type<Point>()) {
-    for (const auto& c_h : this->curves_) {
-      if (auto pl = scene().arena<Curve>().get_obj(c_h)) {
-        pl.value()->mark_bezier3_dirty();
-        scene().renderer().push_object_rs_cmd(CurveRSCommand(c_h, CurveRSCommand::Internal::UpdateControlPoints{}));
-        std::visit(
-            eray::util::match{[&](auto& obj) { obj.on_point_update(*pl.value(), *this, unsafe_get_variant<Point>()); }},
-            pl.value()->object);
-      }
-    }
-    for (const auto& ps_h : this->patch_surfaces_) {
-      if (auto ps = scene().arena<PatchSurface>().get_obj(ps_h)) {
-        auto& obj = **ps;
-        obj.mark_bezier3_dirty();
-        scene().renderer().push_object_rs_cmd(
-            PatchSurfaceRSCommand(ps_h, PatchSurfaceRSCommand::Internal::UpdateControlPoints{}));
-      }
-    }
-
-    for (const auto& fs_h : this->fill_in_surfaces_) {
-      if (auto opt = scene().arena<FillInSurface>().get_obj(fs_h)) {
-        auto& obj = **opt;
-        obj.mark_points_dirty();
-        scene().renderer().push_object_rs_cmd(
-            FillInSurfaceRSCommand(fs_h, FillInSurfaceRSCommand::Internal::UpdateControlPoints{}));
-      }
-    }
-  }
-}
+void PointObject::update() { scene().update_points(std::span<const PointObjectHandle>(&handle_, 1)); }
 
 void PointObject::move_refs_to(PointObject& obj) {
   for (const auto& c_h : curves_) {
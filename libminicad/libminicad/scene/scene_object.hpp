@@ -79,7 +79,11 @@ class ObjectBase {
                       object);
   }
 
-  void set_name(std::string&& new_name) { name = std::move(new_name); }
+  /**
+   * @brief Prefer it over assigning the name directly, the scene tracks the renames to refresh the objects list.
+   *
+   */
+  void set_name(std::string&& new_name);
 
  public:
   TVariant object;
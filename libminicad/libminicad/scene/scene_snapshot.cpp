@@ -0,0 +1,225 @@
+#include <algorithm>
+#include <liberay/util/variant_match.hpp>
+#include <libminicad/math/bezier3.hpp>
+#include <libminicad/scene/scene.hpp>
+#include <libminicad/scene/scene_snapshot.hpp>
+#include <limits>
+#include <ranges>
+#include <utility>
+
+namespace mini {
+
+bool SceneSnapshot::TrimmingMaskView::is_trimmed(float u, float v) const {
+  if (texels.empty()) {
+    return false;
+  }
+
+  auto x = std::clamp(static_cast<int>(u * static_cast<float>(width)), 0, static_cast<int>(width) - 1);
+  auto y = std::clamp(static_cast<int>(v * static_cast<float>(height)), 0, static_cast<int>(height) - 1);
+
+  static constexpr uint32_t kRedMask      = 0x000000FF;
+  static constexpr uint32_t kRedThreshold = 0x80;
+
+  return (texels[static_cast<size_t>(y) * width + static_cast<size_t>(x)] & kRedMask) < kRedThreshold;
+}
+
+eray::math::Vec3f SceneSnapshot::CurveView::evaluate(float t) const { return bezier3_segments(bezier3_points, t); }
+
+eray::math::Vec3f SceneSnapshot::PatchSurfaceView::evaluate(float u, float v) const {
+  return bezier3_patches(bezier3_points, dim, u, v);
+}
+
+std::pair<eray::math::Vec3f, eray::math::Vec3f> SceneSnapshot::PatchSurfaceView::evaluate_derivatives(float u,
+                                                                                                      float v) const {
+  return bezier3_patches_derivatives(bezier3_points, dim, u, v);
+}
+
+std::pair<eray::math::Vec3f, eray::math::Vec3f> SceneSnapshot::PatchSurfaceView::aabb_bounding_box() const {
+  static constexpr auto kFltLowest = std::numeric_limits<float>::lowest();
+  static constexpr auto kFltMax    = std::numeric_limits<float>::max();
+
+  auto min = eray::math::Vec3f::filled(kFltMax);
+  auto max = eray::math::Vec3f::filled(kFltLowest);
+
+  for (const auto& p : bezier3_points) {
+    min = eray::math::min(p, min);
+    max = eray::math::max(p, max);
+  }
+
+  return std::make_pair(min, max);
+}
+
+eray::math::Vec3f SceneSnapshot::ParamPrimitiveView::evaluate(float u, float v) const {
+  const auto& e = entry.get();
+  return std::visit(
+      eray::util::match([&](const CParamPrimitiveType auto& param) { return param.evaluate(e.matrices, u, v); }),
+      e.object);
+}
+
+std::pair<eray::math::Vec3f, eray::math::Vec3f> SceneSnapshot::ParamPrimitiveView::evaluate_derivatives(
+    float u, float v) const {
+  const auto& e = entry.get();
+  return std::visit(eray::util::match([&](const CParamPrimitiveType auto& param) {
+                      return param.evaluate_derivatives(e.matrices, u, v);
+                    }),
+                    e.object);
+}
+
+SceneSnapshot::SceneSnapshot(Members&& m) : m_(std::move(m)) {}
+
+std::shared_ptr<const SceneSnapshot> SceneSnapshot::create(Scene& scene) {
+  auto m = Members{
+      .point_handles    = {},
+      .point_positions  = {},
+      .curves           = {},
+      .patch_surfaces   = {},
+      .fill_in_surfaces = {},
+      .param_primitives = {},
+      .control_points   = {},
+      .bezier3_points   = {},
+      .trimming_masks   = {},
+  };
+
+  auto append = [](auto& target, auto&& source) {
+    auto range = Range{.offset = target.size(), .count = 0};
+    for (const auto& elem : source) {
+      target.push_back(elem);
+    }
+    range.count = target.size() - range.offset;
+    return range;
+  };
+
+  auto append_mask = [&](ParamSpaceTrimmingDataManager& manager) {
+    return TrimmingMaskEntry{
+        .texels = append(m.trimming_masks, manager.final_txt()),
+        .width  = manager.width(),
+        .height = manager.height(),
+    };
+  };
+
+  for (const auto& point : scene.arena<PointObject>().objs()) {
+    m.point_handles.push_back(point.handle());
+    m.point_positions.push_back(point.transform().pos());
+  }
+
+  for (auto& curve : scene.arena<Curve>().objs()) {
+    curve.prepare();
+    m.curves.push_back(CurveEntry{
+        .handle         = curve.handle(),
+        .control_points = append(m.control_points, curve.points()),
+        .bezier3_points = append(m.bezier3_points, curve.bezier3_points()),
+    });
+  }
+
+  for (auto& surface : scene.arena<PatchSurface>().objs()) {
+    surface.prepare();
+    m.patch_surfaces.push_back(PatchSurfaceEntry{
+        .handle         = surface.handle(),
+        .dim            = surface.dimensions(),
+        .control_points = append(m.control_points, surface.points()),
+        .bezier3_points = append(m.bezier3_points, surface.bezier3_points()),
+        .trimming_mask  = append_mask(surface.trimming_manager()),
+    });
+  }
+
+  for (auto& surface : scene.arena<FillInSurface>().objs()) {
+    m.fill_in_surfaces.push_back(FillInSurfaceEntry{
+        .handle                 = surface.handle(),
+        .rational_bezier_points = append(m.bezier3_points, surface.rational_bezier_points()),
+    });
+  }
+
+  for (auto& primitive : scene.arena<ParamPrimitive>().objs()) {
+    primitive.prepare();
+    m.param_primitives.push_back(ParamPrimitiveEntry{
+        .handle = primitive.handle(),
+        .object = primitive.object,
+        .matrices =
+            ParamPrimitiveMatrices{
+                .world  = primitive.world_matrix(),
+                .normal = primitive.normal_matrix(),
+            },
+        .aabb          = std::as_const(primitive).aabb_bounding_box(),
+        .obb           = std::as_const(primitive).oriented_bounding_box(),
+        .trimming_mask = append_mask(primitive.trimming_manager()),
+    });
+  }
+
+  return std::shared_ptr<const SceneSnapshot>(new SceneSnapshot(std::move(m)));
+}
+
+SceneSnapshot::TrimmingMaskView SceneSnapshot::trimming_mask(const TrimmingMaskEntry& entry) const {
+  return TrimmingMaskView{
+      .texels = subspan(m_.trimming_masks, entry.texels),
+      .width  = entry.width,
+      .height = entry.height,
+  };
+}
+
+SceneSnapshot::CurveView SceneSnapshot::curve(const CurveEntry& entry) const {
+  return CurveView{
+      .handle         = entry.handle,
+      .control_points = subspan(m_.control_points, entry.control_points),
+      .bezier3_points = subspan(m_.bezier3_points, entry.bezier3_points),
+  };
+}
+
+SceneSnapshot::PatchSurfaceView SceneSnapshot::patch_surface(const PatchSurfaceEntry& entry) const {
+  return PatchSurfaceView{
+      .handle         = entry.handle,
+      .dim            = entry.dim,
+      .control_points = subspan(m_.control_points, entry.control_points),
+      .bezier3_points = subspan(m_.bezier3_points, entry.bezier3_points),
+      .trimming_mask  = trimming_mask(entry.trimming_mask),
+  };
+}
+
+SceneSnapshot::ParamPrimitiveView SceneSnapshot::param_primitive(const ParamPrimitiveEntry& entry) const {
+  return ParamPrimitiveView{
+      .entry         = std::cref(entry),
+      .trimming_mask = trimming_mask(entry.trimming_mask),
+  };
+}
+
+std::span<const eray::math::Vec3f> SceneSnapshot::rational_bezier_points(const FillInSurfaceEntry& entry) const {
+  return subspan(m_.bezier3_points, entry.rational_bezier_points);
+}
+
+std::optional<eray::math::Vec3f> SceneSnapshot::point(const PointObjectHandle& handle) const {
+  auto it = std::ranges::find(m_.point_handles, handle);
+  if (it == m_.point_handles.end()) {
+    return std::nullopt;
+  }
+
+  return m_.point_positions[static_cast<size_t>(std::distance(m_.point_handles.begin(), it))];
+}
+
+std::optional<SceneSnapshot::CurveView> SceneSnapshot::curve(const CurveHandle& handle) const {
+  auto it = std::ranges::find(m_.curves, handle, &CurveEntry::handle);
+  if (it == m_.curves.end()) {
+    return std::nullopt;
+  }
+
+  return curve(*it);
+}
+
+std::optional<SceneSnapshot::PatchSurfaceView> SceneSnapshot::patch_surface(const PatchSurfaceHandle& handle) const {
+  auto it = std::ranges::find(m_.patch_surfaces, handle, &PatchSurfaceEntry::handle);
+  if (it == m_.patch_surfaces.end()) {
+    return std::nullopt;
+  }
+
+  return patch_surface(*it);
+}
+
+std::optional<SceneSnapshot::ParamPrimitiveView> SceneSnapshot::param_primitive(
+    const ParamPrimitiveHandle& handle) const {
+  auto it = std::ranges::find(m_.param_primitives, handle, &ParamPrimitiveEntry::handle);
+  if (it == m_.param_primitives.end()) {
+    return std::nullopt;
+  }
+
+  return param_primitive(*it);
+}
+
+}  // namespace mini
@@ -0,0 +1,168 @@
+#pragma once
+
+#include <cstdint>
+#include <liberay/math/vec.hpp>
+#include <libminicad/math/obb.hpp>
+#include <libminicad/scene/handles.hpp>
+#include <libminicad/scene/param_primitive.hpp>
+#include <memory>
+#include <optional>
+#include <span>
+#include <vector>
+
+namespace mini {
+
+/**
+ * @brief Immutable, self-contained copy of the scene geometry. All the object data is flattened into contiguous arrays
+ * and the snapshot does not reference the scene in any way, so it can be shared between worker threads while the
+ * scene is being edited.
+ *
+ */
+class SceneSnapshot {
+ public:
+  SceneSnapshot() = delete;
+
+  /**
+   * @brief Range of elements in one of the flat arrays of the snapshot.
+   *
+   */
+  struct Range {
+    size_t offset = 0;
+    size_t count  = 0;
+  };
+
+  /**
+   * @brief Trimming mask texels in the flat array and the size of the mask they form.
+   *
+   */
+  struct TrimmingMaskEntry {
+    Range texels;
+    size_t width  = 0;
+    size_t height = 0;
+  };
+
+  struct CurveEntry {
+    CurveHandle handle;
+    Range control_points;
+    Range bezier3_points;
+  };
+
+  struct PatchSurfaceEntry {
+    PatchSurfaceHandle handle;
+    eray::math::Vec2u dim;
+    Range control_points;
+    Range bezier3_points;
+    TrimmingMaskEntry trimming_mask;
+  };
+
+  struct FillInSurfaceEntry {
+    FillInSurfaceHandle handle;
+    Range rational_bezier_points;
+  };
+
+  struct ParamPrimitiveEntry {
+    ParamPrimitiveHandle handle;
+    ParamPrimitiveVariant object;
+    ParamPrimitiveMatrices matrices;
+    std::pair<eray::math::Vec3f, eray::math::Vec3f> aabb;
+    OrientedBoundingBox obb;
+    TrimmingMaskEntry trimming_mask;
+  };
+
+  /**
+   * @brief Trimming mask in the (u, v) parameter space. A texel is trimmed if its red channel is dark, which matches
+   * the rule used by the surface shaders.
+   *
+   */
+  struct TrimmingMaskView {
+    std::span<const uint32_t> texels;
+    size_t width  = 0;
+    size_t height = 0;
+
+    [[nodiscard]] bool is_trimmed(float u, float v) const;
+  };
+
+  struct CurveView {
+    CurveHandle handle;
+    std::span<const eray::math::Vec3f> control_points;
+    std::span<const eray::math::Vec3f> bezier3_points;
+
+    [[nodiscard]] eray::math::Vec3f evaluate(float t) const;
+  };
+
+  struct PatchSurfaceView {
+    PatchSurfaceHandle handle;
+    eray::math::Vec2u dim;
+    std::span<const eray::math::Vec3f> control_points;
+    std::span<const eray::math::Vec3f> bezier3_points;
+    TrimmingMaskView trimming_mask;
+
+    [[nodiscard]] eray::math::Vec3f evaluate(float u, float v) const;
+    [[nodiscard]] std::pair<eray::math::Vec3f, eray::math::Vec3f> evaluate_derivatives(float u, float v) const;
+    [[nodiscard]] std::pair<eray::math::Vec3f, eray::math::Vec3f> aabb_bounding_box() const;
+  };
+
+  struct ParamPrimitiveView {
+    ref<const ParamPrimitiveEntry> entry;
+    TrimmingMaskView trimming_mask;
+
+    [[nodiscard]] eray::math::Vec3f evaluate(float u, float v) const;
+    [[nodiscard]] std::pair<eray::math::Vec3f, eray::math::Vec3f> evaluate_derivatives(float u, float v) const;
+    [[nodiscard]] std::pair<eray::math::Vec3f, eray::math::Vec3f> aabb_bounding_box() const {
+      return entry.get().aabb;
+    }
+    [[nodiscard]] OrientedBoundingBox oriented_bounding_box() const { return entry.get().obb; }
+  };
+
+  /**
+   * @brief Prepares all the scene objects and copies their geometry.
+   *
+   * @param scene
+   * @return std::shared_ptr<const SceneSnapshot>
+   */
+  static std::shared_ptr<const SceneSnapshot> create(Scene& scene);
+
+  [[nodiscard]] std::span<const PointObjectHandle> point_handles() const { return m_.point_handles; }
+  [[nodiscard]] std::span<const eray::math::Vec3f> point_positions() const { return m_.point_positions; }
+
+  [[nodiscard]] std::span<const CurveEntry> curves() const { return m_.curves; }
+  [[nodiscard]] std::span<const PatchSurfaceEntry> patch_surfaces() const { return m_.patch_surfaces; }
+  [[nodiscard]] std::span<const FillInSurfaceEntry> fill_in_surfaces() const { return m_.fill_in_surfaces; }
+  [[nodiscard]] std::span<const ParamPrimitiveEntry> param_primitives() const { return m_.param_primitives; }
+
+  [[nodiscard]] CurveView curve(const CurveEntry& entry) const;
+  [[nodiscard]] PatchSurfaceView patch_surface(const PatchSurfaceEntry& entry) const;
+  [[nodiscard]] ParamPrimitiveView param_primitive(const ParamPrimitiveEntry& entry) const;
+  [[nodiscard]] std::span<const eray::math::Vec3f> rational_bezier_points(const FillInSurfaceEntry& entry) const;
+
+  [[nodiscard]] std::optional<eray::math::Vec3f> point(const PointObjectHandle& handle) const;
+  [[nodiscard]] std::optional<CurveView> curve(const CurveHandle& handle) const;
+  [[nodiscard]] std::optional<PatchSurfaceView> patch_surface(const PatchSurfaceHandle& handle) const;
+  [[nodiscard]] std::optional<ParamPrimitiveView> param_primitive(const ParamPrimitiveHandle& handle) const;
+
+ private:
+  struct Members {
+    std::vector<PointObjectHandle> point_handles;
+    std::vector<eray::math::Vec3f> point_positions;
+
+    std::vector<CurveEntry> curves;
+    std::vector<PatchSurfaceEntry> patch_surfaces;
+    std::vector<FillInSurfaceEntry> fill_in_surfaces;
+    std::vector<ParamPrimitiveEntry> param_primitives;
+
+    std::vector<eray::math::Vec3f> control_points;
+    std::vector<eray::math::Vec3f> bezier3_points;
+    std::vector<uint32_t> trimming_masks;
+  } m_;
+
+  explicit SceneSnapshot(Members&& m);
+
+  TrimmingMaskView trimming_mask(const TrimmingMaskEntry& entry) const;
+
+  template <typename T>
+  static std::span<const T> subspan(const std::vector<T>& data, const Range& range) {
+    return std::span<const T>(data).subspan(range.offset, range.count);
+  }
+};
+
+}  // namespace mini
@@ -31,6 +31,38 @@ concept CParametricSurfaceObject = requires(T t, float param1, float param2, Par
   { t.txt_handle() } -> std::same_as<const TextureHandle&>;
 };
 
+/**
+ * @brief Curves that expose a const evaluation path. After `prepare()`, the const methods only read immutable cached
+ * data, so they may be called concurrently from multiple threads as long as no thread modifies the object.
+ *
+ */
+template <typename T>
+concept CConcurrentParametricCurveObject =
+    CParametricCurveObject<T> && requires(T t, const T& const_t, float param) {
+      { t.prepare() } -> std::same_as<void>;
+      { const_t.is_prepared() } -> std::same_as<bool>;
+      { const_t.frenet_frame(param) } -> std::same_as<eray::math::Mat4f>;
+      { const_t.evaluate(param) } -> std::same_as<eray::math::Vec3f>;
+      { const_t.aabb_bounding_box() } -> std::same_as<std::pair<eray::math::Vec3f, eray::math::Vec3f>>;
+    };
+
+/**
+ * @brief Surface counterpart of `CConcurrentParametricCurveObject`.
+ *
+ */
+template <typename T>
+concept CConcurrentParametricSurfaceObject =
+    CParametricSurfaceObject<T> && requires(T t, const T& const_t, float param1, float param2) {
+      { t.prepare() } -> std::same_as<void>;
+      { const_t.is_prepared() } -> std::same_as<bool>;
+      { const_t.frenet_frame(param1, param2) } -> std::same_as<eray::math::Mat4f>;
+      { const_t.evaluate(param1, param2) } -> std::same_as<eray::math::Vec3f>;
+      {
+        const_t.evaluate_derivatives(param1, param2)
+      } -> std::same_as<std::pair<eray::math::Vec3f, eray::math::Vec3f>>;
+      { const_t.aabb_bounding_box() } -> std::same_as<std::pair<eray::math::Vec3f, eray::math::Vec3f>>;
+    };
+
 template <typename T>
 concept CTransformableObject = requires(T t) {
   typename T::Variant;
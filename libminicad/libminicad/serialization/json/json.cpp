@@ -168,6 +168,17 @@ JsonDeserializer JsonDeserializer::create() {
 }
 std::expected<void, JsonDeserializer::JsonDeserializationError> JsonDeserializer::deserialize(Scene& scene,
                                                                                               const std::string& json) {
+  auto project = parse(json);
+  if (!project) {
+    return std::unexpected(project.error());
+  }
+
+  deserialize(scene, *project);
+  return {};
+}
+
+std::expected<json_schema::JsonProject, JsonDeserializer::JsonDeserializationError> JsonDeserializer::parse(
+    const std::string& json) {
   if (!nlohmann::json::accept(json)) {
     eray::util::Logger::err("Deserialization failed due to invalid JSON input.");
     return std::unexpected(JsonDeserializationError::InvalidJson);
@@ -181,6 +192,10 @@ std::expected<void, JsonDeserializer::JsonDeserializationError> JsonDeserializer
     return std::unexpected(JsonDeserializationError::DoesNotMatchSchema);
   }
 
+  return project;
+}
+
+void JsonDeserializer::deserialize(Scene& scene, const json_schema::JsonProject& project) {
   scene.clear();
 
   if (auto point_elements = project.get_points()) {
@@ -225,9 +240,8 @@ std::expected<void, JsonDeserializer::JsonDeserializationError> JsonDeserializer
                  variant);
     }
   }
-
-  return {};
 }
+
 void JsonDeserializer::Visitor::operator()(PointObjectVariant&& /*v*/, const json_schema::Geometry& /*elem*/) {}
 
 void JsonDeserializer::Visitor::operator()(ParamPrimitiveVariant&& v, const json_schema::Geometry& elem) {
@@ -48,6 +48,19 @@ class JsonDeserializer {
    */
   std::expected<void, JsonDeserializationError> deserialize(Scene& scene, const std::string& json);
 
+  /**
+   * @brief Parses and validates the json string without touching the scene, so it may run on a worker thread.
+   *
+   * @return std::expected<json_schema::JsonProject, JsonDeserializationError>
+   */
+  static std::expected<json_schema::JsonProject, JsonDeserializationError> parse(const std::string& json);
+
+  /**
+   * @brief Replaces the scene content with the parsed project. Must be called on the main thread.
+   *
+   */
+  void deserialize(Scene& scene, const json_schema::JsonProject& project);
+
  private:
   struct Members {
     std::unordered_map<std::int64_t, PointObjectHandle> id_map;
@@ -0,0 +1,52 @@
+#include <gtest/gtest.h>
+
+#include <libminicad/scene/scene.hpp>
+#include <vector>
+
+#include "null_scene_renderer.hpp"
+
+namespace mini {
+
+TEST(ArenaTest, StorageGrowsByDoublingOnDemand) {
+  auto scene   = test::make_scene();
+  auto& points = scene.arena<PointObject>();
+  EXPECT_EQ(points.capacity(), 0U);
+
+  auto& first    = **scene.create_obj_and_get<PointObject>(Point{});
+  auto first_ptr = &first;
+  EXPECT_EQ(points.capacity(), 64U);
+
+  ASSERT_TRUE(scene.create_many_objs<PointObject>(Point{}, 199));
+  EXPECT_EQ(points.capacity(), 256U);
+
+  // The objects never move, so the references taken before the growth stay valid
+  auto handle = first.handle();
+  EXPECT_EQ(&**points.get_obj(handle), first_ptr);
+}
+
+TEST(ArenaTest, FreedIdsAreReusedBeforeTheStorageGrows) {
+  auto scene   = test::make_scene();
+  auto& points = scene.arena<PointObject>();
+
+  auto handles = *scene.create_many_objs<PointObject>(Point{}, 64);
+  EXPECT_EQ(points.capacity(), 64U);
+
+  auto freed_id = handles[10].obj_id;
+  EXPECT_TRUE(scene.delete_obj(handles[10]));
+  EXPECT_FALSE(points.exists(handles[10]));
+
+  auto handle = *scene.create_obj<PointObject>(Point{});
+  EXPECT_EQ(handle.obj_id, freed_id);
+  EXPECT_EQ(points.capacity(), 64U);
+  EXPECT_TRUE(points.exists(handle));
+}
+
+TEST(ArenaTest, CreationFailsAtTheMaxNumberOfObjects) {
+  auto scene = test::make_scene();
+
+  ASSERT_TRUE(scene.create_many_objs<PointObject>(Point{}, Scene::kMaxPointObjects));
+  EXPECT_EQ(scene.arena<PointObject>().capacity(), Scene::kMaxPointObjects);
+  EXPECT_FALSE(scene.create_obj<PointObject>(Point{}));
+}
+
+}  // namespace mini
@@ -0,0 +1,156 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <liberay/math/vec.hpp>
+#include <libminicad/algorithm/ball_finishing_paths.hpp>
+#include <libminicad/algorithm/cutter_offset.hpp>
+#include <libminicad/algorithm/paths_generator.hpp>
+#include <libminicad/scene/patch_surface.hpp>
+#include <libminicad/scene/scene.hpp>
+#include <libminicad/scene/scene_snapshot.hpp>
+#include <libminicad/scene/trimming.hpp>
+#include <limits>
+#include <span>
+#include <vector>
+
+#include "null_scene_renderer.hpp"
+
+namespace mini {
+
+namespace {
+
+constexpr float kCutterRadius = 0.4F;
+constexpr float kHoleHalfLen  = 0.15F;
+constexpr uint32_t kSamples   = 100;
+
+// Slack of the chordal tolerance of the sampled iso-lines and of the surface sampling in the check
+constexpr float kGougeTolerance = 5e-3F;
+
+const auto kMilling = MillingDesc{.width = 15.F, .height = 15.F, .texel_size = 15.F / 256.F};
+
+/**
+ * @brief Gaussian bump over a 6x6 square centered at the origin, the control points of a plane are lifted to the bump.
+ *
+ */
+PatchSurface& make_dome(Scene& scene) {
+  auto& surface = **scene.create_obj_and_get<PatchSurface>(BezierPatches{});
+  surface.init_from_starter(PlanePatchSurfaceStarter{.size = eray::math::Vec2f(6.5F, 6.5F)}, eray::math::Vec2u(4, 4));
+  for (auto& point : surface.point_objects()) {
+    auto p = point.transform().pos();
+    p.x -= 3.F;
+    p.z -= 3.F;
+    p.y = 2.F * std::exp(-(p.x * p.x + p.z * p.z) / 2.F);
+    point.transform().set_local_pos(p);
+    point.update();
+  }
+  return surface;
+}
+
+/**
+ * @brief Trims a square hole in the middle of the parameter space.
+ *
+ */
+void trim_square_hole(Scene& scene, PatchSurface& surface) {
+  auto& manager = surface.trimming_manager();
+  auto mask     = std::vector<uint32_t>(manager.width() * manager.height(), 0xFFFFFFFF);
+  for (auto y = size_t{0}; y < manager.height(); ++y) {
+    for (auto x = size_t{0}; x < manager.width(); ++x) {
+      auto u = (static_cast<float>(x) + 0.5F) / static_cast<float>(manager.width());
+      auto v = (static_cast<float>(y) + 0.5F) / static_cast<float>(manager.height());
+      if (std::abs(u - 0.5F) < kHoleHalfLen && std::abs(v - 0.5F) < kHoleHalfLen) {
+        mask[y * manager.width() + x] = 0xFF000000;
+      }
+    }
+  }
+
+  auto& renderer = scene.renderer();
+  auto txt       = renderer.upload_texture(mask, manager.width(), manager.height());
+  manager.add(ParamSpaceTrimmingData{
+      .curve_txt                 = txt,
+      .trimming_variant_txt      = {txt, txt},
+      .trimming_variant_txt_data = {mask, mask},
+      .enable                    = true,
+  });
+}
+
+/**
+ * @brief Untrimmed points of the surface, the material that must be left intact by the cutter.
+ *
+ */
+std::vector<eray::math::Vec3f> surface_samples(const SceneSnapshot::PatchSurfaceView& surface) {
+  auto result = std::vector<eray::math::Vec3f>();
+  for (auto j = 0U; j <= kSamples; ++j) {
+    for (auto i = 0U; i <= kSamples; ++i) {
+      auto u = static_cast<float>(i) / static_cast<float>(kSamples);
+      auto v = static_cast<float>(j) / static_cast<float>(kSamples);
+      if (!surface.trimming_mask.is_trimmed(u, v)) {
+        result.push_back(surface.evaluate(u, v));
+      }
+    }
+  }
+  return result;
+}
+
+/**
+ * @brief Deepest penetration of the ball into the samples over all the tips of the path, negative if the ball never
+ * touches them.
+ *
+ */
+float max_penetration(const ToolPath& path, const std::vector<eray::math::Vec3f>& samples) {
+  auto result = std::numeric_limits<float>::lowest();
+  for (const auto& tip : path.points) {
+    auto center = tip + eray::math::Vec3f(0.F, kCutterRadius, 0.F);
+    auto dist   = std::numeric_limits<float>::max();
+    for (const auto& s : samples) {
+      dist = std::min(dist, eray::math::distance(center, s));
+    }
+    result = std::max(result, kCutterRadius - dist);
+  }
+  return result;
+}
+
+ToolPath finishing_path(const SceneSnapshot& snapshot, const PatchSurfaceHandle& handle) {
+  auto heights = HeightMap::sample(snapshot, std::span(&handle, 1), kMilling);
+  auto texel   = eray::math::Vec2f(kMilling.width / static_cast<float>(heights.width()),
+                                   kMilling.height / static_cast<float>(heights.height()));
+  auto safety  = CutterOffset::compute(heights, texel, Cutter{.type = CutterType::Ball, .radius = kCutterRadius});
+  return BallFinishingPaths::generate(snapshot, std::span(&handle, 1), safety, kMilling,
+                                      BallFinishingDesc{.cutter_radius = kCutterRadius});
+}
+
+}  // namespace
+
+TEST(BallFinishingPathsTest, CutterDoesNotGougeTheTrimmedDome) {
+  auto scene    = test::make_scene();
+  auto& surface = make_dome(scene);
+  trim_square_hole(scene, surface);
+
+  auto snapshot = scene.snapshot();
+  auto view     = snapshot->patch_surface(surface.handle());
+  ASSERT_TRUE(view);
+  ASSERT_TRUE(view->trimming_mask.is_trimmed(0.5F, 0.5F));
+
+  auto path = finishing_path(*snapshot, surface.handle());
+  ASSERT_GT(path.points.size(), 2U);
+  EXPECT_LE(max_penetration(path, surface_samples(*view)), kGougeTolerance);
+
+  // Every move off the surface goes up to the safe height
+  EXPECT_FLOAT_EQ(path.points.front().y, BallFinishingDesc{}.safe_height);
+  EXPECT_FLOAT_EQ(path.points.back().y, BallFinishingDesc{}.safe_height);
+
+  // No tip touches the surface inside of the hole, the ball only rides over its edges
+  const auto inner = kHoleHalfLen - 0.05F;
+  auto hole        = std::vector<eray::math::Vec3f>();
+  for (auto j = 0U; j <= 10; ++j) {
+    for (auto i = 0U; i <= 10; ++i) {
+      auto u = 0.5F - inner + 2.F * inner * static_cast<float>(i) / 10.F;
+      auto v = 0.5F - inner + 2.F * inner * static_cast<float>(j) / 10.F;
+      hole.push_back(view->evaluate(u, v));
+    }
+  }
+  EXPECT_LT(max_penetration(path, hole), -kGougeTolerance);
+}
+
+}  // namespace mini
@@ -0,0 +1,22 @@
+#pragma once
+
+#include <liberay/math/vec.hpp>
+#include <libminicad/camera/camera.hpp>
+#include <libminicad/math/frustum.hpp>
+#include <numbers>
+
+namespace mini::test {
+
+/**
+ * @brief Frustum of a camera at (0, 0, 10) looking along -z with the 90 degree field of view, the square aspect ratio
+ * and the [0.1, 100] depth range.
+ *
+ */
+inline Frustum camera_frustum(bool orthographic = false) {
+  auto camera = Camera(orthographic, std::numbers::pi_v<float> / 2.F, 1.F, 0.1F, 100.F);
+  camera.transform.set_local_pos(eray::math::Vec3f(0.F, 0.F, 10.F));
+  camera.recalculate_projection();
+  return Frustum::from_matrix(camera.proj_matrix() * camera.view_matrix());
+}
+
+}  // namespace mini::test
@@ -0,0 +1,83 @@
+#include <gtest/gtest.h>
+
+#include <liberay/math/vec.hpp>
+#include <libminicad/renderer/gl/buffer.hpp>
+#include <libminicad/scene/handles.hpp>
+#include <span>
+#include <vector>
+
+#include "camera_frustum.hpp"
+
+namespace mini::gl {
+
+namespace {
+
+using PointsChunksBuffer =
+    ChunksBuffer<CurveHandle, eray::math::Vec3f, float, 3, [](const eray::math::Vec3f& vec, float* target) {
+      target[0] = vec.x;
+      target[1] = vec.y;
+      target[2] = vec.z;
+    }>;
+
+/**
+ * @brief Chunk of `count` points at the position, its bounds are set from the points.
+ *
+ */
+void add_chunk(PointsChunksBuffer& buffer, const CurveHandle& handle, const eray::math::Vec3f& pos, size_t count) {
+  auto points = std::vector<eray::math::Vec3f>(count, pos);
+  buffer.update_chunk(handle, points);
+  buffer.set_chunk_bounds(handle, std::span<const eray::math::Vec3f>(points));
+}
+
+const auto kVisible = eray::math::Vec3f(0.F, 0.F, 0.F);
+const auto kCulled  = eray::math::Vec3f(0.F, 0.F, 50.F);
+
+}  // namespace
+
+TEST(ChunksBufferTest, AdjacentVisibleChunksAreMerged) {
+  auto buffer = PointsChunksBuffer::create();
+  add_chunk(buffer, CurveHandle(0, 0, 0), kVisible, 4);
+  add_chunk(buffer, CurveHandle(0, 1, 1), kVisible, 2);
+  add_chunk(buffer, CurveHandle(0, 2, 2), kVisible, 3);
+
+  auto ranges = MultiDrawRanges();
+  buffer.visible_ranges(test::camera_frustum(), ranges);
+  EXPECT_EQ(ranges.first, std::vector<GLint>{0});
+  EXPECT_EQ(ranges.count, std::vector<GLsizei>{9});
+}
+
+TEST(ChunksBufferTest, CulledChunksSplitTheRanges) {
+  auto buffer = PointsChunksBuffer::create();
+  add_chunk(buffer, CurveHandle(0, 0, 0), kVisible, 4);
+  add_chunk(buffer, CurveHandle(0, 1, 1), kCulled, 2);
+  add_chunk(buffer, CurveHandle(0, 2, 2), kVisible, 3);
+  add_chunk(buffer, CurveHandle(0, 3, 3), kCulled, 5);
+
+  auto ranges = MultiDrawRanges();
+  buffer.visible_ranges(test::camera_frustum(), ranges);
+  EXPECT_EQ(ranges.first, (std::vector<GLint>{0, 6}));
+  EXPECT_EQ(ranges.count, (std::vector<GLsizei>{4, 3}));
+}
+
+TEST(ChunksBufferTest, ChunksWithoutBoundsAreAlwaysDrawn) {
+  auto buffer = PointsChunksBuffer::create();
+  add_chunk(buffer, CurveHandle(0, 0, 0), kCulled, 4);
+  buffer.update_chunk(CurveHandle(0, 1, 1), std::vector<eray::math::Vec3f>(2, kCulled));
+
+  auto ranges = MultiDrawRanges();
+  buffer.visible_ranges(test::camera_frustum(), ranges);
+  EXPECT_EQ(ranges.first, std::vector<GLint>{4});
+  EXPECT_EQ(ranges.count, std::vector<GLsizei>{2});
+}
+
+TEST(ChunksBufferTest, NothingIsDrawnWhenAllChunksAreCulled) {
+  auto buffer = PointsChunksBuffer::create();
+  add_chunk(buffer, CurveHandle(0, 0, 0), kCulled, 4);
+
+  auto ranges = MultiDrawRanges();
+  ranges.push(0, 1);
+  buffer.visible_ranges(test::camera_frustum(), ranges);
+  EXPECT_TRUE(ranges.empty());
+}
+
+}  // namespace mini::gl
@@ -0,0 +1,116 @@
+#include <gtest/gtest.h>
+
+#include <liberay/math/vec.hpp>
+#include <libminicad/scene/curve.hpp>
+#include <libminicad/scene/patch_surface.hpp>
+#include <libminicad/scene/scene.hpp>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "null_scene_renderer.hpp"
+
+namespace mini {
+
+namespace {
+
+constexpr size_t kThreadsCount = 8;
+constexpr size_t kSamplesCount = 257;
+
+float param(size_t i) { return static_cast<float>(i) / static_cast<float>(kSamplesCount - 1); }
+
+Curve& make_bspline(Scene& scene) {
+  auto& curve = **scene.create_obj_and_get<Curve>(BSplineCurve{});
+  for (auto i = 0U; i < 8; ++i) {
+    auto& point = **scene.create_obj_and_get<PointObject>(Point{});
+    auto t      = static_cast<float>(i);
+    point.transform().set_local_pos(eray::math::Vec3f(t, (i % 2 == 0) ? 1.F : -1.F, 0.25F * t * t));
+    point.update();
+    EXPECT_TRUE(curve.push_back(point.handle()));
+  }
+  return curve;
+}
+
+PatchSurface& make_cylinder(Scene& scene) {
+  auto& surface = **scene.create_obj_and_get<PatchSurface>(BezierPatches{});
+  surface.init_from_starter(CylinderPatchSurfaceStarter{.radius = 1.5F, .height = 2.F, .phase = 0.3F},
+                            eray::math::Vec2u(4, 3));
+  return surface;
+}
+
+/**
+ * @brief Runs the evaluation on many threads at once and returns the results of each thread.
+ *
+ */
+template <typename Fn>
+std::vector<std::vector<eray::math::Vec3f>> evaluate_concurrently(Fn&& fn) {
+  auto results = std::vector<std::vector<eray::math::Vec3f>>(kThreadsCount);
+  {
+    auto threads = std::vector<std::jthread>();
+    for (auto& result : results) {
+      threads.emplace_back([&fn, &result] { result = fn(); });
+    }
+  }
+  return results;
+}
+
+void expect_same(const std::vector<eray::math::Vec3f>& actual, const std::vector<eray::math::Vec3f>& expected) {
+  ASSERT_EQ(actual.size(), expected.size());
+  for (auto i = size_t{0}; i < actual.size(); ++i) {
+    EXPECT_EQ(actual[i].x, expected[i].x);
+    EXPECT_EQ(actual[i].y, expected[i].y);
+    EXPECT_EQ(actual[i].z, expected[i].z);
+  }
+}
+
+}  // namespace
+
+TEST(ConcurrentEvaluationTest, PreparedCurveMatchesSingleThreadedEvaluation) {
+  auto scene  = test::make_scene();
+  auto& curve = make_bspline(scene);
+  curve.prepare();
+  ASSERT_TRUE(curve.is_prepared());
+
+  const auto& prepared = std::as_const(curve);
+  auto evaluate_all    = [&prepared] {
+    auto result = std::vector<eray::math::Vec3f>();
+    for (auto i = size_t{0}; i < kSamplesCount; ++i) {
+      result.push_back(prepared.evaluate(param(i)));
+      result.push_back(prepared.evaluate_at_length(param(i) * prepared.length()));
+    }
+    return result;
+  };
+
+  const auto expected = evaluate_all();
+  for (const auto& result : evaluate_concurrently(evaluate_all)) {
+    expect_same(result, expected);
+  }
+}
+
+TEST(ConcurrentEvaluationTest, PreparedPatchSurfaceMatchesSingleThreadedEvaluation) {
+  auto scene    = test::make_scene();
+  auto& surface = make_cylinder(scene);
+  surface.prepare();
+  ASSERT_TRUE(surface.is_prepared());
+
+  const auto& prepared = std::as_const(surface);
+  auto evaluate_all    = [&prepared] {
+    auto result = std::vector<eray::math::Vec3f>();
+    for (auto j = size_t{0}; j < kSamplesCount; j += 8) {
+      for (auto i = size_t{0}; i < kSamplesCount; i += 8) {
+        auto [du, dv] = prepared.evaluate_derivatives(param(i), param(j));
+        result.push_back(prepared.evaluate(param(i), param(j)));
+        result.push_back(du);
+        result.push_back(dv);
+      }
+    }
+    return result;
+  };
+
+  const auto expected = evaluate_all();
+  for (const auto& result : evaluate_concurrently(evaluate_all)) {
+    expect_same(result, expected);
+  }
+}
+
+}  // namespace mini
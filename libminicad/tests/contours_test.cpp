@@ -0,0 +1,144 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <liberay/math/vec.hpp>
+#include <libminicad/algorithm/contours.hpp>
+#include <limits>
+#include <vector>
+
+namespace mini {
+
+namespace {
+
+constexpr uint32_t kSize     = 200;
+constexpr float kCenter      = 100.F;
+constexpr float kRadius      = 60.F;
+constexpr float kHoleHalfLen = 15.F;
+
+/**
+ * @brief Signed distance to the boundary of a disk, optionally with a square hole in its middle, positive inside.
+ *
+ */
+std::vector<float> disk_field(float center_x, bool with_hole) {
+  auto field = std::vector<float>(kSize * kSize);
+  for (auto y = 0U; y < kSize; ++y) {
+    for (auto x = 0U; x < kSize; ++x) {
+      auto dx = static_cast<float>(x) - center_x;
+      auto dy = static_cast<float>(y) - kCenter;
+      auto d  = kRadius - std::sqrt(dx * dx + dy * dy);
+      if (with_hole) {
+        d = std::min(d, std::max(std::abs(dx), std::abs(dy)) - kHoleHalfLen);
+      }
+      field[y * kSize + x] = d;
+    }
+  }
+  return field;
+}
+
+float signed_area(const Contour& contour) {
+  auto area = 0.F;
+  for (auto i = size_t{0}; i < contour.points.size(); ++i) {
+    const auto& p = contour.points[i];
+    const auto& q = contour.points[(i + 1) % contour.points.size()];
+    area += p.x * q.y - q.x * p.y;
+  }
+  return area / 2.F;
+}
+
+/**
+ * @brief The loop is closed if every point, including the last one, is within a cell diagonal from the next one.
+ *
+ */
+void expect_closed(const Contour& contour) {
+  ASSERT_GT(contour.points.size(), 2U);
+  for (auto i = size_t{0}; i < contour.points.size(); ++i) {
+    const auto& p = contour.points[i];
+    const auto& q = contour.points[(i + 1) % contour.points.size()];
+    EXPECT_LE(eray::math::length(q - p), std::sqrt(2.F) + 1e-4F) << "point " << i;
+  }
+}
+
+/**
+ * @brief Distance from the point to the nearest segment of the closed polyline.
+ *
+ */
+float distance_to_loop(const eray::math::Vec2f& p, const std::vector<eray::math::Vec2f>& loop) {
+  auto result = std::numeric_limits<float>::max();
+  for (auto i = size_t{0}; i < loop.size(); ++i) {
+    const auto& a = loop[i];
+    const auto& b = loop[(i + 1) % loop.size()];
+    auto ab       = b - a;
+    auto t        = std::clamp(eray::math::dot(p - a, ab) / eray::math::dot(ab, ab), 0.F, 1.F);
+    result        = std::min(result, eray::math::length(p - (a + t * ab)));
+  }
+  return result;
+}
+
+}  // namespace
+
+TEST(IsoContoursTest, DiskGivesASingleCounterClockwiseLoop) {
+  auto contours = IsoContours::extract(disk_field(kCenter, false), kSize, kSize, 0.F);
+  ASSERT_EQ(contours.size(), 1U);
+  expect_closed(contours[0]);
+
+  const auto pi = std::acos(-1.F);
+  EXPECT_GT(signed_area(contours[0]), 0.F);
+  EXPECT_NEAR(signed_area(contours[0]), pi * kRadius * kRadius, 0.01F * pi * kRadius * kRadius);
+
+  // The linear interpolation along the cell edges places the points on the circle
+  for (const auto& p : contours[0].points) {
+    EXPECT_NEAR(eray::math::length(p - eray::math::Vec2f(kCenter, kCenter)), kRadius, 0.05F);
+  }
+}
+
+TEST(IsoContoursTest, HoleIsAClockwiseLoop) {
+  auto contours = IsoContours::extract(disk_field(kCenter, true), kSize, kSize, 0.F);
+  ASSERT_EQ(contours.size(), 2U);
+  for (const auto& contour : contours) {
+    expect_closed(contour);
+  }
+
+  std::ranges::sort(contours, [](const auto& a, const auto& b) { return signed_area(a) > signed_area(b); });
+  EXPECT_GT(signed_area(contours[0]), 0.F);
+  EXPECT_LT(signed_area(contours[1]), 0.F);
+
+  const auto hole_area = 4.F * kHoleHalfLen * kHoleHalfLen;
+  EXPECT_NEAR(signed_area(contours[1]), -hole_area, 0.01F * hole_area);
+}
+
+TEST(IsoContoursTest, RegionCutByTheBorderIsClosedOutsideOfTheField) {
+  auto contours = IsoContours::extract(disk_field(20.F, false), kSize, kSize, 0.F);
+  ASSERT_EQ(contours.size(), 1U);
+  expect_closed(contours[0]);
+  EXPECT_GT(signed_area(contours[0]), 0.F);
+
+  auto min_x = std::ranges::min(contours[0].points, {}, [](const auto& p) { return p.x; }).x;
+  EXPECT_NEAR(min_x, -0.5F, 1e-4F);
+}
+
+TEST(IsoContoursTest, FieldBelowTheLevelHasNoContours) {
+  auto field = std::vector<float>(kSize * kSize, -1.F);
+  EXPECT_TRUE(IsoContours::extract(field, kSize, kSize, 0.F).empty());
+}
+
+TEST(IsoContoursTest, SimplifiedLoopStaysWithinTheTolerance) {
+  auto contours = IsoContours::extract(disk_field(kCenter, false), kSize, kSize, 0.F);
+  ASSERT_EQ(contours.size(), 1U);
+
+  const auto tolerance = 0.1F;
+  auto simplified      = IsoContours::simplify(contours[0].points, tolerance);
+  EXPECT_LT(simplified.size(), contours[0].points.size());
+  EXPECT_GT(simplified.size(), 8U);
+  for (const auto& p : simplified) {
+    EXPECT_TRUE(std::ranges::any_of(contours[0].points, [&](const auto& q) { return q.x == p.x && q.y == p.y; }));
+  }
+
+  // Every point of the input, including the dropped ones, lies within the tolerance from the simplified loop
+  for (const auto& p : contours[0].points) {
+    EXPECT_LE(distance_to_loop(p, simplified), tolerance + 1e-4F) << "point " << p.x << ", " << p.y;
+  }
+}
+
+}  // namespace mini
@@ -0,0 +1,136 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <liberay/math/vec.hpp>
+#include <libminicad/algorithm/cutter_offset.hpp>
+#include <libminicad/algorithm/height_field.hpp>
+#include <limits>
+#include <random>
+#include <vector>
+
+namespace mini {
+
+namespace {
+
+constexpr uint32_t kWidth  = 45;
+constexpr uint32_t kHeight = 31;
+
+const auto kTexelSize = eray::math::Vec2f(0.05F, 0.07F);
+
+std::vector<float> random_field(uint32_t seed) {
+  auto rng    = std::mt19937(seed);
+  auto height = std::uniform_real_distribution<float>(0.F, 2.F);
+  auto field  = std::vector<float>(static_cast<size_t>(kWidth) * kHeight, 0.F);
+  for (auto& h : field) {
+    if (rng() % 3 == 0) {
+      h = height(rng);
+    }
+  }
+  return field;
+}
+
+/**
+ * @brief Dilation by the cutter profile evaluated directly for every pair of texels. A texel is under the cutter if it
+ * lies on one of the chords of the disk, see `CutterOffset`.
+ *
+ */
+float brute_force_offset(const std::vector<float>& field, uint32_t x, uint32_t y, const Cutter& cutter) {
+  auto result = std::numeric_limits<float>::lowest();
+  for (auto sy = 0U; sy < kHeight; ++sy) {
+    for (auto sx = 0U; sx < kWidth; ++sx) {
+      auto dx = (static_cast<float>(sx) - static_cast<float>(x)) * kTexelSize.x;
+      auto dz = (static_cast<float>(sy) - static_cast<float>(y)) * kTexelSize.y;
+      auto r2 = cutter.radius * cutter.radius - dz * dz;
+      if (r2 < 0.F) {
+        continue;
+      }
+
+      auto half_width = std::floor(std::sqrt(r2) / kTexelSize.x);
+      if (half_width < std::abs(static_cast<float>(sx) - static_cast<float>(x))) {
+        continue;
+      }
+
+      auto offset = cutter.type == CutterType::Ball ? std::sqrt(std::max(r2 - dx * dx, 0.F)) - cutter.radius : 0.F;
+      result      = std::max(result, field[static_cast<size_t>(sy) * kWidth + sx] + offset);
+    }
+  }
+  return result;
+}
+
+void expect_brute_force_offsets(const Cutter& cutter, float tolerance) {
+  const auto field   = random_field(3);
+  const auto heights = TiledHeightField::from_dense(kWidth, kHeight, 0.F, field);
+  const auto offsets = CutterOffset::compute(heights, kTexelSize, cutter);
+
+  ASSERT_EQ(offsets.width(), kWidth);
+  ASSERT_EQ(offsets.height(), kHeight);
+  for (auto y = 0U; y < kHeight; ++y) {
+    for (auto x = 0U; x < kWidth; ++x) {
+      EXPECT_NEAR(offsets.at(x, y), brute_force_offset(field, x, y, cutter), tolerance) << "at " << x << ", " << y;
+    }
+  }
+}
+
+}  // namespace
+
+TEST(CutterOffsetTest, MaxFilterMatchesTheWindowMax) {
+  auto rng   = std::mt19937(7);
+  auto value = std::uniform_real_distribution<float>(-1.F, 1.F);
+  auto in    = std::vector<float>(97);
+  std::ranges::generate(in, [&] { return value(rng); });
+
+  for (auto half_width : {0U, 1U, 3U, 10U, 200U}) {
+    auto out     = std::vector<float>(in.size());
+    auto scratch = std::vector<float>(2 * (in.size() + 2 * half_width));
+    CutterOffset::max_filter(in, half_width, out, scratch);
+
+    for (auto x = size_t{0}; x < in.size(); ++x) {
+      auto begin = x > half_width ? x - half_width : 0;
+      auto end   = std::min(x + half_width + 1, in.size());
+      auto max   = *std::max_element(in.begin() + static_cast<std::ptrdiff_t>(begin),
+                                     in.begin() + static_cast<std::ptrdiff_t>(end));
+      EXPECT_EQ(out[x], max) << "half width " << half_width << " at " << x;
+    }
+  }
+}
+
+TEST(CutterOffsetTest, FlatCutterMatchesBruteForceDilation) {
+  expect_brute_force_offsets(Cutter{.type = CutterType::Flat, .radius = 0.6F}, 0.F);
+}
+
+TEST(CutterOffsetTest, BallCutterMatchesBruteForceDilation) {
+  expect_brute_force_offsets(Cutter{.type = CutterType::Ball, .radius = 0.6F}, 1e-5F);
+}
+
+TEST(CutterOffsetTest, EmptyFieldStaysAtTheBackground) {
+  const auto heights = TiledHeightField(kWidth, kHeight, 0.F);
+  const auto offsets = CutterOffset::compute(heights, kTexelSize, Cutter{.type = CutterType::Ball, .radius = 0.5F});
+  EXPECT_EQ(offsets.max(), 0.F);
+}
+
+TEST(CutterOffsetTest, BackgroundBandsAllocateNoTiles) {
+  // The model covers only the first rows of a tall field, the bands of tile rows further than the cutter radius from
+  // it stay at the background
+  constexpr uint32_t kTallHeight = 5 * TiledHeightField::kTileSize;
+  const auto cutter              = Cutter{.type = CutterType::Ball, .radius = 0.6F};
+
+  auto field = random_field(5);
+  std::fill(field.begin() + static_cast<std::ptrdiff_t>(20 * kWidth), field.end(), 0.F);
+  auto tall = field;
+  tall.resize(static_cast<size_t>(kWidth) * kTallHeight, 0.F);
+
+  const auto heights = TiledHeightField::from_dense(kWidth, kTallHeight, 0.F, tall);
+  const auto offsets = CutterOffset::compute(heights, kTexelSize, cutter);
+
+  EXPECT_EQ(offsets.allocated_tiles(), 1U);
+  EXPECT_EQ(offsets.range_max(0, TiledHeightField::kTileSize, kWidth, kTallHeight), 0.F);
+  for (auto y = 0U; y < kHeight; ++y) {
+    for (auto x = 0U; x < kWidth; ++x) {
+      EXPECT_NEAR(offsets.at(x, y), brute_force_offset(field, x, y, cutter), 1e-5F) << "at " << x << ", " << y;
+    }
+  }
+}
+
+}  // namespace mini
@@ -0,0 +1,80 @@
+#include <gtest/gtest.h>
+
+#include <liberay/math/vec.hpp>
+#include <libminicad/renderer/debug_primitives.hpp>
+
+namespace mini {
+
+namespace {
+
+const auto kOrigin = eray::math::Vec3f(1.F, 2.F, 3.F);
+const auto kX      = eray::math::Vec3f(1.F, 0.F, 0.F);
+const auto kY      = eray::math::Vec3f(0.F, 1.F, 0.F);
+const auto kZ      = eray::math::Vec3f(0.F, 0.F, 1.F);
+
+}  // namespace
+
+TEST(DebugPrimitivesTest, PrimitivesAccumulateIntoTheArraysOfTheirKind) {
+  auto debug = DebugPrimitives();
+  EXPECT_TRUE(debug.empty());
+
+  debug.add_point(kOrigin);
+  debug.add_point(kX);
+  debug.add_line(kX, kY);
+  debug.add_box(kX, kOrigin);
+  debug.add_frame(kOrigin, kX, kY, kZ, 2.F);
+
+  ASSERT_EQ(debug.points().size(), 2U);
+  EXPECT_EQ(debug.points()[0], (DebugVec3{1.F, 2.F, 3.F}));
+  EXPECT_EQ(debug.points()[1], (DebugVec3{1.F, 0.F, 0.F}));
+
+  ASSERT_EQ(debug.lines().size(), 2U);
+  EXPECT_EQ(debug.lines()[0], (DebugVec3{1.F, 0.F, 0.F}));
+  EXPECT_EQ(debug.lines()[1], (DebugVec3{0.F, 1.F, 0.F}));
+
+  ASSERT_EQ(debug.boxes().size(), 1U);
+  EXPECT_EQ(debug.boxes()[0].min, (DebugVec3{1.F, 0.F, 0.F}));
+  EXPECT_EQ(debug.boxes()[0].max, (DebugVec3{1.F, 2.F, 3.F}));
+
+  ASSERT_EQ(debug.frames().size(), 1U);
+  EXPECT_EQ(debug.frames()[0].origin, (DebugVec3{1.F, 2.F, 3.F}));
+  EXPECT_EQ(debug.frames()[0].x_axis, (DebugVec3{2.F, 0.F, 0.F}));
+  EXPECT_EQ(debug.frames()[0].y_axis, (DebugVec3{0.F, 2.F, 0.F}));
+  EXPECT_EQ(debug.frames()[0].z_axis, (DebugVec3{0.F, 0.F, 2.F}));
+
+  EXPECT_FALSE(debug.empty());
+}
+
+TEST(DebugPrimitivesTest, ClearEmptiesAllTheArrays) {
+  auto debug = DebugPrimitives();
+  debug.add_point(kOrigin);
+  debug.add_line(kX, kY);
+  debug.add_box(kX, kOrigin);
+  debug.add_frame(kOrigin, kX, kY, kZ);
+
+  debug.clear();
+  EXPECT_TRUE(debug.empty());
+  EXPECT_TRUE(debug.points().empty());
+  EXPECT_TRUE(debug.lines().empty());
+  EXPECT_TRUE(debug.boxes().empty());
+  EXPECT_TRUE(debug.frames().empty());
+}
+
+TEST(DebugPrimitivesTest, OnlyTheChangedKindsAreDirty) {
+  auto debug = DebugPrimitives();
+  debug.add_box(kX, kOrigin);
+
+  EXPECT_TRUE(debug.take_dirty(DebugPrimitives::Kind::Boxes));
+  EXPECT_FALSE(debug.take_dirty(DebugPrimitives::Kind::Boxes));
+  EXPECT_FALSE(debug.take_dirty(DebugPrimitives::Kind::Points));
+
+  // Clearing dirties only the kinds that had any primitives
+  debug.clear();
+  EXPECT_TRUE(debug.take_dirty(DebugPrimitives::Kind::Boxes));
+  EXPECT_FALSE(debug.take_dirty(DebugPrimitives::Kind::Frames));
+
+  debug.clear();
+  EXPECT_FALSE(debug.take_dirty(DebugPrimitives::Kind::Boxes));
+}
+
+}  // namespace mini
@@ -0,0 +1,83 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <liberay/math/vec.hpp>
+#include <libminicad/algorithm/flat_finishing_paths.hpp>
+#include <libminicad/algorithm/height_field.hpp>
+#include <libminicad/algorithm/paths_generator.hpp>
+#include <limits>
+#include <vector>
+
+namespace mini {
+
+namespace {
+
+constexpr uint32_t kSize = 200;
+
+const auto kMilling = MillingDesc{.width = 10.F, .height = 10.F};
+const auto kDesc    = FlatFinishingDesc{.level = 0.001F, .cutter_radius = 0.5F, .step_over = 0.8F, .safe_height = 3.F};
+
+/**
+ * @brief Flat base with a round island in the middle and a rectangular one close to the stock corner, so that some of
+ * the offset contours run between the islands and the border.
+ *
+ */
+TiledHeightField islands_heights() {
+  auto heights = TiledHeightField(kSize, kSize, 0.F);
+  for (auto z = 0U; z < kSize; ++z) {
+    for (auto x = 0U; x < kSize; ++x) {
+      auto p      = kMilling.texel_center(x, z, kSize, kSize);
+      auto round  = eray::math::length(p - eray::math::Vec2f(0.5F, -0.5F)) < 1.5F;
+      auto corner = p.x > 2.5F && p.x < 4.F && p.y > 2.F && p.y < 3.5F;
+      if (round || corner) {
+        heights.set(x, z, 1.F);
+      }
+    }
+  }
+  return heights;
+}
+
+}  // namespace
+
+TEST(FlatFinishingPathsTest, CutterKeepsItsRadiusFromTheObstacles) {
+  const auto heights = islands_heights();
+  const auto path    = FlatFinishingPaths::generate(heights, kMilling, kDesc);
+  ASSERT_FALSE(path.points.empty());
+
+  auto obstacles = std::vector<eray::math::Vec2f>();
+  for (auto z = 0U; z < kSize; ++z) {
+    for (auto x = 0U; x < kSize; ++x) {
+      if (heights.at(x, z) > kDesc.level) {
+        obstacles.push_back(kMilling.texel_center(x, z, kSize, kSize));
+      }
+    }
+  }
+
+  // The contours are interpolated between the texel centers, so they may come up to a texel closer
+  const auto texel     = kMilling.width / static_cast<float>(kSize);
+  const auto clearance = kDesc.cutter_radius - texel;
+  auto level_points    = size_t{0};
+  for (const auto& p : path.points) {
+    if (p.y != kDesc.level) {
+      EXPECT_FLOAT_EQ(p.y, kDesc.safe_height);
+      continue;
+    }
+
+    ++level_points;
+    auto nearest = std::numeric_limits<float>::max();
+    for (const auto& o : obstacles) {
+      nearest = std::min(nearest, eray::math::length(eray::math::Vec2f(p.x, p.z) - o));
+    }
+    EXPECT_GE(nearest, clearance) << "point " << p.x << ", " << p.z;
+  }
+  EXPECT_GT(level_points, 0U);
+}
+
+TEST(FlatFinishingPathsTest, FlatStockGivesAnEmptyPath) {
+  const auto heights = TiledHeightField(kSize, kSize, 0.F);
+  EXPECT_TRUE(FlatFinishingPaths::generate(heights, kMilling, kDesc).points.empty());
+}
+
+}  // namespace mini
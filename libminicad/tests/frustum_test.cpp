@@ -0,0 +1,52 @@
+#include <gtest/gtest.h>
+
+#include <liberay/math/vec.hpp>
+#include <libminicad/math/frustum.hpp>
+#include <utility>
+
+#include "camera_frustum.hpp"
+
+namespace mini {
+
+namespace {
+
+AxisAlignedBoundingBox box(const eray::math::Vec3f& center, float half_size) {
+  return std::make_pair(center - eray::math::Vec3f::filled(half_size), center + eray::math::Vec3f::filled(half_size));
+}
+
+}  // namespace
+
+TEST(FrustumTest, BoxInsideIsVisible) {
+  for (auto orthographic : {false, true}) {
+    auto frustum = test::camera_frustum(orthographic);
+    EXPECT_TRUE(frustum.intersects(box(eray::math::Vec3f(0.F, 0.F, 0.F), 1.F)));
+    EXPECT_TRUE(frustum.intersects(box(eray::math::Vec3f(2.F, -2.F, -5.F), 0.5F)));
+  }
+}
+
+TEST(FrustumTest, BoxOutsideOfAPlaneIsCulled) {
+  for (auto orthographic : {false, true}) {
+    auto frustum = test::camera_frustum(orthographic);
+    EXPECT_FALSE(frustum.intersects(box(eray::math::Vec3f(0.F, 0.F, 20.F), 1.F)));    // behind the camera
+    EXPECT_FALSE(frustum.intersects(box(eray::math::Vec3f(0.F, 0.F, -200.F), 1.F)));  // past the far plane
+    EXPECT_FALSE(frustum.intersects(box(eray::math::Vec3f(50.F, 0.F, 0.F), 1.F)));    // right of the frustum
+    EXPECT_FALSE(frustum.intersects(box(eray::math::Vec3f(0.F, -50.F, 0.F), 1.F)));   // below the frustum
+  }
+}
+
+TEST(FrustumTest, BoxStraddlingAPlaneIsVisible) {
+  auto frustum = test::camera_frustum(false);
+
+  // The right plane passes through x = 10 at z = 0
+  EXPECT_TRUE(frustum.intersects(box(eray::math::Vec3f(10.F, 0.F, 0.F), 1.F)));
+  EXPECT_TRUE(frustum.intersects(box(eray::math::Vec3f(0.F, 0.F, 10.F), 1.F)));   // near plane
+  EXPECT_TRUE(frustum.intersects(box(eray::math::Vec3f(0.F, 0.F, -90.F), 1.F)));  // far plane
+}
+
+TEST(FrustumTest, EmptyBoxIsNeverVisible) {
+  auto frustum = test::camera_frustum(false);
+  EXPECT_FALSE(frustum.intersects(points_aabb({})));
+  EXPECT_FALSE(frustum.intersects(std::make_pair(eray::math::Vec3f(1.F, 0.F, 0.F), eray::math::Vec3f(-1.F, 0.F, 0.F))));
+}
+
+}  // namespace mini
@@ -0,0 +1,183 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <libminicad/algorithm/height_field.hpp>
+#include <limits>
+#include <span>
+#include <utility>
+#include <vector>
+
+namespace mini {
+
+namespace {
+
+// Neither side is a multiple of the tile size, so the last tiles are partial
+constexpr uint32_t kWidth      = 300;
+constexpr uint32_t kHeight     = 200;
+constexpr float kBackground    = 1.F;
+constexpr uint32_t kTile       = TiledHeightField::kTileSize;
+constexpr float kLowest        = std::numeric_limits<float>::lowest();
+constexpr uint32_t kQueryCount = 500;
+
+/**
+ * @brief Deterministic pseudo-random numbers, so the failures are reproducible.
+ *
+ */
+class Lcg {
+ public:
+  uint32_t next(uint32_t bound) {
+    state_ = state_ * 6364136223846793005ULL + 1442695040888963407ULL;
+    return static_cast<uint32_t>(state_ >> 33) % bound;
+  }
+
+ private:
+  uint64_t state_ = 42;
+};
+
+/**
+ * @brief Background field with raised texels scattered over a few tiles, the rest of the tiles stay unallocated.
+ *
+ */
+std::vector<float> sparse_dense(Lcg& rng) {
+  auto dense = std::vector<float>(static_cast<size_t>(kWidth) * kHeight, kBackground);
+  for (auto i = 0U; i < 400; ++i) {
+    auto x = rng.next(kWidth / 2);
+    auto y = rng.next(kHeight);
+    dense[static_cast<size_t>(y) * kWidth + x] = kBackground + static_cast<float>(rng.next(1000)) * 0.01F;
+  }
+  return dense;
+}
+
+float brute_max(std::span<const float> dense, uint32_t x0, uint32_t y0, uint32_t x1, uint32_t y1) {
+  auto result = kLowest;
+  for (auto y = y0; y < std::min(y1, kHeight); ++y) {
+    for (auto x = x0; x < std::min(x1, kWidth); ++x) {
+      result = std::max(result, dense[static_cast<size_t>(y) * kWidth + x]);
+    }
+  }
+  return result;
+}
+
+/**
+ * @brief Compares the rectangle queries with the brute-force max, most of the rectangles cross the tile and the
+ * pyramid cell borders, so the query has to descend into the partially covered cells.
+ *
+ */
+void expect_range_max_matches(const TiledHeightField& field, std::span<const float> dense, Lcg& rng) {
+  for (auto i = 0U; i < kQueryCount; ++i) {
+    auto x0 = rng.next(kWidth + 10);
+    auto y0 = rng.next(kHeight + 10);
+    auto x1 = x0 + rng.next(kWidth);
+    auto y1 = y0 + rng.next(kHeight);
+    ASSERT_FLOAT_EQ(field.range_max(x0, y0, x1, y1), brute_max(dense, x0, y0, x1, y1))
+        << "rectangle [" << x0 << ", " << x1 << ") x [" << y0 << ", " << y1 << ")";
+  }
+  EXPECT_FLOAT_EQ(field.max(), brute_max(dense, 0, 0, kWidth, kHeight));
+}
+
+}  // namespace
+
+TEST(TiledHeightFieldTest, RangeMaxMatchesTheBruteForceMax) {
+  auto rng   = Lcg();
+  auto dense = sparse_dense(rng);
+  auto field = TiledHeightField::from_dense(kWidth, kHeight, kBackground, dense);
+
+  expect_range_max_matches(field, dense, rng);
+
+  // A single texel peak inside a partially covered cell of every level
+  dense[static_cast<size_t>(130) * kWidth + 131] = 50.F;
+  field.set(131, 130, 50.F);
+  EXPECT_FLOAT_EQ(field.range_max(131, 130, 132, 131), 50.F);
+  EXPECT_FLOAT_EQ(field.range_max(0, 0, 131, kHeight), brute_max(dense, 0, 0, 131, kHeight));
+  EXPECT_FLOAT_EQ(field.range_max(132, 0, kWidth, kHeight), brute_max(dense, 132, 0, kWidth, kHeight));
+  EXPECT_FLOAT_EQ(field.range_max(0, 131, kWidth, kHeight), brute_max(dense, 0, 131, kWidth, kHeight));
+  expect_range_max_matches(field, dense, rng);
+
+  EXPECT_FLOAT_EQ(field.range_max(10, 10, 10, 20), kLowest);
+  EXPECT_FLOAT_EQ(field.range_max(kWidth, 0, kWidth + 5, kHeight), kLowest);
+}
+
+TEST(TiledHeightFieldTest, LoweringATexelRefreshesTheLevels) {
+  auto rng   = Lcg();
+  auto dense = std::vector<float>(static_cast<size_t>(kWidth) * kHeight, kBackground);
+  auto field = TiledHeightField(kWidth, kHeight, kBackground);
+
+  field.set(70, 70, 9.F);
+  field.set(75, 72, 4.F);
+  field.set(250, 190, 6.F);
+  dense[static_cast<size_t>(70) * kWidth + 70]   = 9.F;
+  dense[static_cast<size_t>(72) * kWidth + 75]   = 4.F;
+  dense[static_cast<size_t>(190) * kWidth + 250] = 6.F;
+  EXPECT_FLOAT_EQ(field.max(), 9.F);
+
+  // The lowered texel was the max of its tile and of the whole field
+  field.set(70, 70, 2.F);
+  dense[static_cast<size_t>(70) * kWidth + 70] = 2.F;
+  EXPECT_FLOAT_EQ(field.max(), 6.F);
+  EXPECT_FLOAT_EQ(field.range_max(64, 64, 128, 128), 4.F);
+  expect_range_max_matches(field, dense, rng);
+
+  // Lowering below the background keeps the tile allocated
+  field.set(75, 72, -3.F);
+  dense[static_cast<size_t>(72) * kWidth + 75] = -3.F;
+  EXPECT_FLOAT_EQ(field.at(75, 72), -3.F);
+  EXPECT_FLOAT_EQ(field.range_max(75, 72, 76, 73), -3.F);
+  expect_range_max_matches(field, dense, rng);
+
+  // max_with never lowers a texel
+  field.max_with(250, 190, 5.F);
+  EXPECT_FLOAT_EQ(field.at(250, 190), 6.F);
+}
+
+TEST(TiledHeightFieldTest, FromDenseSkipsTheBackgroundTiles) {
+  auto dense = std::vector<float>(static_cast<size_t>(kWidth) * kHeight, kBackground);
+  dense[static_cast<size_t>(10) * kWidth + 10]   = 3.F;    // tile (0, 0)
+  dense[static_cast<size_t>(199) * kWidth + 299] = 0.5F;   // tile (4, 3), lower than the background
+  dense[static_cast<size_t>(100) * kWidth + 128] = 2.F;    // tile (2, 1)
+
+  auto field = TiledHeightField::from_dense(kWidth, kHeight, kBackground, dense);
+  EXPECT_EQ(field.tiles_count(), static_cast<size_t>((kWidth + kTile - 1) / kTile) * ((kHeight + kTile - 1) / kTile));
+  EXPECT_EQ(field.allocated_tiles(), 3U);
+  EXPECT_EQ(field.to_dense(), dense);
+
+  auto empty = TiledHeightField::from_dense(kWidth, kHeight, kBackground,
+                                            std::vector<float>(static_cast<size_t>(kWidth) * kHeight, kBackground));
+  EXPECT_EQ(empty.allocated_tiles(), 0U);
+  EXPECT_FLOAT_EQ(empty.max(), kBackground);
+}
+
+TEST(TiledHeightFieldTest, ReadRowCrossesTheTileEdges) {
+  auto rng   = Lcg();
+  auto dense = sparse_dense(rng);
+  for (auto x = 0U; x < kWidth; ++x) {
+    dense[static_cast<size_t>(kTile) * kWidth + x] = static_cast<float>(x);
+  }
+  auto field = TiledHeightField::from_dense(kWidth, kHeight, kBackground, dense);
+
+  for (auto y : {0U, kTile - 1, kTile, kHeight - 1}) {
+    for (auto [x0, count] : {std::pair{0U, kWidth}, std::pair{kTile - 3, 6U}, std::pair{kTile - 1, 2 * kTile + 2},
+                             std::pair{kWidth - 5, 5U}}) {
+      auto row = std::vector<float>(count, kLowest);
+      field.read_row(y, x0, row);
+
+      auto expected = std::span<const float>(dense).subspan(static_cast<size_t>(y) * kWidth + x0, count);
+      EXPECT_TRUE(std::ranges::equal(row, expected)) << "row " << y << " from " << x0;
+    }
+  }
+}
+
+TEST(TiledHeightFieldTest, MergeMaxKeepsTheHigherTexels) {
+  auto rng   = Lcg();
+  auto a     = sparse_dense(rng);
+  auto b     = sparse_dense(rng);
+  auto field = TiledHeightField::from_dense(kWidth, kHeight, kBackground, a);
+  field.merge_max(TiledHeightField::from_dense(kWidth, kHeight, kBackground, b));
+
+  auto merged = std::vector<float>(a.size());
+  std::ranges::transform(a, b, merged.begin(), [](float l, float r) { return std::max(l, r); });
+  EXPECT_EQ(field.to_dense(), merged);
+  expect_range_max_matches(field, merged, rng);
+}
+
+}  // namespace mini
@@ -0,0 +1,126 @@
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <libminicad/algorithm/height_field.hpp>
+#include <libminicad/algorithm/paths_generator.hpp>
+#include <libminicad/scene/scene.hpp>
+#include <string>
+#include <vector>
+
+#include "null_scene_renderer.hpp"
+
+namespace mini {
+
+namespace {
+
+// Magic, version, dimensions, center, stock extents, texel scale and checksum
+constexpr auto kHeaderSize = 8 + 3 * sizeof(uint32_t) + 7 * sizeof(float) + sizeof(uint64_t);
+
+/**
+ * @brief Removes the file when the test ends, also when an assertion fails.
+ *
+ */
+class TempFile {
+ public:
+  explicit TempFile(const std::string& name) : path_(std::filesystem::temp_directory_path() / name) {}
+  ~TempFile() { std::filesystem::remove(path_); }
+
+  TempFile(const TempFile&)            = delete;
+  TempFile(TempFile&&)                 = delete;
+  TempFile& operator=(const TempFile&) = delete;
+  TempFile& operator=(TempFile&&)      = delete;
+
+  [[nodiscard]] const std::filesystem::path& path() const { return path_; }
+
+ private:
+  std::filesystem::path path_;
+};
+
+const auto kDesc = MillingDesc{.center = eray::math::Vec3f(1.F, 1.5F, -2.F), .width = 12.F, .height = 9.F};
+
+/**
+ * @brief Field of 300x200 texels, neither side is a multiple of the tile size.
+ *
+ */
+TiledHeightField ramp_heights() {
+  static constexpr uint32_t kWidth  = 300;
+  static constexpr uint32_t kHeight = 200;
+
+  auto heights = std::vector<float>(static_cast<size_t>(kWidth) * kHeight);
+  for (auto i = size_t{0}; i < heights.size(); ++i) {
+    heights[i] = static_cast<float>(i % 997) * 0.01F;
+  }
+  return TiledHeightField::from_dense(kWidth, kHeight, kDesc.center.y, heights);
+}
+
+}  // namespace
+
+TEST(HeightMapTest, BinaryFileRoundTrip) {
+  auto scene = test::make_scene();
+  auto file  = TempFile("minicad_height_map_round_trip.bin");
+
+  auto map = HeightMap::from_samples(scene, ramp_heights(), kDesc);
+  ASSERT_TRUE(map.save_to_file(file.path()));
+
+  auto loaded = HeightMap::load_from_file(scene, file.path());
+  ASSERT_TRUE(loaded);
+  EXPECT_EQ(loaded->width(), map.width());
+  EXPECT_EQ(loaded->height(), map.height());
+  EXPECT_EQ(loaded->heights.to_dense(), map.heights.to_dense());
+  EXPECT_FLOAT_EQ(loaded->desc.center.x, kDesc.center.x);
+  EXPECT_FLOAT_EQ(loaded->desc.center.y, kDesc.center.y);
+  EXPECT_FLOAT_EQ(loaded->desc.center.z, kDesc.center.z);
+  EXPECT_FLOAT_EQ(loaded->desc.width, kDesc.width);
+  EXPECT_FLOAT_EQ(loaded->desc.height, kDesc.height);
+}
+
+TEST(HeightMapTest, CorruptedFileIsRejected) {
+  auto scene = test::make_scene();
+  auto file  = TempFile("minicad_height_map_corrupted.bin");
+  ASSERT_TRUE(HeightMap::from_samples(scene, ramp_heights(), kDesc).save_to_file(file.path()));
+
+  {
+    // Flips the bits of a single byte of the heights
+    auto stream = std::fstream(file.path(), std::ios::in | std::ios::out | std::ios::binary);
+    stream.seekg(static_cast<std::streamoff>(kHeaderSize + 1234));
+    auto byte = static_cast<char>(stream.get());
+    stream.seekp(static_cast<std::streamoff>(kHeaderSize + 1234));
+    stream.put(static_cast<char>(~byte));
+  }
+
+  EXPECT_FALSE(HeightMap::load_from_file(scene, file.path()));
+}
+
+TEST(HeightMapTest, TruncatedFileIsRejected) {
+  auto scene = test::make_scene();
+  auto file  = TempFile("minicad_height_map_truncated.bin");
+  ASSERT_TRUE(HeightMap::from_samples(scene, ramp_heights(), kDesc).save_to_file(file.path()));
+
+  std::filesystem::resize_file(file.path(), std::filesystem::file_size(file.path()) - sizeof(float));
+  EXPECT_FALSE(HeightMap::load_from_file(scene, file.path()));
+
+  std::filesystem::resize_file(file.path(), kHeaderSize);
+  EXPECT_FALSE(HeightMap::load_from_file(scene, file.path()));
+}
+
+TEST(HeightMapTest, TextFileFallsBackToTheLegacyReader) {
+  auto scene = test::make_scene();
+  auto file  = TempFile("minicad_height_map_legacy.txt");
+  {
+    auto stream = std::ofstream(file.path());
+    stream << "2 2\n0.5\n1.25\n-0.75\n2\n";
+  }
+
+  auto loaded = HeightMap::load_from_file(scene, file.path());
+  ASSERT_TRUE(loaded);
+  ASSERT_EQ(loaded->width(), 2U);
+  ASSERT_EQ(loaded->height(), 2U);
+  EXPECT_FLOAT_EQ(loaded->heights.at(0, 0), 0.5F);
+  EXPECT_FLOAT_EQ(loaded->heights.at(1, 0), 1.25F);
+  EXPECT_FLOAT_EQ(loaded->heights.at(0, 1), -0.75F);
+  EXPECT_FLOAT_EQ(loaded->heights.at(1, 1), 2.F);
+}
+
+}  // namespace mini
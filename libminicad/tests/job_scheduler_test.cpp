@@ -0,0 +1,94 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <libminicad/jobs/job_context.hpp>
+#include <libminicad/jobs/job_scheduler.hpp>
+#include <optional>
+#include <stdexcept>
+#include <thread>
+
+namespace mini {
+
+namespace {
+
+/**
+ * @brief Polls the scheduler like the main loop does until the result of the job is available.
+ *
+ */
+template <typename T>
+JobResult<T> wait_for(JobScheduler& scheduler, JobHandle<T>& handle) {
+  while (true) {
+    scheduler.poll();
+    if (auto result = handle.try_take()) {
+      return std::move(*result);
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+}
+
+}  // namespace
+
+TEST(JobSchedulerTest, ValueIsDeliveredOnPoll) {
+  auto scheduler = JobScheduler::create(2);
+  auto handle    = scheduler.submit<int>("value", [](const JobContext&) { return 42; });
+
+  auto result = wait_for(scheduler, handle);
+  ASSERT_TRUE(result);
+  EXPECT_EQ(*result, 42);
+  EXPECT_FLOAT_EQ(handle.progress(), 1.F);
+  EXPECT_TRUE(scheduler.is_idle());
+}
+
+TEST(JobSchedulerTest, VoidJobsAreSupported) {
+  auto scheduler = JobScheduler::create(1);
+  auto ran       = std::atomic<bool>(false);
+  auto done      = std::optional<JobResult<void>>();
+  auto handle    = scheduler.submit<void>(
+      "void", [&ran](const JobContext&) { ran = true; }, [&done](JobResult<void>&& result) { done = result; });
+
+  while (!done) {
+    scheduler.poll();
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  EXPECT_TRUE(ran);
+  EXPECT_TRUE(*done);
+  EXPECT_TRUE(handle.is_finished());
+}
+
+TEST(JobSchedulerTest, ExceptionsAreReportedAsFailures) {
+  auto scheduler = JobScheduler::create(1);
+  auto std_error = scheduler.submit<int>("std", [](const JobContext&) -> int { throw std::runtime_error("boom"); });
+  auto unknown   = scheduler.submit<int>("unknown", [](const JobContext&) -> int { throw 7; });
+
+  auto std_result = wait_for(scheduler, std_error);
+  ASSERT_FALSE(std_result);
+  EXPECT_EQ(std_result.error(), JobError::Failed);
+
+  auto unknown_result = wait_for(scheduler, unknown);
+  ASSERT_FALSE(unknown_result);
+  EXPECT_EQ(unknown_result.error(), JobError::Failed);
+}
+
+TEST(JobSchedulerTest, CancelledJobReportsCancellation) {
+  auto scheduler = JobScheduler::create(1);
+  auto started   = std::atomic<bool>(false);
+  auto handle    = scheduler.submit<int>("cancelled", [&started](const JobContext& ctx) {
+    started = true;
+    while (!ctx.is_cancelled()) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return 1;
+  });
+
+  while (!started) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  handle.cancel();
+
+  auto result = wait_for(scheduler, handle);
+  ASSERT_FALSE(result);
+  EXPECT_EQ(result.error(), JobError::Cancelled);
+}
+
+}  // namespace mini
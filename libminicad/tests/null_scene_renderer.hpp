@@ -0,0 +1,74 @@
+#pragma once
+
+#include <cstdint>
+#include <libminicad/renderer/scene_renderer.hpp>
+#include <libminicad/scene/scene.hpp>
+#include <memory>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace mini::test {
+
+/**
+ * @brief Scene renderer that drops all the commands, lets the tests create a scene without a GL context.
+ *
+ */
+class NullSceneRenderer final : public ISceneRenderer {
+ public:
+  void push_object_rs_cmd(const RSCommand&) override {}
+
+  std::optional<ObjectRS> object_rs(const ObjectHandle&) override { return std::nullopt; }
+  void set_object_rs(const ObjectHandle&, const ObjectRS&) override {}
+
+  void add_billboard(zstring_view name, const eray::res::Image&) override { billboards_[std::string(name)] = {}; }
+  BillboardRS& billboard(zstring_view name) override { return billboards_[std::string(name)]; }
+
+  void show_grid(bool) override {}
+  bool is_grid_shown() const override { return false; }
+
+  void show_polylines(bool) override {}
+  bool are_polylines_shown() const override { return false; }
+
+  void show_points(bool) override {}
+  bool are_points_shown() const override { return false; }
+
+  void resize_viewport(eray::math::Vec2i) override {}
+  SamplingResult sample_mouse_pick_box(Scene&, size_t, size_t, size_t, size_t) const override { return std::nullopt; }
+
+  void set_anaglyph_rendering_enabled(bool) override {}
+  bool is_anaglyph_rendering_enabled() const override { return false; }
+  eray::math::Vec3f anaglyph_output_color_coeffs() const override { return eray::math::Vec3f::filled(0.F); }
+  void set_anaglyph_output_color_coeffs(const eray::math::Vec3f&) override {}
+
+  TextureHandle upload_texture(const std::vector<uint32_t>&, size_t, size_t) override {
+    return TextureHandle(0, 0, next_texture_id_++);
+  }
+  void reupload_texture(const TextureHandle&, const std::vector<uint32_t>&, size_t, size_t) override {}
+  void delete_texture(const TextureHandle&) override {}
+  std::optional<Texture> get_texture_info(const TextureHandle&) override { return std::nullopt; }
+  void draw_imgui_texture_image(const TextureHandle&, size_t, size_t) override {}
+
+  void update(Scene&) override {}
+  RSCommandStats rs_command_stats() const override { return {}; }
+
+  void render(const Camera&) override {}
+
+  void debug_point(const eray::math::Vec3f&) override {}
+  void debug_line(const eray::math::Vec3f&, const eray::math::Vec3f&) override {}
+  void debug_box(const eray::math::Vec3f&, const eray::math::Vec3f&) override {}
+  void clear_debug() override {}
+  void debug_frame(const eray::math::Vec3f&, const eray::math::Vec3f&, const eray::math::Vec3f&,
+                   const eray::math::Vec3f&, float) override {}
+
+  void clear() override {}
+
+ private:
+  std::unordered_map<std::string, BillboardRS> billboards_;
+  uint32_t next_texture_id_ = 1;
+};
+
+inline Scene make_scene() { return Scene(std::make_unique<NullSceneRenderer>()); }
+
+}  // namespace mini::test
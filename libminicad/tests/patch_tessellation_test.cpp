@@ -0,0 +1,98 @@
+#include <gtest/gtest.h>
+
+#include <array>
+#include <cmath>
+#include <liberay/math/mat.hpp>
+#include <liberay/math/vec.hpp>
+#include <libminicad/camera/camera.hpp>
+#include <libminicad/renderer/patch_tessellation.hpp>
+#include <numbers>
+#include <span>
+
+namespace mini {
+
+namespace {
+
+const auto kViewport = eray::math::Vec2f(1000.F, 1000.F);
+
+/**
+ * @brief Flat 4x4 control hull of the given size, parallel to the screen and centered on the view axis.
+ *
+ */
+std::array<eray::math::Vec3f, PatchTessellation::kHullSize> square_hull(float size, float z) {
+  auto hull = std::array<eray::math::Vec3f, PatchTessellation::kHullSize>();
+  for (auto j = 0U; j < 4; ++j) {
+    for (auto i = 0U; i < 4; ++i) {
+      hull[j * 4 + i] = eray::math::Vec3f(size * (static_cast<float>(i) / 3.F - 0.5F),
+                                          size * (static_cast<float>(j) / 3.F - 0.5F), z);
+    }
+  }
+  return hull;
+}
+
+eray::math::Mat4f pv_matrix() {
+  auto camera = Camera(false, std::numbers::pi_v<float> / 2.F, 1.F, 0.1F, 100.F);
+  return camera.proj_matrix() * camera.view_matrix();
+}
+
+}  // namespace
+
+TEST(PatchTessellationTest, FactorIsClampedToTheUserLevel) {
+  const auto pv = pv_matrix();
+
+  EXPECT_FLOAT_EQ(PatchTessellation::factor(square_hull(50.F, -1.F), pv, kViewport), 1.F);
+
+  auto partial = square_hull(1.F, -5.F);
+  EXPECT_FLOAT_EQ(PatchTessellation::factor(std::span(partial).first(4), pv, kViewport), 1.F);
+}
+
+TEST(PatchTessellationTest, FactorFallsWithTheProjectedSize) {
+  const auto pv = pv_matrix();
+
+  auto near    = PatchTessellation::factor(square_hull(2.F, -5.F), pv, kViewport);
+  auto far     = PatchTessellation::factor(square_hull(2.F, -10.F), pv, kViewport);
+  auto farther = PatchTessellation::factor(square_hull(2.F, -20.F), pv, kViewport);
+  EXPECT_LT(near, 1.F);
+  EXPECT_LT(far, near);
+  EXPECT_LT(farther, far);
+  EXPECT_GT(farther, PatchTessellation::kMinFactor);
+
+  auto small = PatchTessellation::factor(square_hull(1.F, -5.F), pv, kViewport);
+  EXPECT_NEAR(small, 0.5F * near, 1.F / PatchTessellation::kFactorSteps);
+}
+
+TEST(PatchTessellationTest, FactorIsQuantized) {
+  const auto pv = pv_matrix();
+
+  for (auto z : {-3.F, -5.F, -7.5F, -10.F}) {
+    auto factor = PatchTessellation::factor(square_hull(2.F, z), pv, kViewport);
+    auto steps  = factor * PatchTessellation::kFactorSteps;
+    EXPECT_FLOAT_EQ(steps, std::round(steps));
+  }
+
+  // A camera move much smaller than a step keeps the factor
+  auto hull  = square_hull(2.F, -5.3F);
+  auto moved = square_hull(2.F, -5.301F);
+  EXPECT_FLOAT_EQ(PatchTessellation::factor(hull, pv, kViewport), PatchTessellation::factor(moved, pv, kViewport));
+}
+
+TEST(PatchTessellationTest, FactorIsMinimalForInvisibleOrDegenerateHulls) {
+  const auto pv = pv_matrix();
+
+  EXPECT_FLOAT_EQ(PatchTessellation::factor(square_hull(2.F, 5.F), pv, kViewport), PatchTessellation::kMinFactor);
+  EXPECT_FLOAT_EQ(PatchTessellation::factor(square_hull(0.F, -5.F), pv, kViewport), PatchTessellation::kMinFactor);
+  EXPECT_FLOAT_EQ(PatchTessellation::factor(square_hull(1e-3F, -50.F), pv, kViewport),
+                  PatchTessellation::kMinFactor);
+}
+
+TEST(PatchTessellationTest, HullCrossingTheCameraPlaneGetsTheFullDetail) {
+  const auto pv = pv_matrix();
+
+  auto hull = square_hull(2.F, -5.F);
+  for (auto i = 0U; i < 4; ++i) {
+    hull[i].z = 5.F;
+  }
+  EXPECT_FLOAT_EQ(PatchTessellation::factor(hull, pv, kViewport), 1.F);
+}
+
+}  // namespace mini
@@ -0,0 +1,116 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <liberay/math/vec.hpp>
+#include <libminicad/algorithm/height_field.hpp>
+#include <libminicad/algorithm/paths_generator.hpp>
+#include <libminicad/algorithm/roughing_paths.hpp>
+#include <optional>
+#include <vector>
+
+namespace mini {
+
+namespace {
+
+constexpr uint32_t kResolution = 150;
+constexpr float kEpsilon       = 1e-3F;
+
+/**
+ * @brief Dome sticking out of the layers in the middle of the stock, stands in for the cutter-offset heights.
+ *
+ */
+TiledHeightField dome_field() {
+  auto dense = std::vector<float>(kResolution * kResolution, 0.F);
+  for (auto z = 0U; z < kResolution; ++z) {
+    for (auto x = 0U; x < kResolution; ++x) {
+      auto dx = (static_cast<float>(x) - 75.F) / 30.F;
+      auto dz = (static_cast<float>(z) - 75.F) / 30.F;
+      auto r  = 1.F - dx * dx - dz * dz;
+      if (r > 0.F) {
+        dense[z * kResolution + x] = 4.F * std::sqrt(r);
+      }
+    }
+  }
+  return TiledHeightField::from_dense(kResolution, kResolution, 0.F, dense);
+}
+
+/**
+ * @brief Texel whose center lies at the coordinate, nullopt if the coordinate falls between the centers.
+ *
+ */
+std::optional<uint32_t> texel_at(float coord, float extent) {
+  auto t     = (coord + extent / 2.F) / extent * static_cast<float>(kResolution) - 0.5F;
+  auto texel = std::round(t);
+  if (std::abs(t - texel) > 1e-3F || texel < 0.F || texel >= static_cast<float>(kResolution)) {
+    return std::nullopt;
+  }
+  return static_cast<uint32_t>(texel);
+}
+
+}  // namespace
+
+TEST(RoughingPathsTest, PathStaysAboveTheLayersAndTheOffsetHeights) {
+  const auto field   = dome_field();
+  const auto milling = MillingDesc{};
+  const auto desc    = RoughingDesc{.stock_top = 5.F, .layer_depths = {1.75F, 3.5F}, .step_over = 1.2F};
+
+  auto path = RoughingPaths::generate(field, milling, desc);
+  ASSERT_GT(path.points.size(), 2U);
+
+  const auto floor = desc.stock_top - desc.layer_depths.back();
+  for (const auto& p : path.points) {
+    EXPECT_GE(p.y, floor - kEpsilon);
+    EXPECT_LE(p.y, desc.stock_top + desc.clearance + kEpsilon);
+  }
+
+  // The simplified passes are checked at every texel center they cross, not only at their ends
+  auto checked = size_t{0};
+  for (auto i = size_t{1}; i < path.points.size(); ++i) {
+    const auto& a = path.points[i - 1];
+    const auto& b = path.points[i];
+    auto z        = texel_at(a.z, milling.height);
+    if (!z || a.z != b.z || a.x == b.x) {
+      continue;
+    }
+
+    auto texel_x = milling.width / static_cast<float>(kResolution);
+    for (auto x = std::min(a.x, b.x); x <= std::max(a.x, b.x) + kEpsilon; x += texel_x) {
+      auto tx = texel_at(x, milling.width);
+      if (!tx) {
+        continue;
+      }
+      auto center = milling.texel_center(*tx, *z, kResolution, kResolution).x;
+      auto y      = a.y + (center - a.x) / (b.x - a.x) * (b.y - a.y);
+      EXPECT_GE(y, field.at(*tx, *z) - kEpsilon) << "texel " << *tx << ", " << *z;
+      ++checked;
+    }
+  }
+  EXPECT_GT(checked, kResolution);
+}
+
+TEST(RoughingPathsTest, EveryLayerIsMilledAtItsDepth) {
+  const auto field = dome_field();
+  const auto desc  = RoughingDesc{.stock_top = 5.F, .layer_depths = {1.75F, 3.5F}, .step_over = 1.2F};
+
+  auto path = RoughingPaths::generate(field, MillingDesc{}, desc);
+  for (auto depth : desc.layer_depths) {
+    auto layer_h = desc.stock_top - depth;
+    EXPECT_TRUE(std::ranges::any_of(path.points, [&](const auto& p) { return std::abs(p.y - layer_h) < kEpsilon; }))
+        << "layer at " << layer_h;
+  }
+
+  // The dome peak sticks out of both layers, so the passes over it follow the dome instead of the layer
+  EXPECT_TRUE(std::ranges::any_of(path.points, [&](const auto& p) { return p.y > desc.stock_top - 1.F; }));
+}
+
+TEST(RoughingPathsTest, EmptyInputsGiveAnEmptyPath) {
+  auto no_layers = RoughingDesc{.layer_depths = {}};
+  EXPECT_TRUE(RoughingPaths::generate(dome_field(), MillingDesc{}, no_layers).points.empty());
+
+  auto empty = TiledHeightField::from_dense(0, 0, 0.F, {});
+  EXPECT_TRUE(RoughingPaths::generate(empty, MillingDesc{}, RoughingDesc{}).points.empty());
+}
+
+}  // namespace mini
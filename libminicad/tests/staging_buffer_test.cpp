@@ -0,0 +1,132 @@
+#include <gtest/gtest.h>
+
+#include <cstddef>
+#include <libminicad/renderer/gl/staging_buffer.hpp>
+#include <span>
+#include <utility>
+#include <vector>
+
+namespace mini::gl {
+
+namespace {
+
+struct Upload {
+  size_t offset;
+  std::vector<int> data;
+};
+
+struct SyncResult {
+  std::vector<size_t> reallocations;
+  std::vector<Upload> uploads;
+};
+
+SyncResult sync(StagingBuffer<int>& buffer) {
+  auto result = SyncResult{};
+  buffer.sync(
+      [&](size_t capacity, std::span<const int> data) {
+        EXPECT_GE(capacity, data.size());
+        result.reallocations.push_back(capacity);
+      },
+      [&](size_t offset, std::span<const int> data) {
+        result.uploads.push_back(Upload{.offset = offset, .data = {data.begin(), data.end()}});
+      });
+  return result;
+}
+
+StagingBuffer<int> synced_buffer(size_t count) {
+  auto buffer = StagingBuffer<int>();
+  buffer.resize(count);
+  sync(buffer);
+  return buffer;
+}
+
+}  // namespace
+
+TEST(StagingBufferTest, FirstSyncAllocatesTheInitialCapacity) {
+  auto buffer = StagingBuffer<int>();
+  buffer.push_back(1);
+
+  auto result = sync(buffer);
+  EXPECT_EQ(result.reallocations, std::vector<size_t>{StagingBuffer<int>::kInitialCapacity});
+  EXPECT_TRUE(result.uploads.empty());
+  EXPECT_FALSE(buffer.is_dirty());
+}
+
+TEST(StagingBufferTest, NearbyDirtyRangesAreMerged) {
+  auto buffer = synced_buffer(64);
+  buffer.write(2)  = 1;
+  buffer.write(10) = 2;
+  buffer.write(5)  = 3;
+
+  auto result = sync(buffer);
+  ASSERT_TRUE(result.reallocations.empty());
+  ASSERT_EQ(result.uploads.size(), 1U);
+  EXPECT_EQ(result.uploads[0].offset, 2U);
+  EXPECT_EQ(result.uploads[0].data.size(), 9U);
+  EXPECT_EQ(result.uploads[0].data.front(), 1);
+  EXPECT_EQ(result.uploads[0].data[3], 3);
+  EXPECT_EQ(result.uploads[0].data.back(), 2);
+}
+
+TEST(StagingBufferTest, DistantDirtyRangesAreUploadedSeparately) {
+  auto buffer = synced_buffer(64);
+  buffer.write(40) = 1;
+  buffer.write(0, 4);
+  buffer.write(40 + StagingBuffer<int>::kMergeGap + 5) = 2;
+
+  auto result = sync(buffer);
+  ASSERT_EQ(result.uploads.size(), 3U);
+  EXPECT_EQ(result.uploads[0].offset, 0U);
+  EXPECT_EQ(result.uploads[0].data.size(), 4U);
+  EXPECT_EQ(result.uploads[1].offset, 40U);
+  EXPECT_EQ(result.uploads[1].data.size(), 1U);
+  EXPECT_EQ(result.uploads[2].offset, 40U + StagingBuffer<int>::kMergeGap + 5);
+  EXPECT_EQ(result.uploads[2].data.size(), 1U);
+}
+
+TEST(StagingBufferTest, SyncClearsTheDirtyRanges) {
+  auto buffer = synced_buffer(64);
+  buffer.write(7) = 1;
+  sync(buffer);
+
+  EXPECT_FALSE(buffer.is_dirty());
+  auto result = sync(buffer);
+  EXPECT_TRUE(result.reallocations.empty());
+  EXPECT_TRUE(result.uploads.empty());
+}
+
+TEST(StagingBufferTest, OutgrowingTheCapacityDoublesItAndReallocatesOnce) {
+  auto buffer = synced_buffer(StagingBuffer<int>::kInitialCapacity);
+  for (auto i = 0; i < 3 * static_cast<int>(StagingBuffer<int>::kInitialCapacity); ++i) {
+    buffer.push_back(i);
+  }
+
+  EXPECT_EQ(buffer.capacity(), 4 * StagingBuffer<int>::kInitialCapacity);
+  auto result = sync(buffer);
+  EXPECT_EQ(result.reallocations, std::vector<size_t>{4 * StagingBuffer<int>::kInitialCapacity});
+  EXPECT_TRUE(result.uploads.empty());
+
+  buffer.write(0) = 1;
+  result          = sync(buffer);
+  EXPECT_TRUE(result.reallocations.empty());
+  EXPECT_EQ(result.uploads.size(), 1U);
+}
+
+TEST(StagingBufferTest, SwapRemoveMovesTheLastElement) {
+  auto buffer = synced_buffer(0);
+  for (auto i = 0; i < 5; ++i) {
+    buffer.push_back(i);
+  }
+  sync(buffer);
+
+  EXPECT_EQ(buffer.swap_remove(1), 4U);
+  EXPECT_EQ(buffer.size(), 4U);
+  EXPECT_EQ(buffer[1], 4);
+
+  auto result = sync(buffer);
+  ASSERT_EQ(result.uploads.size(), 1U);
+  EXPECT_EQ(result.uploads[0].offset, 1U);
+  EXPECT_EQ(result.uploads[0].data, std::vector<int>{4});
+}
+
+}  // namespace mini::gl
@@ -0,0 +1,14 @@
+#version 430 core
+
+// USAGE:
+// Render as instanced GL_LINES, 24 vertices per box
+
+layout (location = 0) in vec3 a_corner;
+layout (location = 1) in vec3 a_min;
+layout (location = 2) in vec3 a_max;
+
+uniform mat4 u_pvMat;
+
+void main() {
+    gl_Position = u_pvMat * vec4(mix(a_min, a_max, a_corner), 1.0);
+}
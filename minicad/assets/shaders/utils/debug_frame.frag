@@ -0,0 +1,9 @@
+#version 430 core
+
+in vec4 axisColor;
+
+layout(location = 0) out vec4 fragColor;
+
+void main() {
+    fragColor = axisColor;
+}
@@ -0,0 +1,27 @@
+#version 430 core
+
+// USAGE:
+// Render as instanced GL_LINES, 6 vertices per frame
+
+layout (location = 0) in vec2 a_axisVertex; // x: axis index, y: 0 at the origin, 1 at the end of the axis
+layout (location = 1) in vec3 a_origin;
+layout (location = 2) in vec3 a_xAxis;
+layout (location = 3) in vec3 a_yAxis;
+layout (location = 4) in vec3 a_zAxis;
+
+uniform mat4 u_pvMat;
+
+out vec4 axisColor;
+
+const vec4 AxisColors[3] = vec4[3](
+    vec4(0.9, 0.2, 0.2, 1.0),
+    vec4(0.2, 0.8, 0.2, 1.0),
+    vec4(0.2, 0.4, 1.0, 1.0)
+);
+
+void main() {
+    int axis = int(a_axisVertex.x);
+    vec3 dir = axis == 0 ? a_xAxis : (axis == 1 ? a_yAxis : a_zAxis);
+    gl_Position = u_pvMat * vec4(a_origin + a_axisVertex.y * dir, 1.0);
+    axisColor = AxisColors[axis];
+}
@@ -28,6 +28,7 @@
 #include <liberay/util/variant_match.hpp>
 #include <libminicad/algorithm/hole_finder.hpp>
 #include <libminicad/algorithm/intersection_finder.hpp>
+#include <libminicad/jobs/job_scheduler.hpp>
 #include <libminicad/renderer/gl/opengl_scene_renderer.hpp>
 #include <libminicad/renderer/rendering_command.hpp>
 #include <libminicad/renderer/scene_renderer.hpp>
@@ -49,6 +50,7 @@
 #include <minicad/gui_components/object_list.hpp>
 #include <minicad/imgui/modals.hpp>
 #include <minicad/imgui/reorder_dnd.hpp>
+#include <minicad/imgui/scene_obj_list.hpp>
 #include <minicad/imgui/transform.hpp>
 #include <minicad/imgui/transform_gizmo.hpp>
 #include <minicad/selection/selection.hpp>
@@ -128,6 +130,7 @@ MiniCadApp MiniCadApp::create(std::unique_ptr<os::Window> window) {
                         .non_transformable_selection = std::make_unique<NonTransformableSelection>(),  //
                         .helper_point_selection      = HelperPointSelection(),                         //
                         .milling_height_map          = {},
+                        .jobs                        = JobScheduler::create(),
                     });
 }
 
@@ -249,8 +252,8 @@ void MiniCadApp::gui_objects_list_window() {
     }
   }
 
-  static auto hide_points = false;
-  ImGui::Checkbox("Hide points", &hide_points);
+  static auto obj_list = ImGui::mini::SceneObjList();
+  obj_list.filter_widgets();
   ImGui::Separator();
 
   static std::optional<ObjectHandle> selected_single_handle  = std::nullopt;
@@ -311,27 +314,16 @@ void MiniCadApp::gui_objects_list_window() {
       std::visit(match{draw_obj}, h);
     };
 
-    auto skip_point = [&](const PointObjectHandle& h) {
-      if (hide_points) {
-        if (auto opt = m_.scene.arena<PointObject>().get_obj(h)) {
-          const auto& obj = **opt;
-          if (obj.has_type<Point>()) {
-            return true;
-          }
-        }
-      }
-
-      return false;
-    };
-
-    for (const auto& handle : m_.scene.handles()) {
-      if (std::visit(util::match{skip_point, [](const auto&) { return false; }}, handle)) {
-        continue;
+    // Only the visible rows of the cached filtered list are drawn
+    const auto& indices = obj_list.indices(m_.scene);
+    auto clipper        = ImGuiListClipper();
+    clipper.Begin(static_cast<int>(indices.size()));
+    while (clipper.Step()) {
+      for (auto row = clipper.DisplayStart; row < clipper.DisplayEnd; ++row) {
+        const auto& handle = obj_list.handle(m_.scene, static_cast<size_t>(row));
+        std::visit(util::match{draw_transformable_obj, draw_item_non_transformable_obj}, handle);
+        std::visit(util::match{drop_target, drop_source, [](const auto&) {}}, handle);
       }
-
-      std::visit(util::match{draw_transformable_obj, draw_item_non_transformable_obj}, handle);
-      std::visit(util::match{drop_target, [](const auto&) {}}, handle);
-      std::visit(util::match{drop_source, [](const auto&) {}}, handle);
     }
   }
 
@@ -498,7 +490,7 @@ void MiniCadApp::gui_object_window() {
         object_name = curve.name;
       }
       if (ImGui::mini::RenameModal("Rename object", object_name)) {
-        obj.value()->name = object_name;
+        obj.value()->set_name(std::string(object_name));
       }
 
       if (ImGui::Button("Create BPatches")) {
@@ -597,7 +589,7 @@ void MiniCadApp::gui_object_window() {
         object_name = patch.name;
       }
       if (ImGui::mini::RenameModal("Rename object", object_name)) {
-        obj.value()->name = object_name;
+        obj.value()->set_name(std::string(object_name));
       }
 
       int t     = patch.tess_level();
@@ -634,7 +626,7 @@ void MiniCadApp::gui_object_window() {
         object_name = obj.name;
       }
       if (ImGui::mini::RenameModal("Rename object", object_name)) {
-        obj.name = object_name;
+        obj.set_name(std::string(object_name));
       }
 
       std::visit(util::match{[&](auto& o) {
@@ -658,7 +650,7 @@ void MiniCadApp::gui_object_window() {
         object_name = obj.name;
       }
       if (ImGui::mini::RenameModal("Rename object", object_name)) {
-        obj.name = object_name;
+        obj.set_name(std::string(object_name));
       }
 
       std::visit(util::match{[&](auto& o) {
@@ -704,7 +696,7 @@ void MiniCadApp::gui_object_window() {
         object_name = patch.name;
       }
       if (ImGui::mini::RenameModal("Rename object", object_name)) {
-        obj.value()->name = object_name;
+        obj.value()->set_name(std::string(object_name));
       }
 
       int t     = patch.tess_level();
@@ -732,16 +724,18 @@ void MiniCadApp::gui_object_window() {
         object_name = patch.name;
       }
       if (ImGui::mini::RenameModal("Rename object", object_name)) {
-        obj.value()->name = object_name;
+        obj.value()->set_name(std::string(object_name));
       }
 
+      static auto curvature_weight = 0.F;
+      ImGui::SliderFloat("Curvature weight", &curvature_weight, 0.F, 1.F);
       if (ImGui::Button("Create Natural Spline")) {
         ImGui::mini::OpenModal("Natural Spline");
       }
 
       static auto points = 3;
       if (ImGui::mini::NaturalSplineModal("Natural Spline", points)) {
-        on_natural_spline_from_approx_curve(h, static_cast<size_t>(points));
+        on_natural_spline_from_approx_curve(h, static_cast<size_t>(points), curvature_weight);
       }
     }
   };
@@ -757,6 +751,30 @@ void MiniCadApp::gui_object_window() {
   ImGui::End();
 }
 
+void MiniCadApp::gui_jobs_window() {
+  if (m_.jobs.is_idle()) {
+    return;
+  }
+
+  ImGui::Begin(ICON_FA_GEARS " Jobs");
+  for (const auto& [i, info] : std::views::enumerate(m_.jobs.jobs())) {
+    ImGui::PushID(static_cast<int>(i));
+    ImGui::Text("%s", info.name.c_str());
+    ImGui::ProgressBar(info.progress, ImVec2(-1.F, 0.F), info.status == JobStatus::Queued ? "Queued" : nullptr);
+    if (!info.message.empty()) {
+      ImGui::TextDisabled("%s", info.message.c_str());
+    }
+    ImGui::BeginDisabled(info.cancel_requested);
+    if (ImGui::Button(ICON_FA_XMARK " Cancel")) {
+      m_.jobs.cancel(static_cast<size_t>(i));
+    }
+    ImGui::EndDisabled();
+    ImGui::Separator();
+    ImGui::PopID();
+  }
+  ImGui::End();
+}
+
 void MiniCadApp::render_gui(Duration /* delta */) {
   ImGui::ShowDemoWindow();
 
@@ -801,6 +819,8 @@ void MiniCadApp::render_gui(Duration /* delta */) {
     }
 
     ImGui::Text("FPS: %d", fps_);
+    auto cmd_stats = m_.scene.renderer().rs_command_stats();
+    ImGui::Text("Render commands: %zu (%zu applied)", cmd_stats.pushed, cmd_stats.applied);
     ImGui::Checkbox(ICON_FA_TABLE " Grid", &m_.grid_on);
 
     bool points = m_.scene.renderer().are_points_shown();
@@ -837,8 +857,9 @@ void MiniCadApp::render_gui(Duration /* delta */) {
         Logger::info("File dialog error");
       }
     }
-    m_.scene.renderer().draw_imgui_texture_image(m_.milling_height_map->height_map_handle, HeightMap::kHeightMapSize,
-                                                 HeightMap::kHeightMapSize);
+    m_.scene.renderer().draw_imgui_texture_image(m_.milling_height_map->height_map_handle,
+                                                 m_.milling_height_map->preview_width,
+                                                 m_.milling_height_map->preview_height);
   }
   ImGui::End();
 
@@ -894,6 +915,7 @@ void MiniCadApp::render_gui(Duration /* delta */) {
   gui_objects_list_window();
   gui_transform_window();
   gui_object_window();
+  gui_jobs_window();
 
   ImGui::Begin(ICON_FA_TOOLBOX " Tools");
   bool selected = m_.tool_state == ToolState::Cursor;
@@ -1040,6 +1062,8 @@ void MiniCadApp::render(Application::Duration /* delta */) {
 void MiniCadApp::update(Duration delta) {
   auto deltaf = std::chrono::duration<float>(delta).count();
 
+  m_.jobs.poll();
+
   if (m_.orbiting_camera_operator.update(*m_.camera, *m_.camera_gimbal, math::Vec2f(window_->mouse_pos()), deltaf)) {
     m_.cursor->mark_dirty();
   }
@@ -1166,7 +1190,7 @@ bool MiniCadApp::on_selection_merge() {
     return false;
   }
 
-  auto points = m_.transformable_selection->points();
+  const auto& points = m_.transformable_selection->points();
   if (!m_.scene.merge_points(points.begin(), points.end())) {
     Logger::warn("Could not merge points");
     return false;
@@ -1370,7 +1394,7 @@ bool MiniCadApp::on_selection_set_single(const ObjectHandle& handle) {
 }
 
 bool MiniCadApp::on_selection_clear() {
-  for (const auto& handle : *m_.transformable_selection) {
+  for (const auto& handle : m_.transformable_selection->handles()) {
     std::visit(eray::util::match{
                    [&](const PointObjectHandle& h) {
                      m_.scene.renderer().push_object_rs_cmd(PointObjectRSCommand(
@@ -1391,7 +1415,7 @@ bool MiniCadApp::on_selection_clear() {
 
 bool MiniCadApp::on_selection_deleted() {
   auto result = false;
-  for (const auto& handle : *m_.transformable_selection) {
+  for (const auto& handle : m_.transformable_selection->handles()) {
     std::visit(util::match{[&](const auto& h) { result = on_obj_deleted(h) || result; }}, handle);
   }
   for (const auto& handle : *m_.non_transformable_selection) {
@@ -1432,37 +1456,75 @@ bool MiniCadApp::on_tool_action_start() {
 
 bool MiniCadApp::on_project_open(const std::filesystem::path& path) {
   util::Logger::info("Received file path: {}", path.string());
-  auto deserializer = JsonDeserializer::create();
-  if (auto file = std::ifstream(path)) {
+
+  // Reading and parsing runs on a worker, only the scene rebuild happens on the main thread
+  auto parse_project = [path](const JobContext& ctx) -> std::optional<json_schema::JsonProject> {
+    ctx.report(0.F, "Reading the file");
+    auto file = std::ifstream(path);
+    if (!file) {
+      util::Logger::err("Could not open file {}. Input stream could not be opened.", path.string());
+      return std::nullopt;
+    }
+
     std::ostringstream ss;
     ss << file.rdbuf();
     auto json = ss.str();
 
-    if (auto result = deserializer.deserialize(m_.scene, json); !result) {
+    ctx.report(0.5F, "Parsing the project");
+    auto project = JsonDeserializer::parse(json);
+    if (!project) {
       util::Logger::err("Could deserialize file with path {}.", path.string());
-    } else {
-      m_.proj_path = path;
-      util::Logger::succ("Loaded project from file: {}", path.string());
+      return std::nullopt;
     }
 
-  } else {
-    util::Logger::err("Could not open file {}. Input stream could not be opened.", path.string());
-  }
+    return std::move(*project);
+  };
+
+  auto load_project = [this, path](JobResult<std::optional<json_schema::JsonProject>>&& result) {
+    if (!result || !*result) {
+      return;
+    }
+
+    auto deserializer = JsonDeserializer::create();
+    deserializer.deserialize(m_.scene, **result);
+    m_.proj_path = path;
+    util::Logger::succ("Loaded project from file: {}", path.string());
+  };
+
+  m_.jobs.submit<std::optional<json_schema::JsonProject>>("Open project", std::move(parse_project),
+                                                          std::move(load_project));
 
   return true;
 }
 
 bool MiniCadApp::on_project_save_as(const std::filesystem::path& path) {
   util::Logger::info("Received file path: {}", path.string());
+
+  // The scene is serialized on the main thread, the worker only writes the file
   auto serializer = JsonSerializer::create();
   auto str        = serializer.serialize(m_.scene);
-  if (auto file = std::ofstream(path); file) {
+
+  auto write_project = [path, str = std::move(str)](const JobContext& ctx) {
+    ctx.report(0.F, "Writing the file");
+    auto file = std::ofstream(path);
+    if (!file) {
+      return false;
+    }
     file << str;
-    m_.proj_path = path;
-    util::Logger::succ("Saved project to file: {}", path.string());
-  } else {
-    util::Logger::err("Could save to file {}. Output stream could not be opened.", path.string());
-  }
+    return static_cast<bool>(file);
+  };
+
+  auto on_written = [this, path](JobResult<bool>&& result) {
+    if (result && *result) {
+      m_.proj_path = path;
+      util::Logger::succ("Saved project to file: {}", path.string());
+    } else {
+      util::Logger::err("Could save to file {}. Output stream could not be opened.", path.string());
+    }
+  };
+
+  m_.jobs.submit<bool>("Save project", std::move(write_project), std::move(on_written));
+
   return true;
 }
 
@@ -1678,60 +1740,71 @@ bool MiniCadApp::on_find_intersection(std::optional<eray::math::Vec3f> init_poin
     std::visit(util::match{append, [](const auto&) {}}, h);
   }
 
-  for (const auto& h : *m_.transformable_selection) {
+  for (const auto& h : m_.transformable_selection->handles()) {
     if (!std::visit(util::match{is_valid}, h)) {
       continue;
     }
     std::visit(util::match{append, [](const auto&) {}}, h);
   }
 
-  if (count == 2) {
-    auto unsafe_param_obj_extractor = [&](const auto& handle1, const auto& handle2) {
-      using T1 = ERAY_HANDLE_OBJ(handle1);
-      using T2 = ERAY_HANDLE_OBJ(handle2);
+  if (count == 0) {
+    return false;
+  }
 
-      CParametricSurfaceObject auto& obj1 = **m_.scene.arena<T1>().get_obj(handle1);
-      CParametricSurfaceObject auto& obj2 = **m_.scene.arena<T2>().get_obj(handle2);
-      auto curve = IntersectionFinder::find_intersection(m_.scene.renderer(), obj1, obj2, init_point, accuracy);
-      if (!curve) {
-        util::Logger::info("No intersection found");
-        return;
-      }
-      if (auto opt = m_.scene.create_obj_and_get<ApproxCurve>(DefaultApproxCurve{})) {
-        auto& obj = **opt;
-        obj.set_points(curve->points, curve->is_closed);
-        util::Logger::info("Created new approx curve from intersection points");
-      }
+  // The search runs on the snapshot, so the scene may be edited in the meantime. The objects are looked up again when
+  // the result is applied.
+  auto snapshot   = m_.scene.snapshot();
+  auto& renderer  = m_.scene.renderer();
+  auto find_curve = [snapshot, &renderer, first, second, count, init_point, accuracy](const JobContext& ctx) {
+    if (count == 2) {
+      return IntersectionFinder::find_intersection(renderer, *snapshot, first, second, init_point, accuracy, ctx);
+    }
+    return IntersectionFinder::find_self_intersection(renderer, *snapshot, first, init_point, accuracy, ctx);
+  };
 
-      obj1.trimming_manager().add(
-          ParamSpaceTrimmingData::from_intersection_curve(m_.scene.renderer(), curve->param_space1));
-      obj2.trimming_manager().add(
-          ParamSpaceTrimmingData::from_intersection_curve(m_.scene.renderer(), curve->param_space2));
-    };
+  auto apply_curve = [this, first, second, count](JobResult<std::optional<IntersectionFinder::Curve>>&& result) {
+    if (!result) {
+      util::Logger::info("Intersection search cancelled");
+      return;
+    }
+    if (!*result) {
+      util::Logger::info("No intersection found");
+      return;
+    }
 
-    std::visit(match{unsafe_param_obj_extractor}, first, second);
-  } else if (count == 1) {
-    auto unsafe_param_obj_extractor = [&](const auto& handle) {
-      using T = ERAY_HANDLE_OBJ(handle);
+    auto& curve = **result;
+    if (auto opt = m_.scene.create_obj_and_get<ApproxCurve>(DefaultApproxCurve{})) {
+      auto& obj = **opt;
+      if (count == 2) {
+        obj.set_points(curve.points, curve.is_closed);
+      } else {
+        obj.set_points(curve.points);
+      }
+      util::Logger::info("Created new approx curve from intersection points");
+    }
 
-      CParametricSurfaceObject auto& obj = **m_.scene.arena<T>().get_obj(handle);
+    if (count != 2) {
+      return;
+    }
 
-      auto curve = IntersectionFinder::find_self_intersection(m_.scene.renderer(), obj, init_point, accuracy);
-      if (!curve) {
-        util::Logger::info("No intersection found");
-        return;
-      }
-      if (auto opt = m_.scene.create_obj_and_get<ApproxCurve>(DefaultApproxCurve{})) {
-        auto& c_obj = **opt;
-        c_obj.set_points(curve->points);
-        util::Logger::info("Created new approx curve from intersection points");
-      }
+    auto add_trimming = [&](const IntersectionFinder::ParamSpace& param_space) {
+      return [&](const auto& handle) {
+        using T = ERAY_HANDLE_OBJ(handle);
+        if (auto opt = m_.scene.arena<T>().get_obj(handle)) {
+          opt.value()->trimming_manager().add(
+              ParamSpaceTrimmingData::from_intersection_curve(m_.scene.renderer(), param_space));
+        }
+      };
     };
 
-    std::visit(match{unsafe_param_obj_extractor}, first);
-  }
+    std::visit(match{add_trimming(curve.param_space1)}, first);
+    std::visit(match{add_trimming(curve.param_space2)}, second);
+  };
 
-  return false;
+  m_.jobs.submit<std::optional<IntersectionFinder::Curve>>("Find intersection", std::move(find_curve),
+                                                            std::move(apply_curve));
+
+  return true;
 }
 
 bool MiniCadApp::on_generate_height_map() {
@@ -1741,11 +1814,26 @@ bool MiniCadApp::on_generate_height_map() {
     std::visit(util::match{append, [](const auto&) {}}, h);
   }
 
-  m_.milling_height_map = HeightMap::create(m_.scene, handles);
+  auto snapshot        = m_.scene.snapshot();
+  auto sample_surfaces = [snapshot, handles = std::move(handles)](const JobContext& ctx) {
+    return HeightMap::sample(*snapshot, handles, MillingDesc{}, ctx);
+  };
+
+  auto apply_height_map = [this](JobResult<TiledHeightField>&& result) {
+    if (!result) {
+      util::Logger::info("Height map generation cancelled");
+      return;
+    }
+    m_.milling_height_map = HeightMap::from_samples(m_.scene, std::move(*result));
+  };
+
+  m_.jobs.submit<TiledHeightField>("Generate height map", std::move(sample_surfaces), std::move(apply_height_map));
+
   return true;
 }
 
-bool MiniCadApp::on_natural_spline_from_approx_curve(const ApproxCurveHandle& handle, size_t count) {
+bool MiniCadApp::on_natural_spline_from_approx_curve(const ApproxCurveHandle& handle, size_t count,
+                                                     float curvature_weight) {
   if (auto opt = m_.scene.arena<ApproxCurve>().get_obj(handle)) {
     auto& obj = **opt;
     if (obj.points().size() < count) {
@@ -1759,7 +1847,8 @@ bool MiniCadApp::on_natural_spline_from_approx_curve(const ApproxCurveHandle& ha
     }
     auto& spline = **spline_opt;
 
-    auto points = obj.get_equidistant_points(count);
+    auto points = curvature_weight > 0.F ? obj.get_curvature_weighted_points(count, curvature_weight)
+                                         : obj.get_equidistant_points(count);
 
     auto point_handles_opt = m_.scene.create_many_objs<PointObject>(Point{}, points.size());
     if (!point_handles_opt) {
@@ -16,6 +16,7 @@
 #include <liberay/util/iterator.hpp>
 #include <liberay/util/timer.hpp>
 #include <libminicad/algorithm/hole_finder.hpp>
+#include <libminicad/jobs/job_scheduler.hpp>
 #include <libminicad/renderer/rendering_command.hpp>
 #include <libminicad/renderer/scene_renderer.hpp>
 #include <libminicad/renderer/visibility_state.hpp>
@@ -81,6 +82,9 @@ class MiniCadApp final : public eray::os::Application {
     HelperPointSelection helper_point_selection;
 
     std::optional<HeightMap> milling_height_map;
+
+    // Declared last, so the workers are joined before the scene they may still reference is destroyed
+    JobScheduler jobs;
   };
 
   MiniCadApp(std::unique_ptr<eray::os::Window> window, Members&& m);
@@ -92,6 +96,7 @@ class MiniCadApp final : public eray::os::Application {
   void gui_objects_list_window();
   void gui_transform_window();
   void gui_object_window();
+  void gui_jobs_window();
 
   // GUI Events
   bool on_point_object_added(PointObjectVariant variant);
@@ -153,7 +158,8 @@ class MiniCadApp final : public eray::os::Application {
   bool on_find_intersection(std::optional<eray::math::Vec3f> init_point, float accuracy);
   bool on_generate_height_map();
 
-  bool on_natural_spline_from_approx_curve(const ApproxCurveHandle& handle, size_t count);
+  bool on_natural_spline_from_approx_curve(const ApproxCurveHandle& handle, size_t count,
+                                           float curvature_weight = 0.F);
 
   // Window Events
   bool on_mouse_pressed(const eray::os::MouseButtonPressedEvent& ev);
@@ -0,0 +1,124 @@
+#include <imgui/imgui.h>
+#include <imgui/imgui_stdlib.h>
+
+#include <cctype>
+#include <liberay/util/enum_mapper.hpp>
+#include <liberay/util/object_handle.hpp>
+#include <liberay/util/variant_match.hpp>
+#include <minicad/fonts/font_awesome.hpp>
+#include <minicad/imgui/scene_obj_list.hpp>
+#include <ranges>
+#include <string_view>
+#include <type_traits>
+#include <variant>
+
+namespace ImGui::mini {
+
+namespace {
+
+std::string to_lower(std::string_view str) {
+  return str | std::views::transform([](char c) {
+           return static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+         }) |
+         std::ranges::to<std::string>();
+}
+
+}  // namespace
+
+void SceneObjList::filter_widgets() {
+  static constexpr auto kTypeNames = eray::util::StringEnumMapper<SceneObjTypeFilter>({
+      {SceneObjTypeFilter::All, "All"},                          //
+      {SceneObjTypeFilter::Points, "Points"},                    //
+      {SceneObjTypeFilter::Curves, "Curves"},                    //
+      {SceneObjTypeFilter::PatchSurfaces, "Patch Surfaces"},     //
+      {SceneObjTypeFilter::FillInSurfaces, "Fill In Surfaces"},  //
+      {SceneObjTypeFilter::ApproxCurves, "Approx Curves"},       //
+      {SceneObjTypeFilter::ParamPrimitives, "Param Surfaces"},   //
+  });
+
+  ImGui::InputTextWithHint("##Filter", ICON_FA_MAGNIFYING_GLASS " Filter", &filter.text);
+  if (ImGui::BeginCombo("Type", kTypeNames[filter.type].c_str())) {
+    for (auto [type, name] : kTypeNames) {
+      const auto is_selected = (filter.type == type);
+      if (ImGui::Selectable(name.c_str(), is_selected)) {
+        filter.type = type;
+      }
+
+      if (is_selected) {
+        ImGui::SetItemDefaultFocus();
+      }
+    }
+    ImGui::EndCombo();
+  }
+  ImGui::Checkbox("Hide points", &filter.hide_points);
+}
+
+const std::vector<size_t>& SceneObjList::indices(const ::mini::Scene& scene) {
+  if (cached_version_ != scene.objects_version() || cached_filter_ != filter) {
+    rebuild(scene);
+  }
+
+  return indices_;
+}
+
+void SceneObjList::rebuild(const ::mini::Scene& scene) {
+  const auto lowercase_text = to_lower(filter.text);
+  const auto& handles       = scene.handles();
+
+  indices_.clear();
+  for (auto i = size_t{0}; i < handles.size(); ++i) {
+    if (matches(scene, handles[i], lowercase_text)) {
+      indices_.push_back(i);
+    }
+  }
+
+  cached_version_ = scene.objects_version();
+  cached_filter_  = filter;
+}
+
+bool SceneObjList::matches(const ::mini::Scene& scene, const ::mini::ObjectHandle& handle,
+                           const std::string& lowercase_text) const {
+  auto type_matches = [this](const auto& h) {
+    using T = ERAY_HANDLE_OBJ(h);
+    switch (filter.type) {
+      case SceneObjTypeFilter::All:
+        return true;
+      case SceneObjTypeFilter::Points:
+        return std::is_same_v<T, ::mini::PointObject>;
+      case SceneObjTypeFilter::Curves:
+        return std::is_same_v<T, ::mini::Curve>;
+      case SceneObjTypeFilter::PatchSurfaces:
+        return std::is_same_v<T, ::mini::PatchSurface>;
+      case SceneObjTypeFilter::FillInSurfaces:
+        return std::is_same_v<T, ::mini::FillInSurface>;
+      case SceneObjTypeFilter::ApproxCurves:
+        return std::is_same_v<T, ::mini::ApproxCurve>;
+      case SceneObjTypeFilter::ParamPrimitives:
+        return std::is_same_v<T, ::mini::ParamPrimitive>;
+      case SceneObjTypeFilter::_Count:
+        return false;
+    }
+    return false;
+  };
+
+  auto obj_matches = [&](const auto& h) {
+    using T = ERAY_HANDLE_OBJ(h);
+    auto opt = scene.arena<T>().get_obj(h);
+    if (!opt) {
+      return false;
+    }
+    const auto& obj = **opt;
+
+    if constexpr (std::is_same_v<T, ::mini::PointObject>) {
+      if (filter.hide_points && obj.template has_type<::mini::Point>()) {
+        return false;
+      }
+    }
+
+    return lowercase_text.empty() || to_lower(obj.name).contains(lowercase_text);
+  };
+
+  return std::visit(eray::util::match{[&](const auto& h) { return type_matches(h) && obj_matches(h); }}, handle);
+}
+
+}  // namespace ImGui::mini
@@ -1 +1,65 @@
 #pragma once
+
+#include <cstdint>
+#include <libminicad/scene/handles.hpp>
+#include <libminicad/scene/scene.hpp>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace ImGui::mini {  // NOLINT
+
+enum class SceneObjTypeFilter : uint8_t {
+  All             = 0,
+  Points          = 1,
+  Curves          = 2,
+  PatchSurfaces   = 3,
+  FillInSurfaces  = 4,
+  ApproxCurves    = 5,
+  ParamPrimitives = 6,
+  _Count          = 7,  // NOLINT
+};
+
+struct SceneObjFilter {
+  std::string text;
+  SceneObjTypeFilter type = SceneObjTypeFilter::All;
+  bool hide_points        = false;
+
+  bool operator==(const SceneObjFilter&) const = default;
+};
+
+/**
+ * @brief Cached indices (into `Scene::handles()`) of the objects passing the filter. The index is rebuilt only when
+ * the scene objects version or the filter changes, so with the list clipper the per frame cost of the objects list does
+ * not depend on the scene size.
+ *
+ */
+class SceneObjList {
+ public:
+  /**
+   * @brief Draws the text and type filter widgets.
+   *
+   */
+  void filter_widgets();
+
+  const std::vector<size_t>& indices(const ::mini::Scene& scene);
+
+  const ::mini::ObjectHandle& handle(const ::mini::Scene& scene, size_t row) const {
+    return scene.handles()[indices_[row]];
+  }
+
+  size_t count() const { return indices_.size(); }
+
+ public:
+  SceneObjFilter filter;
+
+ private:
+  void rebuild(const ::mini::Scene& scene);
+  bool matches(const ::mini::Scene& scene, const ::mini::ObjectHandle& handle, const std::string& lowercase_text) const;
+
+  std::vector<size_t> indices_;
+  std::optional<size_t> cached_version_;
+  SceneObjFilter cached_filter_;
+};
+
+}  // namespace ImGui::mini
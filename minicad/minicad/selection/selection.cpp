@@ -1,3 +1,6 @@
+#include <algorithm>
+#include <array>
+#include <functional>
 #include <liberay/math/vec_fwd.hpp>
 #include <liberay/util/object_handle.hpp>
 #include <liberay/util/variant_match.hpp>
@@ -9,31 +12,82 @@
 #include <minicad/selection/selection.hpp>
 #include <optional>
 #include <variant>
+#include <vector>
 
 namespace mini {
 
 using Vec3f = eray::math::Vec3f;
 
+namespace {
+
+/**
+ * @brief Sums the coordinates using independent partial sums, which lets the compiler vectorize the reduction
+ * without relaxing the floating point semantics.
+ *
+ */
+float sum(const std::vector<float>& values) {
+  static constexpr size_t kLanes = 8;
+
+  auto lanes = std::array<float, kLanes>{};
+  auto i     = size_t{0};
+  for (; i + kLanes <= values.size(); i += kLanes) {
+    for (auto k = size_t{0}; k < kLanes; ++k) {
+      lanes[k] += values[i + k];
+    }
+  }
+  for (; i < values.size(); ++i) {
+    lanes[0] += values[i];
+  }
+
+  return std::ranges::fold_left(lanes, 0.F, std::plus<>());
+}
+
+}  // namespace
+
+bool TransformableSelection::insert(const TransformableObjectHandle& handle) {
+  return std::visit(eray::util::match{
+                        [this](const PointObjectHandle& h) { return points_.insert(h); },
+                        [this](const ParamPrimitiveHandle& h) { return primitives_.insert(h); },
+                    },
+                    handle);
+}
+
+bool TransformableSelection::erase(const TransformableObjectHandle& handle) {
+  return std::visit(eray::util::match{
+                        [this](const PointObjectHandle& h) { return points_.erase(h); },
+                        [this](const ParamPrimitiveHandle& h) { return primitives_.erase(h); },
+                    },
+                    handle);
+}
+
+std::generator<TransformableObjectHandle> TransformableSelection::handles() const {
+  for (const auto& h : points_.handles()) {
+    co_yield h;
+  }
+  for (const auto& h : primitives_.handles()) {
+    co_yield h;
+  }
+}
+
 void TransformableSelection::remove(Scene& scene, const TransformableObjectHandle& handle) {
-  auto f = objs_.find(handle);
-  if (f == objs_.end()) {
+  if (!contains(handle)) {
     return;
   }
   detach_all(scene);
 
-  objs_.erase(objs_.find(handle));
+  erase(handle);
   update_centroid(scene);
   update_is_points_only_selection();
 }
 
 void TransformableSelection::add(Scene& scene, const TransformableObjectHandle& handle) {
-  if (points_only_ || objs_.empty()) {
+  if (points_only_ || is_empty()) {
     points_only_ = std::holds_alternative<PointObjectHandle>(handle);
   }
 
   detach_all(scene);
 
-  objs_.insert(handle);
+  insert(handle);
   update_centroid(scene);
 }
 
@@ -41,14 +95,17 @@ void TransformableSelection::clear(Scene& scene) {
   points_only_ = false;
   detach_all(scene);
 
-  objs_.clear();
+  points_.clear();
+  primitives_.clear();
   transform.reset_local(eray::math::Vec3f::filled(0.F));
+  sync_transform();
 }
 
 void TransformableSelection::set_custom_origin(Scene& scene, eray::math::Vec3f vec) {
   if (use_custom_origin_) {
     detach_all(scene);
     transform.reset_local(vec);
+    sync_transform();
   }
 
   custom_origin_ = vec;
@@ -64,10 +121,16 @@ void TransformableSelection::use_custom_origin(Scene& scene, bool use_custom_ori
   use_custom_origin_ = use_custom_origin;
   if (!use_custom_origin_) {
     transform.reset_local(centroid_);
+    sync_transform();
   }
 }
 
 void TransformableSelection::update_transforms(Scene& scene, Cursor& cursor) {
+  // The points are moved in one batch and their dependents are refreshed once. The param primitives need the full
+  // transform, so they are parented to the selection transform instead.
+  transform_points(scene);
+  scene.update_points(points_.handles());
+
   if (use_custom_origin_) {
     update_centroid(scene);
     cursor.transform.set_local_pos(transform.pos());
@@ -76,53 +139,80 @@ void TransformableSelection::update_transforms(Scene& scene, Cursor& cursor) {
     centroid_ = transform.pos();
   }
 
-  auto obj_update = [&](const auto& handle) {
-    using T = ERAY_HANDLE_OBJ(handle);
-    if (auto opt = scene.arena<T>().get_obj(handle)) {
-      CObject auto& obj = **opt;
-      obj.update();
+  for (const auto& handle : primitives_.handles()) {
+    if (auto opt = scene.arena<ParamPrimitive>().get_obj(handle)) {
+      opt.value()->update();
     }
-  };
-
-  for (const auto& handle : objs_) {
-    std::visit(eray::util::match{obj_update}, handle);
   }
 
   if (transform_dirty_) {
     return;
   }
 
-  auto obj_set_parent = [&](const auto& handle) {
-    using T = ERAY_HANDLE_OBJ(handle);
-    if (auto opt = scene.arena<T>().get_obj(handle)) {
-      CTransformableObject auto& obj = **opt;
-      obj.transform().set_parent(transform);
+  transform_dirty_ = true;
+  for (const auto& handle : primitives_.handles()) {
+    if (auto opt = scene.arena<ParamPrimitive>().get_obj(handle)) {
+      opt.value()->transform().set_parent(transform);
     }
-  };
+  }
+}
 
-  transform_dirty_ = true;
-  for (const auto& handle : objs_) {
-    std::visit(eray::util::match{obj_set_parent}, handle);
+void TransformableSelection::gather_positions(Scene& scene) {
+  const auto& handles = points_.handles();
+  positions_.x.resize(handles.size());
+  positions_.y.resize(handles.size());
+  positions_.z.resize(handles.size());
+
+  for (auto i = size_t{0}; i < handles.size(); ++i) {
+    auto pos = eray::math::Vec3f::filled(0.F);
+    if (auto opt = scene.arena<PointObject>().get_obj(handles[i])) {
+      pos = opt.value()->transform().pos();
+    }
+    positions_.x[i] = pos.x;
+    positions_.y[i] = pos.y;
+    positions_.z[i] = pos.z;
   }
 }
 
-void TransformableSelection::detach_all(Scene& scene) {
-  auto detach_from_parent = [&](const auto& handle) {
-    using T = ERAY_HANDLE_OBJ(handle);
-    if (auto opt = scene.arena<T>().get_obj(handle)) {
-      CTransformableObject auto& obj = **opt;
-      obj.transform().detach_from_parent();
-      obj.update();
+void TransformableSelection::transform_points(Scene& scene) {
+  auto delta = transform.local_to_world_matrix() * synced_world_to_local_;
+  sync_transform();
+
+  gather_positions(scene);
+
+  // The matrices are column major
+  auto& xs = positions_.x;
+  auto& ys = positions_.y;
+  auto& zs = positions_.z;
+  for (auto i = size_t{0}; i < xs.size(); ++i) {
+    auto x = xs[i];
+    auto y = ys[i];
+    auto z = zs[i];
+    xs[i]  = delta[0][0] * x + delta[1][0] * y + delta[2][0] * z + delta[3][0];
+    ys[i]  = delta[0][1] * x + delta[1][1] * y + delta[2][1] * z + delta[3][1];
+    zs[i]  = delta[0][2] * x + delta[1][2] * y + delta[2][2] * z + delta[3][2];
+  }
+
+  const auto& handles = points_.handles();
+  for (auto i = size_t{0}; i < handles.size(); ++i) {
+    if (auto opt = scene.arena<PointObject>().get_obj(handles[i])) {
+      opt.value()->transform().set_local_pos(Vec3f(xs[i], ys[i], zs[i]));
     }
-  };
+  }
+}
 
+void TransformableSelection::detach_all(Scene& scene) {
   if (!transform_dirty_) {
     return;
   }
   transform_dirty_ = false;
 
-  for (const auto& handle : objs_) {
-    std::visit(eray::util::match{detach_from_parent}, handle);
+  for (const auto& handle : primitives_.handles()) {
+    if (auto opt = scene.arena<ParamPrimitive>().get_obj(handle)) {
+      auto& obj = **opt;
+      obj.transform().detach_from_parent();
+      obj.update();
+    }
   }
 }
 
@@ -131,39 +221,28 @@ void TransformableSelection::update_centroid(Scene& scene) {
   if (is_empty()) {
     if (!use_custom_origin_) {
       transform.reset_local(centroid_);
+      sync_transform();
     }
     return;
   }
 
-  int count            = 0;
-  auto update_centroid = [&](const auto& handle) {
-    using T = ERAY_HANDLE_OBJ(handle);
-    if (auto opt = scene.arena<T>().get_obj(handle)) {
-      CTransformableObject auto& obj = **opt;
-      centroid_ += obj.transform().pos();
-      count++;
+  gather_positions(scene);
+  centroid_ = Vec3f(sum(positions_.x), sum(positions_.y), sum(positions_.z));
+
+  for (const auto& handle : primitives_.handles()) {
+    if (auto opt = scene.arena<ParamPrimitive>().get_obj(handle)) {
+      centroid_ += opt.value()->transform().pos();
     }
-  };
-  for (const auto& obj : objs_) {
-    std::visit(eray::util::match{update_centroid}, obj);
   }
 
-  centroid_ /= static_cast<float>(count);
+  centroid_ /= static_cast<float>(size());
   if (!use_custom_origin_) {
     transform.reset_local(centroid_);
+    sync_transform();
   }
 }
 
-void TransformableSelection::update_is_points_only_selection() {
-  points_only_ = true;
-
-  for (const auto& h : objs_) {
-    if (!std::holds_alternative<PointObjectHandle>(h)) {
-      points_only_ = false;
-      return;
-    }
-  }
-}
+void TransformableSelection::update_is_points_only_selection() { points_only_ = primitives_.empty(); }
 
 std::optional<eray::math::Vec3f> HelperPointSelection::pos(Scene& scene) {
   if (!selection_) {
@@ -1,8 +1,12 @@
 #pragma once
 
+#include <generator>
+#include <liberay/math/mat.hpp>
 #include <liberay/math/transform3_fwd.hpp>
 #include <liberay/math/vec.hpp>
 #include <liberay/util/iterator.hpp>
+#include <liberay/util/object_handle.hpp>
+#include <liberay/util/variant_match.hpp>
 #include <libminicad/scene/handles.hpp>
 #include <libminicad/scene/scene_object.hpp>
 #include <minicad/cursor/cursor.hpp>
@@ -10,6 +14,7 @@
 #include <ranges>
 #include <unordered_set>
 #include <variant>
+#include <vector>
 
 namespace mini {
 
@@ -47,6 +52,77 @@ class NonTransformableSelection {
   std::unordered_set<NonTransformableObjectHandle> objs_;
 };
 
+/**
+ * @brief Dense array of handles with a bitset indexed by the object ids for the membership tests. The removal moves
+ * the last handle into the freed slot, so the order of the handles is not preserved.
+ *
+ */
+template <typename TObject>
+class DenseHandleSet {
+ public:
+  using Handle = eray::util::Handle<TObject>;
+
+  bool insert(const Handle& handle) {
+    auto id = static_cast<size_t>(handle.obj_id);
+    if (id >= members_.size()) {
+      members_.resize(id + 1, false);
+      slots_.resize(id + 1, 0);
+    }
+
+    if (members_[id]) {
+      // The object id might have been reused by a new object, the stale handle is replaced then
+      auto& stored = handles_[slots_[id]];
+      if (stored == handle) {
+        return false;
+      }
+      stored = handle;
+      return true;
+    }
+
+    members_[id] = true;
+    slots_[id]   = handles_.size();
+    handles_.push_back(handle);
+    return true;
+  }
+
+  bool erase(const Handle& handle) {
+    if (!contains(handle)) {
+      return false;
+    }
+
+    auto id   = static_cast<size_t>(handle.obj_id);
+    auto slot = slots_[id];
+    if (slot + 1 != handles_.size()) {
+      handles_[slot]                                     = handles_.back();
+      slots_[static_cast<size_t>(handles_[slot].obj_id)] = slot;
+    }
+    handles_.pop_back();
+    members_[id] = false;
+    return true;
+  }
+
+  bool contains(const Handle& handle) const {
+    auto id = static_cast<size_t>(handle.obj_id);
+    return id < members_.size() && members_[id] && handles_[slots_[id]] == handle;
+  }
+
+  void clear() {
+    for (const auto& h : handles_) {
+      members_[static_cast<size_t>(h.obj_id)] = false;
+    }
+    handles_.clear();
+  }
+
+  const std::vector<Handle>& handles() const { return handles_; }
+  size_t size() const { return handles_.size(); }
+  bool empty() const { return handles_.empty(); }
+
+ private:
+  std::vector<Handle> handles_;
+  std::vector<bool> members_;
+  std::vector<size_t> slots_;
+};
+
 class TransformableSelection {
  public:
   void remove(Scene& scene, const TransformableObjectHandle& handle);
@@ -56,7 +132,9 @@ class TransformableSelection {
   template <eray::util::Iterator<TransformableObjectHandle> It>
   void add_many(Scene& scene, It begin, It end) {
     detach_all(scene);
-    objs_.insert(begin, end);
+    for (const auto& handle : std::ranges::subrange(begin, end)) {
+      insert(handle);
+    }
     update_centroid(scene);
     update_is_points_only_selection();
   }
@@ -65,33 +143,42 @@ class TransformableSelection {
   void remove_many(Scene& scene, It begin, It end) {
     detach_all(scene);
     for (const auto& handle : std::ranges::subrange(begin, end)) {
-      auto f = objs_.find(handle);
-      if (f != objs_.end()) {
-        objs_.erase(f);
-      }
+      erase(handle);
     }
     update_centroid(scene);
     update_is_points_only_selection();
   }
 
-  bool is_multi_selection() const { return objs_.size() > 1; }
-  bool is_single_selection() const { return objs_.size() == 1; }
-  bool is_empty() const { return objs_.empty(); }
+  size_t size() const { return points_.size() + primitives_.size(); }
+  bool is_multi_selection() const { return size() > 1; }
+  bool is_single_selection() const { return size() == 1; }
+  bool is_empty() const { return size() == 0; }
 
-  bool contains(const TransformableObjectHandle& handle) const { return objs_.contains(handle); }
+  bool contains(const TransformableObjectHandle& handle) const {
+    return std::visit(eray::util::match{
+                          [this](const PointObjectHandle& h) { return points_.contains(h); },
+                          [this](const ParamPrimitiveHandle& h) { return primitives_.contains(h); },
+                      },
+                      handle);
+  }
 
   auto centroid() const { return centroid_; }
 
-  const TransformableObjectHandle& first() { return *objs_.begin(); }
-  std::optional<TransformableObjectHandle> single() {
+  TransformableObjectHandle first() const {
+    if (!points_.empty()) {
+      return points_.handles().front();
+    }
+    return primitives_.handles().front();
+  }
+  std::optional<TransformableObjectHandle> single() const {
     if (is_single_selection()) {
-      return *objs_.begin();
+      return first();
     }
     return std::nullopt;
   }
-  std::optional<PointObjectHandle> single_point() {
-    if (is_single_selection() && std::holds_alternative<PointObjectHandle>(*objs_.begin())) {
-      return std::get<PointObjectHandle>(*objs_.begin());
+  std::optional<PointObjectHandle> single_point() const {
+    if (is_single_selection() && !points_.empty()) {
+      return points_.handles().front();
     }
     return std::nullopt;
   }
@@ -104,25 +191,54 @@ class TransformableSelection {
 
   bool is_points_only() const { return points_only_; }
 
-  auto points() const {
-    auto is_point = [](const TransformableObjectHandle& h) { return std::holds_alternative<PointObjectHandle>(h); };
-    auto to_point = [](const TransformableObjectHandle& h) { return std::get<PointObjectHandle>(h); };
-    return objs_ | std::views::filter(is_point) | std::views::transform(to_point);
-  }
+  const std::vector<PointObjectHandle>& points() const { return points_.handles(); }
 
-  auto begin() { return objs_.begin(); }
-  auto begin() const { return objs_.begin(); }
-  auto end() { return objs_.end(); }
-  auto end() const { return objs_.end(); }
+  /**
+   * @brief Yields the selected points followed by the selected param primitives.
+   *
+   */
+  std::generator<TransformableObjectHandle> handles() const;
 
  public:
   eray::math::Transform3f transform;
 
  private:
+  /**
+   * @brief Positions of the selected points stored as separate coordinate arrays, so the batch operations are
+   * vectorized by the compiler.
+   *
+   */
+  struct PointPositions {
+    std::vector<float> x;
+    std::vector<float> y;
+    std::vector<float> z;
+  };
+
+  bool insert(const TransformableObjectHandle& handle);
+  bool erase(const TransformableObjectHandle& handle);
+
   void detach_all(Scene& scene);
   void update_centroid(Scene& scene);
   void update_is_points_only_selection();
 
+  /**
+   * @brief Loads the positions of the selected points into the coordinate arrays.
+   *
+   */
+  void gather_positions(Scene& scene);
+
+  /**
+   * @brief Applies the change of the selection transform since the last call to all of the selected points at once.
+   *
+   */
+  void transform_points(Scene& scene);
+
+  /**
+   * @brief Makes the current selection transform the reference for the next `transform_points` call.
+   *
+   */
+  void sync_transform() { synced_world_to_local_ = transform.world_to_local_matrix(); }
+
  private:
   bool transform_dirty_;
   bool use_custom_origin_;
@@ -132,8 +248,11 @@ class TransformableSelection {
   eray::math::Vec3f centroid_;
   eray::math::Vec3f custom_origin_;
 
-  // NOTE: The hashes of  handles of different types are typically non colliding because of the timestamp.
-  std::unordered_set<TransformableObjectHandle> objs_;
+  DenseHandleSet<PointObject> points_;
+  DenseHandleSet<ParamPrimitive> primitives_;
+
+  PointPositions positions_;
+  eray::math::Mat4f synced_world_to_local_ = eray::math::Mat4f::identity();
 };
 
 struct HelperPoint {